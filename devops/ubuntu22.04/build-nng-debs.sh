@@ -15,6 +15,9 @@ quilt push
 quilt import -P ce_nng_hub.patch "$TARGET_DIR/ce_nng_hub.patch"
 quilt push
 dch -n "CE NNG hub protocol support"
+quilt import -P ce_nng_hub_addressing.patch "$TARGET_DIR/ce_nng_hub_addressing.patch"
+quilt push
+dch -n "CE NNG hub peer addressing"
 quilt import -P ce_fix_mbedtls_lookup.patch "$TARGET_DIR/ce_fix_mbedtls_lookup.patch"
 quilt push
 dch -n "Fix mbedTLS lookup"
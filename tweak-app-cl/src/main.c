@@ -65,6 +65,8 @@ static const char* s_params = NULL;
 
 static const char* s_uri = NULL;
 
+static const char* s_uri_patterns = NULL;
+
 static tweak_id s_tweak_id = TWEAK_INVALID_ID;
 
 static bool s_is_connected = false;
@@ -149,15 +151,24 @@ static void print_brief(const tweak_app_item_snapshot* snapshot) {
   tweak_variant_destroy_string(&current_value_str);
 }
 
-static void execute_list_cmd(tweak_app_client_context context, char **tokens) {
-  TWEAK_LOG_TRACE_ENTRY("context = %p tokens = %p", context, tokens);
+static struct tweak_app_cl_tweak_uris_list* create_uris_list(tweak_app_client_context context, char **tokens) {
   bool use_regex = tokens[0] && tokens[1]
     && (strcmp("re", tokens[0]) == 0 || strcmp("regex", tokens[0]) == 0);
+  bool use_glob = tokens[0] && tokens[1] && strcmp("glob", tokens[0]) == 0;
 
-  const char* pattern = use_regex ? tokens[1] : tokens[0];
-  struct tweak_app_cl_tweak_uris_list* uris_list = use_regex
-    ? tweak_app_cl_create_sorted_tweak_uris_list_regex(context, pattern)
-    : tweak_app_cl_create_sorted_tweak_uris_list_strstr(context, pattern);
+  const char* pattern = use_regex || use_glob ? tokens[1] : tokens[0];
+  if (use_regex) {
+    return tweak_app_cl_create_sorted_tweak_uris_list_regex(context, pattern);
+  } else if (use_glob) {
+    return tweak_app_cl_create_sorted_tweak_uris_list_glob(context, pattern);
+  } else {
+    return tweak_app_cl_create_sorted_tweak_uris_list_strstr(context, pattern);
+  }
+}
+
+static void execute_list_cmd(tweak_app_client_context context, char **tokens) {
+  TWEAK_LOG_TRACE_ENTRY("context = %p tokens = %p", context, tokens);
+  struct tweak_app_cl_tweak_uris_list* uris_list = create_uris_list(context, tokens);
 
   if (!uris_list) {
     fprintf(stderr, "ERROR: Can't build uri list. Review regex search pattern.\n");
@@ -181,13 +192,7 @@ static void execute_list_cmd(tweak_app_client_context context, char **tokens) {
 
 static void execute_details_cmd(tweak_app_client_context context, char **tokens) {
   TWEAK_LOG_TRACE_ENTRY("context = %p tokens = %p", context, tokens);
-  bool use_regex = tokens[0] && tokens[1]
-    && (strcmp("re", tokens[0]) == 0 || strcmp("regex", tokens[0]) == 0);
-
-  const char* pattern = use_regex ? tokens[1] : tokens[0];
-  struct tweak_app_cl_tweak_uris_list* uris_list = use_regex
-    ? tweak_app_cl_create_sorted_tweak_uris_list_regex(context, pattern)
-    : tweak_app_cl_create_sorted_tweak_uris_list_strstr(context, pattern);
+  struct tweak_app_cl_tweak_uris_list* uris_list = create_uris_list(context, tokens);
 
   if (!uris_list) {
     fprintf(stderr, "ERROR: Can't build uri list. Review search pattern.\n");
@@ -265,24 +270,34 @@ static void execute_wait_cmd(tweak_app_client_context context, char **tokens) {
   }
 }
 
+static void execute_subscribe_cmd(tweak_app_client_context context, char **tokens) {
+  TWEAK_LOG_TRACE_ENTRY("context = %p tokens = %p", context, tokens);
+  tweak_app_client_subscribe(context, tokens[0]);
+  printf("Subscribed to %s\n", tokens[0] ? tokens[0] : "all items");
+}
+
+static void format_current_value(const tweak_app_item_view* view, void* cookie) {
+  tweak_variant_string* string_repr = cookie;
+  *string_repr = tweak_app_cl_metadata_aware_variant_to_string(view->current_value, view->meta);
+}
+
 static void execute_get_cmd(tweak_app_client_context context, char **tokens) {
   TWEAK_LOG_TRACE_ENTRY("context = %p tokens = %p", context, tokens);
   tweak_id tweak_id = get_tweak_id(context, tokens[0], NULL);
   if (tweak_id == TWEAK_INVALID_ID)
     return;
 
-  tweak_app_item_snapshot* snapshot = tweak_app_item_get_snapshot(context, tweak_id);
-  if (snapshot) {
-    tweak_variant_string string_repr =
-      tweak_app_cl_metadata_aware_variant_to_string(&snapshot->current_value, &snapshot->meta);
+  tweak_variant_string string_repr = TWEAK_VARIANT_STRING_EMPTY;
+  tweak_app_error_code error_code =
+    tweak_app_item_read(context, tweak_id, &format_current_value, &string_repr);
+  if (error_code == TWEAK_APP_SUCCESS || error_code == TWEAK_APP_SUCCESS_LAST_KNOWN_VALUE) {
     const char* format = s_is_connected
       ? "%s\n"
       : "Last known value : %s\n";
     printf(format, tweak_variant_string_c_str(&string_repr));
     tweak_variant_destroy_string(&string_repr);
-    tweak_app_release_snapshot(context, snapshot);
   } else {
-    TWEAK_LOG_ERROR("tweak_app_item_get_snapshot() with context = %p and tweak_id = %" PRIu64 "", context, tweak_id);
+    TWEAK_LOG_ERROR("tweak_app_item_read() with context = %p and tweak_id = %" PRIu64 "", context, tweak_id);
     fprintf(stderr, "ERROR: Internal tweak-app-cl error. Check error logs\n");
   }
 }
@@ -570,6 +585,7 @@ static const char s_quick_help[] =
   "Supported commands are: \n"
   " - ? or help [ command ]\n"
   " - wait <tweak_uri>\n"
+  " - subscribe [ patterns ]\n"
   " - details [ pattern ]\n"
   " - list [ pattern ]\n"
   " - load filename\n"
@@ -586,11 +602,19 @@ static const char s_help_help[] =
 static const char s_wait_help[] =
   "Blocks until item with given uri appears in scope.\n";
 
+static const char s_help_subscribe[] =
+  "Asks server to announce only items whose uris match any of given glob patterns\n"
+  "separated by semicolon, as in \"subscribe /camera/exposure_*;/isp/**\".\n"
+  "Items that don't match are dropped. If patterns are omitted, all items are announced.\n";
+
 static const char s_help_list[] =
   "This function is invoked by list command followed by optional pattern.\n"
   "It displays all items whose uris matches provided filter.\n"
   "User could provide POSIX regex prefixed by \"re\" argument, as in \"list re [ABC]/d\"\n"
   "that will match all occurrences of A/d, B/d, or C/d.\n"
+  "Glob pattern prefixed by \"glob\" argument, as in \"list glob /camera/*/gain\"\n"
+  "only visits items under the part preceding the first wildcard. '*' and '?' don't match '/',\n"
+  "\"**\" matches any sequence of characters.\n"
   "If pattern is omitted, no filter is applied.\n";
 
 static const char s_help_details[] =
@@ -598,6 +622,9 @@ static const char s_help_details[] =
   "It displays all items whose uris matches provided filter.\n"
   "User could provide POSIX regex prefixed by \"re\" argument, as in \"details re [ABC]/d\"\n"
   "that will match all occurrences of A/d, B/d, or C/d.\n"
+  "Glob pattern prefixed by \"glob\" argument, as in \"details glob /camera/*/gain\"\n"
+  "only visits items under the part preceding the first wildcard. '*' and '?' don't match '/',\n"
+  "\"**\" matches any sequence of characters.\n"
   "If pattern is omitted, no filter is applied.\n";
 
 static const char s_help_load[] =
@@ -636,6 +663,7 @@ static const char s_help_exit[] =
 
 struct command_handler_pair command_handler_pairs[] = {
   { "wait", &guess_tweak_uri, &execute_wait_cmd, &s_wait_help[0] },
+  { "subscribe", &guess_no_arg, &execute_subscribe_cmd, &s_help_subscribe[0] },
   { "list", &guess_tweak_uri, &execute_list_cmd, &s_help_list[0] },
   { "details", &guess_tweak_uri, &execute_details_cmd, &s_help_details[0] },
   { "select", &guess_tweak_uri, &execute_select_cmd, &s_help_select[0] },
@@ -825,7 +853,7 @@ int main(int argc, char **argv) {
 
   int opt;
   atexit(&cleanup);
-  while ((opt = getopt(argc, argv, "t:p:u:L:")) != -1) {
+  while ((opt = getopt(argc, argv, "t:p:u:s:L:")) != -1) {
     switch (opt) {
     case 't':
       s_connection_type = optarg;
@@ -836,6 +864,9 @@ int main(int argc, char **argv) {
     case 'u':
       s_uri = optarg;
       break;
+    case 's':
+      s_uri_patterns = optarg;
+      break;
     case 'L':
       s_log_output = fopen(optarg, "wa+");
       if (!s_log_output) {
@@ -843,7 +874,7 @@ int main(int argc, char **argv) {
       }
       break;
     default: /* '?' */
-      fprintf(stderr, "Usage: %s [-t connection type] [-p params] [-u uri]\n", argv[0]);
+      fprintf(stderr, "Usage: %s [-t connection type] [-p params] [-u uri] [-s uri patterns]\n", argv[0]);
       exit(EXIT_FAILURE);
     }
   }
@@ -861,6 +892,10 @@ int main(int argc, char **argv) {
   tweak_uri_list.app_context = app_context;
   tweak_common_mutex_unlock(&tweak_uri_list.lock);
 
+  if (app_context && s_uri_patterns) {
+    tweak_app_client_subscribe(app_context, s_uri_patterns);
+  }
+
   if (app_context) {
     result = main_loop(app_context);
     tweak_app_flush_queue(app_context);
@@ -160,6 +160,33 @@ struct tweak_app_cl_tweak_uris_list* tweak_app_cl_create_sorted_tweak_uris_list_
   }
 }
 
+struct tweak_app_cl_tweak_uris_list* tweak_app_cl_create_sorted_tweak_uris_list_glob(tweak_app_client_context context,
+                                                                                     const char* pattern)
+{
+  struct enumerate_context enumerate_context = { 0 };
+
+  /* Items are traversed in lexicographic order, so there's no need to sort them */
+  bool success = tweak_app_traverse_glob(context, pattern ? pattern : "**",
+                                         &enumerate_traverse_strstr, &enumerate_context)
+    && ensure_capacity(&enumerate_context, enumerate_context.size + 1);
+
+  if (success) {
+    enumerate_context.uris[enumerate_context.size] = NULL;
+    struct tweak_app_cl_tweak_uris_list* result = calloc(1, sizeof(*result));
+    if (!result) {
+      tweak_app_cl_release_tokens(enumerate_context.uris);
+      return NULL;
+    }
+
+    result->uris = (const char **)enumerate_context.uris;
+    result->size = enumerate_context.size;
+
+    return result;
+  } else {
+    return NULL;
+  }
+}
+
 typedef int (*comparator_proc)(const void *, const void *);
 
 static size_t lower_bound(const void *needle,
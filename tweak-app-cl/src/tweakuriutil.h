@@ -83,6 +83,20 @@ struct tweak_app_cl_tweak_uris_list* tweak_app_cl_create_sorted_tweak_uris_list_
 struct tweak_app_cl_tweak_uris_list* tweak_app_cl_create_sorted_tweak_uris_list_regex(tweak_app_client_context context,
                                                                                       const char* filter);
 
+/**
+ * @brief Creates list of available items matching glob pattern, sorted by uri.
+ *
+ * @note Unlike other variants, it doesn't visit every item. Only items under the part
+ * of @p pattern preceding the first wildcard are checked. See @p tweak_app_traverse_glob.
+ *
+ * @param context tweak-app context for which list is being populated.
+ * @param pattern glob pattern to filter tweak uri's. Assumed to be ** when user provides NULL.
+
+ * @return filtered and sorted list of available items.
+ */
+struct tweak_app_cl_tweak_uris_list* tweak_app_cl_create_sorted_tweak_uris_list_glob(tweak_app_client_context context,
+                                                                                     const char* pattern);
+
 /**
  * @brief Helper method to find nth tweak URI having @p prefix. For use in automatic completion routeines.
  *
@@ -84,6 +84,9 @@ typedef void (*tweak_app_on_connection_status_changed_callback)(tweak_app_contex
 
 /**
  * @brief Collection of listeners needed to initialize client context.
+ *
+ * @details Fields may be appended by later library versions, so the structure
+ * should be initialized with designated initializers or zeroed.
  */
 typedef struct {
   /**
@@ -106,6 +109,11 @@ typedef struct {
    * @see tweak_app_on_item_removed_callback.
    */
   tweak_app_on_item_removed_callback on_item_removed;
+  /**
+   * @brief Selects who runs IO jobs of the context, see tweak_app_poll.
+   * Zero initialized structure yields TWEAK_APP_IO_MODE_THREAD.
+   */
+  tweak_app_io_mode io_mode;
 } tweak_app_client_callbacks;
 
 /**
@@ -113,8 +121,11 @@ typedef struct {
  *
  * @param connection_type One of "nng", "serial". Type is case-sensitive.
  * @param params Additional params for backend seperated by semicolon ';'.
- * Only mutually exclusive "role=server" and "role=client"
- * are currently recognized for IP-based connections.
+ * Mutually exclusive "role=server" and "role=client"
+ * are mandatory for IP-based connections. Optional "tx_queue=N"
+ * makes transmit asynchronous with up to N datagrams in flight;
+ * transmit returns TWEAK_WIRE_ERROR_TIMEOUT if all of them stay busy
+ * for too long. Example: "role=server;tx_queue=32".
  * @param uri address to start server on. Format is defined by backend.
  * @param client_listeners A structure containing all listeners.
  *
@@ -142,6 +153,25 @@ tweak_app_client_context tweak_app_create_client_context(const char *context_typ
 tweak_app_error_code tweak_app_client_wait_uris(tweak_app_client_context client_context,
   const char** uris, size_t uris_size, tweak_id* tweak_ids, tweak_common_milliseconds timeout_millis);
 
+/**
+ * @brief Limit items announced by server to ones with uris matching @p uri_patterns.
+ *
+ * @details Patterns are separated by semicolon, see @p tweak_app_traverse_glob
+ * for their syntax. NULL, empty string, "*" or "**" select all items, that's the default.
+ * Selection is kept across reconnects. If the client is connected, server is asked
+ * to apply new selection at once: items which don't match anymore are removed
+ * from the model as if server had removed them, newly matching items are added.
+ * Servers not supporting subscriptions keep announcing all items, so do servers
+ * whose transport doesn't tell clients apart, since every client would be affected.
+ *
+ * @note Calling it right after @p tweak_app_create_client_context usually lets
+ * the client skip loading whole model of a large server.
+ *
+ * @param client_context tweak client context created @see by tweak_app_create_client_context.
+ * @param uri_patterns uri patterns separated by semicolon.
+ */
+void tweak_app_client_subscribe(tweak_app_client_context client_context, const char* uri_patterns);
+
 #ifdef __cplusplus
 }
 #endif
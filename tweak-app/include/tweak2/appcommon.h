@@ -82,6 +82,47 @@ typedef enum {
   TWEAK_APP_TIMEOUT
 } tweak_app_error_code;
 
+/**
+ * @brief Behaviour of calls altering the model when outbound
+ * IO queue of the context is full.
+ */
+typedef enum {
+  /**
+   * @brief Wait until the queue is drained by IO thread. This is the default.
+   */
+  TWEAK_APP_QUEUE_POLICY_BLOCK = 0,
+  /**
+   * @brief Never wait. Since peer is always sent the latest value of an item,
+   * pending updates of the same item are merged, so the queue grows
+   * up to the number of distinct items being updated. Memory might be allocated.
+   */
+  TWEAK_APP_QUEUE_POLICY_MERGE,
+  /**
+   * @brief Never wait and never allocate memory. Updates that don't fit
+   * the queue are merged into a set of the same size, which is sent
+   * once the queue is drained. Update that doesn't fit that set either
+   * is stored in the model, but it isn't sent to the peer.
+   * Peer would see it with a later update of the item or upon next reconnect.
+   */
+  TWEAK_APP_QUEUE_POLICY_DROP
+} tweak_app_queue_policy;
+
+/**
+ * @brief Selects who runs IO jobs of a context.
+ */
+typedef enum {
+  /**
+   * @brief Context runs IO jobs on threads of its own. This is the default.
+   */
+  TWEAK_APP_IO_MODE_THREAD = 0,
+  /**
+   * @brief Context doesn't create threads. IO jobs are run by
+   * application calling tweak_app_poll periodically.
+   * Inbound requests are still received by threads of the transport.
+   */
+  TWEAK_APP_IO_MODE_POLL
+} tweak_app_io_mode;
+
 /**
  * @brief A container for all fields in the model.
  */
@@ -124,6 +165,55 @@ typedef struct {
   tweak_variant current_value;
 } tweak_app_item_snapshot;
 
+/**
+ * @brief Read only view of item's fields passed to @see tweak_app_item_visitor.
+ *
+ * Fields point directly to the model and are valid only until the visitor returns.
+ */
+typedef struct {
+  /**
+   * @brief tweak id.
+   */
+  tweak_id id;
+  /**
+   * @brief Unique uri.
+   */
+  const char* uri;
+  /**
+   * @brief Description.
+   */
+  const tweak_variant_string* description;
+  /**
+   * @brief Meta. Json snippet describing properties of data.
+   */
+  const tweak_variant_string* meta;
+  /**
+   * @brief default_value.
+   */
+  const tweak_variant* default_value;
+  /**
+   * @brief current_value.
+   */
+  const tweak_variant* current_value;
+} tweak_app_item_view;
+
+/**
+ * @brief Direct reference to an item. It doesn't require any lookups by id,
+ * so it is cheaper to use it than tweak_id when the same item is accessed repeatedly.
+ *
+ * Handle doesn't own any resources. It stays valid until item is removed,
+ * after that all operations on the handle report TWEAK_APP_ITEM_NOT_FOUND.
+ * Client context invalidates all handles when it reconnects to the server.
+ */
+typedef uint64_t tweak_app_handle;
+
+enum {
+  /**
+   * @brief Default value for @p tweak_app_handle or error indicator.
+   */
+  TWEAK_APP_INVALID_HANDLE = 0
+};
+
 /**
  * @brief Forward declaration of base class for all context types.
  */
@@ -140,6 +230,14 @@ struct tweak_app_context_base;
 typedef bool (*tweak_app_traverse_items_callback)(const tweak_app_item_snapshot* snapshot,
   void* cookie);
 
+/**
+ * @brief Prototype for a callback inspecting an item in tweak_app_item_read method.
+ *
+ * @param view fields of the item.
+ * @param cookie opaque pointer provided by user.
+ */
+typedef void (*tweak_app_item_visitor)(const tweak_app_item_view* view, void* cookie);
+
 /**
  * @brief Instance encapsulating an abstract application context.
  */
@@ -178,6 +276,42 @@ tweak_id tweak_app_find_id(tweak_app_context context, const char* uri);
 bool tweak_app_traverse_items(tweak_app_context context,
   tweak_app_traverse_items_callback callback, void* cookie);
 
+/**
+ * @brief Enumerate items whose uris start with @p prefix, in lexicographic order of uris.
+ * Cost is proportional to prefix length and number of items found, not to size of the model.
+ *
+ * @note Prefix is matched character by character, so "/camera/front" matches
+ * "/camera/frontal/gain" as well. End prefix with '/' to select a whole subtree,
+ * as in "/camera/front/".
+ *
+ * @param context an application context.
+ * @param prefix uri prefix. Empty string selects all items.
+ * @param callback callback to capture items being enumerated.
+ * @param cookie opaque pointer provided by user.
+ *
+ * @return false if @p callback has aborted enumeration.
+ */
+bool tweak_app_traverse_subtree(tweak_app_context context, const char* prefix,
+  tweak_app_traverse_items_callback callback, void* cookie);
+
+/**
+ * @brief Enumerate items whose uris match glob @p pattern, in lexicographic order of uris.
+ *
+ * @details '?' matches any character except '/', '*' matches any part of a single
+ * path segment, "**" matches any sequence of characters including '/'.
+ * Only items under the part of @p pattern preceding the first wildcard are visited,
+ * so a pattern starting with "/camera/front/" costs as much as enumerating that subtree.
+ *
+ * @param context an application context.
+ * @param pattern glob pattern.
+ * @param callback callback to capture items being enumerated.
+ * @param cookie opaque pointer provided by user.
+ *
+ * @return false if @p callback has aborted enumeration.
+ */
+bool tweak_app_traverse_glob(tweak_app_context context, const char* pattern,
+  tweak_app_traverse_items_callback callback, void* cookie);
+
 /**
  * @brief Get a snapshot of an item's state at the current moment.
  *
@@ -193,6 +327,23 @@ bool tweak_app_traverse_items(tweak_app_context context,
 tweak_app_item_snapshot* tweak_app_item_get_snapshot(tweak_app_context context,
   tweak_id id);
 
+/**
+ * @brief Inspect an item's fields in place, without copying them.
+ *
+ * @p visitor is invoked while model is locked for reading, so it shall be brief,
+ * it shall not retain pointers from the view and it shall not alter items of @p context.
+ *
+ * @param context an application context.
+ * @param id tweak id.
+ * @param visitor callback invoked once if item exists.
+ * @param cookie opaque pointer passed to @p visitor.
+ *
+ * @return TWEAK_APP_SUCCESS if there wasn't any errors, TWEAK_APP_SUCCESS_LAST_KNOWN_VALUE
+ * if client context is disconnected, TWEAK_APP_ITEM_NOT_FOUND if there's no such item.
+ */
+tweak_app_error_code tweak_app_item_read(tweak_app_context context, tweak_id id,
+  tweak_app_item_visitor visitor, void* cookie);
+
 /**
  * @brief Get an item's type.
  *
@@ -230,6 +381,23 @@ void tweak_app_release_snapshot(tweak_app_context context,
 tweak_app_error_code tweak_app_item_clone_current_value(tweak_app_context context,
   tweak_id id, tweak_variant* value);
 
+/**
+ * @brief Read current value of a scalar item.
+ *
+ * Unlike tweak_app_item_clone_current_value, this method doesn't take any locks
+ * and doesn't allocate memory, thus it is safe to call it from real time threads
+ * at high rate. It never reports TWEAK_APP_SUCCESS_LAST_KNOWN_VALUE status.
+ *
+ * @param context an application context.
+ * @param id tweak id.
+ * @param value a pointer to empty instance receiving the value.
+ *
+ * @return TWEAK_APP_SUCCESS if there wasn't any errors,
+ * TWEAK_APP_TYPE_MISMATCH if item isn't scalar.
+ */
+tweak_app_error_code tweak_app_item_load_scalar(tweak_app_context context,
+  tweak_id id, tweak_variant* value);
+
 /**
  * @brief Swap item's value with provided @p value and propagate new item's value
  * to the connected peer, it there's one.
@@ -246,6 +414,117 @@ tweak_app_error_code tweak_app_item_clone_current_value(tweak_app_context contex
 tweak_app_error_code tweak_app_item_replace_current_value(tweak_app_context context,
   tweak_id id, tweak_variant* value);
 
+/**
+ * @brief Replace values of several items atomically and propagate them
+ * to the connected peer together.
+ *
+ * All values are applied under a single lock, so no reader observes a partially
+ * applied set, and server context sends them to every client within one message
+ * when the client supports batched changes. If any of the items doesn't exist,
+ * nothing is changed.
+ *
+ * @param context an application context.
+ * @param ids ids of items to update.
+ * @param values new values, one per item in @p ids. After the call their contents
+ * are in the same state as after tweak_app_item_replace_current_value call.
+ * @param count number of items.
+ *
+ * @return TWEAK_APP_SUCCESS if there wasn't any errors, TWEAK_APP_ITEM_NOT_FOUND
+ * if any of @p ids isn't found.
+ */
+tweak_app_error_code tweak_app_item_replace_values(tweak_app_context context,
+  const tweak_id* ids, tweak_variant* values, size_t count);
+
+/**
+ * @brief Copy a range of elements of vector item to @p buffer.
+ *
+ * Unlike tweak_app_item_clone_current_value, this method doesn't allocate memory
+ * and copies only requested elements.
+ *
+ * @param context an application context.
+ * @param id tweak id.
+ * @param type expected type of the item, one of TWEAK_VARIANT_TYPE_VECTOR_* types.
+ * @param offset index of the first element to copy.
+ * @param count number of elements to copy.
+ * @param buffer output buffer large enough for @p count elements of @p type.
+ *
+ * @return TWEAK_APP_SUCCESS if there wasn't any errors,
+ * TWEAK_APP_TYPE_MISMATCH if item's type isn't @p type,
+ * TWEAK_APP_INVALID_ARGUMENT if range exceeds vector size.
+ */
+tweak_app_error_code tweak_app_item_load_vector_range(tweak_app_context context,
+  tweak_id id, tweak_variant_type type, size_t offset, size_t count, void* buffer);
+
+/**
+ * @brief Overwrite a range of elements of vector item in place and propagate
+ * the range to the connected peer, it there's one.
+ *
+ * Only altered range is sent to peers supporting partial updates,
+ * other peers receive the whole value.
+ *
+ * @param context an application context.
+ * @param id tweak id.
+ * @param type expected type of the item, one of TWEAK_VARIANT_TYPE_VECTOR_* types.
+ * @param offset index of the first element to overwrite.
+ * @param count number of elements to overwrite.
+ * @param buffer new values of @p count elements of @p type.
+ *
+ * @return TWEAK_APP_SUCCESS if there wasn't any errors,
+ * TWEAK_APP_TYPE_MISMATCH if item's type isn't @p type,
+ * TWEAK_APP_INVALID_ARGUMENT if range exceeds vector size.
+ */
+tweak_app_error_code tweak_app_item_store_vector_range(tweak_app_context context,
+  tweak_id id, tweak_variant_type type, size_t offset, size_t count, const void* buffer);
+
+/**
+ * @brief Acquire handle of an item. Doesn't take any locks and doesn't allocate memory.
+ *
+ * @param context an application context.
+ * @param id tweak id.
+ *
+ * @return handle or TWEAK_APP_INVALID_HANDLE if there's no such item.
+ */
+tweak_app_handle tweak_app_acquire_handle(tweak_app_context context, tweak_id id);
+
+/**
+ * @brief Same as tweak_app_item_load_scalar, but the item is addressed by handle.
+ *
+ * @param context an application context.
+ * @param handle item handle.
+ * @param value a pointer to empty instance receiving the value.
+ *
+ * @return TWEAK_APP_SUCCESS if there wasn't any errors,
+ * TWEAK_APP_TYPE_MISMATCH if item isn't scalar.
+ */
+tweak_app_error_code tweak_app_handle_load_scalar(tweak_app_context context,
+  tweak_app_handle handle, tweak_variant* value);
+
+/**
+ * @brief Same as tweak_app_item_clone_current_value, but the item is addressed by handle.
+ *
+ * @param context an application context.
+ * @param handle item handle.
+ * @param value a pointer to instance. Preexisting data will be released with
+ * tweak_variant_destroy() call.
+ *
+ * @return TWEAK_APP_SUCCESS if there wasn't any errors.
+ */
+tweak_app_error_code tweak_app_handle_clone_current_value(tweak_app_context context,
+  tweak_app_handle handle, tweak_variant* value);
+
+/**
+ * @brief Same as tweak_app_item_replace_current_value, but the item is addressed by handle.
+ *
+ * @param context an application context.
+ * @param handle item handle.
+ * @param value a pointer to new value. After the call its contents will be replaced
+ * by previous value of item.
+ *
+ * @return TWEAK_APP_SUCCESS if there wasn't any errors.
+ */
+tweak_app_error_code tweak_app_handle_replace_current_value(tweak_app_context context,
+  tweak_app_handle handle, tweak_variant* value);
+
 /**
  * @brief Retrieves metadata instance for given item. Client does assume
  * ownership for this instance, thus user must invoke @see tweak_metadata_destroy
@@ -260,6 +539,47 @@ tweak_app_error_code tweak_app_item_replace_current_value(tweak_app_context cont
 tweak_app_error_code tweak_app_item_get_metadata(tweak_app_context context,
   tweak_id id, tweak_metadata* metadata);
 
+/**
+ * @brief Select behaviour of the context when its outbound IO queue is full.
+ *
+ * @note Real time threads altering items should use either
+ * TWEAK_APP_QUEUE_POLICY_MERGE or TWEAK_APP_QUEUE_POLICY_DROP policy.
+ *
+ * @param context an application context.
+ * @param policy new policy.
+ *
+ * @return TWEAK_APP_SUCCESS if there wasn't any errors,
+ * TWEAK_APP_INVALID_ARGUMENT if policy is unknown, memory for the queue
+ * couldn't be reserved or TWEAK_APP_QUEUE_POLICY_BLOCK is requested
+ * for a context created with TWEAK_APP_IO_MODE_POLL.
+ */
+tweak_app_error_code tweak_app_set_queue_policy(tweak_app_context context,
+  tweak_app_queue_policy policy);
+
+/**
+ * @brief Number of times outbound IO queue was found full since context creation.
+ *
+ * @param context an application context.
+ *
+ * @return overflow count.
+ */
+uint64_t tweak_app_get_queue_overflow_count(tweak_app_context context);
+
+/**
+ * @brief Number of outbound updates rejected by TWEAK_APP_QUEUE_POLICY_DROP policy
+ * since context creation.
+ *
+ * @details Item change calls succeed even if their update is rejected, because
+ * the new value is stored in the model anyway. Peer receives it with a later
+ * update of the same item or on reconnect. Caller can compare the count before
+ * and after a series of changes to detect that some of them haven't been sent.
+ *
+ * @param context an application context.
+ *
+ * @return drop count.
+ */
+uint64_t tweak_app_get_queue_drop_count(tweak_app_context context);
+
 /**
  * @brief Blocks unless all pending IO jobs are being completed
  *
@@ -269,6 +589,62 @@ tweak_app_error_code tweak_app_item_get_metadata(tweak_app_context context,
  */
 void tweak_app_flush_queue(tweak_app_context context);
 
+/**
+ * @brief Run pending IO jobs of a context created with TWEAK_APP_IO_MODE_POLL.
+ *
+ * @details Runs jobs that'd be run by threads of the context otherwise:
+ * sending of item changes to peer, initial synchronization of connected peer
+ * and, with TWEAK_APP_CALLBACK_DISPATCH_EXECUTOR, server callbacks.
+ * Returns once there are no pending jobs or @p budget_us microseconds
+ * have passed. Jobs aren't interrupted, so the call can exceed the budget
+ * by duration of a single job. At least one job is run if there's any.
+ *
+ * @note Context of this mode is created with TWEAK_APP_QUEUE_POLICY_MERGE policy,
+ * TWEAK_APP_QUEUE_POLICY_BLOCK would block the polling thread forever,
+ * so tweak_app_set_queue_policy() rejects it.
+ * Calls of this function are serialized, there's no use in polling a context
+ * from several threads.
+ *
+ * @param context an application context.
+ * @param budget_us time limit in microseconds.
+ *
+ * @return true if budget has been exhausted before all pending jobs have been run.
+ * false if there's no more jobs or context runs its own threads.
+ */
+bool tweak_app_poll(tweak_app_context context, uint64_t budget_us);
+
+/**
+ * @brief Get a descriptor to wait for item changes in a host event loop
+ * with poll(), select() or epoll.
+ *
+ * @details The context starts collecting ids of items which values have been
+ * changed by remote peer with the first call of this function. The descriptor
+ * stays readable while there are ids to drain with tweak_app_drain_changes,
+ * it shall not be read nor closed by the application.
+ *
+ * @param context an application context.
+ *
+ * @return eventfd descriptor on Linux, -1 on other platforms. Changes are
+ * collected either way and can be drained periodically.
+ */
+int tweak_app_get_event_fd(tweak_app_context context);
+
+/**
+ * @brief Take ids of items changed by remote peer since the last drain.
+ *
+ * @details Each id is reported once no matter how many times the item has
+ * been changed, ids come in order of the first change. Ids not fitting into
+ * @p ids are kept for the next call. Items could've been removed since.
+ *
+ * @param context an application context.
+ * @param ids buffer receiving item ids.
+ * @param max_count capacity of @p ids.
+ *
+ * @return number of ids stored in @p ids, 0 if there are no changes
+ * or tweak_app_get_event_fd hasn't been called.
+ */
+size_t tweak_app_drain_changes(tweak_app_context context, tweak_id* ids, size_t max_count);
+
 /**
  * @brief a virtual destructor for application context objects.
  */
@@ -39,6 +39,30 @@
 extern "C" {
 #endif
 
+/**
+ * @brief Thread on which on_current_value_changed callback is invoked.
+ */
+typedef enum {
+  /**
+   * @brief Callback is invoked by the thread receiving client requests.
+   * Next request isn't processed until callback returns.
+   */
+  TWEAK_APP_CALLBACK_DISPATCH_INLINE = 0,
+  /**
+   * @brief Callback is invoked by a dedicated thread of server context
+   * or by tweak_app_poll if context is created with TWEAK_APP_IO_MODE_POLL.
+   * Receiving thread only enqueues item id. Changes of an item made while
+   * its callback is pending are coalesced, callback observes the latest value.
+   */
+  TWEAK_APP_CALLBACK_DISPATCH_EXECUTOR
+} tweak_app_callback_dispatch;
+
+/**
+ * @brief Collection of listeners and options needed to initialize server context.
+ *
+ * @details Fields may be appended by later library versions, so the structure
+ * should be initialized with designated initializers or zeroed.
+ */
 typedef struct {
   /**
    * @brief Opaque pointer to pass into callback declared below.
@@ -48,8 +72,42 @@ typedef struct {
    * @see tweak_app_on_current_value_changed_callback.
    */
   tweak_app_on_current_value_changed_callback on_current_value_changed;
+  /**
+   * @brief Selects the thread invoking @p on_current_value_changed.
+   * Zero initialized structure yields TWEAK_APP_CALLBACK_DISPATCH_INLINE.
+   */
+  tweak_app_callback_dispatch callback_dispatch;
+  /**
+   * @brief Selects who runs IO jobs of the context, see tweak_app_poll.
+   * With TWEAK_APP_IO_MODE_POLL, executor callbacks are invoked by tweak_app_poll.
+   * Zero initialized structure yields TWEAK_APP_IO_MODE_THREAD.
+   */
+  tweak_app_io_mode io_mode;
 } tweak_app_server_callbacks;
 
+/**
+ * @brief Cumulative statistics of on_current_value_changed callback invocations.
+ */
+typedef struct {
+  /**
+   * @brief Number of client changes that required a callback.
+   */
+  uint64_t change_count;
+  /**
+   * @brief Number of callbacks invoked. Less than @p change_count
+   * when executor has coalesced changes or some callbacks are pending.
+   */
+  uint64_t callback_count;
+  /**
+   * @brief Total time spent in callbacks, in nanoseconds.
+   */
+  uint64_t callback_total_ns;
+  /**
+   * @brief Longest callback, in nanoseconds.
+   */
+  uint64_t callback_max_ns;
+} tweak_app_server_callback_stats;
+
 /**
  * @brief Server context instance. Can be upcasted to tweak_app_context with C-style cast.
  *
@@ -60,10 +118,20 @@ typedef tweak_app_context tweak_app_server_context;
 /**
  * @brief Spawn a server context instance using provided parameters.
  *
+ * @details Each connected client is served by its own worker thread
+ * unless @p callbacks select TWEAK_APP_IO_MODE_POLL, so thread count grows
+ * with number of clients. Servers expecting many simultaneous clients
+ * should select TWEAK_APP_IO_MODE_POLL and call tweak_app_poll periodically.
+ *
  * @param connection_type One of "nng", "serial". Type is case-sensitive.
  * @param params Additional params for backend seperated by semicolon ';'.
- * Only mutually exclusive "role=server" and "role=client"
- * are currently recognized for IP-based connections.
+ * Mutually exclusive "role=server" and "role=client"
+ * are mandatory for IP-based connections. Optional "tx_queue=N"
+ * makes transmit asynchronous with up to N datagrams in flight;
+ * transmit returns TWEAK_WIRE_ERROR_TIMEOUT if all of them stay busy
+ * for too long. Example: "role=server;tx_queue=32". Optional "broadcast"
+ * makes server treat all clients as a single peer, as it does when nng
+ * hub can't address them.
  * @param uri address to start server on. Format is defined by backend.
  *
  * @param on_current_value_changed listener for on_current_value_changed events
@@ -74,6 +142,19 @@ typedef tweak_app_context tweak_app_server_context;
 tweak_app_server_context tweak_app_create_server_context(const char *context_type, const char *params,
   const char *uri, const tweak_app_server_callbacks* callbacks);
 
+/**
+ * @brief Retrieve on_current_value_changed callback statistics.
+ *
+ * @details Callback time is measured apart from request decoding and
+ * propagation of changes to clients, so slow user callbacks can be told
+ * from slow transport.
+ *
+ * @param server_context server context to query.
+ * @param stats receives a snapshot of the statistics.
+ */
+void tweak_app_server_get_callback_stats(tweak_app_server_context server_context,
+  tweak_app_server_callback_stats* stats);
+
 /**
  * @brief Adds new item into the set of available tweaks.
  *
@@ -0,0 +1,172 @@
+/**
+ * @file tweakappchanges.c
+ * @ingroup tweak-internal
+ *
+ * @brief part of tweak2 application implementation.
+ *
+ * @copyright 2020-2023 Cogent Embedded, Inc. ALL RIGHTS RESERVED.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <tweak2/log.h>
+
+#include "tweakappchanges.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__linux__)
+#include <errno.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+#endif
+
+enum { TWEAK_APP_CHANGES_INITIAL_CAPACITY = 64 };
+
+static int create_event_fd(void) {
+#if defined(__linux__)
+  int fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+  if (fd < 0) {
+    TWEAK_LOG_ERROR("eventfd() failed, errno = %d", errno);
+  }
+  return fd;
+#else
+  TWEAK_LOG_WARN("Event descriptor isn't supported on this platform");
+  return -1;
+#endif
+}
+
+static void signal_event_fd(int fd) {
+#if defined(__linux__)
+  uint64_t increment = 1;
+  if (write(fd, &increment, sizeof(increment)) != (ssize_t)sizeof(increment)) {
+    TWEAK_LOG_ERROR("Can't signal eventfd, errno = %d", errno);
+  }
+#else
+  (void)fd;
+#endif
+}
+
+static void reset_event_fd(int fd) {
+#if defined(__linux__)
+  uint64_t counter;
+  if (read(fd, &counter, sizeof(counter)) != (ssize_t)sizeof(counter) && errno != EAGAIN) {
+    TWEAK_LOG_ERROR("Can't reset eventfd, errno = %d", errno);
+  }
+#else
+  (void)fd;
+#endif
+}
+
+static void close_event_fd(int fd) {
+#if defined(__linux__)
+  close(fd);
+#else
+  (void)fd;
+#endif
+}
+
+void tweak_app_changes_init(struct tweak_app_change_tracker* tracker) {
+  memset(tracker, 0, sizeof(*tracker));
+  tracker->event_fd = -1;
+  tweak_common_mutex_init(&tracker->lock);
+}
+
+void tweak_app_changes_destroy(struct tweak_app_change_tracker* tracker) {
+  if (tracker->event_fd >= 0) {
+    close_event_fd(tracker->event_fd);
+  }
+  tweak_id_map_destroy(&tracker->pending_set);
+  free(tracker->pending_ids);
+  tweak_common_mutex_destroy(&tracker->lock);
+}
+
+int tweak_app_changes_get_event_fd(struct tweak_app_change_tracker* tracker) {
+  tweak_common_mutex_lock(&tracker->lock);
+  if (!tracker->enabled) {
+    tracker->event_fd = create_event_fd();
+    tracker->enabled = true;
+  }
+  int event_fd = tracker->event_fd;
+  tweak_common_mutex_unlock(&tracker->lock);
+  return event_fd;
+}
+
+static bool append_pending_id(struct tweak_app_change_tracker* tracker, tweak_id id) {
+  if (tracker->pending_size == tracker->pending_capacity) {
+    size_t capacity = tracker->pending_capacity
+      ? tracker->pending_capacity * 2 : TWEAK_APP_CHANGES_INITIAL_CAPACITY;
+    tweak_id* pending_ids = realloc(tracker->pending_ids, capacity * sizeof(*pending_ids));
+    if (!pending_ids) {
+      TWEAK_LOG_ERROR("realloc() returned NULL");
+      return false;
+    }
+    tracker->pending_ids = pending_ids;
+    tracker->pending_capacity = capacity;
+  }
+  tracker->pending_ids[tracker->pending_size++] = id;
+  return true;
+}
+
+void tweak_app_changes_record(struct tweak_app_change_tracker* tracker, tweak_id id) {
+  tweak_common_mutex_lock(&tracker->lock);
+  if (!tracker->enabled || tweak_id_map_contains(&tracker->pending_set, id)) {
+    goto unlock;
+  }
+  if (!tweak_id_map_insert(&tracker->pending_set, id, 0)) {
+    goto unlock;
+  }
+  if (!append_pending_id(tracker, id)) {
+    tweak_id_map_remove(&tracker->pending_set, id);
+    goto unlock;
+  }
+  /* Descriptor is readable as long as there are pending ids, signal it once */
+  if (tracker->pending_size == 1 && tracker->event_fd >= 0) {
+    signal_event_fd(tracker->event_fd);
+  }
+
+unlock:
+  tweak_common_mutex_unlock(&tracker->lock);
+}
+
+size_t tweak_app_changes_drain(struct tweak_app_change_tracker* tracker, tweak_id* ids, size_t max_count) {
+  tweak_common_mutex_lock(&tracker->lock);
+  size_t count = tracker->pending_size < max_count ? tracker->pending_size : max_count;
+  if (count == 0) {
+    goto unlock;
+  }
+  memcpy(ids, tracker->pending_ids, count * sizeof(*ids));
+  /* Removal is cheaper than clearing the table grown by an earlier burst */
+  for (size_t ix = 0; ix < count; ++ix) {
+    tweak_id_map_remove(&tracker->pending_set, ids[ix]);
+  }
+  tracker->pending_size -= count;
+  if (tracker->pending_size > 0) {
+    memmove(tracker->pending_ids, tracker->pending_ids + count,
+      tracker->pending_size * sizeof(*tracker->pending_ids));
+  } else if (tracker->event_fd >= 0) {
+    reset_event_fd(tracker->event_fd);
+  }
+
+unlock:
+  tweak_common_mutex_unlock(&tracker->lock);
+  return count;
+}
@@ -0,0 +1,112 @@
+/**
+ * @file tweakappchanges.h
+ * @ingroup tweak-internal
+ *
+ * @brief part of tweak2 application implementation.
+ *
+ * @copyright 2020-2023 Cogent Embedded, Inc. ALL RIGHTS RESERVED.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef TWEAK_APP_CHANGES_H_INCLUDED
+#define TWEAK_APP_CHANGES_H_INCLUDED
+
+#include <tweak2/idmap.h>
+#include <tweak2/thread.h>
+#include <tweak2/types.h>
+
+#include <stdbool.h>
+#include <stddef.h>
+
+/**
+ * @brief Ids of items changed by remote peer, collected for the host event loop.
+ *
+ * @details Tracking begins with the first tweak_app_changes_get_event_fd call,
+ * contexts of applications not using it pay nothing but a flag check.
+ */
+struct tweak_app_change_tracker {
+  /**
+   * @brief Guards all fields below.
+   */
+  tweak_common_mutex lock;
+  /**
+   * @brief Whether changes are being collected.
+   */
+  bool enabled;
+  /**
+   * @brief Descriptor readable while @p pending_ids isn't empty, -1 if not supported.
+   */
+  int event_fd;
+  /**
+   * @brief Ids in @p pending_ids, to merge repeated changes of an item.
+   */
+  struct tweak_id_map pending_set;
+  /**
+   * @brief Ids changed since the last drain, in order of first change.
+   */
+  tweak_id* pending_ids;
+  size_t pending_size;
+  size_t pending_capacity;
+};
+
+/**
+ * @brief Initialize tracker instance, changes aren't collected yet.
+ *
+ * @param tracker tracker instance.
+ */
+void tweak_app_changes_init(struct tweak_app_change_tracker* tracker);
+
+/**
+ * @brief Release resources held by @p tracker including the event descriptor.
+ *
+ * @param tracker tracker instance.
+ */
+void tweak_app_changes_destroy(struct tweak_app_change_tracker* tracker);
+
+/**
+ * @brief Start collecting changes if it hasn't been started yet.
+ *
+ * @param tracker tracker instance.
+ *
+ * @return descriptor that becomes readable when changes are pending,
+ * -1 if platform doesn't provide one. Changes are collected either way.
+ */
+int tweak_app_changes_get_event_fd(struct tweak_app_change_tracker* tracker);
+
+/**
+ * @brief Record change of an item. Does nothing unless tracking has been started.
+ *
+ * @param tracker tracker instance.
+ * @param id id of an item that has been changed.
+ */
+void tweak_app_changes_record(struct tweak_app_change_tracker* tracker, tweak_id id);
+
+/**
+ * @brief Move up to @p max_count pending ids to @p ids.
+ *
+ * @param tracker tracker instance.
+ * @param ids buffer receiving ids.
+ * @param max_count capacity of @p ids.
+ *
+ * @return number of ids stored in @p ids.
+ */
+size_t tweak_app_changes_drain(struct tweak_app_change_tracker* tracker, tweak_id* ids, size_t max_count);
+
+#endif
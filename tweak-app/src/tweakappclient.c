@@ -42,6 +42,13 @@
 
 enum { TWEAK_APP_CLIENT_QUEUE_SIZE = 100 };
 
+/*
+ * Upper bound of items kept across reconnects which are listed in subscribe request.
+ * Each of them takes 16 bytes, so the request stays well below 1 MiB datagram
+ * size limit of nng and default ring size of shm. Larger models are resent as a whole.
+ */
+enum { TWEAK_APP_CLIENT_MAX_KNOWN_ITEMS = 16384 };
+
 struct wait_context {
   tweak_common_mutex lock;
   tweak_common_cond cond;
@@ -53,6 +60,22 @@ struct tweak_app_context_client_impl {
   tweak_pickle_client_endpoint rpc_endpoint;
   struct tweak_app_features remote_peer_features;
   struct wait_context wait_context;
+  /**
+   * @brief Uri patterns to subscribe to, see tweak_app_client_subscribe.
+   * Guarded by conn_state_lock.
+   */
+  tweak_variant_string uri_patterns;
+  /**
+   * @brief Features and initial subscribe have been sent over current connection.
+   * Server announces its model epoch only after it has received client features,
+   * so subscribe shall not precede them. Guarded by conn_state_lock.
+   */
+  bool features_sent;
+  /**
+   * @brief Epoch of server model current items have been received from.
+   * 0 if they can't be resynchronized after reconnect. Guarded by model_lock.
+   */
+  uint64_t model_epoch;
 };
 
 static bool init_wait_context(struct wait_context* wait_context) {
@@ -77,6 +100,86 @@ static void destroy_wait_context(struct wait_context* wait_context) {
   tweak_common_mutex_destroy(&wait_context->lock);
 }
 
+struct known_items_context {
+  tweak_pickle_known_item* known_items;
+  size_t size;
+  size_t capacity;
+  bool too_many;
+};
+
+static bool collect_known_item_proc(tweak_item* item, void* cookie) {
+  struct known_items_context* context = cookie;
+  if (context->size == TWEAK_APP_CLIENT_MAX_KNOWN_ITEMS) {
+    context->too_many = true;
+    return false;
+  }
+  if (context->size == context->capacity) {
+    size_t new_capacity = context->capacity ? context->capacity * 2 : TWEAK_APP_CLIENT_QUEUE_SIZE;
+    tweak_pickle_known_item* new_known_items =
+      realloc(context->known_items, new_capacity * sizeof(*new_known_items));
+    if (!new_known_items) {
+      TWEAK_LOG_ERROR("realloc() returned NULL");
+      return false;
+    }
+    context->known_items = new_known_items;
+    context->capacity = new_capacity;
+  }
+  tweak_pickle_known_item* known_item = &context->known_items[context->size++];
+  known_item->id = item->id;
+  known_item->version = item->version;
+  return true;
+}
+
+/**
+ * @brief Fill model_epoch and known_items of @p subscribe, so that server
+ * resends only items that have been added, removed or changed since
+ * the previous connection. Fields are left empty if it isn't possible.
+ */
+static void reset_model(struct tweak_app_context_client_impl* client_impl, uint64_t model_epoch);
+
+static void collect_known_items(struct tweak_app_context_client_impl* client_impl,
+  tweak_pickle_subscribe* subscribe)
+{
+  struct tweak_model_impl* model = &client_impl->base.model_impl;
+  struct known_items_context context = { 0 };
+  tweak_common_rwlock_read_lock(&model->model_lock);
+  uint64_t model_epoch = client_impl->model_epoch;
+  bool success = model_epoch == 0
+    || tweak_model_walk_items(model->model, &collect_known_item_proc, &context);
+  tweak_common_rwlock_read_unlock(&model->model_lock);
+  if (success) {
+    subscribe->model_epoch = model_epoch;
+    subscribe->known_items = context.known_items;
+    subscribe->known_items_size = context.size;
+  } else {
+    if (context.too_many) {
+      TWEAK_LOG_DEBUG("More than %d items are kept, all items shall be announced anew",
+        TWEAK_APP_CLIENT_MAX_KNOWN_ITEMS);
+    } else {
+      TWEAK_LOG_WARN("Can't collect known items, all items shall be announced anew");
+    }
+    free(context.known_items);
+    /* Items would be kept if server announced the same model epoch, so they're dropped now */
+    reset_model(client_impl, 0);
+  }
+}
+
+static void send_subscribe(struct tweak_app_context_client_impl* client_impl, bool resync) {
+  tweak_pickle_subscribe subscribe = { 0 };
+  tweak_common_mutex_lock(&client_impl->base.conn_state_lock);
+  subscribe.uri_patterns = tweak_variant_string_copy(&client_impl->uri_patterns);
+  tweak_common_mutex_unlock(&client_impl->base.conn_state_lock);
+  if (resync) {
+    collect_known_items(client_impl, &subscribe);
+  }
+  tweak_pickle_call_result result = tweak_pickle_client_subscribe(client_impl->rpc_endpoint, &subscribe);
+  if (result != TWEAK_PICKLE_SUCCESS) {
+    TWEAK_LOG_ERROR("tweak_pickle_client_subscribe() returned %d", result);
+  }
+  tweak_variant_destroy_string(&subscribe.uri_patterns);
+  free(subscribe.known_items);
+}
+
 static void io_loop_subscribe(tweak_id tweak_id, void* cookie) {
   (void)tweak_id;
   TWEAK_LOG_TRACE_ENTRY("tweak_id = %" PRId64 " , cookie = %p", cookie);
@@ -97,11 +200,10 @@ static void io_loop_subscribe(tweak_id tweak_id, void* cookie) {
   }
   tweak_variant_destroy_string(&my_supported_features_json);
 
-  tweak_pickle_subscribe subscribe = { 0 };
-  result = tweak_pickle_client_subscribe(client_impl->rpc_endpoint, &subscribe);
-  if (result != TWEAK_PICKLE_SUCCESS) {
-    TWEAK_LOG_ERROR("tweak_pickle_client_subscribe() returned %d", result);
-  }
+  tweak_common_mutex_lock(&client_impl->base.conn_state_lock);
+  client_impl->features_sent = true;
+  tweak_common_mutex_unlock(&client_impl->base.conn_state_lock);
+  send_subscribe(client_impl, true);
 }
 
 static void push_subscribe(tweak_app_context context) {
@@ -113,6 +215,28 @@ static void push_subscribe(tweak_app_context context) {
   tweak_app_queue_push(context->job_queue, &job);
 }
 
+static void io_loop_resubscribe(tweak_id tweak_id, void* cookie) {
+  (void)tweak_id;
+  TWEAK_LOG_TRACE_ENTRY("cookie = %p", cookie);
+  struct tweak_app_context_client_impl* client_impl = cookie;
+  tweak_common_mutex_lock(&client_impl->base.conn_state_lock);
+  bool features_sent = client_impl->features_sent;
+  tweak_common_mutex_unlock(&client_impl->base.conn_state_lock);
+  /* Otherwise initial subscribe is pending and it picks up current uri patterns */
+  if (features_sent && tweak_app_context_private_is_connected(&client_impl->base)) {
+    send_subscribe(client_impl, false);
+  }
+}
+
+static void push_resubscribe(tweak_app_context context) {
+  TWEAK_LOG_TRACE_ENTRY();
+  struct job job = {
+    .job_proc = &io_loop_resubscribe,
+    .cookie = context
+  };
+  tweak_app_queue_push(context->job_queue, &job);
+}
+
 static bool invoke_item_removed_callback(const char *uri, tweak_id id, void* cookie) {
   TWEAK_LOG_TRACE_ENTRY("uri = %s, tweak_id = %" PRId64 ", cookie = %p", uri, id, cookie);
   (void) uri;
@@ -139,8 +263,8 @@ static void call_remove_callback_for_all_items(
   }
 }
 
-static void reset_model(struct tweak_app_context_client_impl* client_impl) {
-  TWEAK_LOG_TRACE_ENTRY();
+static void reset_model(struct tweak_app_context_client_impl* client_impl, uint64_t model_epoch) {
+  TWEAK_LOG_TRACE_ENTRY("model_epoch = %" PRIx64, model_epoch);
   tweak_model new_model = tweak_model_create();
   if (!new_model) {
     TWEAK_FATAL("Can't allocate new model upon reconnect");
@@ -158,6 +282,8 @@ static void reset_model(struct tweak_app_context_client_impl* client_impl) {
   tweak_common_rwlock_write_lock(&model->model_lock);
   model->model = new_model;
   model->index = new_index;
+  tweak_model_scalar_cache_clear(model->scalar_cache);
+  client_impl->model_epoch = model_epoch;
   tweak_common_rwlock_write_unlock(&model->model_lock);
 
   call_remove_callback_for_all_items(client_impl, old_index);
@@ -172,6 +298,16 @@ static void announce_features_impl(tweak_pickle_features* announce_features,
   TWEAK_LOG_TRACE_ENTRY("announce_features = \"%s\", cookie = %p",
     tweak_variant_string_c_str(&announce_features->features), cookie);
   struct tweak_app_context_client_impl* client_impl = (struct tweak_app_context_client_impl*) cookie;
+  /* Server announces features before it announces any item, so items
+   * of another model are dropped before new ones arrive */
+  tweak_common_rwlock_read_lock(&client_impl->base.model_impl.model_lock);
+  bool model_is_stale = client_impl->model_epoch != announce_features->model_epoch;
+  tweak_common_rwlock_read_unlock(&client_impl->base.model_impl.model_lock);
+  if (model_is_stale) {
+    TWEAK_LOG_DEBUG("Server model epoch is %" PRIx64 ", items are announced anew",
+      announce_features->model_epoch);
+    reset_model(client_impl, announce_features->model_epoch);
+  }
   struct tweak_app_features remote_peer_features;
   tweak_app_features_init_minimal(&remote_peer_features);
   if (!tweak_app_features_from_json(&announce_features->features, &remote_peer_features)) {
@@ -181,6 +317,7 @@ static void announce_features_impl(tweak_pickle_features* announce_features,
   TWEAK_LOG_DEBUG("Remote side vector support: %s", remote_peer_features.vectors ? "yes" : "no");
   tweak_common_mutex_lock(&client_impl->base.conn_state_lock);
   client_impl->base.remote_peer_features = remote_peer_features;
+  tweak_pickle_client_set_packed_vectors(client_impl->rpc_endpoint, remote_peer_features.packed_vectors);
   tweak_common_mutex_unlock(&client_impl->base.conn_state_lock);
 }
 
@@ -194,8 +331,17 @@ static void client_connection_state_pickle_impl(tweak_pickle_connection_state co
   case TWEAK_PICKLE_CONNECTED:
     tweak_common_mutex_lock(&client_impl->base.conn_state_lock);
     tweak_app_features_init_minimal(&client_impl->base.remote_peer_features);
+    tweak_pickle_client_set_packed_vectors(client_impl->rpc_endpoint, false);
+    client_impl->features_sent = false;
     tweak_common_mutex_unlock(&client_impl->base.conn_state_lock);
-    reset_model(client_impl);
+    tweak_common_rwlock_read_lock(&client_impl->base.model_impl.model_lock);
+    bool resync = client_impl->model_epoch != 0;
+    tweak_common_rwlock_read_unlock(&client_impl->base.model_impl.model_lock);
+    if (!resync) {
+      reset_model(client_impl, 0);
+    } else {
+      TWEAK_LOG_DEBUG("Items are kept till server announces its model epoch");
+    }
     tweak_app_context_private_set_connected(&client_impl->base, true);
     if (client_impl->client_callbacks.on_connection_status_changed != NULL) {
       TWEAK_LOG_TRACE("Calling on_connection_status_changed(TWEAK_PICKLE_CONNECTED)");
@@ -239,6 +385,16 @@ static tweak_id add_item_to_model(struct tweak_model_impl* model, tweak_pickle_a
     tweak_model_remove_item(model->model, add_item->id);
     return TWEAK_INVALID_ID;
   }
+
+  if (!tweak_model_scalar_cache_insert(model->scalar_cache, add_item->id, &add_item->current_value,
+    tweak_model_find_item_by_id(model->model, add_item->id)))
+  {
+    TWEAK_LOG_TRACE("Can't handle add_item request for tweak_id = %" PRIu64 "\n", add_item->id);
+    tweak_model_uri_to_tweak_id_index_remove(model->index, tweak_variant_string_c_str(&add_item->uri));
+    tweak_model_remove_item(model->model, add_item->id);
+    return TWEAK_INVALID_ID;
+  }
+  tweak_model_find_item_by_id(model->model, add_item->id)->version = add_item->version;
   return add_item->id;
 }
 
@@ -246,10 +402,11 @@ bool is_add_item_correct(tweak_pickle_add_item *add_item, tweak_item* item)
 {
   return (
       item->id == add_item->id &&
-      tweak_variant_str_is_equal(&item->uri, &add_item->uri) &&
-      tweak_variant_str_is_equal(&item->description, &add_item->description) &&
-      tweak_variant_str_is_equal(&item->meta, &add_item->meta) &&
-      tweak_variant_is_equal(&item->default_value, &add_item->default_value)
+      tweak_interned_string_length(item->cold->uri) == add_item->uri.length &&
+      strcmp(tweak_interned_string_c_str(item->cold->uri), tweak_variant_string_c_str(&add_item->uri)) == 0 &&
+      tweak_variant_str_is_equal(&item->cold->description, &add_item->description) &&
+      tweak_variant_str_is_equal(&item->cold->meta, &add_item->meta) &&
+      tweak_variant_is_equal(&item->cold->default_value, &add_item->default_value)
   );
 }
 
@@ -277,9 +434,11 @@ static void client_add_item_pickle_impl(tweak_pickle_add_item *add_item, void *c
       TWEAK_FATAL("Client model is inconsistent. uri = %s id = %" PRIu64,
         tweak_variant_string_c_str(&add_item->uri), add_item->id);
     }
+    item->version = add_item->version;
 
     if (!tweak_variant_is_equal(&item->current_value, &add_item->current_value)) {
       tweak_variant_swap(&item->current_value, &add_item->current_value);
+      tweak_model_scalar_cache_update(model->scalar_cache, tweak_id, &item->current_value);
       value = tweak_variant_copy(&item->current_value);
       status = TWEAK_APP_ITEM_VALUE_UPDATED;
     } else {
@@ -295,6 +454,9 @@ static void client_add_item_pickle_impl(tweak_pickle_add_item *add_item, void *c
 
   tweak_common_rwlock_write_unlock(&model->model_lock);
   wait_context_notify_all(&client_impl->wait_context);
+  if (status == TWEAK_APP_ITEM_VALUE_UPDATED) {
+    tweak_app_changes_record(&client_impl->base.changes, tweak_id);
+  }
 
   switch (status) {
   case TWEAK_APP_ITEM_CREATED:
@@ -326,16 +488,34 @@ static void client_change_item_pickle_impl(tweak_pickle_change_item *change, voi
   struct tweak_app_context_client_impl* client_impl = cookie;
   struct tweak_model_impl* model = &client_impl->base.model_impl;
   bool emit_change_event = false;
+  bool changed = false;
   tweak_id id = TWEAK_INVALID_ID;
   tweak_variant value = TWEAK_VARIANT_INIT_EMPTY;
   tweak_common_rwlock_write_lock(&model->model_lock);
   tweak_item* item = tweak_model_find_item_by_id(model->model, change->id);
-  if (item) {
+  if (item && change->partial) {
+    if (tweak_app_context_private_apply_partial_value(&item->current_value, change->offset,
+      &change->value, &changed))
+    {
+      item->version = change->version;
+      TWEAK_LOG_TRACE("range of item with id = %" PRIu64 " updated", change->id);
+      id = item->id;
+      if (changed && client_impl->client_callbacks.on_current_value_changed) {
+        value = tweak_variant_copy(&item->current_value);
+        emit_change_event = true;
+      }
+    } else {
+      TWEAK_LOG_WARN("invalid range of item with id = %" PRIu64 " ignored", change->id);
+    }
+  } else if (item) {
     tweak_variant_swap(&item->current_value, &change->value);
+    tweak_model_scalar_cache_update(model->scalar_cache, change->id, &item->current_value);
+    item->version = change->version;
     TWEAK_LOG_TRACE("item with id = %" PRIu64 " updated", change->id);
     id = item->id;
+    changed = !tweak_variant_is_equal(&item->current_value, &change->value);
     if (client_impl->client_callbacks.on_current_value_changed) {
-      if (!tweak_variant_is_equal(&item->current_value, &change->value)) {
+      if (changed) {
         value = tweak_variant_copy(&item->current_value);
         emit_change_event = true;
       }
@@ -347,6 +527,9 @@ static void client_change_item_pickle_impl(tweak_pickle_change_item *change, voi
   }
   tweak_common_rwlock_write_unlock(&model->model_lock);
   wait_context_notify_all(&client_impl->wait_context);
+  if (changed) {
+    tweak_app_changes_record(&client_impl->base.changes, id);
+  }
   if (emit_change_event) {
     TWEAK_LOG_TRACE("Invoking on_current_value_changed");
     client_impl->client_callbacks.on_current_value_changed(&client_impl->base,
@@ -365,7 +548,8 @@ static void client_remove_item_pickle_impl(tweak_pickle_remove_item* remove_item
   tweak_common_rwlock_write_lock(&model->model_lock);
   tweak_item* item = tweak_model_find_item_by_id(model->model, remove_item->id);
   if (item != NULL) {
-    tweak_model_uri_to_tweak_id_index_remove(model->index, tweak_variant_string_c_str(&item->uri));
+    tweak_model_uri_to_tweak_id_index_remove(model->index, tweak_interned_string_c_str(item->cold->uri));
+    tweak_model_scalar_cache_remove(model->scalar_cache, remove_item->id);
     tweak_model_remove_item(model->model, remove_item->id);
     TWEAK_LOG_TRACE("item with id = %" PRIu64 " removed", remove_item->id);
     item_removed = true;
@@ -411,6 +595,62 @@ static void io_loop_change(tweak_id tweak_id, void* cookie) {
   }
 }
 
+/**
+ * @brief Send a range of vector item to server, or the whole value
+ * if server doesn't support partial changes.
+ */
+static void io_loop_partial_change(tweak_id tweak_id, size_t offset, size_t count, void* cookie) {
+  TWEAK_LOG_TRACE_ENTRY();
+  struct tweak_app_context_client_impl* client_impl = cookie;
+  struct tweak_model_impl* model = &client_impl->base.model_impl;
+  tweak_pickle_change_item change = {
+    .id = tweak_id,
+    .value = TWEAK_VARIANT_INIT_EMPTY,
+    .partial = true,
+    .offset = offset
+  };
+  bool should_push_change = false;
+  tweak_common_mutex_lock(&client_impl->base.conn_state_lock);
+  bool partial_changes = client_impl->base.remote_peer_features.partial_changes;
+  tweak_common_mutex_unlock(&client_impl->base.conn_state_lock);
+  if (!partial_changes) {
+    io_loop_change(tweak_id, cookie);
+    return;
+  }
+  tweak_common_rwlock_read_lock(&model->model_lock);
+  tweak_item* item = tweak_model_find_item_by_id(model->model, tweak_id);
+  if (item != NULL) {
+    should_push_change = tweak_app_context_private_is_connected(&client_impl->base)
+      && tweak_app_context_private_copy_vector_range(&item->current_value, offset, count, &change.value);
+  } else {
+    TWEAK_LOG_WARN("io_loop_partial_change: Unknown item id %" PRIu64 "\n", tweak_id);
+  }
+  tweak_common_rwlock_read_unlock(&model->model_lock);
+  if (should_push_change) {
+    TWEAK_LOG_TRACE("Pushing range change for tweak_id = %" PRIu64 " to server", tweak_id);
+    tweak_pickle_call_result result =
+      tweak_pickle_client_change_item(client_impl->rpc_endpoint, &change);
+    if (result != TWEAK_PICKLE_SUCCESS) {
+      TWEAK_LOG_TRACE("failed tweak_pickle_client_change_item RPC call on id = %" PRIu64 "\n", tweak_id);
+    }
+  }
+  tweak_variant_destroy(&change.value);
+}
+
+static void client_push_partial_changes(tweak_app_context context, tweak_id tweak_id,
+  size_t offset, size_t count)
+{
+  TWEAK_LOG_TRACE_ENTRY();
+  struct job job = {
+    .range_job_proc = &io_loop_partial_change,
+    .tweak_id = tweak_id,
+    .offset = offset,
+    .count = count,
+    .cookie = context
+  };
+  tweak_app_queue_push(context->job_queue, &job);
+}
+
 static void client_push_changes(tweak_app_context context, tweak_id tweak_id) {
   TWEAK_LOG_TRACE_ENTRY();
   struct job job = {
@@ -421,6 +661,23 @@ static void client_push_changes(tweak_app_context context, tweak_id tweak_id) {
   tweak_app_queue_push(context->job_queue, &job);
 }
 
+static void client_push_changes_batch(tweak_app_context context, const tweak_id* tweak_ids,
+  size_t count)
+{
+  TWEAK_LOG_TRACE_ENTRY();
+  struct job* jobs = calloc(count, sizeof(*jobs));
+  if (!jobs) {
+    TWEAK_FATAL("Can't allocate memory");
+  }
+  for (size_t ix = 0; ix < count; ++ix) {
+    jobs[ix].job_proc = &io_loop_change;
+    jobs[ix].tweak_id = tweak_ids[ix];
+    jobs[ix].cookie = context;
+  }
+  tweak_app_queue_push_batch(context->job_queue, jobs, count);
+  free(jobs);
+}
+
 static tweak_app_error_code check_connection_and_clone_current_value(tweak_app_context context,
   tweak_id id, tweak_variant* value)
 {
@@ -431,6 +688,16 @@ static tweak_app_error_code check_connection_and_clone_current_value(tweak_app_c
   return error_code;
 }
 
+static tweak_app_error_code check_connection_and_read_item(tweak_app_context context,
+  tweak_id id, tweak_app_item_visitor visitor, void* cookie)
+{
+  TWEAK_LOG_TRACE_ENTRY();
+  tweak_app_error_code error_code = tweak_app_context_private_item_read(context, id, visitor, cookie);
+  if (error_code == TWEAK_APP_SUCCESS && !tweak_app_context_private_is_connected(context))
+    error_code = TWEAK_APP_SUCCESS_LAST_KNOWN_VALUE;
+  return error_code;
+}
+
 static tweak_app_error_code replace_current_value(tweak_app_context context,
   tweak_id tweak_id, tweak_variant* value)
 {
@@ -454,6 +721,92 @@ static tweak_app_error_code replace_current_value(tweak_app_context context,
   }
 }
 
+static tweak_app_error_code replace_values(tweak_app_context context,
+  const tweak_id* tweak_ids, tweak_variant* values, size_t count)
+{
+  TWEAK_LOG_TRACE_ENTRY();
+  struct tweak_model_impl* model = &context->model_impl;
+  tweak_app_error_code error_code = TWEAK_APP_SUCCESS;
+  tweak_common_rwlock_read_lock(&model->model_lock);
+  for (size_t ix = 0; ix < count && error_code == TWEAK_APP_SUCCESS; ++ix) {
+    tweak_item* item = tweak_model_find_item_by_id(model->model, tweak_ids[ix]);
+    if (item == NULL) {
+      TWEAK_LOG_WARN("item with id = %" PRIu64 " isn't found ", tweak_ids[ix]);
+      error_code = TWEAK_APP_ITEM_NOT_FOUND;
+    } else if (!tweak_app_context_private_check_value_compatibility(&item->current_value, &values[ix])) {
+      TWEAK_LOG_WARN("Type mismatch error while updating item with tweak_id = %" PRIu64 "", tweak_ids[ix]);
+      error_code = TWEAK_APP_TYPE_MISMATCH;
+    }
+  }
+  tweak_common_rwlock_read_unlock(&model->model_lock);
+  if (error_code != TWEAK_APP_SUCCESS) {
+    return error_code;
+  }
+  return tweak_app_context_private_is_connected(context)
+    ? tweak_app_context_private_item_replace_values(context, tweak_ids, values, count)
+    : TWEAK_APP_PEER_DISCONNECTED;
+}
+
+static tweak_app_error_code check_connection_and_load_vector_range(tweak_app_context context,
+  tweak_id tweak_id, tweak_variant_type type, size_t offset, size_t count, void* buffer)
+{
+  TWEAK_LOG_TRACE_ENTRY();
+  tweak_app_error_code error_code = tweak_app_context_private_item_load_vector_range(context,
+    tweak_id, type, offset, count, buffer);
+  if (error_code == TWEAK_APP_SUCCESS && !tweak_app_context_private_is_connected(context))
+    error_code = TWEAK_APP_SUCCESS_LAST_KNOWN_VALUE;
+  return error_code;
+}
+
+static tweak_app_error_code store_vector_range(tweak_app_context context,
+  tweak_id tweak_id, tweak_variant_type type, size_t offset, size_t count, const void* buffer)
+{
+  TWEAK_LOG_TRACE_ENTRY();
+  tweak_app_error_code error_code = tweak_app_context_private_check_vector_range(context,
+    tweak_id, type, offset, count);
+  if (error_code != TWEAK_APP_SUCCESS) {
+    TWEAK_LOG_WARN("Can't update range of item with tweak_id = %" PRIu64 ", error = %d", tweak_id, error_code);
+    return error_code;
+  }
+  return tweak_app_context_private_is_connected(context)
+    ? tweak_app_context_private_item_store_vector_range(context, tweak_id, type, offset, count, buffer)
+    : TWEAK_APP_PEER_DISCONNECTED;
+}
+
+static tweak_app_error_code check_connection_and_clone_current_value_by_handle(tweak_app_context context,
+  tweak_app_handle handle, tweak_variant* value)
+{
+  TWEAK_LOG_TRACE_ENTRY();
+  tweak_app_error_code error_code = tweak_app_context_private_item_clone_current_value_by_handle(context,
+    handle, value);
+  if (error_code == TWEAK_APP_SUCCESS && !tweak_app_context_private_is_connected(context))
+    error_code = TWEAK_APP_SUCCESS_LAST_KNOWN_VALUE;
+  return error_code;
+}
+
+static tweak_app_error_code replace_current_value_by_handle(tweak_app_context context,
+  tweak_app_handle handle, tweak_variant* value)
+{
+  TWEAK_LOG_TRACE_ENTRY();
+  struct tweak_model_impl* model = &context->model_impl;
+  bool value_allowed = false;
+  tweak_common_rwlock_read_lock(&model->model_lock);
+  tweak_item* item = tweak_model_scalar_cache_get_item_by_handle(model->scalar_cache, handle);
+  value_allowed = (item != NULL) && tweak_app_context_private_check_value_compatibility(&item->current_value, value);
+  tweak_common_rwlock_read_unlock(&model->model_lock);
+  if ((item != NULL) && value_allowed) {
+    return tweak_app_context_private_is_connected(context)
+      ? tweak_app_context_private_item_replace_current_value_by_handle(context, handle, value)
+      : TWEAK_APP_PEER_DISCONNECTED;
+  } else if ((item != NULL) && !value_allowed) {
+    TWEAK_LOG_WARN("Type mismatch error while updating item with handle = %" PRIx64 "", handle);
+    return TWEAK_APP_TYPE_MISMATCH;
+  } else {
+    TWEAK_LOG_WARN("item with handle = %" PRIx64 " isn't found ", handle);
+    return TWEAK_APP_ITEM_NOT_FOUND;
+  }
+}
+
 static void client_destroy_context(struct tweak_app_context_base* context) {
   TWEAK_LOG_TRACE_ENTRY();
   struct tweak_app_context_client_impl* client_impl = (struct tweak_app_context_client_impl*)context;
@@ -470,6 +823,7 @@ static void client_destroy_context(struct tweak_app_context_base* context) {
 
   tweak_app_context_private_destroy_base(&client_impl->base);
   destroy_wait_context(&client_impl->wait_context);
+  tweak_variant_destroy_string(&client_impl->uri_patterns);
   free(context);
 }
 
@@ -518,21 +872,34 @@ tweak_app_client_context tweak_app_create_client_context(const char *context_typ
     }
   };
 
-  if (!tweak_app_context_private_initialize_base(&client_impl->base, TWEAK_APP_CLIENT_QUEUE_SIZE)) {
+  tweak_app_io_mode io_mode = client_callbacks ? client_callbacks->io_mode : TWEAK_APP_IO_MODE_THREAD;
+  if (!tweak_app_context_private_initialize_base(&client_impl->base, TWEAK_APP_CLIENT_QUEUE_SIZE, io_mode)) {
     TWEAK_LOG_ERROR("tweak_app_context_private_initialize_base() fail");
     goto destroy_context;
   }
 
   client_impl->base.clone_current_value_proc = &check_connection_and_clone_current_value;
+  client_impl->base.read_item_proc = &check_connection_and_read_item;
   client_impl->base.replace_current_value_proc = &replace_current_value;
+  client_impl->base.replace_values_proc = &replace_values;
+  client_impl->base.load_vector_range_proc = &check_connection_and_load_vector_range;
+  client_impl->base.store_vector_range_proc = &store_vector_range;
+  client_impl->base.clone_current_value_by_handle_proc = &check_connection_and_clone_current_value_by_handle;
+  client_impl->base.replace_current_value_by_handle_proc = &replace_current_value_by_handle;
   client_impl->base.push_changes_proc = &client_push_changes;
+  client_impl->base.push_partial_changes_proc = &client_push_partial_changes;
+  client_impl->base.push_changes_batch_proc = &client_push_changes_batch;
   client_impl->base.destroy_context = &client_destroy_context;
 
   if (client_callbacks) {
     client_impl->client_callbacks = *client_callbacks;
   }
 
+  /* Connection state listener can be invoked by transport thread before endpoint
+   * is returned, it waits on the lock till the endpoint is set */
+  tweak_common_mutex_lock(&client_impl->base.conn_state_lock);
   client_impl->rpc_endpoint = tweak_pickle_create_client_endpoint(&client_descriptor);
+  tweak_common_mutex_unlock(&client_impl->base.conn_state_lock);
   if (!client_impl->rpc_endpoint) {
     TWEAK_LOG_ERROR("tweak_pickle_create_client_endpoint() fail");
     goto destroy_context;
@@ -617,3 +984,16 @@ tweak_app_error_code tweak_app_client_wait_uris(tweak_app_client_context client_
     return TWEAK_APP_TIMEOUT;
   }
 }
+
+void tweak_app_client_subscribe(tweak_app_client_context client_context, const char* uri_patterns) {
+  TWEAK_LOG_TRACE_ENTRY("client_context = %p, uri_patterns = %s", client_context, uri_patterns);
+  if (!client_context) {
+    TWEAK_FATAL("Invalid argument: client_context is NULL");
+  }
+  struct tweak_app_context_client_impl* client_impl =
+    (struct tweak_app_context_client_impl*) client_context;
+  tweak_common_mutex_lock(&client_impl->base.conn_state_lock);
+  tweak_assign_string(&client_impl->uri_patterns, uri_patterns ? uri_patterns : "");
+  tweak_common_mutex_unlock(&client_impl->base.conn_state_lock);
+  push_resubscribe(client_context);
+}
@@ -28,6 +28,7 @@
 #include <tweak2/log.h>
 #include <errno.h>
 #include <inttypes.h>
+#include <string.h>
 
 #include "tweakappinternal.h"
 
@@ -84,6 +85,10 @@ bool tweak_app_context_private_check_value_compatibility(const tweak_variant* sa
   return false;
 }
 
+void tweak_app_context_private_touch_item(struct tweak_model_impl* model, tweak_item* item) {
+  item->version = model->epoch != 0 ? ++model->version : 0;
+}
+
 static void* io_loop(void* arg) {
   TWEAK_LOG_TRACE_ENTRY();
   struct tweak_app_context_base* app_context = arg;
@@ -96,17 +101,23 @@ static void* io_loop(void* arg) {
     }
     const struct job_array* job_array = jobs_batch.job_array;
     for (size_t ix = 0; ix < job_array->size; ++ix) {
-      struct job* job = &job_array->jobs[ix];
-      assert(job->job_proc != NULL);
-      job->job_proc(job->tweak_id, job->cookie);
+      tweak_app_queue_run_job(&job_array->jobs[ix]);
+    }
+    if (app_context->end_of_batch_proc) {
+      app_context->end_of_batch_proc(app_context);
     }
   }
   return NULL;
 }
 
-bool tweak_app_context_private_initialize_base(struct tweak_app_context_base* app_context, uint32_t queue_size) {
-  TWEAK_LOG_TRACE_ENTRY("app_context = %p, queue_size = %u", app_context, queue_size);
+bool tweak_app_context_private_initialize_base(struct tweak_app_context_base* app_context, uint32_t queue_size,
+  tweak_app_io_mode io_mode)
+{
+  TWEAK_LOG_TRACE_ENTRY("app_context = %p, queue_size = %u, io_mode = %d", app_context, queue_size, io_mode);
   tweak_common_mutex_init(&app_context->conn_state_lock);
+  tweak_common_mutex_init(&app_context->poll_lock);
+  tweak_app_changes_init(&app_context->changes);
+  app_context->io_mode = io_mode;
 
   app_context->model_impl.model = tweak_model_create();
   if (!app_context->model_impl.model) {
@@ -120,9 +131,15 @@ bool tweak_app_context_private_initialize_base(struct tweak_app_context_base* ap
     goto destroy_model;
   }
 
+  app_context->model_impl.scalar_cache = tweak_model_scalar_cache_create();
+  if (!app_context->model_impl.scalar_cache) {
+    TWEAK_LOG_ERROR("tweak_model_scalar_cache_create() failed");
+    goto destroy_tweak_id_index;
+  }
+
   if (tweak_common_rwlock_init(&app_context->model_impl.model_lock) != TWEAK_COMMON_THREAD_SUCCESS) {
     TWEAK_LOG_ERROR("tweak_common_rwlock_init() failed");
-    goto destroy_tweak_id_index;
+    goto destroy_scalar_cache;
   }
 
   app_context->job_queue = tweak_app_queue_create(queue_size);
@@ -131,7 +148,15 @@ bool tweak_app_context_private_initialize_base(struct tweak_app_context_base* ap
     goto destroy_rwlock;
   }
 
-  if (tweak_common_thread_create(&app_context->worker_thread, io_loop, app_context) != TWEAK_COMMON_THREAD_SUCCESS) {
+  if (io_mode == TWEAK_APP_IO_MODE_POLL) {
+    /* Blocking push would wait for the polling thread, which might be the caller itself */
+    if (!tweak_app_queue_set_policy(app_context->job_queue, JOB_QUEUE_POLICY_MERGE)) {
+      TWEAK_LOG_ERROR("tweak_app_queue_set_policy() failed");
+      goto destroy_app_queue;
+    }
+  } else if (tweak_common_thread_create(&app_context->worker_thread, io_loop, app_context)
+    != TWEAK_COMMON_THREAD_SUCCESS)
+  {
     TWEAK_LOG_ERROR("Platform specific threading error in tweak_common_thread_create()");
     goto destroy_app_queue;
   }
@@ -144,6 +169,9 @@ destroy_app_queue:
 destroy_rwlock:
   tweak_common_rwlock_destroy(&app_context->model_impl.model_lock);
 
+destroy_scalar_cache:
+  tweak_model_scalar_cache_destroy(app_context->model_impl.scalar_cache);
+
 destroy_tweak_id_index:
   tweak_model_uri_to_tweak_id_index_destroy(app_context->model_impl.index);
 
@@ -151,6 +179,8 @@ destroy_model:
   tweak_model_destroy(app_context->model_impl.model);
 
 destroy_connection_state_lock:
+  tweak_app_changes_destroy(&app_context->changes);
+  tweak_common_mutex_destroy(&app_context->poll_lock);
   tweak_common_mutex_destroy(&app_context->conn_state_lock);
 
   return false;
@@ -171,28 +201,41 @@ tweak_id tweak_app_find_id(tweak_app_context context, const char* uri) {
 }
 
 struct traverse_context {
-  struct tweak_app_context_base* context;
   tweak_app_traverse_items_callback user_callback;
   void* user_cookie;
 };
 
-static bool index_traverse_proc(const char *uri, tweak_id id, void* cookie) {
-  (void) uri;
-  TWEAK_LOG_TRACE_ENTRY("uri = %s, id = %" PRIu64 ", cookie= %p", uri, id, cookie);
-  struct traverse_context* traverse_context = cookie;
-   struct tweak_app_context_base* context = traverse_context->context;
-  tweak_item* item = NULL;
-  item = tweak_model_find_item_by_id(context->model_impl.model, id);
-  assert(item);
+static bool invoke_traverse_callback(tweak_item* item, struct traverse_context* traverse_context) {
   tweak_app_item_snapshot snapshot = {
     .id = item->id,
-    .uri = item->uri,
-    .description = item->description,
-    .meta = item->meta,
-    .default_value = item->default_value,
+    .uri = tweak_interned_string_copy(item->cold->uri),
+    .description = item->cold->description,
+    .meta = item->cold->meta,
+    .default_value = item->cold->default_value,
     .current_value = item->current_value
   };
-  return traverse_context->user_callback(&snapshot, traverse_context->user_cookie);
+  bool result = traverse_context->user_callback(&snapshot, traverse_context->user_cookie);
+  tweak_variant_destroy_string(&snapshot.uri);
+  return result;
+}
+
+static bool model_traverse_proc(tweak_item* item, void* cookie) {
+  TWEAK_LOG_TRACE_ENTRY("item = %p, cookie= %p", item, cookie);
+  return invoke_traverse_callback(item, cookie);
+}
+
+struct index_traverse_context {
+  struct tweak_app_context_base* context;
+  struct traverse_context traverse_context;
+};
+
+static bool index_traverse_proc(const char *uri, tweak_id id, void* cookie) {
+  (void) uri;
+  TWEAK_LOG_TRACE_ENTRY("uri = %s, id = %" PRIu64 ", cookie= %p", uri, id, cookie);
+  struct index_traverse_context* index_traverse_context = cookie;
+  tweak_item* item = tweak_model_find_item_by_id(index_traverse_context->context->model_impl.model, id);
+  assert(item);
+  return invoke_traverse_callback(item, &index_traverse_context->traverse_context);
 }
 
 bool tweak_app_traverse_items(tweak_app_context context,
@@ -200,14 +243,51 @@ bool tweak_app_traverse_items(tweak_app_context context,
 {
   TWEAK_LOG_TRACE_ENTRY("context = %p, callback = %p, cookie= %p", context, callback, cookie);
   struct traverse_context traverse_context = {
-    .context = context,
     .user_callback = callback,
     .user_cookie = cookie
   };
   bool result;
   tweak_common_rwlock_read_lock(&context->model_impl.model_lock);
-  result = tweak_model_uri_to_tweak_id_index_walk(context->model_impl.index,
-    &index_traverse_proc, &traverse_context);
+  result = tweak_model_walk_items(context->model_impl.model,
+    &model_traverse_proc, &traverse_context);
+  tweak_common_rwlock_read_unlock(&context->model_impl.model_lock);
+  return result;
+}
+
+bool tweak_app_traverse_subtree(tweak_app_context context, const char* prefix,
+  tweak_app_traverse_items_callback callback, void* cookie)
+{
+  TWEAK_LOG_TRACE_ENTRY("context = %p, prefix = %s, callback = %p, cookie= %p", context, prefix, callback, cookie);
+  struct index_traverse_context index_traverse_context = {
+    .context = context,
+    .traverse_context = {
+      .user_callback = callback,
+      .user_cookie = cookie
+    }
+  };
+  bool result;
+  tweak_common_rwlock_read_lock(&context->model_impl.model_lock);
+  result = tweak_model_uri_to_tweak_id_index_walk_subtree(context->model_impl.index, prefix,
+    &index_traverse_proc, &index_traverse_context);
+  tweak_common_rwlock_read_unlock(&context->model_impl.model_lock);
+  return result;
+}
+
+bool tweak_app_traverse_glob(tweak_app_context context, const char* pattern,
+  tweak_app_traverse_items_callback callback, void* cookie)
+{
+  TWEAK_LOG_TRACE_ENTRY("context = %p, pattern = %s, callback = %p, cookie= %p", context, pattern, callback, cookie);
+  struct index_traverse_context index_traverse_context = {
+    .context = context,
+    .traverse_context = {
+      .user_callback = callback,
+      .user_cookie = cookie
+    }
+  };
+  bool result;
+  tweak_common_rwlock_read_lock(&context->model_impl.model_lock);
+  result = tweak_model_uri_to_tweak_id_index_walk_glob(context->model_impl.index, pattern,
+    &index_traverse_proc, &index_traverse_context);
   tweak_common_rwlock_read_unlock(&context->model_impl.model_lock);
   return result;
 }
@@ -224,10 +304,10 @@ tweak_app_item_snapshot* tweak_app_item_get_snapshot(tweak_app_context context,
     snapshot = calloc(1, sizeof(*snapshot));
     if (snapshot) {
       snapshot->id = item->id;
-      snapshot->uri = tweak_variant_string_copy(&item->uri);
-      snapshot->description = tweak_variant_string_copy(&item->description);
-      snapshot->meta = tweak_variant_string_copy(&item->meta);
-      snapshot->default_value = tweak_variant_copy(&item->default_value);
+      snapshot->uri = tweak_interned_string_copy(item->cold->uri);
+      snapshot->description = tweak_variant_string_copy(&item->cold->description);
+      snapshot->meta = tweak_variant_string_copy(&item->cold->meta);
+      snapshot->default_value = tweak_variant_copy(&item->cold->default_value);
       snapshot->current_value = tweak_variant_copy(&item->current_value);
     } else {
       TWEAK_FATAL("Can't allocate memory for item state snapshot");
@@ -237,18 +317,48 @@ tweak_app_item_snapshot* tweak_app_item_get_snapshot(tweak_app_context context,
   return snapshot;
 }
 
-tweak_variant_type tweak_app_item_get_type(tweak_app_context context, tweak_id id) {
-  TWEAK_LOG_TRACE_ENTRY("context = %p, id = %" PRIu64 "", context, id);
-  tweak_variant_type result = TWEAK_VARIANT_TYPE_NULL;
+tweak_app_error_code tweak_app_item_read(tweak_app_context context, tweak_id id,
+  tweak_app_item_visitor visitor, void* cookie)
+{
+  return context->read_item_proc(context, id, visitor, cookie);
+}
+
+tweak_app_error_code tweak_app_context_private_item_read(tweak_app_context context,
+  tweak_id id, tweak_app_item_visitor visitor, void* cookie)
+{
+  TWEAK_LOG_TRACE_ENTRY("context = %p, id = %" PRIu64 ", visitor = %p, cookie = %p", context, id, visitor, cookie);
+  tweak_item* item = NULL;
   tweak_common_rwlock_read_lock(&context->model_impl.model_lock);
-  tweak_item* item = tweak_model_find_item_by_id(context->model_impl.model, id);
+  item = tweak_model_find_item_by_id(context->model_impl.model, id);
   if (item != NULL) {
-    result = item->default_value.type;
+    tweak_app_item_view view = {
+      .id = item->id,
+      .uri = tweak_interned_string_c_str(item->cold->uri),
+      .description = &item->cold->description,
+      .meta = &item->cold->meta,
+      .default_value = &item->cold->default_value,
+      .current_value = &item->current_value
+    };
+    visitor(&view, cookie);
+  }
+  tweak_common_rwlock_read_unlock(&context->model_impl.model_lock);
+  if (item == NULL) {
+    TWEAK_LOG_TRACE("Item with tweak_id = %" PRIu64 " hasn't been found, can't read", id);
+    return TWEAK_APP_ITEM_NOT_FOUND;
+  }
+  return TWEAK_APP_SUCCESS;
+}
+
+tweak_variant_type tweak_app_item_get_type(tweak_app_context context, tweak_id id) {
+  TWEAK_LOG_TRACE_ENTRY("context = %p, id = %" PRIu64 "", context, id);
+  tweak_variant scalar_value = TWEAK_VARIANT_INIT_EMPTY;
+  tweak_variant_type result = tweak_model_scalar_cache_load(context->model_impl.scalar_cache,
+    id, &scalar_value);
+  if (result != TWEAK_VARIANT_TYPE_NULL) {
     TWEAK_LOG_TRACE("Item with tweak_id = %" PRIu64 " has type %d", id, result);
   } else {
     TWEAK_LOG_TRACE("Item with tweak_id = %" PRIu64 " isn't found", id);
   }
-  tweak_common_rwlock_read_unlock(&context->model_impl.model_lock);
   return result;
 }
 
@@ -277,6 +387,83 @@ tweak_app_error_code tweak_app_item_replace_current_value(tweak_app_context cont
   return context->replace_current_value_proc(context, id, value);
 }
 
+tweak_app_error_code tweak_app_item_replace_values(tweak_app_context context,
+  const tweak_id* ids, tweak_variant* values, size_t count)
+{
+  return context->replace_values_proc(context, ids, values, count);
+}
+
+tweak_app_error_code tweak_app_item_load_scalar(tweak_app_context context,
+  tweak_id id, tweak_variant* value)
+{
+  TWEAK_LOG_TRACE_ENTRY("context = %p, tweak_id =  %" PRIu64 ", value = %p", context, id, value);
+  tweak_variant scalar_value = TWEAK_VARIANT_INIT_EMPTY;
+  tweak_variant_type type = tweak_model_scalar_cache_load(context->model_impl.scalar_cache,
+    id, &scalar_value);
+  if (type == TWEAK_VARIANT_TYPE_NULL) {
+    TWEAK_LOG_TRACE("Item with tweak_id = %" PRIu64 " hasn't been found", id);
+    return TWEAK_APP_ITEM_NOT_FOUND;
+  }
+  if (scalar_value.type != type) {
+    TWEAK_LOG_TRACE("Item with tweak_id = %" PRIu64 " has non scalar type %d", id, type);
+    return TWEAK_APP_TYPE_MISMATCH;
+  }
+  *value = scalar_value;
+  return TWEAK_APP_SUCCESS;
+}
+
+tweak_app_handle tweak_app_acquire_handle(tweak_app_context context, tweak_id id) {
+  TWEAK_LOG_TRACE_ENTRY("context = %p, tweak_id =  %" PRIu64 "", context, id);
+  tweak_app_handle handle = tweak_model_scalar_cache_get_handle(context->model_impl.scalar_cache, id);
+  if (handle == TWEAK_APP_INVALID_HANDLE) {
+    TWEAK_LOG_TRACE("Item with tweak_id = %" PRIu64 " hasn't been found", id);
+  }
+  return handle;
+}
+
+tweak_app_error_code tweak_app_handle_load_scalar(tweak_app_context context,
+  tweak_app_handle handle, tweak_variant* value)
+{
+  TWEAK_LOG_TRACE_ENTRY("context = %p, handle =  %" PRIx64 ", value = %p", context, handle, value);
+  tweak_variant scalar_value = TWEAK_VARIANT_INIT_EMPTY;
+  tweak_variant_type type = tweak_model_scalar_cache_load_by_handle(context->model_impl.scalar_cache,
+    handle, NULL, &scalar_value);
+  if (type == TWEAK_VARIANT_TYPE_NULL) {
+    TWEAK_LOG_TRACE("Item with handle = %" PRIx64 " hasn't been found", handle);
+    return TWEAK_APP_ITEM_NOT_FOUND;
+  }
+  if (scalar_value.type != type) {
+    TWEAK_LOG_TRACE("Item with handle = %" PRIx64 " has non scalar type %d", handle, type);
+    return TWEAK_APP_TYPE_MISMATCH;
+  }
+  *value = scalar_value;
+  return TWEAK_APP_SUCCESS;
+}
+
+tweak_app_error_code tweak_app_handle_clone_current_value(tweak_app_context context,
+  tweak_app_handle handle, tweak_variant* value)
+{
+  return context->clone_current_value_by_handle_proc(context, handle, value);
+}
+
+tweak_app_error_code tweak_app_handle_replace_current_value(tweak_app_context context,
+  tweak_app_handle handle, tweak_variant* value)
+{
+  return context->replace_current_value_by_handle_proc(context, handle, value);
+}
+
+tweak_app_error_code tweak_app_item_load_vector_range(tweak_app_context context,
+  tweak_id id, tweak_variant_type type, size_t offset, size_t count, void* buffer)
+{
+  return context->load_vector_range_proc(context, id, type, offset, count, buffer);
+}
+
+tweak_app_error_code tweak_app_item_store_vector_range(tweak_app_context context,
+  tweak_id id, tweak_variant_type type, size_t offset, size_t count, const void* buffer)
+{
+  return context->store_vector_range_proc(context, id, type, offset, count, buffer);
+}
+
 tweak_app_error_code tweak_app_context_private_item_clone_current_value(tweak_app_context context,
   tweak_id id, tweak_variant* value)
 {
@@ -307,19 +494,19 @@ tweak_app_error_code tweak_app_item_get_metadata(tweak_app_context context,
   tweak_common_rwlock_read_lock(&context->model_impl.model_lock);
   item = tweak_model_find_item_by_id(context->model_impl.model, id);
   if (item) {
-    if (!item->metadata_initialized) {
+    if (!item->cold->metadata_initialized) {
       tweak_common_rwlock_read_unlock(&context->model_impl.model_lock);
       tweak_common_rwlock_write_lock(&context->model_impl.model_lock);
-      if (!item->metadata_initialized) {
-        item->metadata = tweak_metadata_create(item->current_value.type,
+      if (!item->cold->metadata_initialized) {
+        item->cold->metadata = tweak_metadata_create(item->current_value.type,
           tweak_variant_get_item_count(&item->current_value),
-          tweak_variant_string_c_str(&item->meta));
-        item->metadata_initialized = true;
+          tweak_variant_string_c_str(&item->cold->meta));
+        item->cold->metadata_initialized = true;
       }
       tweak_common_rwlock_write_unlock(&context->model_impl.model_lock);
       tweak_common_rwlock_read_lock(&context->model_impl.model_lock);
     }
-    *metadata = tweak_metadata_copy(item->metadata);
+    *metadata = tweak_metadata_copy(item->cold->metadata);
     result = TWEAK_APP_SUCCESS;
   } else {
     TWEAK_LOG_ERROR("Item with tweak_id = %" PRIu64 " hasn't been found", id);
@@ -329,6 +516,22 @@ tweak_app_error_code tweak_app_item_get_metadata(tweak_app_context context,
   return result;
 }
 
+static bool replace_item_value(tweak_app_context context, tweak_item* item, tweak_variant* value) {
+  bool should_push_change = false;
+  if (!tweak_variant_is_equal(&item->current_value, value)) {
+    tweak_variant_swap(&item->current_value, value);
+    tweak_model_scalar_cache_update(context->model_impl.scalar_cache, item->id, &item->current_value);
+    tweak_app_context_private_touch_item(&context->model_impl, item);
+    bool item_is_compatible =
+      tweak_app_features_check_type_compatibility(&context->remote_peer_features, value->type);
+    should_push_change = item_is_compatible && tweak_app_context_private_is_connected(context);
+  } else {
+    TWEAK_LOG_TRACE("Omitting redundant value update");
+  }
+  tweak_variant_destroy(value);
+  return should_push_change;
+}
+
 tweak_app_error_code tweak_app_context_private_item_replace_current_value(tweak_app_context context,
   tweak_id tweak_id, tweak_variant* value)
 {
@@ -338,15 +541,7 @@ tweak_app_error_code tweak_app_context_private_item_replace_current_value(tweak_
   tweak_common_rwlock_write_lock(&context->model_impl.model_lock);
   item = tweak_model_find_item_by_id(context->model_impl.model, tweak_id);
   if (item) {
-    if (!tweak_variant_is_equal(&item->current_value, value)) {
-      tweak_variant_swap(&item->current_value, value);
-      bool item_is_compatible =
-        tweak_app_features_check_type_compatibility(&context->remote_peer_features, value->type);
-      should_push_change = item_is_compatible && tweak_app_context_private_is_connected(context);
-    } else {
-      TWEAK_LOG_TRACE("Omitting redundant value update");
-    }
-    tweak_variant_destroy(value);
+    should_push_change = replace_item_value(context, item, value);
     result = TWEAK_APP_SUCCESS;
   } else {
     result = TWEAK_APP_ITEM_NOT_FOUND;
@@ -364,6 +559,256 @@ tweak_app_error_code tweak_app_context_private_item_replace_current_value(tweak_
   return result;
 }
 
+tweak_app_error_code tweak_app_context_private_item_replace_values(tweak_app_context context,
+  const tweak_id* ids, tweak_variant* values, size_t count)
+{
+  TWEAK_LOG_TRACE_ENTRY("context = %p, ids = %p, values = %p, count = %zu", context, ids, values, count);
+  tweak_app_error_code result = TWEAK_APP_SUCCESS;
+  tweak_id* changed_ids;
+  size_t changed_count = 0;
+  if (count == 0) {
+    return TWEAK_APP_SUCCESS;
+  }
+  changed_ids = malloc(count * sizeof(*changed_ids));
+  if (!changed_ids) {
+    TWEAK_FATAL("Can't allocate memory");
+  }
+  tweak_common_rwlock_write_lock(&context->model_impl.model_lock);
+  for (size_t ix = 0; ix < count; ++ix) {
+    if (!tweak_model_find_item_by_id(context->model_impl.model, ids[ix])) {
+      TWEAK_LOG_TRACE("Item with tweak_id = %" PRIu64 " hasn't been found, can't update", ids[ix]);
+      result = TWEAK_APP_ITEM_NOT_FOUND;
+      break;
+    }
+  }
+  if (result == TWEAK_APP_SUCCESS) {
+    for (size_t ix = 0; ix < count; ++ix) {
+      tweak_item* item = tweak_model_find_item_by_id(context->model_impl.model, ids[ix]);
+      if (replace_item_value(context, item, &values[ix])) {
+        changed_ids[changed_count++] = ids[ix];
+      }
+    }
+  }
+  tweak_common_rwlock_write_unlock(&context->model_impl.model_lock);
+  if (changed_count > 0) {
+    assert(context->push_changes_batch_proc != NULL);
+    context->push_changes_batch_proc(context, changed_ids, changed_count);
+  }
+  free(changed_ids);
+  return result;
+}
+
+tweak_app_error_code tweak_app_context_private_item_clone_current_value_by_handle(tweak_app_context context,
+  tweak_app_handle handle, tweak_variant* value)
+{
+  TWEAK_LOG_TRACE_ENTRY("context = %p, handle =  %" PRIx64 ", value = %p", context, handle, value);
+  tweak_item* item = NULL;
+  tweak_common_rwlock_read_lock(&context->model_impl.model_lock);
+  item = tweak_model_scalar_cache_get_item_by_handle(context->model_impl.scalar_cache, handle);
+  if (item) {
+    *value = tweak_variant_copy(&item->current_value);
+  }
+  tweak_common_rwlock_read_unlock(&context->model_impl.model_lock);
+  if (item) {
+    TWEAK_LOG_TRACE("Current value of item with handle = %" PRIx64 " has been cloned", handle);
+    return TWEAK_APP_SUCCESS;
+  } else {
+    TWEAK_LOG_TRACE("Item with handle = %" PRIx64 " hasn't been found, can't clone", handle);
+    return TWEAK_APP_ITEM_NOT_FOUND;
+  }
+}
+
+tweak_app_error_code tweak_app_context_private_item_replace_current_value_by_handle(tweak_app_context context,
+  tweak_app_handle handle, tweak_variant* value)
+{
+  tweak_app_error_code result;
+  tweak_item* item = NULL;
+  tweak_id tweak_id = TWEAK_INVALID_ID;
+  bool should_push_change = false;
+  tweak_common_rwlock_write_lock(&context->model_impl.model_lock);
+  item = tweak_model_scalar_cache_get_item_by_handle(context->model_impl.scalar_cache, handle);
+  if (item) {
+    tweak_id = item->id;
+    should_push_change = replace_item_value(context, item, value);
+    result = TWEAK_APP_SUCCESS;
+  } else {
+    result = TWEAK_APP_ITEM_NOT_FOUND;
+  }
+  tweak_common_rwlock_write_unlock(&context->model_impl.model_lock);
+  if (should_push_change) {
+    assert(context->push_changes_proc != NULL);
+    context->push_changes_proc(context, tweak_id);
+  }
+  if (result == TWEAK_APP_SUCCESS) {
+    TWEAK_LOG_TRACE("Current value of item with tweak_id = %" PRIu64 " has been updated", tweak_id);
+  } else {
+    TWEAK_LOG_TRACE("Item with handle = %" PRIx64 " hasn't been found, can't update", handle);
+  }
+  return result;
+}
+
+static size_t get_vector_element_size(tweak_variant_type type) {
+  switch (type) {
+  case TWEAK_VARIANT_TYPE_VECTOR_SINT8:
+    return sizeof(int8_t);
+  case TWEAK_VARIANT_TYPE_VECTOR_SINT16:
+    return sizeof(int16_t);
+  case TWEAK_VARIANT_TYPE_VECTOR_SINT32:
+    return sizeof(int32_t);
+  case TWEAK_VARIANT_TYPE_VECTOR_SINT64:
+    return sizeof(int64_t);
+  case TWEAK_VARIANT_TYPE_VECTOR_UINT8:
+    return sizeof(uint8_t);
+  case TWEAK_VARIANT_TYPE_VECTOR_UINT16:
+    return sizeof(uint16_t);
+  case TWEAK_VARIANT_TYPE_VECTOR_UINT32:
+    return sizeof(uint32_t);
+  case TWEAK_VARIANT_TYPE_VECTOR_UINT64:
+    return sizeof(uint64_t);
+  case TWEAK_VARIANT_TYPE_VECTOR_FLOAT:
+    return sizeof(float);
+  case TWEAK_VARIANT_TYPE_VECTOR_DOUBLE:
+    return sizeof(double);
+  default:
+    return 0;
+  }
+}
+
+static tweak_app_error_code check_value_range(const tweak_variant* value, tweak_variant_type type,
+  size_t offset, size_t count)
+{
+  if (value->type != type || get_vector_element_size(type) == 0) {
+    return TWEAK_APP_TYPE_MISMATCH;
+  }
+  size_t item_count = tweak_variant_get_item_count(value);
+  if (offset > item_count || count > item_count - offset) {
+    return TWEAK_APP_INVALID_ARGUMENT;
+  }
+  return TWEAK_APP_SUCCESS;
+}
+
+/**
+ * @brief Overwrite elements of vector @p value in place. Shared buffer is detached
+ * by tweak_buffer_get_data, so copies of previous value held by io threads stay intact.
+ */
+static bool store_value_range(tweak_variant* value, size_t offset, size_t count, const void* buffer) {
+  size_t element_size = get_vector_element_size(value->type);
+  const uint8_t* data = tweak_buffer_get_data_const(&value->value.buffer);
+  if (count == 0 || memcmp(data + offset * element_size, buffer, count * element_size) == 0) {
+    return false;
+  }
+  memcpy((uint8_t*)tweak_buffer_get_data(&value->value.buffer) + offset * element_size,
+    buffer, count * element_size);
+  return true;
+}
+
+tweak_app_error_code tweak_app_context_private_check_vector_range(tweak_app_context context,
+  tweak_id tweak_id, tweak_variant_type type, size_t offset, size_t count)
+{
+  tweak_app_error_code result = TWEAK_APP_ITEM_NOT_FOUND;
+  tweak_common_rwlock_read_lock(&context->model_impl.model_lock);
+  tweak_item* item = tweak_model_find_item_by_id(context->model_impl.model, tweak_id);
+  if (item) {
+    result = check_value_range(&item->current_value, type, offset, count);
+  }
+  tweak_common_rwlock_read_unlock(&context->model_impl.model_lock);
+  return result;
+}
+
+tweak_app_error_code tweak_app_context_private_item_load_vector_range(tweak_app_context context,
+  tweak_id tweak_id, tweak_variant_type type, size_t offset, size_t count, void* buffer)
+{
+  TWEAK_LOG_TRACE_ENTRY("context = %p, tweak_id =  %" PRIu64 ", offset = %zu, count = %zu",
+    context, tweak_id, offset, count);
+  tweak_app_error_code result = TWEAK_APP_ITEM_NOT_FOUND;
+  if (count != 0 && buffer == NULL) {
+    return TWEAK_APP_INVALID_ARGUMENT;
+  }
+  tweak_common_rwlock_read_lock(&context->model_impl.model_lock);
+  tweak_item* item = tweak_model_find_item_by_id(context->model_impl.model, tweak_id);
+  if (item) {
+    result = check_value_range(&item->current_value, type, offset, count);
+  }
+  if (result == TWEAK_APP_SUCCESS && count != 0) {
+    size_t element_size = get_vector_element_size(type);
+    const uint8_t* data = tweak_buffer_get_data_const(&item->current_value.value.buffer);
+    memcpy(buffer, data + offset * element_size, count * element_size);
+  }
+  tweak_common_rwlock_read_unlock(&context->model_impl.model_lock);
+  if (result != TWEAK_APP_SUCCESS) {
+    TWEAK_LOG_TRACE("Can't load range of item with tweak_id = %" PRIu64 ", error = %d", tweak_id, result);
+  }
+  return result;
+}
+
+tweak_app_error_code tweak_app_context_private_item_store_vector_range(tweak_app_context context,
+  tweak_id tweak_id, tweak_variant_type type, size_t offset, size_t count, const void* buffer)
+{
+  TWEAK_LOG_TRACE_ENTRY("context = %p, tweak_id =  %" PRIu64 ", offset = %zu, count = %zu",
+    context, tweak_id, offset, count);
+  tweak_app_error_code result = TWEAK_APP_ITEM_NOT_FOUND;
+  bool should_push_change = false;
+  if (count != 0 && buffer == NULL) {
+    return TWEAK_APP_INVALID_ARGUMENT;
+  }
+  tweak_common_rwlock_write_lock(&context->model_impl.model_lock);
+  tweak_item* item = tweak_model_find_item_by_id(context->model_impl.model, tweak_id);
+  if (item) {
+    result = check_value_range(&item->current_value, type, offset, count);
+  }
+  if (result == TWEAK_APP_SUCCESS) {
+    if (store_value_range(&item->current_value, offset, count, buffer)) {
+      tweak_app_context_private_touch_item(&context->model_impl, item);
+      should_push_change = tweak_app_features_check_type_compatibility(&context->remote_peer_features, type)
+        && tweak_app_context_private_is_connected(context);
+    } else {
+      TWEAK_LOG_TRACE("Omitting redundant range update");
+    }
+  }
+  tweak_common_rwlock_write_unlock(&context->model_impl.model_lock);
+  if (should_push_change) {
+    assert(context->push_partial_changes_proc != NULL);
+    context->push_partial_changes_proc(context, tweak_id, offset, count);
+  }
+  if (result == TWEAK_APP_SUCCESS) {
+    TWEAK_LOG_TRACE("Range of item with tweak_id = %" PRIu64 " has been updated", tweak_id);
+  } else {
+    TWEAK_LOG_TRACE("Can't update range of item with tweak_id = %" PRIu64 ", error = %d", tweak_id, result);
+  }
+  return result;
+}
+
+bool tweak_app_context_private_apply_partial_value(tweak_variant* value, size_t offset,
+  const tweak_variant* partial_value, bool* changed)
+{
+  *changed = false;
+  if (partial_value->type != value->type) {
+    return false;
+  }
+  size_t count = tweak_variant_get_item_count(partial_value);
+  if (check_value_range(value, partial_value->type, offset, count) != TWEAK_APP_SUCCESS) {
+    return false;
+  }
+  if (count != 0) {
+    *changed = store_value_range(value, offset, count,
+      tweak_buffer_get_data_const(&partial_value->value.buffer));
+  }
+  return true;
+}
+
+bool tweak_app_context_private_copy_vector_range(const tweak_variant* value, size_t offset,
+  size_t count, tweak_variant* partial_value)
+{
+  if (count == 0 || check_value_range(value, value->type, offset, count) != TWEAK_APP_SUCCESS) {
+    return false;
+  }
+  size_t element_size = get_vector_element_size(value->type);
+  const uint8_t* data = tweak_buffer_get_data_const(&value->value.buffer);
+  partial_value->type = value->type;
+  partial_value->value.buffer = tweak_buffer_create(data + offset * element_size, count * element_size);
+  return true;
+}
+
 void tweak_app_context_private_set_connected(struct tweak_app_context_base* app_context, bool arg) {
   TWEAK_LOG_TRACE_ENTRY("app_context = %p, connected = %s", app_context, arg ? "true" : "false");
   tweak_common_mutex_lock(&app_context->conn_state_lock);
@@ -383,16 +828,144 @@ bool tweak_app_context_private_is_connected(struct tweak_app_context_base* app_c
 
 void tweak_app_context_private_destroy_base(struct tweak_app_context_base* app_context) {
   TWEAK_LOG_TRACE_ENTRY("app_context = %p", app_context);
-  tweak_common_thread_join(app_context->worker_thread, NULL);
+  if (app_context->io_mode != TWEAK_APP_IO_MODE_POLL) {
+    tweak_common_thread_join(app_context->worker_thread, NULL);
+  }
   tweak_app_queue_destroy(app_context->job_queue);
   tweak_model_destroy(app_context->model_impl.model);
   tweak_model_uri_to_tweak_id_index_destroy(app_context->model_impl.index);
+  tweak_model_scalar_cache_destroy(app_context->model_impl.scalar_cache);
   tweak_common_rwlock_destroy(&app_context->model_impl.model_lock);
+  tweak_app_changes_destroy(&app_context->changes);
+  tweak_common_mutex_destroy(&app_context->poll_lock);
   tweak_common_mutex_destroy(&app_context->conn_state_lock);
 }
 
+tweak_app_error_code tweak_app_set_queue_policy(tweak_app_context context,
+  tweak_app_queue_policy policy)
+{
+  TWEAK_LOG_TRACE_ENTRY("context = %p, policy = %d", context, policy);
+  enum job_queue_policy job_queue_policy;
+  switch (policy) {
+  case TWEAK_APP_QUEUE_POLICY_BLOCK:
+    if (context->io_mode == TWEAK_APP_IO_MODE_POLL) {
+      TWEAK_LOG_ERROR("Blocking queue policy would block polling thread forever");
+      return TWEAK_APP_INVALID_ARGUMENT;
+    }
+    job_queue_policy = JOB_QUEUE_POLICY_BLOCK;
+    break;
+  case TWEAK_APP_QUEUE_POLICY_MERGE:
+    job_queue_policy = JOB_QUEUE_POLICY_MERGE;
+    break;
+  case TWEAK_APP_QUEUE_POLICY_DROP:
+    job_queue_policy = JOB_QUEUE_POLICY_DROP;
+    break;
+  default:
+    TWEAK_LOG_ERROR("Unknown queue policy %d", policy);
+    return TWEAK_APP_INVALID_ARGUMENT;
+  }
+  if (!tweak_app_queue_set_policy(context->job_queue, job_queue_policy)) {
+    TWEAK_LOG_ERROR("Can't reserve memory for io queue");
+    return TWEAK_APP_INVALID_ARGUMENT;
+  }
+  return TWEAK_APP_SUCCESS;
+}
+
+uint64_t tweak_app_get_queue_overflow_count(tweak_app_context context) {
+  return tweak_app_queue_get_overflow_count(context->job_queue);
+}
+
+uint64_t tweak_app_get_queue_drop_count(tweak_app_context context) {
+  return tweak_app_queue_get_drop_count(context->job_queue);
+}
+
+static bool is_budget_exhausted(struct tweak_app_poll_budget* budget) {
+  if (budget->job_count == 0 || budget->budget_ns == UINT64_MAX) {
+    return false;
+  }
+  tweak_common_timestamp now;
+  tweak_common_timestamp_now(&now);
+  return tweak_common_timestamp_subtract_timestamps(&now, &budget->start) >= budget->budget_ns;
+}
+
+bool tweak_app_context_private_poll_queue(struct job_queue* job_queue, struct tweak_app_poll_cursor* cursor,
+  struct tweak_app_poll_budget* budget, void (*end_of_batch)(void* cookie), void* cookie)
+{
+  for (;;) {
+    if (!cursor->job_array) {
+      struct pull_jobs_result jobs_batch = tweak_app_queue_try_pull(job_queue);
+      if (!jobs_batch.job_array) {
+        return false;
+      }
+      cursor->job_array = jobs_batch.job_array;
+      cursor->next_job = 0;
+    }
+    while (cursor->next_job < cursor->job_array->size) {
+      if (is_budget_exhausted(budget)) {
+        return true;
+      }
+      tweak_app_queue_run_job(&cursor->job_array->jobs[cursor->next_job++]);
+      ++budget->job_count;
+    }
+    cursor->job_array = NULL;
+    if (end_of_batch) {
+      end_of_batch(cookie);
+    }
+  }
+}
+
+static void end_of_polled_batch(void* cookie) {
+  struct tweak_app_context_base* context = cookie;
+  if (context->end_of_batch_proc) {
+    context->end_of_batch_proc(context);
+  }
+}
+
+static bool poll_context(tweak_app_context context, struct tweak_app_poll_budget* budget) {
+  tweak_common_mutex_lock(&context->poll_lock);
+  bool exhausted = tweak_app_context_private_poll_queue(context->job_queue, &context->poll_cursor,
+    budget, &end_of_polled_batch, context);
+  if (!exhausted && context->poll_proc) {
+    exhausted = context->poll_proc(context, budget);
+  }
+  tweak_common_mutex_unlock(&context->poll_lock);
+  return exhausted;
+}
+
 void tweak_app_flush_queue(tweak_app_context context) {
+  if (context->io_mode == TWEAK_APP_IO_MODE_POLL) {
+    /* There's no thread to wait for, jobs are run by the caller */
+    struct tweak_app_poll_budget budget = { .budget_ns = UINT64_MAX };
+    tweak_common_timestamp_now(&budget.start);
+    (void)poll_context(context, &budget);
+    return;
+  }
   tweak_app_queue_wait_empty(context->job_queue);
+  if (context->flush_queue_proc) {
+    context->flush_queue_proc(context);
+  }
+}
+
+bool tweak_app_poll(tweak_app_context context, uint64_t budget_us) {
+  if (context->io_mode != TWEAK_APP_IO_MODE_POLL) {
+    TWEAK_LOG_ERROR("Context runs its own IO threads");
+    return false;
+  }
+  struct tweak_app_poll_budget budget = {
+    .budget_ns = budget_us < UINT64_MAX / TWEAK_COMMON_NANOS_IN_USEC
+      ? budget_us * TWEAK_COMMON_NANOS_IN_USEC : UINT64_MAX
+  };
+  tweak_common_timestamp_now(&budget.start);
+  return poll_context(context, &budget);
+}
+
+int tweak_app_get_event_fd(tweak_app_context context) {
+  TWEAK_LOG_TRACE_ENTRY("context = %p", context);
+  return tweak_app_changes_get_event_fd(&context->changes);
+}
+
+size_t tweak_app_drain_changes(tweak_app_context context, tweak_id* ids, size_t max_count) {
+  return tweak_app_changes_drain(&context->changes, ids, max_count);
 }
 
 void tweak_app_destroy_context(tweak_app_context context) {
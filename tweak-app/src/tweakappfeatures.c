@@ -34,10 +34,18 @@
 
 void tweak_app_features_init_minimal(struct tweak_app_features* features) {
   features->vectors = false;
+  features->change_items = false;
+  features->add_items = false;
+  features->packed_vectors = false;
+  features->partial_changes = false;
 }
 
 void tweak_app_features_init_default(struct tweak_app_features* features) {
   features->vectors = true;
+  features->change_items = true;
+  features->add_items = true;
+  features->packed_vectors = true;
+  features->partial_changes = true;
 }
 
 bool tweak_app_features_from_json(const tweak_variant_string* json, struct tweak_app_features* out_result) {
@@ -47,6 +55,10 @@ bool tweak_app_features_from_json(const tweak_variant_string* json, struct tweak
   bool result = false;
   struct tweak_json_node* doc = tweak_json_parse(tweak_variant_string_c_str(json));
   const struct tweak_json_node* vector_node;
+  const struct tweak_json_node* change_items_node;
+  const struct tweak_json_node* add_items_node;
+  const struct tweak_json_node* packed_vectors_node;
+  const struct tweak_json_node* partial_changes_node;
 
   if (tweak_json_get_type(doc) != TWEAK_JSON_NODE_TYPE_OBJECT) {
     TWEAK_LOG_WARN("Can't parse json snippet: %s", tweak_variant_string_c_str(json));
@@ -58,6 +70,18 @@ bool tweak_app_features_from_json(const tweak_variant_string* json, struct tweak
   if (vector_node) {
     out_result->vectors = (strcmp("true", tweak_json_node_as_c_str(vector_node)) == 0);
   }
+  change_items_node = tweak_json_get_object_field(doc, "change_items", TWEAK_JSON_NODE_TYPE_BOOL);
+  out_result->change_items = change_items_node
+    && (strcmp("true", tweak_json_node_as_c_str(change_items_node)) == 0);
+  add_items_node = tweak_json_get_object_field(doc, "add_items", TWEAK_JSON_NODE_TYPE_BOOL);
+  out_result->add_items = add_items_node
+    && (strcmp("true", tweak_json_node_as_c_str(add_items_node)) == 0);
+  packed_vectors_node = tweak_json_get_object_field(doc, "packed_vectors", TWEAK_JSON_NODE_TYPE_BOOL);
+  out_result->packed_vectors = packed_vectors_node
+    && (strcmp("true", tweak_json_node_as_c_str(packed_vectors_node)) == 0);
+  partial_changes_node = tweak_json_get_object_field(doc, "partial_changes", TWEAK_JSON_NODE_TYPE_BOOL);
+  out_result->partial_changes = partial_changes_node
+    && (strcmp("true", tweak_json_node_as_c_str(partial_changes_node)) == 0);
 
   result = true;
 error:
@@ -67,8 +91,13 @@ error:
 
 tweak_variant_string tweak_app_features_to_json(const struct tweak_app_features* arg) {
   tweak_variant_string result = TWEAK_VARIANT_STRING_EMPTY;
-  char buff[128];
-  snprintf(buff, sizeof(buff), "{\"vectors\": %s}", arg->vectors ? "true" : "false");
+  char buff[160];
+  snprintf(buff, sizeof(buff),
+    "{\"vectors\": %s, \"change_items\": %s, \"add_items\": %s, \"packed_vectors\": %s,"
+    " \"partial_changes\": %s}",
+    arg->vectors ? "true" : "false", arg->change_items ? "true" : "false",
+    arg->add_items ? "true" : "false", arg->packed_vectors ? "true" : "false",
+    arg->partial_changes ? "true" : "false");
   tweak_assign_string(&result, buff);
   return result;
 }
@@ -111,5 +140,9 @@ struct tweak_app_features tweak_app_features_combine(
 {
   struct tweak_app_features res = *arg1;
   res.vectors &= arg2->vectors;
+  res.change_items &= arg2->change_items;
+  res.add_items &= arg2->add_items;
+  res.packed_vectors &= arg2->packed_vectors;
+  res.partial_changes &= arg2->partial_changes;
   return res;
 }
@@ -42,6 +42,30 @@ struct tweak_app_features {
    * Updates to these tweaks shall not be marshalled to connected peer as well.
    */
   bool vectors;
+  /**
+   * @brief whether a peer can decode batched change_items requests.
+   * When false, every update of current value shall be sent as a separate change_item request.
+   * Peers that don't mention this feature are assumed not to support it.
+   */
+  bool change_items;
+  /**
+   * @brief whether a peer can decode batched add_items requests.
+   * When false, every item shall be announced by a separate add_item request.
+   * Peers that don't mention this feature are assumed not to support it.
+   */
+  bool add_items;
+  /**
+   * @brief whether a peer can decode numeric vectors packed as single little-endian blocks.
+   * When false, vectors shall be sent element by element.
+   * Peers that don't mention this feature are assumed not to support it.
+   */
+  bool packed_vectors;
+  /**
+   * @brief whether a peer can apply change_item requests updating a slice of a vector.
+   * When false, range updates shall be sent as complete values.
+   * Peers that don't mention this feature are assumed not to support it.
+   */
+  bool partial_changes;
 };
 
 /**
@@ -33,10 +33,12 @@
 #include <tweak2/pickle.h>
 #include <tweak2/variant.h>
 
+#include "tweakappchanges.h"
 #include "tweakappqueue.h"
 #include "tweakmodel.h"
 #include "tweakappfeatures.h"
 #include "tweakmodel_uri_to_tweak_id_index.h"
+#include "tweakmodel_scalar_cache.h"
 
 /**
  * @brief Prototype for virtual method pushing change request to io queue.
@@ -46,6 +48,87 @@
  */
 typedef void (*push_changes_proc)(struct tweak_app_context_base* context, tweak_id tweak_id);
 
+/**
+ * @brief Prototype for virtual method pushing change of vector range to io queue.
+ *
+ * @param context a context instance.
+ * @param tweak_id item on which change event had occurred.
+ * @param offset index of the first altered vector element.
+ * @param count number of altered vector elements.
+ */
+typedef void (*push_partial_changes_proc)(struct tweak_app_context_base* context, tweak_id tweak_id,
+  size_t offset, size_t count);
+
+/**
+ * @brief Prototype for virtual method pushing changes of several items to io queue
+ * so they reach connected peer together.
+ *
+ * @param context a context instance.
+ * @param tweak_ids items on which change event had occurred.
+ * @param count number of items in @p tweak_ids.
+ */
+typedef void (*push_changes_batch_proc)(struct tweak_app_context_base* context,
+  const tweak_id* tweak_ids, size_t count);
+
+/**
+ * @brief Prototype for virtual method invoked by worker thread
+ * after all jobs of a single batch pulled from io queue have been run.
+ *
+ * @param context a context instance.
+ */
+typedef void (*end_of_batch_proc)(struct tweak_app_context_base* context);
+
+/**
+ * @brief Prototype for virtual method waiting for jobs of queues
+ * owned by subclass after io queue has been drained.
+ *
+ * @param context a context instance.
+ */
+typedef void (*flush_queue_proc)(struct tweak_app_context_base* context);
+
+/**
+ * @brief Time limit of a single tweak_app_poll call.
+ */
+struct tweak_app_poll_budget {
+  /**
+   * @brief When polling has started.
+   */
+  tweak_common_timestamp start;
+  /**
+   * @brief Time limit, UINT64_MAX for none.
+   */
+  tweak_common_nanoseconds budget_ns;
+  /**
+   * @brief Number of jobs run so far, budget is checked after the first one.
+   */
+  size_t job_count;
+};
+
+/**
+ * @brief Batch pulled from a queue, which jobs are still to run.
+ */
+struct tweak_app_poll_cursor {
+  /**
+   * @brief Pulled batch, NULL if all jobs of previous batch have been run.
+   */
+  const struct job_array* job_array;
+  /**
+   * @brief Index of the next job to run.
+   */
+  size_t next_job;
+};
+
+/**
+ * @brief Prototype for virtual method running jobs of queues owned by subclass
+ * when context is created with TWEAK_APP_IO_MODE_POLL.
+ *
+ * @param context a context instance.
+ * @param budget time limit shared by all queues of the context.
+ *
+ * @return true if budget has been exhausted.
+ */
+typedef bool (*poll_proc)(struct tweak_app_context_base* context, struct tweak_app_poll_budget* budget);
+
 /**
  * @brief Prototype for virtual method to clone an item's value.
  *
@@ -58,6 +141,19 @@ typedef void (*push_changes_proc)(struct tweak_app_context_base* context, tweak_
 typedef tweak_app_error_code (*clone_current_value_proc)(tweak_app_context context,
   tweak_id id, tweak_variant* value);
 
+/**
+ * @brief Prototype for virtual method to inspect an item in place.
+ *
+ * @param context a context instance.
+ * @param tweak_id id item id to access.
+ * @param visitor callback receiving view of the item.
+ * @param cookie opaque pointer passed to @p visitor.
+ *
+ * @return value indicating success of an operation.
+ */
+typedef tweak_app_error_code (*read_item_proc)(tweak_app_context context,
+  tweak_id id, tweak_app_item_visitor visitor, void* cookie);
+
 /**
  * @brief Prototype for virtual method to alter an item's value.
  *
@@ -70,6 +166,73 @@ typedef tweak_app_error_code (*clone_current_value_proc)(tweak_app_context conte
 typedef tweak_app_error_code (*replace_current_value_proc)(tweak_app_context context,
   tweak_id tweak_id, tweak_variant* value);
 
+/**
+ * @brief Prototype for virtual method to alter values of several items at once.
+ *
+ * @param context a context instance.
+ * @param tweak_ids ids of items to alter.
+ * @param values new values, one per item.
+ * @param count number of items.
+ *
+ * @return value indicating success of an operation.
+ */
+typedef tweak_app_error_code (*replace_values_proc)(tweak_app_context context,
+  const tweak_id* tweak_ids, tweak_variant* values, size_t count);
+
+/**
+ * @brief Prototype for virtual method to clone value of an item addressed by handle.
+ *
+ * @param context a context instance.
+ * @param handle item handle.
+ * @param value as output parameter to store cloned value.
+ *
+ * @return value indicating success of an operation.
+ */
+typedef tweak_app_error_code (*clone_current_value_by_handle_proc)(tweak_app_context context,
+  tweak_app_handle handle, tweak_variant* value);
+
+/**
+ * @brief Prototype for virtual method to alter value of an item addressed by handle.
+ *
+ * @param context a context instance.
+ * @param handle item handle.
+ * @param value as input parameter to store value.
+ *
+ * @return value indicating success of an operation.
+ */
+typedef tweak_app_error_code (*replace_current_value_by_handle_proc)(tweak_app_context context,
+  tweak_app_handle handle, tweak_variant* value);
+
+/**
+ * @brief Prototype for virtual method to copy a range of vector item's elements.
+ *
+ * @param context a context instance.
+ * @param tweak_id item id to access.
+ * @param type expected vector type of the item.
+ * @param offset index of the first element to copy.
+ * @param count number of elements to copy.
+ * @param buffer output buffer large enough for @p count elements.
+ *
+ * @return value indicating success of an operation.
+ */
+typedef tweak_app_error_code (*load_vector_range_proc)(tweak_app_context context,
+  tweak_id tweak_id, tweak_variant_type type, size_t offset, size_t count, void* buffer);
+
+/**
+ * @brief Prototype for virtual method to alter a range of vector item's elements.
+ *
+ * @param context a context instance.
+ * @param tweak_id item id to access.
+ * @param type expected vector type of the item.
+ * @param offset index of the first element to alter.
+ * @param count number of elements to alter.
+ * @param buffer new values of @p count elements.
+ *
+ * @return value indicating success of an operation.
+ */
+typedef tweak_app_error_code (*store_vector_range_proc)(tweak_app_context context,
+  tweak_id tweak_id, tweak_variant_type type, size_t offset, size_t count, const void* buffer);
+
 /**
  * @brief Prototype for virtual destructor for all context types.
  *
@@ -90,6 +253,20 @@ struct tweak_model_impl {
    * @brief Item index.
    */
   tweak_model_uri_to_tweak_id_index index;
+  /**
+   * @brief Lock free mirror of item types and scalar values.
+   * Altered along with model under model_lock, read without it.
+   */
+  tweak_model_scalar_cache scalar_cache;
+  /**
+   * @brief Identifies model instance to clients resynchronizing after reconnect.
+   * Nonzero if model assigns versions to item values, i.e. on server side only.
+   */
+  uint64_t epoch;
+  /**
+   * @brief Version assigned to the latest item value. Guarded by model_lock.
+   */
+  uint64_t version;
 };
 
 /**
@@ -108,9 +285,21 @@ struct tweak_app_context_base {
    */
   bool connected;
   /**
-   * @brief Asynchronous I/O routine.
+   * @brief Asynchronous I/O routine. Not created in TWEAK_APP_IO_MODE_POLL mode.
    */
   tweak_common_thread worker_thread;
+  /**
+   * @brief Who runs jobs of job_queue and queues owned by subclass.
+   */
+  tweak_app_io_mode io_mode;
+  /**
+   * @brief Serializes tweak_app_poll calls.
+   */
+  tweak_common_mutex poll_lock;
+  /**
+   * @brief Batch of job_queue being run by tweak_app_poll. Guarded by poll_lock.
+   */
+  struct tweak_app_poll_cursor poll_cursor;
   /**
    * @brief Queue of jobs to run by worker_thread.
    */
@@ -123,14 +312,61 @@ struct tweak_app_context_base {
    * @brief Virtual function to clone item value.
    */
   clone_current_value_proc clone_current_value_proc;
+  /**
+   * @brief Virtual function to inspect item in place.
+   */
+  read_item_proc read_item_proc;
   /**
    * @brief Virtual function to replace item value.
    */
   replace_current_value_proc replace_current_value_proc;
+  /**
+   * @brief Virtual function to replace values of several items at once.
+   */
+  replace_values_proc replace_values_proc;
+  /**
+   * @brief Virtual function to clone value of an item addressed by handle.
+   */
+  clone_current_value_by_handle_proc clone_current_value_by_handle_proc;
+  /**
+   * @brief Virtual function to replace value of an item addressed by handle.
+   */
+  replace_current_value_by_handle_proc replace_current_value_by_handle_proc;
+  /**
+   * @brief Virtual function to copy a range of vector item.
+   */
+  load_vector_range_proc load_vector_range_proc;
+  /**
+   * @brief Virtual function to alter a range of vector item.
+   */
+  store_vector_range_proc store_vector_range_proc;
   /**
    * @brief Virtual function to push change request to connected peer.
    */
   push_changes_proc push_changes_proc;
+  /**
+   * @brief Virtual function to push change of a vector range to connected peer.
+   */
+  push_partial_changes_proc push_partial_changes_proc;
+  /**
+   * @brief Virtual function to push changes of several items to connected peer at once.
+   */
+  push_changes_batch_proc push_changes_batch_proc;
+  /**
+   * @brief Virtual function to finish processing of a job batch, e.g.
+   * to flush requests accumulated by jobs. Can be NULL.
+   */
+  end_of_batch_proc end_of_batch_proc;
+  /**
+   * @brief Virtual function to wait for queues job_queue is dispatched to.
+   * Can be NULL.
+   */
+  flush_queue_proc flush_queue_proc;
+  /**
+   * @brief Virtual function to run jobs of queues owned by subclass in
+   * TWEAK_APP_IO_MODE_POLL mode. Can be NULL.
+   */
+  poll_proc poll_proc;
   /**
    * @brief Virtual destructor.
    */
@@ -139,6 +375,10 @@ struct tweak_app_context_base {
    * @brief Features supported by current connected peer.
    */
   struct tweak_app_features remote_peer_features;
+  /**
+   * @brief Items changed by remote peer, drained by host event loop.
+   */
+  struct tweak_app_change_tracker changes;
 };
 
 /**
@@ -147,10 +387,29 @@ struct tweak_app_context_base {
  * @param app_context pointer to preallocated memory buffer large enough
  * to contain sizeof(struct tweak_app_context_base) bytes.
  * @param queue_size size of queue containing delayed io requests
+ * @param io_mode whether worker thread is created.
  *
  * @return true if base class has been initialized successfully.
  */
-bool tweak_app_context_private_initialize_base(struct tweak_app_context_base* app_context, uint32_t queue_size);
+bool tweak_app_context_private_initialize_base(struct tweak_app_context_base* app_context, uint32_t queue_size,
+  tweak_app_io_mode io_mode);
+
+/**
+ * @brief Run jobs of a queue without waiting for new ones.
+ *
+ * @details Resumes the batch @p cursor points to, then pulls next batches
+ * until there are no pending jobs or @p budget is exhausted.
+ *
+ * @param job_queue queue to run jobs of.
+ * @param cursor batch partially run by previous call, it's updated before return.
+ * @param budget time limit.
+ * @param end_of_batch invoked after all jobs of a batch have been run. Can be NULL.
+ * @param cookie opaque pointer to pass into @p end_of_batch.
+ *
+ * @return true if budget has been exhausted.
+ */
+bool tweak_app_context_private_poll_queue(struct job_queue* job_queue, struct tweak_app_poll_cursor* cursor,
+  struct tweak_app_poll_budget* budget, void (*end_of_batch)(void* cookie), void* cookie);
 
 /**
  * @brief Deinitialize instance of the base class common for server and client.
@@ -175,6 +434,36 @@ void tweak_app_context_private_destroy_base(struct tweak_app_context_base* app_c
 tweak_app_error_code tweak_app_context_private_item_clone_current_value(tweak_app_context context,
   tweak_id id, tweak_variant* value);
 
+/**
+ * @brief Swap values of several items under a single write lock and propagate
+ * them to the connected peer as one batch.
+ *
+ * @note this is a template method, see tweak_app_context_private_item_replace_current_value.
+ *
+ * @param context an application context.
+ * @param ids ids of items to update.
+ * @param values new values, one per item.
+ * @param count number of items.
+ *
+ * @return TWEAK_APP_SUCCESS if there wasn't any errors, TWEAK_APP_ITEM_NOT_FOUND
+ * if any of @p ids isn't found. Nothing is changed then.
+ */
+tweak_app_error_code tweak_app_context_private_item_replace_values(tweak_app_context context,
+  const tweak_id* ids, tweak_variant* values, size_t count);
+
+/**
+ * @brief Invoke @p visitor on view of an item while model is locked for reading.
+ *
+ * @param context an application context.
+ * @param id tweak id.
+ * @param visitor callback receiving view of the item.
+ * @param cookie opaque pointer passed to @p visitor.
+ *
+ * @return TWEAK_APP_SUCCESS if item has been found.
+ */
+tweak_app_error_code tweak_app_context_private_item_read(tweak_app_context context,
+  tweak_id id, tweak_app_item_visitor visitor, void* cookie);
+
 /**
  * @brief Swap item's value with provided @p value and propagate new item's value
  * to the connected peer, it there's one.
@@ -195,6 +484,34 @@ tweak_app_error_code tweak_app_context_private_item_clone_current_value(tweak_ap
 tweak_app_error_code tweak_app_context_private_item_replace_current_value(tweak_app_context context,
   tweak_id tweak_id, tweak_variant* value);
 
+/**
+ * @brief Same as tweak_app_context_private_item_clone_current_value,
+ * but the item is addressed by handle.
+ *
+ * @param context an application context.
+ * @param handle item handle.
+ * @param value a pointer to instance. Preexisting data will be released with
+ * tweak_variant_destroy() call.
+ *
+ * @return TWEAK_APP_SUCCESS if there wasn't any errors.
+ */
+tweak_app_error_code tweak_app_context_private_item_clone_current_value_by_handle(tweak_app_context context,
+  tweak_app_handle handle, tweak_variant* value);
+
+/**
+ * @brief Same as tweak_app_context_private_item_replace_current_value,
+ * but the item is addressed by handle.
+ *
+ * @param context an application context.
+ * @param handle item handle.
+ * @param value a pointer to new value. After the call its contents will be replaced
+ * by previous value of item.
+ *
+ * @return TWEAK_APP_SUCCESS if there wasn't any errors.
+ */
+tweak_app_error_code tweak_app_context_private_item_replace_current_value_by_handle(tweak_app_context context,
+  tweak_app_handle handle, tweak_variant* value);
+
 /**
  * @brief Set "connected" status for the instance. When connected, subclasses shall sync
  * their state with connected peers.
@@ -227,4 +544,97 @@ bool tweak_app_context_private_is_connected(struct tweak_app_context_base* app_c
  */
 bool tweak_app_context_private_check_value_compatibility(const tweak_variant* sample, const tweak_variant* value);
 
+/**
+ * @brief Assign next version to value of @p item which has just been altered.
+ * Models without epoch reset version to 0, since values altered locally
+ * are unknown to server. Caller shall hold model_lock for writing.
+ *
+ * @param model model of context owning @p item.
+ * @param item item which current value has been altered.
+ */
+void tweak_app_context_private_touch_item(struct tweak_model_impl* model, tweak_item* item);
+
+/**
+ * @brief Check whether vector item can be accessed by range.
+ *
+ * @param context an application context.
+ * @param tweak_id tweak id.
+ * @param type expected vector type of the item.
+ * @param offset index of the first element in range.
+ * @param count number of elements in range.
+ *
+ * @return TWEAK_APP_SUCCESS if range is valid, TWEAK_APP_ITEM_NOT_FOUND,
+ * TWEAK_APP_TYPE_MISMATCH or TWEAK_APP_INVALID_ARGUMENT otherwise.
+ */
+tweak_app_error_code tweak_app_context_private_check_vector_range(tweak_app_context context,
+  tweak_id tweak_id, tweak_variant_type type, size_t offset, size_t count);
+
+/**
+ * @brief Copy a range of vector item's elements to @p buffer.
+ *
+ * @note this is a template method operating on internal model and providing
+ * common functionality for both client and server implementations of this context.
+ * Shouldn't be used directly.
+ *
+ * @param context an application context.
+ * @param tweak_id tweak id.
+ * @param type expected vector type of the item.
+ * @param offset index of the first element to copy.
+ * @param count number of elements to copy.
+ * @param buffer output buffer large enough for @p count elements.
+ *
+ * @return TWEAK_APP_SUCCESS if there wasn't any errors.
+ */
+tweak_app_error_code tweak_app_context_private_item_load_vector_range(tweak_app_context context,
+  tweak_id tweak_id, tweak_variant_type type, size_t offset, size_t count, void* buffer);
+
+/**
+ * @brief Alter a range of vector item's elements in place and propagate
+ * the range to the connected peer, it there's one.
+ *
+ * @note this is a template method operating on internal model and providing
+ * common functionality for both client and server implementations of this context.
+ * Shouldn't be used directly.
+ *
+ * @param context an application context.
+ * @param tweak_id tweak id.
+ * @param type expected vector type of the item.
+ * @param offset index of the first element to alter.
+ * @param count number of elements to alter.
+ * @param buffer new values of @p count elements.
+ *
+ * @return TWEAK_APP_SUCCESS if there wasn't any errors.
+ */
+tweak_app_error_code tweak_app_context_private_item_store_vector_range(tweak_app_context context,
+  tweak_id tweak_id, tweak_variant_type type, size_t offset, size_t count, const void* buffer);
+
+/**
+ * @brief Replace elements of vector @p value starting from @p offset
+ * with elements of @p partial_value received from a peer.
+ * Caller shall hold model_lock for writing.
+ *
+ * @param value current value of an item.
+ * @param offset index of the first element to replace.
+ * @param partial_value vector of the same type as @p value.
+ * @param changed output parameter set to true if @p value has been altered.
+ *
+ * @return false if @p partial_value doesn't fit into @p value.
+ */
+bool tweak_app_context_private_apply_partial_value(tweak_variant* value, size_t offset,
+  const tweak_variant* partial_value, bool* changed);
+
+/**
+ * @brief Create a vector holding a range of elements of vector @p value,
+ * to be sent as partial value. Caller shall hold model_lock.
+ *
+ * @param value current value of an item.
+ * @param offset index of the first element in range.
+ * @param count number of elements in range.
+ * @param partial_value output parameter, assumed to be empty.
+ *
+ * @return false if range is empty or doesn't fit into @p value.
+ */
+bool tweak_app_context_private_copy_vector_range(const tweak_variant* value, size_t offset,
+  size_t count, tweak_variant* partial_value);
+
 #endif
@@ -30,18 +30,114 @@
 
 #include "tweakappqueue.h"
 
+#include <stdint.h>
 #include <stdlib.h>
 #include <string.h>
 
+/*
+ * Open addressing set of jobs pending in respective job_array.
+ * Slots hold job index plus one, zero marks an empty slot.
+ * Set is kept at most half full, so probe sequences stay short.
+ */
+struct pending_set {
+  size_t* slots;
+  size_t capacity;
+};
+
 struct job_queue {
   tweak_common_mutex lock;
   tweak_common_cond cond;
   int current_array;
   struct job_array arrays[2];
+  struct pending_set pending_sets[2];
+  /*
+   * Jobs which haven't fit the queue under JOB_QUEUE_POLICY_DROP policy.
+   * They're moved to the queue by the next pull. Up to max_size jobs.
+   */
+  struct job_array deferred_array;
+  struct pending_set deferred_set;
   size_t max_size;
+  enum job_queue_policy policy;
+  uint64_t overflow_count;
+  uint64_t drop_count;
   bool is_stopped;
 };
 
+static size_t get_home_slot(const struct job* job, size_t capacity) {
+  uint64_t hash = job->tweak_id;
+  hash = (hash ^ (uint64_t)(uintptr_t)job->job_proc) * UINT64_C(0x9E3779B97F4A7C15);
+  hash = (hash ^ (uint64_t)(uintptr_t)job->range_job_proc) * UINT64_C(0x9E3779B97F4A7C15);
+  hash = (hash ^ (uint64_t)job->offset) * UINT64_C(0x9E3779B97F4A7C15);
+  hash = (hash ^ (uint64_t)(uintptr_t)job->cookie) * UINT64_C(0x9E3779B97F4A7C15);
+  return (size_t)(hash >> 32) & (capacity - 1);
+}
+
+static bool is_same_job(const struct job* job1, const struct job* job2) {
+  return job1->tweak_id == job2->tweak_id
+    && job1->job_proc == job2->job_proc
+    && job1->range_job_proc == job2->range_job_proc
+    && job1->offset == job2->offset
+    && job1->count == job2->count
+    && job1->cookie == job2->cookie;
+}
+
+static size_t* find_pending_slot(const struct pending_set* pending_set,
+  const struct job_array* job_array, const struct job* job)
+{
+  size_t mask = pending_set->capacity - 1;
+  for (size_t ix = get_home_slot(job, pending_set->capacity);; ix = (ix + 1) & mask) {
+    size_t* slot = &pending_set->slots[ix];
+    if (*slot == 0 || is_same_job(&job_array->jobs[*slot - 1], job)) {
+      return slot;
+    }
+  }
+}
+
+static bool reserve_pending_set(struct pending_set* pending_set,
+  const struct job_array* job_array)
+{
+  size_t new_capacity = pending_set->capacity != 0 ? pending_set->capacity : 16;
+  size_t* new_slots;
+  while (new_capacity < job_array->capacity * 2) {
+    new_capacity *= 2;
+  }
+  if (new_capacity == pending_set->capacity) {
+    return true;
+  }
+  new_slots = calloc(new_capacity, sizeof(pending_set->slots[0]));
+  if (!new_slots) {
+    return false;
+  }
+  free(pending_set->slots);
+  pending_set->slots = new_slots;
+  pending_set->capacity = new_capacity;
+  for (size_t ix = 0; ix < job_array->size; ix++) {
+    *find_pending_slot(pending_set, job_array, &job_array->jobs[ix]) = ix + 1;
+  }
+  return true;
+}
+
+static void ensure_pending_set_capacity(struct pending_set* pending_set,
+  const struct job_array* job_array)
+{
+  if (!reserve_pending_set(pending_set, job_array)) {
+    TWEAK_FATAL("Can't allocate memory for io queue");
+  }
+}
+
+static void clear_pending_set(struct pending_set* pending_set, const struct job_array* job_array) {
+  size_t mask = pending_set->capacity - 1;
+  /* Every occupied slot belongs to a job from job_array. Clearing them one by one
+   * breaks probe sequences, so slots are looked up by value instead of by job. */
+  for (size_t ix = 0; ix < job_array->size; ix++) {
+    size_t slot_ix = get_home_slot(&job_array->jobs[ix], pending_set->capacity);
+    while (pending_set->slots[slot_ix] != ix + 1) {
+      slot_ix = (slot_ix + 1) & mask;
+    }
+    pending_set->slots[slot_ix] = 0;
+  }
+}
+
 struct job_queue* tweak_app_queue_create(size_t max_size) {
   struct job_queue* job_queue = calloc(1, sizeof(*job_queue));
   if (!job_queue) {
@@ -54,12 +150,23 @@ struct job_queue* tweak_app_queue_create(size_t max_size) {
   return job_queue;
 }
 
-struct pull_jobs_result tweak_app_queue_pull(struct job_queue* job_queue) {
-  struct pull_jobs_result result;
-  tweak_common_mutex_lock(&job_queue->lock);
-  while (!job_queue->is_stopped && job_queue->arrays[job_queue->current_array].size == 0) {
-    tweak_common_cond_wait(&job_queue->cond, &job_queue->lock);
+static void append_job(struct job_array* job_array, struct pending_set* pending_set,
+  const struct job* job);
+
+static void flush_deferred_jobs(struct job_queue* job_queue) {
+  struct job_array* deferred_array = &job_queue->deferred_array;
+  for (size_t ix = 0; ix < deferred_array->size; ix++) {
+    append_job(&job_queue->arrays[job_queue->current_array],
+      &job_queue->pending_sets[job_queue->current_array], &deferred_array->jobs[ix]);
+  }
+  if (deferred_array->size != 0) {
+    clear_pending_set(&job_queue->deferred_set, deferred_array);
+    deferred_array->size = 0;
   }
+}
+
+static struct pull_jobs_result pull_locked(struct job_queue* job_queue) {
+  struct pull_jobs_result result;
   if (job_queue->is_stopped) {
     result.is_stopped = true;
     result.job_array = NULL;
@@ -68,12 +175,52 @@ struct pull_jobs_result tweak_app_queue_pull(struct job_queue* job_queue) {
     result.job_array = &job_queue->arrays[job_queue->current_array];
   }
   job_queue->current_array = (job_queue->current_array + 1) % 2;
+  clear_pending_set(&job_queue->pending_sets[job_queue->current_array],
+    &job_queue->arrays[job_queue->current_array]);
   job_queue->arrays[job_queue->current_array].size = 0;
+  /* Deferred jobs make up the next batch, that's still within max_size */
+  flush_deferred_jobs(job_queue);
   tweak_common_cond_broadcast(&job_queue->cond);
+  return result;
+}
+
+struct pull_jobs_result tweak_app_queue_pull(struct job_queue* job_queue) {
+  struct pull_jobs_result result;
+  tweak_common_mutex_lock(&job_queue->lock);
+  while (!job_queue->is_stopped && job_queue->arrays[job_queue->current_array].size == 0) {
+    tweak_common_cond_wait(&job_queue->cond, &job_queue->lock);
+  }
+  result = pull_locked(job_queue);
   tweak_common_mutex_unlock(&job_queue->lock);
   return result;
 }
 
+struct pull_jobs_result tweak_app_queue_try_pull(struct job_queue* job_queue) {
+  struct pull_jobs_result result = { .job_array = NULL, .is_stopped = false };
+  tweak_common_mutex_lock(&job_queue->lock);
+  if (job_queue->is_stopped) {
+    result.is_stopped = true;
+  } else if (job_queue->arrays[job_queue->current_array].size != 0) {
+    result = pull_locked(job_queue);
+  }
+  tweak_common_mutex_unlock(&job_queue->lock);
+  return result;
+}
+
+static bool reserve_job_array(struct job_array* job_array, size_t capacity) {
+  struct job* new_jobs;
+  if (capacity <= job_array->capacity) {
+    return true;
+  }
+  new_jobs = realloc(job_array->jobs, capacity * sizeof(job_array->jobs[0]));
+  if (!new_jobs) {
+    return false;
+  }
+  job_array->jobs = new_jobs;
+  job_array->capacity = capacity;
+  return true;
+}
+
 static void ensure_job_array_capacity(struct job_array* job_array, size_t size) {
   if (size > job_array->capacity) {
     size_t new_capacity;
@@ -82,36 +229,161 @@ static void ensure_job_array_capacity(struct job_array* job_array, size_t size)
     } else {
       new_capacity = size * 3 / 2;
     }
-    job_array->jobs = realloc(job_array->jobs, new_capacity * sizeof(job_array->jobs[0]));
-    if (!job_array->jobs) {
+    if (!reserve_job_array(job_array, new_capacity)) {
       TWEAK_FATAL("Can't allocate memory for io queue");
     }
-    job_array->capacity = new_capacity;
   }
 }
 
-void tweak_app_queue_push(struct job_queue* job_queue, const struct job* job) {
+static bool is_pending_in(const struct pending_set* pending_set,
+  const struct job_array* job_array, const struct job* job)
+{
+  return pending_set->capacity != 0 && *find_pending_slot(pending_set, job_array, job) != 0;
+}
+
+static bool is_pending(struct job_queue* job_queue, const struct job* job) {
+  return is_pending_in(&job_queue->pending_sets[job_queue->current_array],
+      &job_queue->arrays[job_queue->current_array], job)
+    || is_pending_in(&job_queue->deferred_set, &job_queue->deferred_array, job);
+}
+
+static void append_job(struct job_array* job_array, struct pending_set* pending_set,
+  const struct job* job)
+{
+  ensure_job_array_capacity(job_array, job_array->size + 1);
+  ensure_pending_set_capacity(pending_set, job_array);
+  job_array->jobs[job_array->size] = *job;
+  ++job_array->size;
+  *find_pending_slot(pending_set, job_array, job) = job_array->size;
+}
+
+/*
+ * Keeps a job that doesn't fit the queue under JOB_QUEUE_POLICY_DROP policy
+ * till the next pull. Memory is reserved by tweak_app_queue_set_policy.
+ * Returns false if the job has been dropped since deferred jobs fill max_size too.
+ */
+static bool defer_job(struct job_queue* job_queue, const struct job* job) {
+  if (job_queue->deferred_array.size >= job_queue->max_size) {
+    ++job_queue->drop_count;
+    return false;
+  }
+  append_job(&job_queue->deferred_array, &job_queue->deferred_set, job);
+  return true;
+}
+
+bool tweak_app_queue_push(struct job_queue* job_queue, const struct job* job) {
+  struct job_array* job_array;
+  bool overflow = false;
+  bool result = true;
   tweak_common_mutex_lock(&job_queue->lock);
-  struct job_array* job_array = &job_queue->arrays[job_queue->current_array];
-  for (int i = (int)(job_array->size - 1); i >= 0; --i) {
-    if (job_array->jobs[i].tweak_id == job->tweak_id
-        && job_array->jobs[i].job_proc == job->job_proc
-        && job_array->jobs[i].cookie == job->cookie)
-    {
+  for (;;) {
+    job_array = &job_queue->arrays[job_queue->current_array];
+    if (is_pending(job_queue, job)) {
+      goto item_present;
+    }
+    if (job_array->size < job_queue->max_size) {
+      break;
+    }
+    if (!overflow) {
+      overflow = true;
+      ++job_queue->overflow_count;
+    }
+    if (job_queue->policy == JOB_QUEUE_POLICY_MERGE) {
+      break;
+    } else if (job_queue->policy == JOB_QUEUE_POLICY_DROP) {
+      result = defer_job(job_queue, job);
       goto item_present;
     }
-  }
-
-  while (job_queue->arrays[job_queue->current_array].size >= job_queue->max_size) {
     tweak_common_cond_wait(&job_queue->cond, &job_queue->lock);
   }
-  ensure_job_array_capacity(job_array, job_array->size + 1);
-  job_array->jobs[job_array->size] = *job;
-  ++job_array->size;
+  append_job(job_array, &job_queue->pending_sets[job_queue->current_array], job);
 
 item_present:
   tweak_common_cond_broadcast(&job_queue->cond);
   tweak_common_mutex_unlock(&job_queue->lock);
+  return result;
+}
+
+bool tweak_app_queue_push_batch(struct job_queue* job_queue, const struct job* jobs, size_t count) {
+  struct job_array* job_array;
+  bool overflow = false;
+  bool result = true;
+  tweak_common_mutex_lock(&job_queue->lock);
+  for (;;) {
+    size_t new_jobs = 0;
+    job_array = &job_queue->arrays[job_queue->current_array];
+    for (size_t ix = 0; ix < count; ix++) {
+      new_jobs += is_pending(job_queue, &jobs[ix]) ? 0 : 1;
+    }
+    if (new_jobs == 0 || job_array->size == 0 || job_array->size + new_jobs <= job_queue->max_size) {
+      break;
+    }
+    if (!overflow) {
+      overflow = true;
+      ++job_queue->overflow_count;
+    }
+    if (job_queue->policy != JOB_QUEUE_POLICY_BLOCK) {
+      break;
+    }
+    tweak_common_cond_wait(&job_queue->cond, &job_queue->lock);
+  }
+  for (size_t ix = 0; ix < count; ix++) {
+    if (is_pending(job_queue, &jobs[ix])) {
+      continue;
+    }
+    if (job_queue->policy == JOB_QUEUE_POLICY_DROP && job_array->size >= job_queue->max_size) {
+      result = defer_job(job_queue, &jobs[ix]) && result;
+      continue;
+    }
+    append_job(job_array, &job_queue->pending_sets[job_queue->current_array], &jobs[ix]);
+  }
+  tweak_common_cond_broadcast(&job_queue->cond);
+  tweak_common_mutex_unlock(&job_queue->lock);
+  return result;
+}
+
+void tweak_app_queue_run_job(const struct job* job) {
+  if (job->range_job_proc) {
+    job->range_job_proc(job->tweak_id, job->offset, job->count, job->cookie);
+  } else {
+    assert(job->job_proc != NULL);
+    job->job_proc(job->tweak_id, job->cookie);
+  }
+}
+
+bool tweak_app_queue_set_policy(struct job_queue* job_queue, enum job_queue_policy policy) {
+  bool result = true;
+  tweak_common_mutex_lock(&job_queue->lock);
+  if (policy == JOB_QUEUE_POLICY_DROP) {
+    for (size_t ix = 0; ix < 2 && result; ix++) {
+      result = reserve_job_array(&job_queue->arrays[ix], job_queue->max_size)
+        && reserve_pending_set(&job_queue->pending_sets[ix], &job_queue->arrays[ix]);
+    }
+    result = result
+      && reserve_job_array(&job_queue->deferred_array, job_queue->max_size)
+      && reserve_pending_set(&job_queue->deferred_set, &job_queue->deferred_array);
+  }
+  if (result) {
+    job_queue->policy = policy;
+  }
+  tweak_common_mutex_unlock(&job_queue->lock);
+  return result;
+}
+
+uint64_t tweak_app_queue_get_overflow_count(struct job_queue* job_queue) {
+  uint64_t result;
+  tweak_common_mutex_lock(&job_queue->lock);
+  result = job_queue->overflow_count;
+  tweak_common_mutex_unlock(&job_queue->lock);
+  return result;
+}
+
+uint64_t tweak_app_queue_get_drop_count(struct job_queue* job_queue) {
+  uint64_t result;
+  tweak_common_mutex_lock(&job_queue->lock);
+  result = job_queue->drop_count;
+  tweak_common_mutex_unlock(&job_queue->lock);
+  return result;
 }
 
 void tweak_app_queue_stop(struct job_queue* job_queue) {
@@ -129,6 +401,10 @@ static void free_job_array(struct job_array* job_array) {
 void tweak_app_queue_destroy(struct job_queue* job_queue) {
   free_job_array(&job_queue->arrays[0]);
   free_job_array(&job_queue->arrays[1]);
+  free_job_array(&job_queue->deferred_array);
+  free(job_queue->pending_sets[0].slots);
+  free(job_queue->pending_sets[1].slots);
+  free(job_queue->deferred_set.slots);
   tweak_common_cond_destroy(&job_queue->cond);
   tweak_common_mutex_destroy(&job_queue->lock);
   free(job_queue);
@@ -32,6 +32,7 @@
 
 #include <stdbool.h>
 #include <stddef.h>
+#include <stdint.h>
 
 /**
  * @brief job routine.
@@ -41,6 +42,16 @@
  */
 typedef void (*job_proc)(tweak_id tweak_id, void* cookie);
 
+/**
+ * @brief job routine affecting a range of vector item.
+ *
+ * @param tweak_id id of an item to apply the job.
+ * @param offset index of the first vector element in range.
+ * @param count number of vector elements in range.
+ * @param cookie user defined context for the job.
+ */
+typedef void (*range_job_proc)(tweak_id tweak_id, size_t offset, size_t count, void* cookie);
+
 /**
  * @brief a job for event queue.
  */
@@ -49,10 +60,23 @@ struct job {
    * @brief job routine.
    */
   job_proc job_proc;
+  /**
+   * @brief job routine for jobs affecting a range of vector item.
+   * Used instead of @p job_proc if isn't NULL.
+   */
+  range_job_proc range_job_proc;
   /**
    * @brief id of an item to apply the job.
    */
   tweak_id tweak_id;
+  /**
+   * @brief index of the first vector element passed to @p range_job_proc.
+   */
+  size_t offset;
+  /**
+   * @brief number of vector elements passed to @p range_job_proc.
+   */
+  size_t count;
   /**
    * @brief user defined context for the job.
    */
@@ -82,6 +106,27 @@ struct job_array {
  */
 struct job_queue;
 
+/**
+ * @brief Behaviour of tweak_app_queue_push when queue is full.
+ */
+enum job_queue_policy {
+  /**
+   * @brief Wait until job processing thread pulls pending jobs.
+   */
+  JOB_QUEUE_POLICY_BLOCK,
+  /**
+   * @brief Append job anyway. Since duplicates are merged, queue size is bounded
+   * by number of distinct jobs, but the memory might be allocated.
+   */
+  JOB_QUEUE_POLICY_MERGE,
+  /**
+   * @brief Defer job to the next pull. Up to max_size deferred jobs are kept,
+   * jobs beyond that are rejected. Memory is reserved beforehand, so push
+   * neither waits nor allocates memory.
+   */
+  JOB_QUEUE_POLICY_DROP
+};
+
 /**
  * @brief Result of pull operation.
  * @see tweak_app_queue_pull.
@@ -119,17 +164,81 @@ struct job_queue* tweak_app_queue_create(size_t max_size);
  */
 struct pull_jobs_result tweak_app_queue_pull(struct job_queue* job_queue);
 
+/**
+ * @brief Pull a job batch from a queue if there's any.
+ *
+ * Same as tweak_app_queue_pull, but doesn't wait for jobs.
+ *
+ * @param job_queue Queue instance.
+ * @return batch containing all pending jobs. job_array is NULL
+ * if there are no pending jobs or termination is requested.
+ */
+struct pull_jobs_result tweak_app_queue_try_pull(struct job_queue* job_queue);
+
 /**
  * @brief Push a job into a queue.
  *
- * Blocks until there's less than max_capacity jobs in the queue
- * or termination is requested.
+ * If the same job is already pending, it isn't appended again.
+ * Otherwise, if there's max_size jobs in the queue already,
+ * the outcome depends on queue policy, @see job_queue_policy.
+ *
+ * @param job_queue Queue struct.
+ * @return true if job is pending in the queue, false if it was rejected
+ * due to JOB_QUEUE_POLICY_DROP policy.
+ */
+bool tweak_app_queue_push(struct job_queue* job_queue, const struct job* job);
+
+/**
+ * @brief Push several jobs into a queue at once.
+ *
+ * Jobs are appended under a single lock acquisition, so consumer pulls them
+ * within the same batch. Duplicates are merged as in tweak_app_queue_push.
+ * With JOB_QUEUE_POLICY_BLOCK policy, waits until there's room for all new jobs
+ * or the queue is empty, a batch larger than max_size isn't split.
+ * With JOB_QUEUE_POLICY_DROP policy, jobs that don't fit are deferred
+ * as in tweak_app_queue_push.
+ *
+ * @param job_queue Queue struct.
+ * @param jobs jobs to push.
+ * @param count number of jobs in @p jobs.
+ * @return true if all jobs are pending in the queue, false if some of them were
+ * rejected due to JOB_QUEUE_POLICY_DROP policy.
+ */
+bool tweak_app_queue_push_batch(struct job_queue* job_queue, const struct job* jobs, size_t count);
+
+/**
+ * @brief Run a job pulled from a queue.
+ *
+ * @param job job to run.
+ */
+void tweak_app_queue_run_job(const struct job* job);
+
+/**
+ * @brief Change behaviour of tweak_app_queue_push when queue is full.
+ *
+ * @param job_queue Queue struct.
+ * @param policy new policy.
+ * @return false if memory for JOB_QUEUE_POLICY_DROP policy couldn't be reserved.
+ * Previous policy stays in effect then.
+ */
+bool tweak_app_queue_set_policy(struct job_queue* job_queue, enum job_queue_policy policy);
+
+/**
+ * @brief Number of pushes that found the queue full since its creation.
+ *
+ * @param job_queue Queue struct.
+ * @return overflow count.
+ */
+uint64_t tweak_app_queue_get_overflow_count(struct job_queue* job_queue);
+
+/**
+ * @brief Number of jobs rejected due to JOB_QUEUE_POLICY_DROP policy
+ * since queue creation. Unlike overflow count, every job of a batch is counted.
  *
  * @param job_queue Queue struct.
- * @return true if job is appended to the queue, false if operation
- * is interrupted by termination request.
+ * @return drop count.
  */
-void tweak_app_queue_push(struct job_queue* job_queue, const struct job* job);
+uint64_t tweak_app_queue_get_drop_count(struct job_queue* job_queue);
 
 /**
  * @brief Push a termination request into a queue.
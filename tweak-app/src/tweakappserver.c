@@ -26,6 +26,7 @@
  */
 
 #include <tweak2/appserver.h>
+#include <tweak2/idmap.h>
 #include <tweak2/log.h>
 #include <tweak2/util.h>
 #include <tweak2/pickle_server.h>
@@ -35,6 +36,7 @@
 #include "tweakmodel.h"
 #include "tweakmodel_uri_to_tweak_id_index.h"
 #include "tweakappfeatures.h"
+#include "tweakappsubscription.h"
 
 #include <inttypes.h>
 #include <stdio.h>
@@ -42,17 +44,599 @@
 
 enum { TWEAK_APP_SERVER_QUEUE_SIZE = 100 };
 
+enum { TWEAK_APP_SERVER_MAX_BATCHED_CHANGES = 1024 };
+
+enum { TWEAK_APP_SERVER_MAX_BATCHED_ADD_ITEMS = 1024 };
+
+/* Soft limit, add_items datagram is closed once its estimated size exceeds this value */
+enum { TWEAK_APP_SERVER_ADD_ITEMS_DATAGRAM_SIZE = 64 * 1024 };
+
+/* Rough estimate of add_item encoding overhead: tags, lengths and varints */
+enum { TWEAK_APP_SERVER_ADD_ITEM_OVERHEAD = 48 };
+
 static void server_push_changes(tweak_app_context context, tweak_id tweak_id);
 
+static void server_push_partial_changes(tweak_app_context context, tweak_id tweak_id,
+  size_t offset, size_t count);
+
+static void session_change(tweak_id tweak_id, void* cookie);
+
+struct tweak_app_context_server_impl;
+
+/**
+ * @brief State of a single client.
+ *
+ * @details Jobs of context queue are fanned out to queues of all sessions,
+ * each one being run by its own worker thread. Thus a client that
+ * has just subscribed is synchronized alone and a slow client
+ * doesn't hold back the others. Thread per client suits a handful
+ * of tools attached to a device; TWEAK_APP_IO_MODE_POLL runs all
+ * sessions by the single polling thread instead.
+ */
+struct server_session {
+  struct tweak_app_context_server_impl* server_impl;
+  /**
+   * @brief Next session of the context. Guarded by conn_state_lock.
+   */
+  struct server_session* next;
+  /**
+   * @brief Number of owners: context while the session is in its list
+   * and tweak_app_flush_queue calls in progress. Guarded by conn_state_lock.
+   */
+  uint32_t ref_count;
+  /**
+   * @brief True once session has been unlinked from context.
+   * Guarded by conn_state_lock.
+   */
+  bool detached;
+  tweak_pickle_peer peer;
+  /**
+   * @brief Endpoint delivering messages to this client only.
+   */
+  tweak_pickle_server_endpoint rpc_endpoint;
+  struct job_queue* job_queue;
+  /**
+   * @brief Runs job_queue. Not created in TWEAK_APP_IO_MODE_POLL mode.
+   */
+  tweak_common_thread worker_thread;
+  /**
+   * @brief Batch of job_queue being run by tweak_app_poll. Guarded by base.poll_lock.
+   */
+  struct tweak_app_poll_cursor poll_cursor;
+  /**
+   * @brief Features supported by client. Guarded by conn_state_lock.
+   */
+  struct tweak_app_features remote_peer_features;
+  /**
+   * @brief True if client has announced its features and is waiting
+   * for server ones. Guarded by conn_state_lock.
+   */
+  bool features_announced;
+  /**
+   * @brief Uri patterns of the latest subscribe request.
+   * Guarded by conn_state_lock.
+   */
+  tweak_variant_string requested_uri_patterns;
+  /**
+   * @brief Model epoch and items client has kept since the previous connection,
+   * as given by the latest subscribe request. Guarded by conn_state_lock.
+   */
+  uint64_t requested_model_epoch;
+  tweak_pickle_known_item* requested_known_items;
+  size_t requested_known_items_size;
+  /**
+   * @brief True if updates shall be propagated to client.
+   * Altered by worker thread under conn_state_lock, so worker can read it without one.
+   */
+  bool subscribed;
+  /**
+   * @brief Changes collected by session_change within current job batch
+   * to be sent to client as a single change_items request.
+   * Accessed by worker thread only.
+   */
+  tweak_pickle_change_item* pending_changes;
+  size_t pending_changes_size;
+  size_t pending_changes_capacity;
+  /**
+   * @brief Uri patterns applied by the last session_subscribe.
+   * Accessed by worker thread only.
+   */
+  struct tweak_app_uri_filter uri_filter;
+  /**
+   * @brief Ids of items client knows about. add_item, change_item and remove_item
+   * requests are sent for these items only. Accessed by worker thread only.
+   */
+  struct tweak_id_map announced_ids;
+};
+
 struct tweak_app_context_server_impl {
   struct tweak_app_context_base base;
   tweak_app_server_callbacks server_callbacks;
   tweak_pickle_server_endpoint rpc_endpoint;
-  bool features_announced;
+  /**
+   * @brief Sessions of attached clients. Guarded by conn_state_lock.
+   */
+  struct server_session* sessions;
+  /**
+   * @brief Number of sessions which clients have subscribed.
+   * Context is connected while it's nonzero. Guarded by conn_state_lock.
+   */
+  size_t subscribed_sessions;
+  /**
+   * @brief Set when context is being destroyed, no sessions are created
+   * from then on. Guarded by conn_state_lock.
+   */
+  bool stopping;
+  /**
+   * @brief Ids of items which on_current_value_changed callback is pending.
+   * Created for TWEAK_APP_CALLBACK_DISPATCH_EXECUTOR only, NULL otherwise.
+   */
+  struct job_queue* callback_queue;
+  /**
+   * @brief Thread running jobs of callback_queue. Not created in TWEAK_APP_IO_MODE_POLL mode.
+   */
+  tweak_common_thread callback_thread;
+  /**
+   * @brief Batch of callback_queue being run by tweak_app_poll. Guarded by base.poll_lock.
+   */
+  struct tweak_app_poll_cursor callback_poll_cursor;
+  /**
+   * @brief Sessions referenced by tweak_app_poll call, reused to avoid
+   * allocation on every call. Guarded by base.poll_lock.
+   */
+  struct server_session** polled_sessions;
+  size_t polled_sessions_capacity;
+  /**
+   * @brief Guards callback_stats.
+   */
+  tweak_common_mutex callback_stats_lock;
+  tweak_app_server_callback_stats callback_stats;
 };
 
-static bool check_value_allowed(struct tweak_app_features* features, const tweak_variant* value) {
+static void flush_pending_changes(struct server_session* session) {
+  if (session->pending_changes_size == 0) {
+    return;
+  }
+  TWEAK_LOG_TRACE("Propagating %zu changes to client %u",
+    session->pending_changes_size, session->peer);
+  tweak_pickle_call_result result = tweak_pickle_server_change_items(session->rpc_endpoint,
+    session->pending_changes, session->pending_changes_size);
+  if (result != TWEAK_PICKLE_SUCCESS) {
+    TWEAK_LOG_WARN("failed tweak_pickle_server_change_items RPC call on %zu items",
+      session->pending_changes_size);
+  }
+  for (size_t ix = 0; ix < session->pending_changes_size; ++ix) {
+    tweak_variant_destroy(&session->pending_changes[ix].value);
+  }
+  session->pending_changes_size = 0;
+}
+
+static bool append_pending_change(struct server_session* session, tweak_pickle_change_item* change) {
+  if (session->pending_changes_size == TWEAK_APP_SERVER_MAX_BATCHED_CHANGES) {
+    flush_pending_changes(session);
+  }
+  if (session->pending_changes_size == session->pending_changes_capacity) {
+    size_t new_capacity = session->pending_changes_capacity
+      ? session->pending_changes_capacity * 2
+      : TWEAK_APP_SERVER_QUEUE_SIZE;
+    if (new_capacity > TWEAK_APP_SERVER_MAX_BATCHED_CHANGES) {
+      new_capacity = TWEAK_APP_SERVER_MAX_BATCHED_CHANGES;
+    }
+    tweak_pickle_change_item* new_pending_changes =
+      realloc(session->pending_changes, new_capacity * sizeof(*new_pending_changes));
+    if (!new_pending_changes) {
+      TWEAK_LOG_WARN("realloc() returned NULL");
+      return false;
+    }
+    session->pending_changes = new_pending_changes;
+    session->pending_changes_capacity = new_capacity;
+  }
+  tweak_pickle_change_item* pending_change = &session->pending_changes[session->pending_changes_size++];
+  tweak_variant empty_value = TWEAK_VARIANT_INIT_EMPTY;
+  *pending_change = *change;
+  pending_change->value = empty_value;
+  tweak_variant_swap(&pending_change->value, &change->value);
+  return true;
+}
+
+static void* session_io_loop(void* arg) {
+  TWEAK_LOG_TRACE_ENTRY();
+  struct server_session* session = arg;
+  bool end_of_loop = false;
+  while (!end_of_loop) {
+    struct pull_jobs_result jobs_batch = tweak_app_queue_pull(session->job_queue);
+    if (jobs_batch.is_stopped) {
+      end_of_loop = true;
+      continue;
+    }
+    const struct job_array* job_array = jobs_batch.job_array;
+    for (size_t ix = 0; ix < job_array->size; ++ix) {
+      tweak_app_queue_run_job(&job_array->jobs[ix]);
+    }
+    flush_pending_changes(session);
+  }
+  return NULL;
+}
+
+static void destroy_session(struct server_session* session) {
+  TWEAK_LOG_TRACE_ENTRY("session = %p", session);
+  if (session->rpc_endpoint) {
+    tweak_app_queue_stop(session->job_queue);
+    if (session->server_impl->base.io_mode != TWEAK_APP_IO_MODE_POLL) {
+      tweak_common_thread_join(session->worker_thread, NULL);
+    }
+    tweak_pickle_destroy_server_endpoint(session->rpc_endpoint);
+  }
+  if (session->job_queue) {
+    tweak_app_queue_destroy(session->job_queue);
+  }
+  for (size_t ix = 0; ix < session->pending_changes_size; ++ix) {
+    tweak_variant_destroy(&session->pending_changes[ix].value);
+  }
+  free(session->pending_changes);
+  tweak_variant_destroy_string(&session->requested_uri_patterns);
+  free(session->requested_known_items);
+  tweak_app_uri_filter_destroy(&session->uri_filter);
+  tweak_id_map_destroy(&session->announced_ids);
+  free(session);
+}
+
+static struct server_session* create_session(struct tweak_app_context_server_impl* server_impl,
+  tweak_pickle_peer peer)
+{
+  TWEAK_LOG_TRACE_ENTRY("server_impl = %p, peer = %u", server_impl, peer);
+  struct server_session* session = calloc(1, sizeof(*session));
+  if (!session) {
+    TWEAK_LOG_ERROR("calloc() returned NULL");
+    return NULL;
+  }
+  session->server_impl = server_impl;
+  session->ref_count = 1;
+  session->peer = peer;
+  tweak_app_features_init_default(&session->remote_peer_features);
+  /* Clients that don't announce features can't decode batched changes, packed vectors nor partial changes */
+  session->remote_peer_features.change_items = false;
+  session->remote_peer_features.packed_vectors = false;
+  session->remote_peer_features.partial_changes = false;
+
+  /* Context queue applies user selected policy, fan out to sessions shall never block */
+  session->job_queue = tweak_app_queue_create(TWEAK_APP_SERVER_QUEUE_SIZE);
+  if (!session->job_queue
+    || !tweak_app_queue_set_policy(session->job_queue, JOB_QUEUE_POLICY_MERGE))
+  {
+    TWEAK_LOG_ERROR("Can't create io queue for client %u", peer);
+    goto destroy_session;
+  }
+
+  session->rpc_endpoint = tweak_pickle_server_create_peer_endpoint(server_impl->rpc_endpoint, peer);
+  if (!session->rpc_endpoint) {
+    TWEAK_LOG_ERROR("Can't create endpoint for client %u", peer);
+    goto destroy_session;
+  }
+
+  if (server_impl->base.io_mode != TWEAK_APP_IO_MODE_POLL
+    && tweak_common_thread_create(&session->worker_thread, &session_io_loop, session)
+      != TWEAK_COMMON_THREAD_SUCCESS)
+  {
+    TWEAK_LOG_ERROR("Platform specific threading error in tweak_common_thread_create()");
+    tweak_pickle_destroy_server_endpoint(session->rpc_endpoint);
+    session->rpc_endpoint = NULL;
+    goto destroy_session;
+  }
+  return session;
+
+destroy_session:
+  destroy_session(session);
+  return NULL;
+}
+
+static void release_session(struct server_session* session) {
+  struct tweak_app_context_server_impl* server_impl = session->server_impl;
+  tweak_common_mutex_lock(&server_impl->base.conn_state_lock);
+  uint32_t ref_count = --session->ref_count;
+  tweak_common_mutex_unlock(&server_impl->base.conn_state_lock);
+  if (ref_count == 0) {
+    destroy_session(session);
+  }
+}
+
+static struct server_session* find_session_locked(struct tweak_app_context_server_impl* server_impl,
+  tweak_pickle_peer peer)
+{
+  for (struct server_session* session = server_impl->sessions; session; session = session->next) {
+    if (session->peer == peer) {
+      return session;
+    }
+  }
+  return NULL;
+}
+
+/**
+ * @brief Find session of client @p peer, create it if it doesn't exist yet.
+ * Caller shall hold conn_state_lock.
+ *
+ * @return session or NULL if context is being destroyed or there's no memory.
+ */
+static struct server_session* acquire_session_locked(struct tweak_app_context_server_impl* server_impl,
+  tweak_pickle_peer peer)
+{
+  struct server_session* session = find_session_locked(server_impl, peer);
+  if (session || server_impl->stopping) {
+    return session;
+  }
+  session = create_session(server_impl, peer);
+  if (session) {
+    TWEAK_LOG_DEBUG("Client %u attached", peer);
+    session->next = server_impl->sessions;
+    server_impl->sessions = session;
+  }
+  return session;
+}
+
+/**
+ * @brief Find session of client which has sent the request being dispatched.
+ * Caller shall hold conn_state_lock.
+ */
+static struct server_session* acquire_sender_session_locked(struct tweak_app_context_server_impl* server_impl) {
+  return acquire_session_locked(server_impl, tweak_pickle_server_get_sender(server_impl->rpc_endpoint));
+}
+
+static void set_session_subscribed(struct server_session* session, bool subscribed) {
+  struct tweak_app_context_server_impl* server_impl = session->server_impl;
+  tweak_common_mutex_lock(&server_impl->base.conn_state_lock);
+  if (!session->detached && session->subscribed != subscribed) {
+    session->subscribed = subscribed;
+    if (subscribed) {
+      ++server_impl->subscribed_sessions;
+    } else {
+      --server_impl->subscribed_sessions;
+    }
+    server_impl->base.connected = server_impl->subscribed_sessions != 0;
+  }
+  tweak_common_mutex_unlock(&server_impl->base.conn_state_lock);
+}
+
+/**
+ * @brief Remove session from context list. Caller shall hold conn_state_lock
+ * and call release_session afterwards.
+ */
+static void unlink_session_locked(struct tweak_app_context_server_impl* server_impl,
+  struct server_session* session)
+{
+  struct server_session** link = &server_impl->sessions;
+  while (*link != session) {
+    link = &(*link)->next;
+  }
+  *link = session->next;
+  session->next = NULL;
+  /* Subscribed flag is left to worker thread, it doesn't matter from now on */
+  if (session->subscribed) {
+    --server_impl->subscribed_sessions;
+    server_impl->base.connected = server_impl->subscribed_sessions != 0;
+  }
+  session->detached = true;
+}
+
+static struct tweak_app_features get_session_features(struct server_session* session) {
+  struct tweak_app_features features;
+  tweak_common_mutex_lock(&session->server_impl->base.conn_state_lock);
+  features = session->remote_peer_features;
+  tweak_common_mutex_unlock(&session->server_impl->base.conn_state_lock);
+  return features;
+}
+
+static void* callback_loop(void* arg) {
+  TWEAK_LOG_TRACE_ENTRY();
+  struct tweak_app_context_server_impl* server_impl = arg;
+  bool end_of_loop = false;
+  while (!end_of_loop) {
+    struct pull_jobs_result jobs_batch = tweak_app_queue_pull(server_impl->callback_queue);
+    if (jobs_batch.is_stopped) {
+      end_of_loop = true;
+      continue;
+    }
+    const struct job_array* job_array = jobs_batch.job_array;
+    for (size_t ix = 0; ix < job_array->size; ++ix) {
+      tweak_app_queue_run_job(&job_array->jobs[ix]);
+    }
+  }
+  return NULL;
+}
+
+static void server_destroy_context(struct tweak_app_context_base* context) {
+  TWEAK_LOG_TRACE_ENTRY("context = %p", context);
+  struct tweak_app_context_server_impl* server_impl = (struct tweak_app_context_server_impl*)context;
+  struct server_session* sessions;
+  tweak_common_mutex_lock(&server_impl->base.conn_state_lock);
+  server_impl->stopping = true;
+  sessions = server_impl->sessions;
+  for (struct server_session* session = sessions; session; session = session->next) {
+    session->detached = true;
+  }
+  server_impl->sessions = NULL;
+  server_impl->subscribed_sessions = 0;
+  server_impl->base.connected = false;
+  tweak_common_mutex_unlock(&server_impl->base.conn_state_lock);
+  if (server_impl->base.job_queue) {
+    tweak_app_queue_stop(server_impl->base.job_queue);
+  }
+  while (sessions) {
+    struct server_session* next = sessions->next;
+    release_session(sessions);
+    sessions = next;
+  }
+  if (server_impl->rpc_endpoint) {
+    tweak_pickle_destroy_server_endpoint(server_impl->rpc_endpoint);
+  }
+  /* No requests are received from now on, callbacks still pending are discarded */
+  if (server_impl->callback_queue) {
+    tweak_app_queue_stop(server_impl->callback_queue);
+    if (server_impl->base.io_mode != TWEAK_APP_IO_MODE_POLL) {
+      tweak_common_thread_join(server_impl->callback_thread, NULL);
+    }
+    tweak_app_queue_destroy(server_impl->callback_queue);
+  }
+  free(server_impl->polled_sessions);
+  tweak_common_mutex_destroy(&server_impl->callback_stats_lock);
+  tweak_app_context_private_destroy_base(&server_impl->base);
+  free(context);
+}
+
+/**
+ * @brief Generate epoch for a new model.
+ *
+ * @details Ids and versions start over when server restarts,
+ * so epoch shall differ between runs to tell client its items are stale.
+ * Neither wall clock nor heap addresses can be relied upon for that
+ * on targets without RTC or ASLR, hence platform entropy source.
+ */
+static uint64_t generate_model_epoch() {
+  uint64_t epoch = tweak_common_random_seed();
+  return epoch != 0 ? epoch : 1;
+}
+
+static void server_flush_queue(struct tweak_app_context_base* context) {
+  TWEAK_LOG_TRACE_ENTRY("context = %p", context);
+  struct tweak_app_context_server_impl* server_impl = (struct tweak_app_context_server_impl*)context;
+  struct server_session** sessions = NULL;
+  size_t sessions_count = 0;
+  tweak_common_mutex_lock(&server_impl->base.conn_state_lock);
+  for (struct server_session* session = server_impl->sessions; session; session = session->next) {
+    ++sessions_count;
+  }
+  if (sessions_count > 0) {
+    sessions = calloc(sessions_count, sizeof(*sessions));
+  }
+  if (sessions) {
+    size_t ix = 0;
+    for (struct server_session* session = server_impl->sessions; session; session = session->next) {
+      ++session->ref_count;
+      sessions[ix++] = session;
+    }
+  } else if (sessions_count > 0) {
+    TWEAK_LOG_ERROR("calloc() returned NULL");
+    sessions_count = 0;
+  }
+  tweak_common_mutex_unlock(&server_impl->base.conn_state_lock);
+  /* Sessions are waited for outside of the lock since their workers take it */
+  for (size_t ix = 0; ix < sessions_count; ++ix) {
+    tweak_app_queue_wait_empty(sessions[ix]->job_queue);
+    release_session(sessions[ix]);
+  }
+  free(sessions);
+}
+
+static void flush_polled_session(void* cookie) {
+  flush_pending_changes(cookie);
+}
+
+/**
+ * @brief Runs jobs of session and callback queues in TWEAK_APP_IO_MODE_POLL mode.
+ * Called by tweak_app_poll with base.poll_lock held.
+ */
+static bool server_poll(struct tweak_app_context_base* context, struct tweak_app_poll_budget* budget) {
+  struct tweak_app_context_server_impl* server_impl = (struct tweak_app_context_server_impl*)context;
+  size_t sessions_count = 0;
+  bool exhausted = false;
+  tweak_common_mutex_lock(&server_impl->base.conn_state_lock);
+  for (struct server_session* session = server_impl->sessions; session; session = session->next) {
+    ++sessions_count;
+  }
+  if (sessions_count > server_impl->polled_sessions_capacity) {
+    struct server_session** polled_sessions = realloc(server_impl->polled_sessions,
+      sessions_count * sizeof(*polled_sessions));
+    if (polled_sessions) {
+      server_impl->polled_sessions = polled_sessions;
+      server_impl->polled_sessions_capacity = sessions_count;
+    } else {
+      TWEAK_LOG_ERROR("realloc() returned NULL");
+      sessions_count = server_impl->polled_sessions_capacity;
+    }
+  }
+  size_t ix = 0;
+  for (struct server_session* session = server_impl->sessions; session && ix < sessions_count;
+    session = session->next)
+  {
+    ++session->ref_count;
+    server_impl->polled_sessions[ix++] = session;
+  }
+  sessions_count = ix;
+  tweak_common_mutex_unlock(&server_impl->base.conn_state_lock);
+  /* Jobs are run outside of the lock since they take it */
+  for (ix = 0; ix < sessions_count; ++ix) {
+    struct server_session* session = server_impl->polled_sessions[ix];
+    if (!exhausted) {
+      exhausted = tweak_app_context_private_poll_queue(session->job_queue, &session->poll_cursor,
+        budget, &flush_polled_session, session);
+    }
+    release_session(session);
+  }
+  if (!exhausted && server_impl->callback_queue) {
+    exhausted = tweak_app_context_private_poll_queue(server_impl->callback_queue,
+      &server_impl->callback_poll_cursor, budget, NULL, NULL);
+  }
+  return exhausted;
+}
+
+static void clean_pickle_add_item(tweak_pickle_add_item* add_item) {
+  TWEAK_LOG_TRACE_ENTRY("add_item = %p", add_item);
+  tweak_variant_destroy_string(&add_item->uri);
+  tweak_variant_destroy_string(&add_item->meta);
+  tweak_variant_destroy_string(&add_item->description);
+  tweak_variant_destroy(&add_item->default_value);
+  tweak_variant_destroy(&add_item->current_value);
+}
+
+/**
+ * @brief Ids of items to be announced to client, in index order.
+ */
+struct subscribe_snapshot {
+  tweak_id* ids;
+  size_t size;
+  size_t capacity;
+  /**
+   * @brief All items matching subscription, including ones already announced.
+   */
+  struct tweak_id_map selected_ids;
+  const struct tweak_id_map* announced_ids;
+};
+
+static bool append_snapshot_id(struct subscribe_snapshot* snapshot, tweak_id id) {
+  if (snapshot->size == snapshot->capacity) {
+    size_t new_capacity = snapshot->capacity ? snapshot->capacity * 2 : TWEAK_APP_SERVER_MAX_BATCHED_ADD_ITEMS;
+    tweak_id* new_ids = realloc(snapshot->ids, new_capacity * sizeof(*new_ids));
+    if (!new_ids) {
+      TWEAK_LOG_ERROR("realloc() returned NULL");
+      return false;
+    }
+    snapshot->ids = new_ids;
+    snapshot->capacity = new_capacity;
+  }
+  snapshot->ids[snapshot->size++] = id;
+  return true;
+}
+
+static bool snapshot_walk_proc(const char *uri, tweak_id id, void* cookie) {
+  (void)uri;
+  assert(id != TWEAK_INVALID_ID);
+  struct subscribe_snapshot* snapshot = cookie;
+  if (tweak_id_map_contains(&snapshot->selected_ids, id)) {
+    /* Matched by another pattern */
+    return true;
+  }
+  if (!tweak_id_map_insert(&snapshot->selected_ids, id, 0)) {
+    return false;
+  }
+  if (tweak_id_map_contains(snapshot->announced_ids, id)) {
+    return true;
+  }
+  return append_snapshot_id(snapshot, id);
+}
+
+static size_t estimate_value_size(const tweak_variant* value) {
   switch (value->type) {
+  case TWEAK_VARIANT_TYPE_STRING:
+    return value->value.string.length;
   case TWEAK_VARIANT_TYPE_VECTOR_SINT8:
   case TWEAK_VARIANT_TYPE_VECTOR_SINT16:
   case TWEAK_VARIANT_TYPE_VECTOR_SINT32:
@@ -63,107 +647,357 @@ static bool check_value_allowed(struct tweak_app_features* features, const tweak
   case TWEAK_VARIANT_TYPE_VECTOR_UINT64:
   case TWEAK_VARIANT_TYPE_VECTOR_FLOAT:
   case TWEAK_VARIANT_TYPE_VECTOR_DOUBLE:
-    return features->vectors;
+    return value->value.buffer.size;
   default:
-    return true;
+    return sizeof(uint64_t);
   }
 }
 
-static void server_destroy_context(struct tweak_app_context_base* context) {
-  TWEAK_LOG_TRACE_ENTRY("context = %p", context);
-  struct tweak_app_context_server_impl* server_impl = (struct tweak_app_context_server_impl*)context;
-  if (server_impl->base.job_queue) {
-    tweak_app_queue_stop(server_impl->base.job_queue);
-  }
-  if (server_impl->rpc_endpoint) {
-    tweak_pickle_destroy_server_endpoint(server_impl->rpc_endpoint);
+static size_t estimate_add_item_size(const tweak_item* item) {
+  return TWEAK_APP_SERVER_ADD_ITEM_OVERHEAD
+    + tweak_interned_string_length(item->cold->uri)
+    + item->cold->description.length
+    + item->cold->meta.length
+    + estimate_value_size(&item->cold->default_value)
+    + estimate_value_size(&item->current_value);
+}
+
+/**
+ * @brief Copy items of the next chunk of @p snapshot starting at @p *position.
+ * Takes model_lock only for the duration of copying.
+ *
+ * @return number of items copied to @p chunk.
+ */
+static size_t copy_snapshot_chunk(struct server_session* session,
+  const struct tweak_app_features* features, const struct subscribe_snapshot* snapshot,
+  size_t* position, tweak_pickle_add_item* chunk, size_t max_chunk_size)
+{
+  struct tweak_model_impl* model = &session->server_impl->base.model_impl;
+  size_t chunk_size = 0;
+  size_t datagram_size = 0;
+  tweak_common_rwlock_read_lock(&model->model_lock);
+  while (*position < snapshot->size && chunk_size < max_chunk_size
+    && datagram_size < TWEAK_APP_SERVER_ADD_ITEMS_DATAGRAM_SIZE)
+  {
+    tweak_item* item = tweak_model_find_item_by_id(model->model, snapshot->ids[(*position)++]);
+    if (!item) {
+      /* Item has been removed after snapshot has been taken */
+      continue;
+    }
+    if (!tweak_app_features_check_type_compatibility(features, item->variant_type)) {
+      TWEAK_LOG_WARN("Skipping item with uri = \"%s\" with type %d not supported by remote peer",
+        tweak_interned_string_c_str(item->cold->uri), item->variant_type);
+      continue;
+    }
+    if (!tweak_id_map_insert(&session->announced_ids, item->id, 0)) {
+      TWEAK_LOG_ERROR("Skipping item with uri = \"%s\", can't track it",
+        tweak_interned_string_c_str(item->cold->uri));
+      continue;
+    }
+    tweak_pickle_add_item* add_item = &chunk[chunk_size++];
+    add_item->id = item->id;
+    add_item->uri = tweak_interned_string_copy(item->cold->uri);
+    add_item->meta = tweak_variant_string_copy(&item->cold->meta);
+    add_item->description = tweak_variant_string_copy(&item->cold->description);
+    add_item->default_value = tweak_variant_copy(&item->cold->default_value);
+    add_item->current_value = tweak_variant_copy(&item->current_value);
+    add_item->version = item->version;
+    datagram_size += estimate_add_item_size(item);
   }
-  tweak_app_context_private_destroy_base(&server_impl->base);
-  free(context);
+  tweak_common_rwlock_read_unlock(&model->model_lock);
+  return chunk_size;
 }
 
-static bool subscribe_walk_proc(const char *uri, tweak_id tweak_id, void* cookie) {
-  (void)uri;
-  TWEAK_LOG_TRACE_ENTRY("uri = %s, tweak_id = %" PRId64 ", cookie = %p", uri, tweak_id, cookie);
-  assert(tweak_id != TWEAK_INVALID_ID);
-  struct tweak_app_context_server_impl* server_impl = (struct tweak_app_context_server_impl*) cookie;
-  tweak_item* item = tweak_model_find_item_by_id(server_impl->base.model_impl.model, tweak_id);
-  bool value_allowed = check_value_allowed(&server_impl->base.remote_peer_features, &item->current_value);
-  if (!value_allowed) {
-    TWEAK_LOG_WARN("Remote endpoint doesn't support item : \"%s\"", tweak_variant_string_c_str(&item->uri));
+static bool stream_snapshot(struct server_session* session,
+  const struct subscribe_snapshot* snapshot)
+{
+  struct tweak_app_features features = get_session_features(session);
+  bool batch_items = features.add_items;
+
+  size_t max_chunk_size = batch_items ? TWEAK_APP_SERVER_MAX_BATCHED_ADD_ITEMS : 1;
+  tweak_pickle_add_item* chunk = calloc(max_chunk_size, sizeof(*chunk));
+  if (!chunk) {
+    TWEAK_LOG_ERROR("calloc() returned NULL");
+    return false;
   }
-  if (item != NULL) {
-    bool item_is_compatible =
-      tweak_app_features_check_type_compatibility(&server_impl->base.remote_peer_features, item->variant_type);
-    if (item_is_compatible) {
-      tweak_pickle_add_item pickle_add_item = {
-        .id = item->id,
-        .uri = item->uri,
-        .meta = item->meta,
-        .description = item->description,
-        .default_value = item->default_value,
-        .current_value = item->current_value,
-      };
-      tweak_pickle_call_result call_result =
-        tweak_pickle_server_add_item(server_impl->rpc_endpoint, &pickle_add_item);
-      if (call_result == TWEAK_PICKLE_SUCCESS) {
-        return true;
+
+  bool result = true;
+  size_t position = 0;
+  while (result && position < snapshot->size) {
+    size_t chunk_size = copy_snapshot_chunk(session, &features, snapshot, &position,
+      chunk, max_chunk_size);
+    if (chunk_size > 0) {
+      tweak_pickle_call_result call_result = batch_items
+        ? tweak_pickle_server_add_items(session->rpc_endpoint, chunk, chunk_size)
+        : tweak_pickle_server_add_item(session->rpc_endpoint, chunk);
+      if (call_result != TWEAK_PICKLE_SUCCESS) {
+        TWEAK_LOG_WARN("Announcing items: RPC call failed with code %d", call_result);
+        result = false;
       }
-      TWEAK_LOG_WARN("tweak_pickle_server_add_item: RPC call failed with code %d", call_result);
-    } else {
-      TWEAK_LOG_WARN("Skipping item with uri = \"%s\" with type %d not supported by remote peer",
-        tweak_variant_string_c_str(&item->uri), item->variant_type);
-      return true;
     }
-  } else {
-    TWEAK_LOG_WARN("model index is inconsistent, Unknown tweak_id = %" PRIu64 "", tweak_id);
+    for (size_t ix = 0; ix < chunk_size; ++ix) {
+      clean_pickle_add_item(&chunk[ix]);
+    }
   }
-  return false;
+  free(chunk);
+  return result;
 }
 
-static void io_loop_subscribe(tweak_id tweak_id, void* cookie) {
-  (void) tweak_id;
-  TWEAK_LOG_TRACE_ENTRY("tweak_id = %" PRId64 ", cookie = %p", tweak_id, cookie);
-  struct tweak_app_context_server_impl* server_impl = cookie;
-  if (server_impl->features_announced) {
-    struct tweak_app_features default_features = { 0 };
-    tweak_app_features_init_default(&default_features);
+static bool collect_retracted_proc(tweak_id id, size_t value, void* cookie) {
+  (void)value;
+  struct subscribe_snapshot* retracted = cookie;
+  if (tweak_id_map_contains(retracted->announced_ids, id)) {
+    /* Still selected */
+    return true;
+  }
+  return append_snapshot_id(retracted, id);
+}
 
-    tweak_variant_string session_features = tweak_app_features_to_json(&default_features);
-    tweak_pickle_features features = { .features = session_features };
+/**
+ * @brief Send remove_item requests for announced items which aren't in @p selected_ids anymore.
+ */
+static bool retract_unselected_items(struct server_session* session,
+  const struct tweak_id_map* selected_ids)
+{
+  if (session->announced_ids.size == 0) {
+    return true;
+  }
+  /* Ids are collected first since they can't be removed from the set while it's being walked.
+   * Here announced_ids field of the snapshot refers to items which should stay announced */
+  struct subscribe_snapshot retracted = { .announced_ids = selected_ids };
+  bool result = tweak_id_map_walk(&session->announced_ids, &collect_retracted_proc, &retracted);
+  for (size_t ix = 0; result && ix < retracted.size; ++ix) {
+    tweak_id_map_remove(&session->announced_ids, retracted.ids[ix]);
+    tweak_pickle_remove_item remove_item = {
+      .id = retracted.ids[ix]
+    };
+    if (tweak_pickle_server_remove_item(session->rpc_endpoint, &remove_item) != TWEAK_PICKLE_SUCCESS) {
+      TWEAK_LOG_WARN("failed tweak_pickle_server_remove_item RPC call on id = %" PRIu64 "", remove_item.id);
+      result = false;
+    }
+  }
+  free(retracted.ids);
+  return result;
+}
 
-    tweak_pickle_call_result call_result =
-      tweak_pickle_server_announce_features(server_impl->rpc_endpoint, &features);
+static bool apply_requested_uri_patterns(struct server_session* session) {
+  struct tweak_app_context_server_impl* server_impl = session->server_impl;
+  if (session->peer == TWEAK_PICKLE_ALL_PEERS) {
+    /* Session shared by all clients can't apply selection of any particular one
+     * without retracting items from the others, so it keeps selecting all items */
+    TWEAK_LOG_DEBUG("Ignoring subscription of a client sharing session with other ones");
+    return true;
+  }
+  tweak_common_mutex_lock(&server_impl->base.conn_state_lock);
+  tweak_variant_string uri_patterns = tweak_variant_string_copy(&session->requested_uri_patterns);
+  tweak_common_mutex_unlock(&server_impl->base.conn_state_lock);
 
-    tweak_variant_destroy_string(&session_features);
-    if (call_result != TWEAK_PICKLE_SUCCESS) {
-      TWEAK_LOG_WARN("tweak_pickle_server_announce_features() returned error %d", call_result);
-      return;
+  struct tweak_app_uri_filter uri_filter;
+  bool result = tweak_app_uri_filter_init(&uri_filter, tweak_variant_string_c_str(&uri_patterns));
+  if (result) {
+    TWEAK_LOG_DEBUG("Applying subscription of client %u to \"%s\"", session->peer,
+      tweak_variant_string_c_str(&uri_patterns));
+    tweak_app_uri_filter_destroy(&session->uri_filter);
+    session->uri_filter = uri_filter;
+  }
+  tweak_variant_destroy_string(&uri_patterns);
+  return result;
+}
+
+/**
+ * @brief Epoch of the model as seen by client of @p session.
+ *
+ * @return 0 if items client has kept can't be resynchronized.
+ */
+static uint64_t get_session_model_epoch(const struct server_session* session) {
+  /* Session shared by all clients can't track items of any particular one */
+  return session->peer != TWEAK_PICKLE_ALL_PEERS
+    ? session->server_impl->base.model_impl.epoch
+    : 0;
+}
+
+static bool announce_server_features(struct server_session* session) {
+  struct tweak_app_context_server_impl* server_impl = session->server_impl;
+  tweak_common_mutex_lock(&server_impl->base.conn_state_lock);
+  bool features_announced = session->features_announced;
+  tweak_common_mutex_unlock(&server_impl->base.conn_state_lock);
+  if (!features_announced) {
+    return true;
+  }
+
+  struct tweak_app_features default_features = { 0 };
+  tweak_app_features_init_default(&default_features);
+
+  tweak_variant_string session_features = tweak_app_features_to_json(&default_features);
+  tweak_pickle_features features = {
+    .features = session_features,
+    .model_epoch = get_session_model_epoch(session)
+  };
+
+  tweak_pickle_call_result call_result =
+    tweak_pickle_server_announce_features(session->rpc_endpoint, &features);
+
+  tweak_variant_destroy_string(&session_features);
+  if (call_result != TWEAK_PICKLE_SUCCESS) {
+    TWEAK_LOG_WARN("tweak_pickle_server_announce_features() returned error %d", call_result);
+    return false;
+  }
+  tweak_common_mutex_lock(&server_impl->base.conn_state_lock);
+  session->features_announced = false;
+  tweak_common_mutex_unlock(&server_impl->base.conn_state_lock);
+  return true;
+}
+
+/**
+ * @brief Take items client has kept since the previous connection
+ * provided they've been received from this very model.
+ *
+ * @return number of items stored to @p known_items.
+ */
+static size_t take_known_items(struct server_session* session,
+  tweak_pickle_known_item** known_items)
+{
+  struct tweak_app_context_server_impl* server_impl = session->server_impl;
+  uint64_t model_epoch = get_session_model_epoch(session);
+  size_t known_items_size = 0;
+  *known_items = NULL;
+  tweak_common_mutex_lock(&server_impl->base.conn_state_lock);
+  if (model_epoch != 0 && session->requested_model_epoch == model_epoch) {
+    *known_items = session->requested_known_items;
+    known_items_size = session->requested_known_items_size;
+  } else {
+    if (session->requested_known_items_size > 0) {
+      TWEAK_LOG_DEBUG("Client %u has kept items of another model", session->peer);
     }
-    server_impl->features_announced = false;
+    free(session->requested_known_items);
   }
+  session->requested_model_epoch = 0;
+  session->requested_known_items = NULL;
+  session->requested_known_items_size = 0;
+  tweak_common_mutex_unlock(&server_impl->base.conn_state_lock);
+  return known_items_size;
+}
 
-  tweak_app_context context = &server_impl->base;
+/**
+ * @brief Treat items client has kept as announced ones. Ids of kept items
+ * whose version differs are collected to @p stale. Items server doesn't
+ * have anymore are retracted along with unselected ones.
+ * Caller shall hold model_lock.
+ */
+static bool seed_known_items(struct server_session* session,
+  const tweak_pickle_known_item* known_items, size_t known_items_size,
+  struct subscribe_snapshot* stale)
+{
+  tweak_model model = session->server_impl->base.model_impl.model;
+  for (size_t ix = 0; ix < known_items_size; ++ix) {
+    const tweak_pickle_known_item* known_item = &known_items[ix];
+    if (known_item->id == TWEAK_INVALID_ID) {
+      continue;
+    }
+    if (!tweak_id_map_insert(&session->announced_ids, known_item->id, 0)) {
+      return false;
+    }
+    tweak_item* item = tweak_model_find_item_by_id(model, known_item->id);
+    if (item != NULL && item->version != known_item->version
+      && !append_snapshot_id(stale, known_item->id))
+    {
+      return false;
+    }
+  }
+  return true;
+}
+
+static void session_subscribe(tweak_id tweak_id, void* cookie) {
+  (void) tweak_id;
+  TWEAK_LOG_TRACE_ENTRY("tweak_id = %" PRId64 ", cookie = %p", tweak_id, cookie);
+  struct server_session* session = cookie;
+  flush_pending_changes(session);
+  if (!announce_server_features(session)) {
+    return;
+  }
+
+  if (!apply_requested_uri_patterns(session)) {
+    TWEAK_LOG_WARN("Can't handle subscribe request, can't parse uri patterns");
+    return;
+  }
+
+  /* Session shared by all clients can't tell which one has subscribed,
+   * so whole selection is sent again */
+  struct tweak_id_map no_ids = { 0 };
+  struct subscribe_snapshot snapshot = {
+    .announced_ids = session->peer != TWEAK_PICKLE_ALL_PEERS ? &session->announced_ids : &no_ids
+  };
+  /* Items client has kept are neither announced again nor changed unless their versions differ */
+  tweak_pickle_known_item* known_items;
+  size_t known_items_size = take_known_items(session, &known_items);
+  struct subscribe_snapshot stale = { 0 };
+  tweak_app_context context = &session->server_impl->base;
   tweak_common_rwlock_read_lock(&context->model_impl.model_lock);
-  bool walk_success = tweak_model_uri_to_tweak_id_index_walk(context->model_impl.index,
-    &subscribe_walk_proc, context);
+  bool walk_success = seed_known_items(session, known_items, known_items_size, &stale)
+    && tweak_app_uri_filter_walk(&session->uri_filter, context->model_impl.index,
+      &snapshot_walk_proc, &snapshot);
   if (walk_success) {
-    tweak_app_context_private_set_connected(context, true);
-    TWEAK_LOG_TRACE("Client connected. Updates shall be propagated to client.");
-  } else {
-    TWEAK_LOG_WARN("Can't handle subscribe request, status is still offline");
+    /* Items added or changed from now on are propagated by their own jobs
+     * queued after this one, so the client won't miss any update */
+    set_session_subscribed(session, true);
   }
   tweak_common_rwlock_read_unlock(&context->model_impl.model_lock);
+
+  if (!walk_success) {
+    TWEAK_LOG_WARN("Can't handle subscribe request, status is still offline");
+  } else if ((session->peer == TWEAK_PICKLE_ALL_PEERS
+      || retract_unselected_items(session, &snapshot.selected_ids))
+    && stream_snapshot(session, &snapshot))
+  {
+    TWEAK_LOG_TRACE("Client %u subscribed. Updates shall be propagated to client.", session->peer);
+    if (known_items_size > 0) {
+      TWEAK_LOG_DEBUG("Client %u resynchronized: %zu items kept, %zu announced, %zu changed",
+        session->peer, known_items_size, snapshot.size, stale.size);
+    }
+    /* Retracted items are skipped since they aren't announced anymore */
+    for (size_t ix = 0; ix < stale.size; ++ix) {
+      session_change(stale.ids[ix], session);
+    }
+  } else {
+    set_session_subscribed(session, false);
+    TWEAK_LOG_WARN("Can't handle subscribe request, status is offline");
+  }
+  free(known_items);
+  free(stale.ids);
+  free(snapshot.ids);
+  tweak_id_map_destroy(&snapshot.selected_ids);
 }
 
-static void push_subscribe(tweak_app_context context) {
-  TWEAK_LOG_TRACE_ENTRY("context = %p", context);
+static void push_session_job(struct server_session* session, job_proc job_proc, tweak_id tweak_id) {
   struct job job = {
-    .job_proc = &io_loop_subscribe,
-    .tweak_id = TWEAK_INVALID_ID,
-    .cookie = context
+    .job_proc = job_proc,
+    .tweak_id = tweak_id,
+    .cookie = session
   };
-  tweak_app_queue_push(context->job_queue, &job);
+  tweak_app_queue_push(session->job_queue, &job);
+}
+
+/**
+ * @brief Push a copy of @p job to queues of all sessions, cookie is replaced by session.
+ * Sessions queues merge jobs rather than block, so this never waits for clients.
+ */
+static void fan_out_job(struct tweak_app_context_server_impl* server_impl, struct job job) {
+  tweak_common_mutex_lock(&server_impl->base.conn_state_lock);
+  for (struct server_session* session = server_impl->sessions; session; session = session->next) {
+    job.cookie = session;
+    tweak_app_queue_push(session->job_queue, &job);
+  }
+  tweak_common_mutex_unlock(&server_impl->base.conn_state_lock);
+}
+
+static void fan_out(struct tweak_app_context_server_impl* server_impl, job_proc job_proc,
+  tweak_id tweak_id)
+{
+  struct job job = {
+    .job_proc = job_proc,
+    .tweak_id = tweak_id
+  };
+  fan_out_job(server_impl, job);
 }
 
 static void log_remote_features_change(const struct tweak_app_features *old,
@@ -187,25 +1021,95 @@ static void announce_features_impl(tweak_pickle_features* announce_features,
 
   if (!parse_success) {
     tweak_app_features_init_default(&features);
+    features.change_items = false;
+    features.packed_vectors = false;
+    features.partial_changes = false;
     TWEAK_LOG_WARN("Can't parse server features, using scalar tweaks only");
   }
 
+  struct tweak_app_features my_supported_features = { 0 };
+  tweak_app_features_init_default(&my_supported_features);
+
   tweak_common_mutex_lock(&server_impl->base.conn_state_lock);
-  features = tweak_app_features_combine(
-          &server_impl->base.remote_peer_features,
-          &features);
+  struct server_session* session = acquire_sender_session_locked(server_impl);
+  if (session) {
+    features = tweak_app_features_combine(
+            &my_supported_features,
+            &features);
 
-  log_remote_features_change(&server_impl->base.remote_peer_features, &features);
+    log_remote_features_change(&session->remote_peer_features, &features);
 
-  server_impl->base.remote_peer_features = features;
-  server_impl->features_announced = parse_success;
+    session->remote_peer_features = features;
+    session->features_announced = parse_success;
+    tweak_pickle_server_set_packed_vectors(session->rpc_endpoint, features.packed_vectors);
+  }
   tweak_common_mutex_unlock(&server_impl->base.conn_state_lock);
 }
 
 static void subscribe_tweak_pickle_impl(tweak_pickle_subscribe* subscribe, void *cookie) {
-  (void)subscribe;
   TWEAK_LOG_TRACE_ENTRY("subscribe = %p, cookie = %p", subscribe, cookie);
-  push_subscribe(cookie);
+  struct tweak_app_context_server_impl* server_impl = cookie;
+  tweak_common_mutex_lock(&server_impl->base.conn_state_lock);
+  struct server_session* session = acquire_sender_session_locked(server_impl);
+  if (session) {
+    tweak_variant_swap_string(&session->requested_uri_patterns, &subscribe->uri_patterns);
+    free(session->requested_known_items);
+    session->requested_model_epoch = subscribe->model_epoch;
+    session->requested_known_items = subscribe->known_items;
+    session->requested_known_items_size = subscribe->known_items_size;
+    subscribe->known_items = NULL;
+    subscribe->known_items_size = 0;
+    push_session_job(session, &session_subscribe, TWEAK_INVALID_ID);
+  }
+  tweak_common_mutex_unlock(&server_impl->base.conn_state_lock);
+}
+
+static void count_change_event(struct tweak_app_context_server_impl* server_impl) {
+  tweak_common_mutex_lock(&server_impl->callback_stats_lock);
+  ++server_impl->callback_stats.change_count;
+  tweak_common_mutex_unlock(&server_impl->callback_stats_lock);
+}
+
+static void invoke_value_changed_callback(struct tweak_app_context_server_impl* server_impl,
+  tweak_id id, tweak_variant* value)
+{
+  TWEAK_LOG_TRACE("Invoking on_current_value_changed callback on tweak_id = %" PRId64 "", id);
+  tweak_common_timestamp start;
+  tweak_common_timestamp end;
+  tweak_common_timestamp_now(&start);
+  server_impl->server_callbacks.on_current_value_changed(&server_impl->base,
+    id, value, server_impl->server_callbacks.cookie);
+  tweak_common_timestamp_now(&end);
+  uint64_t elapsed = tweak_common_timestamp_subtract_timestamps(&end, &start);
+  tweak_common_mutex_lock(&server_impl->callback_stats_lock);
+  ++server_impl->callback_stats.callback_count;
+  server_impl->callback_stats.callback_total_ns += elapsed;
+  if (elapsed > server_impl->callback_stats.callback_max_ns) {
+    server_impl->callback_stats.callback_max_ns = elapsed;
+  }
+  tweak_common_mutex_unlock(&server_impl->callback_stats_lock);
+}
+
+/**
+ * @brief Job of callback_queue. Coalesced changes are reported once,
+ * so the value is taken when the job runs rather than when it's queued.
+ */
+static void dispatch_value_changed(tweak_id tweak_id, void* cookie) {
+  struct tweak_app_context_server_impl* server_impl = cookie;
+  struct tweak_model_impl* model = &server_impl->base.model_impl;
+  tweak_variant value = TWEAK_VARIANT_INIT_EMPTY;
+  tweak_common_rwlock_read_lock(&model->model_lock);
+  tweak_item* item = tweak_model_find_item_by_id(model->model, tweak_id);
+  if (item) {
+    value = tweak_variant_copy(&item->current_value);
+  }
+  tweak_common_rwlock_read_unlock(&model->model_lock);
+  if (item) {
+    invoke_value_changed_callback(server_impl, tweak_id, &value);
+  } else {
+    TWEAK_LOG_TRACE("Item with tweak_id = %" PRId64 " has been removed before callback", tweak_id);
+  }
+  tweak_variant_destroy(&value);
 }
 
 static void change_item_pickle_impl(tweak_pickle_change_item *change, void *cookie) {
@@ -213,53 +1117,105 @@ static void change_item_pickle_impl(tweak_pickle_change_item *change, void *cook
   struct tweak_app_context_server_impl* server_impl = cookie;
   struct tweak_model_impl* model = &server_impl->base.model_impl;
   bool emit_change_event = false;
+  bool changed = false;
+  size_t count = 0;
   tweak_id id = TWEAK_INVALID_ID;
   tweak_variant value = TWEAK_VARIANT_INIT_EMPTY;
   tweak_common_rwlock_write_lock(&model->model_lock);
   tweak_item* item = tweak_model_find_item_by_id(model->model, change->id);
-  if (item != NULL &&
+  if (item != NULL && change->partial) {
+    count = tweak_variant_get_item_count(&change->value);
+    if (tweak_app_context_private_apply_partial_value(&item->current_value, change->offset,
+      &change->value, &changed))
+    {
+      TWEAK_LOG_TRACE("Range of item with tweak_id = %" PRId64 " has been updated", change->id);
+      id = item->id;
+      if (changed) {
+        tweak_app_context_private_touch_item(model, item);
+      }
+      if (changed && server_impl->server_callbacks.on_current_value_changed) {
+        if (!server_impl->callback_queue) {
+          value = tweak_variant_copy(&item->current_value);
+        }
+        emit_change_event = true;
+      }
+    } else {
+      TWEAK_LOG_WARN("Ignored partial change request: invalid range of tweak_id = %" PRIu64 "", change->id);
+    }
+  } else if (item != NULL &&
     tweak_app_context_private_check_value_compatibility(&item->current_value, &change->value))
   {
     tweak_variant_swap(&item->current_value, &change->value);
+    tweak_model_scalar_cache_update(model->scalar_cache, change->id, &item->current_value);
     TWEAK_LOG_TRACE("Item with tweak_id = %" PRId64 " has been updated", change->id);
     id = item->id;
 
-    bool changed = !tweak_variant_is_equal(&item->current_value, &change->value);
+    changed = !tweak_variant_is_equal(&item->current_value, &change->value);
+    if (changed) {
+      tweak_app_context_private_touch_item(model, item);
+    }
 
     if (changed && server_impl->server_callbacks.on_current_value_changed) {
-      value = tweak_variant_copy(&item->current_value);
+      if (!server_impl->callback_queue) {
+        value = tweak_variant_copy(&item->current_value);
+      }
       emit_change_event = true;
     }
   } else {
-    TWEAK_LOG_WARN("Ignored change request: Unknown tweak_id =  %" PRIu64 "", item->id);
+    TWEAK_LOG_WARN("Ignored change request: Unknown tweak_id =  %" PRIu64 "", change->id);
   }
   tweak_common_rwlock_write_unlock(&model->model_lock);
+  if (changed) {
+    tweak_app_changes_record(&server_impl->base.changes, id);
+  }
   if (emit_change_event) {
-    TWEAK_LOG_TRACE("Invoking on_current_value_changed callback on tweak_id = %" PRId64 "", id);
-    server_impl->server_callbacks.on_current_value_changed(&server_impl->base,
-      id, &value, server_impl->server_callbacks.cookie);
-    tweak_variant_destroy(&value);
+    count_change_event(server_impl);
+    if (server_impl->callback_queue) {
+      struct job job = {
+        .job_proc = &dispatch_value_changed,
+        .tweak_id = id,
+        .cookie = server_impl
+      };
+      tweak_app_queue_push(server_impl->callback_queue, &job);
+    } else {
+      invoke_value_changed_callback(server_impl, id, &value);
+      tweak_variant_destroy(&value);
+    }
   }
 
-  server_push_changes(&server_impl->base, id);
+  if (!change->partial) {
+    server_push_changes(&server_impl->base, id);
+  } else if (changed) {
+    server_push_partial_changes(&server_impl->base, id, (size_t)change->offset, count);
+  }
 }
 
-static void connection_state_pickle_impl(tweak_pickle_connection_state connection_state,
-  void *cookie)
+static void peer_state_pickle_impl(tweak_pickle_peer peer,
+  tweak_pickle_connection_state connection_state, void *cookie)
 {
-  TWEAK_LOG_TRACE_ENTRY("connection_state = %d, cookie = %p",
-    connection_state, cookie);
+  TWEAK_LOG_TRACE_ENTRY("peer = %u, connection_state = %d, cookie = %p",
+    peer, connection_state, cookie);
   struct tweak_app_context_server_impl* server_impl = cookie;
+  struct server_session* session;
   switch (connection_state) {
   case TWEAK_PICKLE_CONNECTED:
-    TWEAK_LOG_TRACE("Client connected.");
+    TWEAK_LOG_TRACE("Client %u connected.", peer);
     tweak_common_mutex_lock(&server_impl->base.conn_state_lock);
-    tweak_app_features_init_default(&server_impl->base.remote_peer_features);
+    acquire_session_locked(server_impl, peer);
     tweak_common_mutex_unlock(&server_impl->base.conn_state_lock);
     break;
   case TWEAK_PICKLE_DISCONNECTED:
-    TWEAK_LOG_TRACE("Client disconnected.");
-    tweak_app_context_private_set_connected(&server_impl->base, false);
+    TWEAK_LOG_TRACE("Client %u disconnected.", peer);
+    tweak_common_mutex_lock(&server_impl->base.conn_state_lock);
+    session = find_session_locked(server_impl, peer);
+    if (session) {
+      unlink_session_locked(server_impl, session);
+    }
+    tweak_common_mutex_unlock(&server_impl->base.conn_state_lock);
+    if (session) {
+      TWEAK_LOG_DEBUG("Client %u detached", peer);
+      release_session(session);
+    }
     break;
   default:
     TWEAK_LOG_ERROR("Unexpected enum value: %u", connection_state);
@@ -267,30 +1223,38 @@ static void connection_state_pickle_impl(tweak_pickle_connection_state connectio
   }
 }
 
-static void clean_pickle_add_item(tweak_pickle_add_item* add_item) {
-  TWEAK_LOG_TRACE_ENTRY("add_item = %p", add_item);
-  tweak_variant_destroy_string(&add_item->uri);
-  tweak_variant_destroy_string(&add_item->meta);
-  tweak_variant_destroy_string(&add_item->description);
-  tweak_variant_destroy(&add_item->default_value);
-  tweak_variant_destroy(&add_item->current_value);
-}
-
-static void io_loop_append(tweak_id tweak_id, void* cookie) {
+static void session_append(tweak_id tweak_id, void* cookie) {
   TWEAK_LOG_TRACE_ENTRY("tweak_id = %" PRIu64 ", cookie = %p", tweak_id, cookie);
-  struct tweak_app_context_server_impl* server_impl = cookie;
-  struct tweak_model_impl* model = &server_impl->base.model_impl;
+  struct server_session* session = cookie;
+  struct tweak_model_impl* model = &session->server_impl->base.model_impl;
   tweak_item* item;
   tweak_pickle_add_item pickle_add_item = { 0 };
+  if (!session->subscribed) {
+    return;
+  }
+  struct tweak_app_features features = get_session_features(session);
+  flush_pending_changes(session);
   tweak_common_rwlock_write_lock(&model->model_lock);
   item = tweak_model_find_item_by_id(model->model, tweak_id);
-  if (item != NULL) {
+  if (item != NULL && (tweak_id_map_contains(&session->announced_ids, tweak_id)
+    || !tweak_app_uri_filter_match(&session->uri_filter, tweak_interned_string_c_str(item->cold->uri))))
+  {
+    TWEAK_LOG_TRACE("Item with tweak_id = %" PRIu64 " isn't subscribed to", tweak_id);
+    item = NULL;
+  } else if (item != NULL && !tweak_app_features_check_type_compatibility(&features, item->variant_type)) {
+    TWEAK_LOG_TRACE("Item with tweak_id = %" PRIu64 " isn't supported by client", tweak_id);
+    item = NULL;
+  } else if (item != NULL && !tweak_id_map_insert(&session->announced_ids, tweak_id, 0)) {
+    TWEAK_LOG_ERROR("Can't announce item with tweak_id = %" PRIu64 "", tweak_id);
+    item = NULL;
+  } else if (item != NULL) {
     pickle_add_item.id = item->id;
-    pickle_add_item.uri = tweak_variant_string_copy(&item->uri);
-    pickle_add_item.meta = tweak_variant_string_copy(&item->meta);
-    pickle_add_item.description = tweak_variant_string_copy(&item->description);
-    pickle_add_item.default_value = tweak_variant_copy(&item->default_value);
+    pickle_add_item.uri = tweak_interned_string_copy(item->cold->uri);
+    pickle_add_item.meta = tweak_variant_string_copy(&item->cold->meta);
+    pickle_add_item.description = tweak_variant_string_copy(&item->cold->description);
+    pickle_add_item.default_value = tweak_variant_copy(&item->cold->default_value);
     pickle_add_item.current_value = tweak_variant_copy(&item->current_value);
+    pickle_add_item.version = item->version;
   } else {
     TWEAK_LOG_WARN("execute_add_item_task: Unknown tweak_id = %" PRIu64 "", tweak_id);
   }
@@ -298,7 +1262,7 @@ static void io_loop_append(tweak_id tweak_id, void* cookie) {
   if (item) {
     TWEAK_LOG_TRACE("Propagating add_item request to client = %" PRIu64 "", item->id);
     tweak_pickle_call_result call_result =
-      tweak_pickle_server_add_item(server_impl->rpc_endpoint, &pickle_add_item);
+      tweak_pickle_server_add_item(session->rpc_endpoint, &pickle_add_item);
     if (call_result != TWEAK_PICKLE_SUCCESS) {
        TWEAK_LOG_WARN("failed tweak_pickle_server_add_item RPC call on id = %" PRIu64 "", tweak_id);
     }
@@ -306,6 +1270,11 @@ static void io_loop_append(tweak_id tweak_id, void* cookie) {
   }
 }
 
+static void io_loop_append(tweak_id tweak_id, void* cookie) {
+  TWEAK_LOG_TRACE_ENTRY("tweak_id = %" PRIu64 ", cookie = %p", tweak_id, cookie);
+  fan_out(cookie, &session_append, tweak_id);
+}
+
 static void push_append(tweak_app_context context, tweak_id tweak_id) {
   TWEAK_LOG_TRACE_ENTRY("context = %p, tweak_id = %" PRIu64 "", context, tweak_id);
   struct job job = {
@@ -316,34 +1285,118 @@ static void push_append(tweak_app_context context, tweak_id tweak_id) {
   tweak_app_queue_push(context->job_queue, &job);
 }
 
-static void io_loop_change(tweak_id tweak_id, void* cookie) {
+/**
+ * @brief Send @p change to client or defer it till the end of batch.
+ * Value of @p change is consumed.
+ */
+static void send_change(struct server_session* session, tweak_pickle_change_item* change,
+  bool batch_changes)
+{
+  if (batch_changes && append_pending_change(session, change)) {
+    TWEAK_LOG_TRACE("change_item request on id = %" PRIu64 " is deferred till the end of batch", change->id);
+  } else {
+    TWEAK_LOG_TRACE("Propagating change_item request to client = %" PRIu64 "", change->id);
+    tweak_pickle_call_result result =
+      tweak_pickle_server_change_item(session->rpc_endpoint, change);
+    if (result != TWEAK_PICKLE_SUCCESS) {
+      TWEAK_LOG_WARN("failed tweak_pickle_server_change_item RPC call on id = %" PRIu64 "", change->id);
+    }
+  }
+  tweak_variant_destroy(&change->value);
+}
+
+static void session_change(tweak_id tweak_id, void* cookie) {
   TWEAK_LOG_TRACE_ENTRY("tweak_id = %" PRIu64 ", cookie = %p", tweak_id, cookie);
-  struct tweak_app_context_server_impl* server_impl = cookie;
-  struct tweak_model_impl* model = &server_impl->base.model_impl;
+  struct server_session* session = cookie;
+  struct tweak_model_impl* model = &session->server_impl->base.model_impl;
   tweak_variant value = TWEAK_VARIANT_INIT_EMPTY;
+  uint64_t version = 0;
   bool should_push_change = false;
+  bool batch_changes = get_session_features(session).change_items;
   tweak_common_rwlock_read_lock(&model->model_lock);
   tweak_item* item = tweak_model_find_item_by_id(model->model, tweak_id);
   if (item != NULL) {
-    value = tweak_variant_copy(&item->current_value);
-    should_push_change = tweak_app_context_private_is_connected(&server_impl->base);
+    should_push_change = session->subscribed
+      && tweak_id_map_contains(&session->announced_ids, tweak_id);
+    if (should_push_change) {
+      value = tweak_variant_copy(&item->current_value);
+      version = item->version;
+    }
   } else {
     TWEAK_LOG_WARN("change_item_callback: Unknown tweak_id = %" PRIu64 "\n", tweak_id);
   }
   tweak_common_rwlock_read_unlock(&model->model_lock);
   if (should_push_change) {
-    TWEAK_LOG_TRACE("Propagating change_item request to client = %" PRIu64 "", item->id);
     tweak_pickle_change_item change = {
       .id = tweak_id,
-      .value = value
+      .value = value,
+      .version = version
     };
-    tweak_pickle_call_result result =
-      tweak_pickle_server_change_item(server_impl->rpc_endpoint, &change);
-    if (result != TWEAK_PICKLE_SUCCESS) {
-      TWEAK_LOG_WARN("failed tweak_pickle_server_change_item RPC call on id = %" PRIu64 "", tweak_id);
+    send_change(session, &change, batch_changes);
+  } else {
+    tweak_variant_destroy(&value);
+  }
+}
+
+/**
+ * @brief Propagate a range of vector item. Clients that haven't announced
+ * partial_changes feature are sent the whole value. Partial changes
+ * carry version 0, so the item is resent after reconnect.
+ */
+static void session_partial_change(tweak_id tweak_id, size_t offset, size_t count, void* cookie) {
+  TWEAK_LOG_TRACE_ENTRY("tweak_id = %" PRIu64 ", offset = %zu, count = %zu, cookie = %p",
+    tweak_id, offset, count, cookie);
+  struct server_session* session = cookie;
+  struct tweak_model_impl* model = &session->server_impl->base.model_impl;
+  struct tweak_app_features features = get_session_features(session);
+  tweak_pickle_change_item change = {
+    .id = tweak_id,
+    .value = TWEAK_VARIANT_INIT_EMPTY,
+    .partial = true,
+    .offset = offset
+  };
+  bool should_push_change = false;
+  if (!features.partial_changes) {
+    session_change(tweak_id, cookie);
+    return;
+  }
+  tweak_common_rwlock_read_lock(&model->model_lock);
+  tweak_item* item = tweak_model_find_item_by_id(model->model, tweak_id);
+  if (item != NULL) {
+    should_push_change = session->subscribed
+      && tweak_id_map_contains(&session->announced_ids, tweak_id);
+    if (should_push_change && offset == 0 && count == tweak_variant_get_item_count(&item->current_value)) {
+      change.value = tweak_variant_copy(&item->current_value);
+      change.version = item->version;
+      change.partial = false;
+    } else if (should_push_change) {
+      should_push_change = tweak_app_context_private_copy_vector_range(&item->current_value,
+        offset, count, &change.value);
     }
+  } else {
+    TWEAK_LOG_WARN("partial_change_item_callback: Unknown tweak_id = %" PRIu64 "\n", tweak_id);
   }
-  tweak_variant_destroy(&value);
+  tweak_common_rwlock_read_unlock(&model->model_lock);
+  if (should_push_change) {
+    send_change(session, &change, features.change_items);
+  }
+}
+
+static void io_loop_change(tweak_id tweak_id, void* cookie) {
+  TWEAK_LOG_TRACE_ENTRY("tweak_id = %" PRIu64 ", cookie = %p", tweak_id, cookie);
+  fan_out(cookie, &session_change, tweak_id);
+}
+
+static void io_loop_partial_change(tweak_id tweak_id, size_t offset, size_t count, void* cookie) {
+  TWEAK_LOG_TRACE_ENTRY("tweak_id = %" PRIu64 ", offset = %zu, count = %zu, cookie = %p",
+    tweak_id, offset, count, cookie);
+  struct job job = {
+    .range_job_proc = &session_partial_change,
+    .tweak_id = tweak_id,
+    .offset = offset,
+    .count = count
+  };
+  fan_out_job(cookie, job);
 }
 
 static void server_push_changes(tweak_app_context context, tweak_id tweak_id) {
@@ -356,19 +1409,70 @@ static void server_push_changes(tweak_app_context context, tweak_id tweak_id) {
   tweak_app_queue_push(context->job_queue, &job);
 }
 
-static void io_loop_remove(tweak_id tweak_id, void* cookie) {
+static void server_push_partial_changes(tweak_app_context context, tweak_id tweak_id,
+  size_t offset, size_t count)
+{
+  TWEAK_LOG_TRACE_ENTRY("context = %p, tweak_id = %" PRIu64 ", offset = %zu, count = %zu",
+    context, tweak_id, offset, count);
+  struct job job = {
+    .range_job_proc = &io_loop_partial_change,
+    .tweak_id = tweak_id,
+    .offset = offset,
+    .count = count,
+    .cookie = context
+  };
+  tweak_app_queue_push(context->job_queue, &job);
+}
+
+/* Batch bypasses context's job queue: jobs are pushed straight to every session
+ * within one queue operation, so session sends them in one change_items message. */
+static void server_push_changes_batch(tweak_app_context context, const tweak_id* tweak_ids,
+  size_t count)
+{
+  TWEAK_LOG_TRACE_ENTRY("context = %p, tweak_ids = %p, count = %zu", context, tweak_ids, count);
+  struct tweak_app_context_server_impl* server_impl = (struct tweak_app_context_server_impl*)context;
+  struct job* jobs = calloc(count, sizeof(*jobs));
+  if (!jobs) {
+    TWEAK_FATAL("Can't allocate memory");
+  }
+  for (size_t ix = 0; ix < count; ++ix) {
+    jobs[ix].job_proc = &session_change;
+    jobs[ix].tweak_id = tweak_ids[ix];
+  }
+  tweak_common_mutex_lock(&server_impl->base.conn_state_lock);
+  for (struct server_session* session = server_impl->sessions; session; session = session->next) {
+    for (size_t ix = 0; ix < count; ++ix) {
+      jobs[ix].cookie = session;
+    }
+    tweak_app_queue_push_batch(session->job_queue, jobs, count);
+  }
+  tweak_common_mutex_unlock(&server_impl->base.conn_state_lock);
+  free(jobs);
+}
+
+static void session_remove(tweak_id tweak_id, void* cookie) {
   TWEAK_LOG_TRACE_ENTRY("tweak_id = %" PRIu64 ", cookie = %p", tweak_id, cookie);
-  struct tweak_app_context_server_impl* server_impl = cookie;
+  struct server_session* session = cookie;
   tweak_pickle_remove_item remove_item = {
     .id = tweak_id
   };
+  if (!tweak_id_map_remove(&session->announced_ids, tweak_id)) {
+    TWEAK_LOG_TRACE("Item with tweak_id = %" PRIu64 " hasn't been announced", tweak_id);
+    return;
+  }
+  flush_pending_changes(session);
   tweak_pickle_call_result call_result =
-    tweak_pickle_server_remove_item(server_impl->rpc_endpoint, &remove_item);
+    tweak_pickle_server_remove_item(session->rpc_endpoint, &remove_item);
   if (call_result != TWEAK_PICKLE_SUCCESS) {
-    TWEAK_LOG_WARN("failed tweak_pickle_server_add_item RPC call on id = %" PRIu64 "", tweak_id);
+    TWEAK_LOG_WARN("failed tweak_pickle_server_remove_item RPC call on id = %" PRIu64 "", tweak_id);
   }
 }
 
+static void io_loop_remove(tweak_id tweak_id, void* cookie) {
+  TWEAK_LOG_TRACE_ENTRY("tweak_id = %" PRIu64 ", cookie = %p", tweak_id, cookie);
+  fan_out(cookie, &session_remove, tweak_id);
+}
+
 static void push_remove(tweak_app_context context, tweak_id tweak_id) {
   TWEAK_LOG_TRACE_ENTRY("context = %p, tweak_id = %" PRIu64 "", context, tweak_id);
   struct job job = {
@@ -407,27 +1511,69 @@ tweak_app_server_context tweak_app_create_server_context(const char *context_typ
         .callback = &change_item_pickle_impl,
         .cookie = server_impl
       },
-      .connection_state_listener = {
-        .callback = &connection_state_pickle_impl,
+      .peer_state_listener = {
+        .callback = &peer_state_pickle_impl,
         .cookie = server_impl
       }
     }
   };
 
-  if (!tweak_app_context_private_initialize_base(&server_impl->base, TWEAK_APP_SERVER_QUEUE_SIZE)) {
-    goto destroy_context;
+  tweak_app_io_mode io_mode = server_callbacks ? server_callbacks->io_mode : TWEAK_APP_IO_MODE_THREAD;
+  if (!tweak_app_context_private_initialize_base(&server_impl->base, TWEAK_APP_SERVER_QUEUE_SIZE, io_mode)) {
+    free(server_impl);
+    return NULL;
   }
+  tweak_common_mutex_init(&server_impl->callback_stats_lock);
 
   server_impl->base.clone_current_value_proc = &tweak_app_context_private_item_clone_current_value;
+  server_impl->base.read_item_proc = &tweak_app_context_private_item_read;
   server_impl->base.replace_current_value_proc = &tweak_app_context_private_item_replace_current_value;
+  server_impl->base.replace_values_proc = &tweak_app_context_private_item_replace_values;
+  server_impl->base.load_vector_range_proc = &tweak_app_context_private_item_load_vector_range;
+  server_impl->base.store_vector_range_proc = &tweak_app_context_private_item_store_vector_range;
+  server_impl->base.clone_current_value_by_handle_proc = &tweak_app_context_private_item_clone_current_value_by_handle;
+  server_impl->base.replace_current_value_by_handle_proc = &tweak_app_context_private_item_replace_current_value_by_handle;
   server_impl->base.push_changes_proc = &server_push_changes;
+  server_impl->base.push_partial_changes_proc = &server_push_partial_changes;
+  server_impl->base.push_changes_batch_proc = &server_push_changes_batch;
+  server_impl->base.flush_queue_proc = &server_flush_queue;
+  server_impl->base.poll_proc = &server_poll;
   server_impl->base.destroy_context = &server_destroy_context;
+  /* Sessions check item types against features of their clients */
+  tweak_app_features_init_default(&server_impl->base.remote_peer_features);
+  server_impl->base.model_impl.epoch = generate_model_epoch();
 
   if (server_callbacks) {
     server_impl->server_callbacks = *server_callbacks;
   }
 
+  if (server_impl->server_callbacks.on_current_value_changed
+    && server_impl->server_callbacks.callback_dispatch == TWEAK_APP_CALLBACK_DISPATCH_EXECUTOR)
+  {
+    /* Receiving thread shall never block on slow callbacks */
+    server_impl->callback_queue = tweak_app_queue_create(TWEAK_APP_SERVER_QUEUE_SIZE);
+    if (!server_impl->callback_queue
+      || !tweak_app_queue_set_policy(server_impl->callback_queue, JOB_QUEUE_POLICY_MERGE))
+    {
+      TWEAK_LOG_ERROR("Can't create callback queue");
+      goto destroy_context;
+    }
+    if (io_mode != TWEAK_APP_IO_MODE_POLL
+      && tweak_common_thread_create(&server_impl->callback_thread, &callback_loop, server_impl)
+        != TWEAK_COMMON_THREAD_SUCCESS)
+    {
+      TWEAK_LOG_ERROR("Platform specific threading error in tweak_common_thread_create()");
+      tweak_app_queue_destroy(server_impl->callback_queue);
+      server_impl->callback_queue = NULL;
+      goto destroy_context;
+    }
+  }
+
+  /* Listeners can be invoked by transport threads before endpoint is returned,
+   * they need it to tell clients apart and wait on the lock till it's set */
+  tweak_common_mutex_lock(&server_impl->base.conn_state_lock);
   server_impl->rpc_endpoint = tweak_pickle_create_server_endpoint(&server_descriptor);
+  tweak_common_mutex_unlock(&server_impl->base.conn_state_lock);
   if (!server_impl->rpc_endpoint) {
     goto destroy_context;
   }
@@ -468,6 +1614,7 @@ tweak_id tweak_app_server_add_item(tweak_app_server_context server_context,
 
   tweak_model_error_code model_error_code;
   tweak_model_index_result index_result;
+  tweak_item* item;
 
   tweak_common_rwlock_write_lock(&model->model_lock);
   if (tweak_model_uri_to_tweak_id_index_lookup(model->index, uri) != TWEAK_INVALID_ID) {
@@ -494,6 +1641,16 @@ tweak_id tweak_app_server_add_item(tweak_app_server_context server_context,
     goto error;
   }
 
+  item = tweak_model_find_item_by_id(model->model, tweak_id);
+  if (!tweak_model_scalar_cache_insert(model->scalar_cache, tweak_id, &current_value, item)) {
+    TWEAK_LOG_ERROR("tweak_app_server_add_item: tweak_model_scalar_cache_insert failed");
+    tweak_model_uri_to_tweak_id_index_remove(model->index, uri);
+    tweak_model_remove_item(model->model, tweak_id);
+    tweak_id = TWEAK_INVALID_ID;
+    goto error;
+  }
+  tweak_app_context_private_touch_item(model, item);
+
   should_push_change = item_is_compatible && tweak_app_context_private_is_connected(server_context);
 error:
   tweak_common_rwlock_write_unlock(&model->model_lock);
@@ -528,6 +1685,17 @@ void* tweak_app_item_get_cookie(tweak_app_server_context server_context, tweak_i
   return item_cookie;
 }
 
+void tweak_app_server_get_callback_stats(tweak_app_server_context server_context,
+  tweak_app_server_callback_stats* stats)
+{
+  TWEAK_LOG_TRACE_ENTRY("server_context = %p, stats = %p", server_context, stats);
+  struct tweak_app_context_server_impl* server_impl =
+    (struct tweak_app_context_server_impl*)server_context;
+  tweak_common_mutex_lock(&server_impl->callback_stats_lock);
+  *stats = server_impl->callback_stats;
+  tweak_common_mutex_unlock(&server_impl->callback_stats_lock);
+}
+
 bool tweak_app_server_remove_item(tweak_app_server_context server_context, tweak_id id) {
   TWEAK_LOG_TRACE_ENTRY("server_context = %p, tweak_id = %" PRIu64 "", server_context, id);
   bool result = false;
@@ -542,7 +1710,8 @@ bool tweak_app_server_remove_item(tweak_app_server_context server_context, tweak
     bool item_is_compatible =
       tweak_app_features_check_type_compatibility(&server_context->remote_peer_features, item->variant_type);
     tweak_model_uri_to_tweak_id_index_remove(model->index,
-    tweak_variant_string_c_str(&item->uri));
+    tweak_interned_string_c_str(item->cold->uri));
+    tweak_model_scalar_cache_remove(model->scalar_cache, id);
     tweak_model_remove_item(model->model, id);
     result = true;
     should_push_change = item_is_compatible && tweak_app_context_private_is_connected(server_context);
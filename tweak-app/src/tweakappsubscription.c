@@ -0,0 +1,154 @@
+/**
+ * @file tweakappsubscription.c
+ * @ingroup tweak-internal
+ *
+ * @brief part of tweak2 application implementation.
+ *
+ * @copyright 2020-2023 Cogent Embedded, Inc. ALL RIGHTS RESERVED.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <tweak2/log.h>
+
+#include "tweakappsubscription.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+static bool is_pattern_separator(char c) {
+  return c == ';';
+}
+
+static bool is_whitespace(char c) {
+  return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+}
+
+static bool selects_everything(const char* pattern, size_t length) {
+  return (length == 1 && pattern[0] == '*')
+    || (length == 2 && pattern[0] == '*' && pattern[1] == '*');
+}
+
+bool tweak_app_uri_filter_init(struct tweak_app_uri_filter* filter, const char* uri_patterns) {
+  filter->patterns = NULL;
+  filter->size = 0;
+  if (!uri_patterns) {
+    return true;
+  }
+
+  size_t max_patterns = 1;
+  for (const char* p = uri_patterns; *p; ++p) {
+    if (is_pattern_separator(*p)) {
+      ++max_patterns;
+    }
+  }
+
+  char** patterns = calloc(max_patterns, sizeof(*patterns));
+  if (!patterns) {
+    TWEAK_LOG_ERROR("calloc() returned NULL");
+    return false;
+  }
+
+  size_t size = 0;
+  const char* begin = uri_patterns;
+  for (;;) {
+    const char* end = begin;
+    while (*end && !is_pattern_separator(*end)) {
+      ++end;
+    }
+    const char* next = *end ? end + 1 : NULL;
+    while (begin < end && is_whitespace(*begin)) {
+      ++begin;
+    }
+    while (end > begin && is_whitespace(end[-1])) {
+      --end;
+    }
+    size_t length = (size_t)(end - begin);
+    if (selects_everything(begin, length)) {
+      goto select_everything;
+    }
+    if (length > 0) {
+      char* pattern = malloc(length + 1);
+      if (!pattern) {
+        TWEAK_LOG_ERROR("malloc() returned NULL");
+        filter->patterns = patterns;
+        filter->size = size;
+        tweak_app_uri_filter_destroy(filter);
+        return false;
+      }
+      memcpy(pattern, begin, length);
+      pattern[length] = '\0';
+      patterns[size++] = pattern;
+    }
+    if (!next) {
+      break;
+    }
+    begin = next;
+  }
+
+  if (size == 0) {
+    goto select_everything;
+  }
+
+  filter->patterns = patterns;
+  filter->size = size;
+  return true;
+
+select_everything:
+  for (size_t ix = 0; ix < size; ++ix) {
+    free(patterns[ix]);
+  }
+  free(patterns);
+  return true;
+}
+
+void tweak_app_uri_filter_destroy(struct tweak_app_uri_filter* filter) {
+  for (size_t ix = 0; ix < filter->size; ++ix) {
+    free(filter->patterns[ix]);
+  }
+  free(filter->patterns);
+  filter->patterns = NULL;
+  filter->size = 0;
+}
+
+bool tweak_app_uri_filter_match(const struct tweak_app_uri_filter* filter, const char* uri) {
+  if (filter->size == 0) {
+    return true;
+  }
+  for (size_t ix = 0; ix < filter->size; ++ix) {
+    if (tweak_model_uri_glob_match(filter->patterns[ix], uri)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+bool tweak_app_uri_filter_walk(const struct tweak_app_uri_filter* filter,
+  tweak_model_uri_to_tweak_id_index index, tweak_model_uri_to_tweak_id_walk_proc walk_proc, void* cookie)
+{
+  if (filter->size == 0) {
+    return tweak_model_uri_to_tweak_id_index_walk(index, walk_proc, cookie);
+  }
+  for (size_t ix = 0; ix < filter->size; ++ix) {
+    if (!tweak_model_uri_to_tweak_id_index_walk_glob(index, filter->patterns[ix], walk_proc, cookie)) {
+      return false;
+    }
+  }
+  return true;
+}
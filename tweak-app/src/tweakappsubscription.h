@@ -0,0 +1,93 @@
+/**
+ * @file tweakappsubscription.h
+ * @ingroup tweak-internal
+ *
+ * @brief part of tweak2 application implementation.
+ *
+ * @copyright 2020-2023 Cogent Embedded, Inc. ALL RIGHTS RESERVED.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef TWEAK_APP_SUBSCRIPTION_H_INCLUDED
+#define TWEAK_APP_SUBSCRIPTION_H_INCLUDED
+
+#include <tweak2/types.h>
+
+#include "tweakmodel_uri_to_tweak_id_index.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+
+/**
+ * @brief Uri patterns a peer is interested in, parsed from
+ * @p tweak_pickle_subscribe.uri_patterns.
+ *
+ * @details Patterns are separated by semicolon and follow
+ * @p tweak_model_uri_glob_match syntax. Empty string, "*" or "**"
+ * among patterns select all items, @p size is 0 in this case.
+ */
+struct tweak_app_uri_filter {
+  char** patterns;
+  size_t size;
+};
+
+/**
+ * @brief Parse @p uri_patterns.
+ *
+ * @param filter filter to initialize.
+ * @param uri_patterns patterns separated by semicolon. NULL selects all items.
+ *
+ * @return false if there was memory allocation error.
+ */
+bool tweak_app_uri_filter_init(struct tweak_app_uri_filter* filter, const char* uri_patterns);
+
+/**
+ * @brief Release memory held by @p filter.
+ *
+ * @param filter filter initialized by @p tweak_app_uri_filter_init or zeroed one.
+ */
+void tweak_app_uri_filter_destroy(struct tweak_app_uri_filter* filter);
+
+/**
+ * @brief Check whether @p uri matches any of patterns.
+ *
+ * @param filter filter instance.
+ * @param uri uri to check.
+ *
+ * @return true if @p uri is selected by @p filter.
+ */
+bool tweak_app_uri_filter_match(const struct tweak_app_uri_filter* filter, const char* uri);
+
+/**
+ * @brief Walk all entries of @p index selected by @p filter.
+ *
+ * @note Entries matching several patterns are visited several times.
+ *
+ * @param filter filter instance.
+ * @param index index to walk.
+ * @param walk_proc callback to capture index entries.
+ * @param cookie opaque pointer to pass into @p walk_proc.
+ *
+ * @return false if @p walk_proc returned false.
+ */
+bool tweak_app_uri_filter_walk(const struct tweak_app_uri_filter* filter,
+  tweak_model_uri_to_tweak_id_index index, tweak_model_uri_to_tweak_id_walk_proc walk_proc, void* cookie);
+
+#endif
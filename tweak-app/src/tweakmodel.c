@@ -26,8 +26,10 @@
  */
 
 #include "tweakmodel.h"
+#include "tweakmodel_pool.h"
 
 #include <stdlib.h>
+#include <string.h>
 #include <tweak2/metadata.h>
 
 #if defined(_MSC_BUILD)
@@ -42,6 +44,9 @@
 
 #define HASH_ADD_TWEAK_ID(head, intfield, add) HASH_ADD(hh, head, intfield, sizeof(tweak_id), add)
 
+/*
+ * Pairs are kept apart from items, so hash lookups walk densely packed pairs.
+ */
 struct id_item_pair {
   tweak_id id;
   tweak_item* item;
@@ -51,6 +56,9 @@ struct id_item_pair {
 struct tweak_model_impl {
   struct tweak_model_base base;
   struct id_item_pair *pairs;
+  struct tweak_model_pool pair_pool;
+  struct tweak_model_pool item_pool;
+  struct tweak_model_pool cold_pool;
 };
 
 
@@ -63,7 +71,7 @@ static tweak_model_error_code attach_item(tweak_model model, tweak_id id,
   if (pair != NULL) {
     return TWEAK_MODEL_INDEX_ERROR;
   }
-  pair = malloc(sizeof(*pair));
+  pair = tweak_model_pool_alloc(&model_impl->pair_pool);
   if (pair == NULL) {
     return TWEAK_MODEL_BAD_ALLOC;
   }
@@ -78,43 +86,57 @@ tweak_model_error_code tweak_model_create_item(tweak_model model, tweak_id id,
   const tweak_variant_string* meta, const tweak_variant* default_value,
   const tweak_variant* current_value, void* item_cookie)
 {
+  struct tweak_model_impl* model_impl = (struct tweak_model_impl*)model;
   tweak_model_error_code model_error_code;
-  tweak_item* item = calloc(1, sizeof(*item));
-  if (item != NULL) {
+  tweak_item* item = tweak_model_pool_alloc(&model_impl->item_pool);
+  tweak_item_cold* cold = tweak_model_pool_alloc(&model_impl->cold_pool);
+  tweak_interned_string interned_uri = tweak_intern_string_n(tweak_variant_string_c_str(uri), uri->length);
+  if (item != NULL && cold != NULL && interned_uri != NULL) {
     model_error_code = attach_item(model, id, item);
     if (model_error_code == TWEAK_MODEL_SUCCESS) {
+      memset(item, 0, sizeof(*item));
+      memset(cold, 0, sizeof(*cold));
       item->id = id;
-      item->uri = tweak_variant_string_copy(uri);
-      item->description = tweak_variant_string_copy(description);
-      item->meta = tweak_variant_string_copy(meta);
-      item->default_value = tweak_variant_copy(default_value);
-      item->current_value = tweak_variant_copy(current_value);
       item->variant_type = current_value->type;
       item->item_cookie = item_cookie;
-    } else {
-      free(item);
+      item->cold = cold;
+      item->current_value = tweak_variant_copy(current_value);
+      cold->uri = interned_uri;
+      cold->description = tweak_variant_string_copy(description);
+      cold->meta = tweak_variant_string_copy(meta);
+      cold->default_value = tweak_variant_copy(default_value);
+      return TWEAK_MODEL_SUCCESS;
     }
   } else {
     model_error_code = TWEAK_MODEL_BAD_ALLOC;
   }
+  tweak_interned_string_release(interned_uri);
+  tweak_model_pool_free(&model_impl->cold_pool, cold);
+  tweak_model_pool_free(&model_impl->item_pool, item);
   return model_error_code;
 }
 
 static void destroy_item(tweak_item* item) {
-  tweak_variant_destroy_string(&item->uri);
-  tweak_variant_destroy_string(&item->description);
-  tweak_variant_destroy_string(&item->meta);
-  tweak_variant_destroy(&item->default_value);
+  tweak_item_cold* cold = item->cold;
   tweak_variant_destroy(&item->current_value);
-  if (item->metadata_initialized) {
-    tweak_metadata_destroy(item->metadata);
+  tweak_interned_string_release(cold->uri);
+  tweak_variant_destroy_string(&cold->description);
+  tweak_variant_destroy_string(&cold->meta);
+  tweak_variant_destroy(&cold->default_value);
+  if (cold->metadata_initialized) {
+    tweak_metadata_destroy(cold->metadata);
   }
-  free(item);
 }
 
 tweak_model tweak_model_create() {
   struct tweak_model_impl* model_impl = calloc(1, sizeof(*model_impl));
-  return model_impl ? &model_impl->base : NULL;
+  if (!model_impl) {
+    return NULL;
+  }
+  tweak_model_pool_init(&model_impl->pair_pool, sizeof(struct id_item_pair));
+  tweak_model_pool_init(&model_impl->item_pool, sizeof(tweak_item));
+  tweak_model_pool_init(&model_impl->cold_pool, sizeof(tweak_item_cold));
+  return &model_impl->base;
 }
 
 tweak_item* tweak_model_find_item_by_id(tweak_model model, tweak_id id) {
@@ -127,6 +149,17 @@ tweak_item* tweak_model_find_item_by_id(tweak_model model, tweak_id id) {
   return pair->item;
 }
 
+bool tweak_model_walk_items(tweak_model model, tweak_model_walk_items_proc walk_proc, void* cookie) {
+  struct tweak_model_impl* model_impl = (struct tweak_model_impl*)model;
+  struct id_item_pair *pair = NULL, *tmp = NULL;
+  HASH_ITER(hh, model_impl->pairs, pair, tmp) {
+    if (!walk_proc(pair->item, cookie)) {
+      return false;
+    }
+  }
+  return true;
+}
+
 static tweak_item* detach_item(tweak_model model, tweak_id id) {
   struct tweak_model_impl* model_impl = (struct tweak_model_impl*)model;
   struct id_item_pair *pair = NULL;
@@ -137,14 +170,17 @@ static tweak_item* detach_item(tweak_model model, tweak_id id) {
   }
   HASH_DEL(model_impl->pairs, pair);
   tweak_item = pair->item;
-  free(pair);
+  tweak_model_pool_free(&model_impl->pair_pool, pair);
   return tweak_item;
 }
 
 tweak_model_error_code tweak_model_remove_item(tweak_model model, tweak_id id) {
+  struct tweak_model_impl* model_impl = (struct tweak_model_impl*)model;
   tweak_item* item = detach_item(model, id);
   if (item != NULL) {
     destroy_item(item);
+    tweak_model_pool_free(&model_impl->cold_pool, item->cold);
+    tweak_model_pool_free(&model_impl->item_pool, item);
     return TWEAK_MODEL_SUCCESS;
   } else {
     return TWEAK_MODEL_ITEM_NOT_FOUND;
@@ -155,10 +191,13 @@ void tweak_model_destroy(tweak_model model) {
   struct tweak_model_impl* model_impl = (struct tweak_model_impl*)model;
   struct id_item_pair *pair = NULL, *tmp = NULL;
   HASH_ITER(hh, model_impl->pairs, pair, tmp) {
-    HASH_DEL(model_impl->pairs, pair);
     destroy_item(pair->item);
-    free(pair);
   }
+  /*.. Pairs and items go away with their slabs */
+  HASH_CLEAR(hh, model_impl->pairs);
+  tweak_model_pool_destroy(&model_impl->pair_pool);
+  tweak_model_pool_destroy(&model_impl->item_pool);
+  tweak_model_pool_destroy(&model_impl->cold_pool);
   free(model_impl);
 }
 
@@ -28,23 +28,22 @@
 #ifndef TWEAK_MODEL_H_INCLUDED
 #define TWEAK_MODEL_H_INCLUDED
 
+#include <tweak2/intern.h>
 #include <tweak2/string.h>
 #include <tweak2/types.h>
 #include <tweak2/variant.h>
 #include <tweak2/metadata.h>
 
 /**
- * @brief Structure to encapsulate an item.
+ * @brief Part of an item that is only needed to describe the item
+ * to peers and users. Kept apart from tweak_item, so that code dealing
+ * with ids and values doesn't drag it through the cache.
  */
 typedef struct {
   /**
-   * @brief id.
+   * @brief uri. Shared with uri index and other users of the same uri.
    */
-  tweak_id id;
-  /**
-   * @brief uri.
-   */
-  tweak_variant_string uri;
+  tweak_interned_string uri;
   /**
    * @brief description.
    */
@@ -54,30 +53,48 @@ typedef struct {
    */
   tweak_variant_string meta;
   /**
-   * @brief type.
+   * @brief default value.
    */
-  tweak_variant_type variant_type;
+  tweak_variant default_value;
   /**
-   * @brief current value.
+   * @brief Metadata was parsed. If this field is true and metadata
+   * field is NULL then string contained in meta is invalid.
    */
-  tweak_variant current_value;
+  bool metadata_initialized;
   /**
-   * @brief default value.
+   * @brief metadata instance.
    */
-  tweak_variant default_value;
+  tweak_metadata metadata;
+} tweak_item_cold;
+
+/**
+ * @brief Structure to encapsulate an item.
+ */
+typedef struct {
+  /**
+   * @brief id.
+   */
+  tweak_id id;
+  /**
+   * @brief type.
+   */
+  tweak_variant_type variant_type;
   /**
    * @brief user might provide additional context on per-item basis.
    */
   void* item_cookie;
   /**
-   * @brief Metadata was parsed. If this field is true and metadata
-   * field is NULL then string contained in meta is invalid.
+   * @brief uri, description, meta, default value and metadata.
    */
-  bool metadata_initialized;
+  tweak_item_cold* cold;
   /**
-   * @brief metadata instance.
+   * @brief current value.
    */
-  tweak_metadata metadata;
+  tweak_variant current_value;
+  /**
+   * @brief version of current value assigned by server model, 0 if unknown.
+   */
+  uint64_t version;
 } tweak_item;
 
 /**
@@ -165,6 +182,29 @@ tweak_model_error_code tweak_model_create_item(tweak_model model, tweak_id id,
  */
 tweak_item* tweak_model_find_item_by_id(tweak_model model, tweak_id id);
 
+/**
+ * @brief Callback for tweak_model_walk_items.
+ *
+ * @param item model item.
+ * @param cookie value passed to tweak_model_walk_items.
+ *
+ * @return false to stop the walk.
+ */
+typedef bool (*tweak_model_walk_items_proc)(tweak_item* item, void* cookie);
+
+/**
+ * @brief Visit every item in model in order of creation.
+ *
+ * @note This code is thread neutral, and user should provide synchronization when accessing model.
+ *
+ * @param model model instance.
+ * @param walk_proc callback to invoke for every item.
+ * @param cookie opaque pointer passed to @p walk_proc.
+ *
+ * @return false if @p walk_proc has stopped the walk.
+ */
+bool tweak_model_walk_items(tweak_model model, tweak_model_walk_items_proc walk_proc, void* cookie);
+
 /**
  * @brief Remove an item from model given its id.
  *
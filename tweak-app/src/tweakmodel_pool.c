@@ -0,0 +1,123 @@
+/**
+ * @file tweakmodel_pool.c
+ * @ingroup tweak-api
+ *
+ * @brief part of tweak2 application implementation.
+ *
+ * @copyright 2020-2022 Cogent Embedded, Inc. ALL RIGHTS RESERVED.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "tweakmodel_pool.h"
+
+#include <assert.h>
+#include <stdbool.h>
+#include <stdlib.h>
+
+/*
+ * Slabs stay below typical mmap threshold of heap allocators,
+ * so memory of a destroyed pool is reused by the next one.
+ */
+enum {
+  TWEAK_MODEL_POOL_INITIAL_SLAB_CAPACITY = 32,
+  TWEAK_MODEL_POOL_MAX_SLAB_SIZE = 64 * 1024
+};
+
+/*
+ * Strictest alignment of a fundamental type.
+ */
+union tweak_model_pool_max_align {
+  void* pointer;
+  long long long_long;
+  long double long_double;
+  void (*function)(void);
+};
+
+struct tweak_model_pool_slab {
+  union {
+    struct tweak_model_pool_slab* next;
+    union tweak_model_pool_max_align align;
+  } header;
+  /*
+   * Nodes follow immediately.
+   */
+};
+
+static size_t round_up_to_alignment(size_t size) {
+  const size_t alignment = sizeof(union tweak_model_pool_max_align);
+  return (size + alignment - 1) / alignment * alignment;
+}
+
+void tweak_model_pool_init(struct tweak_model_pool* pool, size_t node_size) {
+  assert(pool);
+  pool->node_size = round_up_to_alignment(node_size < sizeof(void*) ? sizeof(void*) : node_size);
+  pool->next_slab_capacity = TWEAK_MODEL_POOL_INITIAL_SLAB_CAPACITY;
+  pool->slabs = NULL;
+  pool->free_list = NULL;
+  pool->unused_begin = NULL;
+  pool->unused_end = NULL;
+}
+
+static bool add_slab(struct tweak_model_pool* pool) {
+  size_t capacity = pool->next_slab_capacity;
+  struct tweak_model_pool_slab* slab = malloc(sizeof(*slab) + capacity * pool->node_size);
+  if (!slab) {
+    return false;
+  }
+  slab->header.next = pool->slabs;
+  pool->slabs = slab;
+  pool->unused_begin = (char*)(slab + 1);
+  pool->unused_end = pool->unused_begin + capacity * pool->node_size;
+  if ((capacity * 2) * pool->node_size <= TWEAK_MODEL_POOL_MAX_SLAB_SIZE) {
+    pool->next_slab_capacity = capacity * 2;
+  }
+  return true;
+}
+
+void* tweak_model_pool_alloc(struct tweak_model_pool* pool) {
+  void* node = pool->free_list;
+  if (node) {
+    pool->free_list = *(void**)node;
+    return node;
+  }
+  if (pool->unused_begin == pool->unused_end && !add_slab(pool)) {
+    return NULL;
+  }
+  node = pool->unused_begin;
+  pool->unused_begin += pool->node_size;
+  return node;
+}
+
+void tweak_model_pool_free(struct tweak_model_pool* pool, void* node) {
+  if (node) {
+    *(void**)node = pool->free_list;
+    pool->free_list = node;
+  }
+}
+
+void tweak_model_pool_destroy(struct tweak_model_pool* pool) {
+  struct tweak_model_pool_slab* slab = pool->slabs;
+  while (slab) {
+    struct tweak_model_pool_slab* next = slab->header.next;
+    free(slab);
+    slab = next;
+  }
+  tweak_model_pool_init(pool, pool->node_size);
+}
@@ -0,0 +1,106 @@
+/**
+ * @file tweakmodel_pool.h
+ * @ingroup tweak-api
+ *
+ * @brief part of tweak2 application implementation.
+ *
+ * @copyright 2020-2022 Cogent Embedded, Inc. ALL RIGHTS RESERVED.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef TWEAK_MODEL_POOL_H_INCLUDED
+#define TWEAK_MODEL_POOL_H_INCLUDED
+
+#include <stddef.h>
+
+/*
+ * Allocator for fixed size model nodes.
+ *
+ * Nodes are carved from slabs holding many nodes each, released nodes
+ * are kept in an intrusive free list and reused by subsequent allocations.
+ * Slabs grow geometrically and are returned to the heap all at once
+ * when the pool is destroyed, so the owner may skip releasing
+ * individual nodes during teardown.
+ *
+ * Node addresses are stable for the node's lifetime.
+ *
+ * This code is thread neutral, owner provides synchronization
+ * the same way as for the tweak_model_* methods.
+ */
+
+struct tweak_model_pool_slab;
+
+struct tweak_model_pool {
+  /*
+   * Size of a single node, rounded up to alignment.
+   */
+  size_t node_size;
+  /*
+   * Number of nodes in the next slab to be allocated.
+   */
+  size_t next_slab_capacity;
+  /*
+   * List of all slabs.
+   */
+  struct tweak_model_pool_slab* slabs;
+  /*
+   * Released nodes.
+   */
+  void* free_list;
+  /*
+   * Untouched part of the most recent slab.
+   */
+  char* unused_begin;
+  char* unused_end;
+};
+
+/**
+ * @brief Initialize empty pool. Doesn't allocate memory.
+ *
+ * @param pool pool to initialize.
+ * @param node_size size of every node.
+ */
+void tweak_model_pool_init(struct tweak_model_pool* pool, size_t node_size);
+
+/**
+ * @brief Allocate a node.
+ *
+ * @param pool pool instance.
+ *
+ * @return uninitialized node or NULL if there was memory allocation error.
+ */
+void* tweak_model_pool_alloc(struct tweak_model_pool* pool);
+
+/**
+ * @brief Return a node to the pool.
+ *
+ * @param pool pool the node has been allocated from.
+ * @param node node to release. NULL is ignored.
+ */
+void tweak_model_pool_free(struct tweak_model_pool* pool, void* node);
+
+/**
+ * @brief Release all slabs. Every node allocated from the pool becomes invalid.
+ *
+ * @param pool pool instance.
+ */
+void tweak_model_pool_destroy(struct tweak_model_pool* pool);
+
+#endif /* TWEAK_MODEL_POOL_H_INCLUDED */
@@ -0,0 +1,513 @@
+/**
+ * @file tweakmodel_scalar_cache.c
+ * @ingroup tweak-api
+ *
+ * @brief part of tweak2 application implementation.
+ *
+ * @copyright 2020-2022 Cogent Embedded, Inc. ALL RIGHTS RESERVED.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <tweak2/atomic.h>
+
+#include "tweakmodel_scalar_cache.h"
+
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+
+enum {
+  TWEAK_MODEL_SCALAR_CACHE_INITIAL_CAPACITY_LOG2 = 6,
+  TWEAK_MODEL_SCALAR_CACHE_CHUNK_SIZE_LOG2 = 10,
+  TWEAK_MODEL_SCALAR_CACHE_MAX_CHUNKS = 4096
+};
+
+/*
+ * Entry value is stored twice and sequence counter selects the copy readers
+ * shall use. Writer updates the copy readers aren't looking at, so reader
+ * preempting the writer on the same core never spins waiting for it.
+ * Reader only retries when sequence counter has changed during the read.
+ *
+ * Generation is bumped every time an entry is assigned to another item,
+ * that's how stale handles are told apart from live ones.
+ */
+struct scalar_value {
+  tweak_id id;
+  uint32_t generation;
+  uint32_t type;
+  uint64_t raw_value;
+};
+
+/*
+ * Entries are allocated in chunks that never move, thus handles
+ * could address them directly without looking into the hash table.
+ */
+struct scalar_entry {
+  volatile uint32_t sequence;
+  volatile struct scalar_value values[2];
+  /* Writer side fields. */
+  tweak_item* item;
+  uint32_t next_free;
+};
+
+/*
+ * Hash table slot maps item id to entry index. Binding is stale
+ * when the entry has been assigned to another item since then.
+ */
+struct scalar_slot {
+  /* Probe key. TWEAK_INVALID_ID marks a vacant slot, vacant slots terminate the probe sequence. */
+  volatile tweak_id id;
+  volatile uint32_t entry_index;
+};
+
+struct scalar_table {
+  /* Previous generation of the table. Late readers could still use it, so it is kept until destruction. */
+  struct scalar_table* retired;
+  struct scalar_slot* slots;
+  uint32_t capacity_log2;
+  size_t occupied;
+};
+
+struct tweak_model_scalar_cache_impl {
+  struct tweak_model_scalar_cache_base base;
+  struct scalar_table* volatile table;
+  struct scalar_entry* volatile chunks[TWEAK_MODEL_SCALAR_CACHE_MAX_CHUNKS];
+  uint32_t num_entries;
+  /* Head of free entry list, index plus one. Zero if the list is empty. */
+  uint32_t free_list;
+};
+
+static size_t get_scalar_size(tweak_variant_type type) {
+  switch (type) {
+  case TWEAK_VARIANT_TYPE_BOOL:
+    return sizeof(bool);
+  case TWEAK_VARIANT_TYPE_SINT8:
+  case TWEAK_VARIANT_TYPE_UINT8:
+    return sizeof(uint8_t);
+  case TWEAK_VARIANT_TYPE_SINT16:
+  case TWEAK_VARIANT_TYPE_UINT16:
+    return sizeof(uint16_t);
+  case TWEAK_VARIANT_TYPE_SINT32:
+  case TWEAK_VARIANT_TYPE_UINT32:
+    return sizeof(uint32_t);
+  case TWEAK_VARIANT_TYPE_SINT64:
+  case TWEAK_VARIANT_TYPE_UINT64:
+    return sizeof(uint64_t);
+  case TWEAK_VARIANT_TYPE_FLOAT:
+    return sizeof(float);
+  case TWEAK_VARIANT_TYPE_DOUBLE:
+    return sizeof(double);
+  default:
+    return 0;
+  }
+}
+
+static size_t get_capacity(const struct scalar_table* table) {
+  return (size_t)1 << table->capacity_log2;
+}
+
+static size_t get_home_slot(tweak_id id, uint32_t capacity_log2) {
+  /* Fibonacci hashing, ids are sequential. */
+  return (size_t)((id * UINT64_C(0x9E3779B97F4A7C15)) >> (64 - capacity_log2));
+}
+
+static uint64_t pack_value(const tweak_variant* value) {
+  uint64_t raw_value = 0;
+  /* Every scalar field of tweak_variant::value starts at offset 0. */
+  memcpy(&raw_value, &value->value, get_scalar_size(value->type));
+  return raw_value;
+}
+
+static void unpack_value(tweak_variant_type type, uint64_t raw_value, tweak_variant* value) {
+  memset(value, 0, sizeof(*value));
+  value->type = type;
+  memcpy(&value->value, &raw_value, get_scalar_size(type));
+}
+
+static uint64_t make_handle(uint32_t entry_index, uint32_t generation) {
+  return ((uint64_t)generation << 32) | (uint64_t)(entry_index + 1);
+}
+
+static struct scalar_entry* get_entry(struct tweak_model_scalar_cache_impl* cache_impl,
+  uint32_t entry_index)
+{
+  /* Writer side only. */
+  struct scalar_entry* chunk = cache_impl->chunks[entry_index >> TWEAK_MODEL_SCALAR_CACHE_CHUNK_SIZE_LOG2];
+  return &chunk[entry_index & ((1U << TWEAK_MODEL_SCALAR_CACHE_CHUNK_SIZE_LOG2) - 1)];
+}
+
+static const struct scalar_entry* load_entry(const struct tweak_model_scalar_cache_impl* cache_impl,
+  uint32_t entry_index)
+{
+  uint32_t chunk_index = entry_index >> TWEAK_MODEL_SCALAR_CACHE_CHUNK_SIZE_LOG2;
+  const struct scalar_entry* chunk;
+  if (chunk_index >= TWEAK_MODEL_SCALAR_CACHE_MAX_CHUNKS) {
+    return NULL;
+  }
+  chunk = tweak_common_atomic_load_ptr((void* const volatile*)&cache_impl->chunks[chunk_index]);
+  if (chunk == NULL) {
+    return NULL;
+  }
+  return &chunk[entry_index & ((1U << TWEAK_MODEL_SCALAR_CACHE_CHUNK_SIZE_LOG2) - 1)];
+}
+
+static const volatile struct scalar_value* get_current_value(const struct scalar_entry* entry) {
+  /* Writer side only, no concurrent modifications are possible. */
+  return &entry->values[entry->sequence & 1];
+}
+
+static void write_entry(struct scalar_entry* entry, tweak_id id, uint32_t generation,
+  tweak_variant_type type, uint64_t raw_value)
+{
+  uint32_t sequence = entry->sequence;
+  tweak_common_atomic_store_u32(&entry->sequence, sequence + 1);
+  tweak_common_atomic_fence_release();
+  entry->values[sequence & 1].id = id;
+  entry->values[sequence & 1].generation = generation;
+  entry->values[sequence & 1].type = type;
+  entry->values[sequence & 1].raw_value = raw_value;
+  tweak_common_atomic_store_u32(&entry->sequence, sequence + 2);
+  tweak_common_atomic_fence_release();
+  entry->values[(sequence + 1) & 1].id = id;
+  entry->values[(sequence + 1) & 1].generation = generation;
+  entry->values[(sequence + 1) & 1].type = type;
+  entry->values[(sequence + 1) & 1].raw_value = raw_value;
+}
+
+static void read_entry(const struct scalar_entry* entry, struct scalar_value* value) {
+  uint32_t sequence;
+  do {
+    sequence = tweak_common_atomic_load_u32(&entry->sequence);
+    value->id = entry->values[sequence & 1].id;
+    value->generation = entry->values[sequence & 1].generation;
+    value->type = entry->values[sequence & 1].type;
+    value->raw_value = entry->values[sequence & 1].raw_value;
+    tweak_common_atomic_fence_acquire();
+  } while (sequence != tweak_common_atomic_load_u32(&entry->sequence));
+}
+
+static bool allocate_entry(struct tweak_model_scalar_cache_impl* cache_impl, uint32_t* entry_index) {
+  uint32_t chunk_index;
+  struct scalar_entry* chunk;
+  if (cache_impl->free_list != 0) {
+    *entry_index = cache_impl->free_list - 1;
+    cache_impl->free_list = get_entry(cache_impl, *entry_index)->next_free;
+    return true;
+  }
+  chunk_index = cache_impl->num_entries >> TWEAK_MODEL_SCALAR_CACHE_CHUNK_SIZE_LOG2;
+  if (chunk_index >= TWEAK_MODEL_SCALAR_CACHE_MAX_CHUNKS) {
+    return false;
+  }
+  if (cache_impl->chunks[chunk_index] == NULL) {
+    chunk = calloc((size_t)1 << TWEAK_MODEL_SCALAR_CACHE_CHUNK_SIZE_LOG2, sizeof(*chunk));
+    if (chunk == NULL) {
+      return false;
+    }
+    tweak_common_atomic_store_ptr((void* volatile*)&cache_impl->chunks[chunk_index], chunk);
+  }
+  *entry_index = cache_impl->num_entries++;
+  return true;
+}
+
+static void release_entry(struct tweak_model_scalar_cache_impl* cache_impl, uint32_t entry_index) {
+  struct scalar_entry* entry = get_entry(cache_impl, entry_index);
+  write_entry(entry, TWEAK_INVALID_ID, get_current_value(entry)->generation, TWEAK_VARIANT_TYPE_NULL, 0);
+  entry->item = NULL;
+  entry->next_free = cache_impl->free_list;
+  cache_impl->free_list = entry_index + 1;
+}
+
+static bool is_bound(struct tweak_model_scalar_cache_impl* cache_impl, const struct scalar_slot* slot) {
+  return slot->id != TWEAK_INVALID_ID
+    && get_current_value(get_entry(cache_impl, slot->entry_index))->id == slot->id;
+}
+
+static struct scalar_table* create_table(uint32_t capacity_log2) {
+  struct scalar_table* table = calloc(1, sizeof(*table));
+  if (table == NULL) {
+    return NULL;
+  }
+  table->slots = calloc((size_t)1 << capacity_log2, sizeof(*table->slots));
+  if (table->slots == NULL) {
+    free(table);
+    return NULL;
+  }
+  table->capacity_log2 = capacity_log2;
+  return table;
+}
+
+static struct scalar_slot* find_slot(struct tweak_model_scalar_cache_impl* cache_impl,
+  struct scalar_table* table, tweak_id id, bool* found)
+{
+  size_t mask = get_capacity(table) - 1;
+  struct scalar_slot* reusable_slot = NULL;
+  for (size_t ix = get_home_slot(id, table->capacity_log2);; ix = (ix + 1) & mask) {
+    struct scalar_slot* slot = &table->slots[ix];
+    if (slot->id == id) {
+      *found = is_bound(cache_impl, slot);
+      return slot;
+    }
+    if (slot->id == TWEAK_INVALID_ID) {
+      *found = false;
+      return reusable_slot != NULL ? reusable_slot : slot;
+    }
+    if (reusable_slot == NULL && !is_bound(cache_impl, slot)) {
+      reusable_slot = slot;
+    }
+  }
+}
+
+static void bind_slot(struct scalar_table* table, struct scalar_slot* slot, tweak_id id,
+  uint32_t entry_index)
+{
+  bool vacant = slot->id == TWEAK_INVALID_ID;
+  /* Entry index goes first. Reader matching new probe key shall see new entry. */
+  slot->entry_index = entry_index;
+  tweak_common_atomic_fence_release();
+  slot->id = id;
+  if (vacant) {
+    ++table->occupied;
+  }
+}
+
+static struct scalar_table* rehash_table(struct tweak_model_scalar_cache_impl* cache_impl,
+  struct scalar_table* table)
+{
+  struct scalar_table* new_table = create_table(table->capacity_log2 + 1);
+  if (new_table == NULL) {
+    return NULL;
+  }
+  for (size_t ix = 0; ix < get_capacity(table); ++ix) {
+    struct scalar_slot* slot = &table->slots[ix];
+    if (is_bound(cache_impl, slot)) {
+      bool found;
+      struct scalar_slot* new_slot = find_slot(cache_impl, new_table, slot->id, &found);
+      assert(!found);
+      bind_slot(new_table, new_slot, slot->id, slot->entry_index);
+    }
+  }
+  new_table->retired = table;
+  return new_table;
+}
+
+static const struct scalar_entry* lookup_entry(const struct tweak_model_scalar_cache_impl* cache_impl,
+  tweak_id id, struct scalar_value* scalar_value, uint32_t* entry_index)
+{
+  const struct scalar_table* table =
+    tweak_common_atomic_load_ptr((void* const volatile*)&cache_impl->table);
+  size_t mask = get_capacity(table) - 1;
+  if (id == TWEAK_INVALID_ID) {
+    return NULL;
+  }
+  for (size_t ix = get_home_slot(id, table->capacity_log2);; ix = (ix + 1) & mask) {
+    const struct scalar_slot* slot = &table->slots[ix];
+    tweak_id slot_id = slot->id;
+    if (slot_id == TWEAK_INVALID_ID) {
+      return NULL;
+    }
+    if (slot_id == id) {
+      const struct scalar_entry* entry;
+      tweak_common_atomic_fence_acquire();
+      *entry_index = slot->entry_index;
+      entry = load_entry(cache_impl, *entry_index);
+      if (entry != NULL) {
+        read_entry(entry, scalar_value);
+        /* Slot might have been rebound to another item, keep probing then. */
+        if (scalar_value->id == id) {
+          return entry;
+        }
+      }
+    }
+  }
+}
+
+tweak_model_scalar_cache tweak_model_scalar_cache_create() {
+  struct tweak_model_scalar_cache_impl* cache_impl = calloc(1, sizeof(*cache_impl));
+  if (cache_impl == NULL) {
+    return NULL;
+  }
+  cache_impl->table = create_table(TWEAK_MODEL_SCALAR_CACHE_INITIAL_CAPACITY_LOG2);
+  if (cache_impl->table == NULL) {
+    free(cache_impl);
+    return NULL;
+  }
+  return &cache_impl->base;
+}
+
+bool tweak_model_scalar_cache_insert(tweak_model_scalar_cache cache, tweak_id id,
+  const tweak_variant* value, tweak_item* item)
+{
+  struct tweak_model_scalar_cache_impl* cache_impl = (struct tweak_model_scalar_cache_impl*)cache;
+  struct scalar_table* table = cache_impl->table;
+  struct scalar_entry* entry;
+  uint32_t entry_index;
+  bool found;
+  assert(id != TWEAK_INVALID_ID);
+  struct scalar_slot* slot = find_slot(cache_impl, table, id, &found);
+  if (found) {
+    entry = get_entry(cache_impl, slot->entry_index);
+    write_entry(entry, id, get_current_value(entry)->generation, value->type, pack_value(value));
+    entry->item = item;
+    return true;
+  }
+
+  if (!allocate_entry(cache_impl, &entry_index)) {
+    return false;
+  }
+
+  if (slot->id == TWEAK_INVALID_ID && (table->occupied + 1) * 4 > get_capacity(table) * 3) {
+    table = rehash_table(cache_impl, table);
+    if (table == NULL) {
+      /* Entry hasn't been touched yet, return it as is. */
+      entry = get_entry(cache_impl, entry_index);
+      entry->next_free = cache_impl->free_list;
+      cache_impl->free_list = entry_index + 1;
+      return false;
+    }
+    slot = find_slot(cache_impl, table, id, &found);
+  }
+
+  /* Value goes first. Reader matching new probe key shall see new value. */
+  entry = get_entry(cache_impl, entry_index);
+  write_entry(entry, id, get_current_value(entry)->generation + 1, value->type, pack_value(value));
+  entry->item = item;
+  bind_slot(table, slot, id, entry_index);
+  if (table != cache_impl->table) {
+    tweak_common_atomic_store_ptr((void* volatile*)&cache_impl->table, table);
+  }
+  return true;
+}
+
+void tweak_model_scalar_cache_update(tweak_model_scalar_cache cache, tweak_id id,
+  const tweak_variant* value)
+{
+  struct tweak_model_scalar_cache_impl* cache_impl = (struct tweak_model_scalar_cache_impl*)cache;
+  bool found;
+  struct scalar_slot* slot = find_slot(cache_impl, cache_impl->table, id, &found);
+  if (found) {
+    struct scalar_entry* entry = get_entry(cache_impl, slot->entry_index);
+    write_entry(entry, id, get_current_value(entry)->generation, value->type, pack_value(value));
+  }
+}
+
+void tweak_model_scalar_cache_remove(tweak_model_scalar_cache cache, tweak_id id) {
+  struct tweak_model_scalar_cache_impl* cache_impl = (struct tweak_model_scalar_cache_impl*)cache;
+  bool found;
+  struct scalar_slot* slot = find_slot(cache_impl, cache_impl->table, id, &found);
+  if (found) {
+    release_entry(cache_impl, slot->entry_index);
+  }
+}
+
+void tweak_model_scalar_cache_clear(tweak_model_scalar_cache cache) {
+  struct tweak_model_scalar_cache_impl* cache_impl = (struct tweak_model_scalar_cache_impl*)cache;
+  for (uint32_t entry_index = 0; entry_index < cache_impl->num_entries; ++entry_index) {
+    if (get_current_value(get_entry(cache_impl, entry_index))->id != TWEAK_INVALID_ID) {
+      release_entry(cache_impl, entry_index);
+    }
+  }
+}
+
+tweak_variant_type tweak_model_scalar_cache_load(tweak_model_scalar_cache cache, tweak_id id,
+  tweak_variant* value)
+{
+  const struct tweak_model_scalar_cache_impl* cache_impl = (const struct tweak_model_scalar_cache_impl*)cache;
+  struct scalar_value scalar_value;
+  uint32_t entry_index;
+  tweak_variant_type type;
+  if (lookup_entry(cache_impl, id, &scalar_value, &entry_index) == NULL) {
+    return TWEAK_VARIANT_TYPE_NULL;
+  }
+  type = (tweak_variant_type)scalar_value.type;
+  if (get_scalar_size(type) != 0) {
+    unpack_value(type, scalar_value.raw_value, value);
+  }
+  return type;
+}
+
+uint64_t tweak_model_scalar_cache_get_handle(tweak_model_scalar_cache cache, tweak_id id) {
+  const struct tweak_model_scalar_cache_impl* cache_impl = (const struct tweak_model_scalar_cache_impl*)cache;
+  struct scalar_value scalar_value;
+  uint32_t entry_index;
+  if (lookup_entry(cache_impl, id, &scalar_value, &entry_index) == NULL) {
+    return 0;
+  }
+  return make_handle(entry_index, scalar_value.generation);
+}
+
+tweak_variant_type tweak_model_scalar_cache_load_by_handle(tweak_model_scalar_cache cache,
+  uint64_t handle, tweak_id* id, tweak_variant* value)
+{
+  const struct tweak_model_scalar_cache_impl* cache_impl = (const struct tweak_model_scalar_cache_impl*)cache;
+  const struct scalar_entry* entry;
+  struct scalar_value scalar_value;
+  tweak_variant_type type;
+  if ((uint32_t)handle == 0) {
+    return TWEAK_VARIANT_TYPE_NULL;
+  }
+  entry = load_entry(cache_impl, (uint32_t)handle - 1);
+  if (entry == NULL) {
+    return TWEAK_VARIANT_TYPE_NULL;
+  }
+  read_entry(entry, &scalar_value);
+  if (scalar_value.id == TWEAK_INVALID_ID || scalar_value.generation != (uint32_t)(handle >> 32)) {
+    return TWEAK_VARIANT_TYPE_NULL;
+  }
+  type = (tweak_variant_type)scalar_value.type;
+  if (id != NULL) {
+    *id = scalar_value.id;
+  }
+  if (value != NULL && get_scalar_size(type) != 0) {
+    unpack_value(type, scalar_value.raw_value, value);
+  }
+  return type;
+}
+
+tweak_item* tweak_model_scalar_cache_get_item_by_handle(tweak_model_scalar_cache cache,
+  uint64_t handle)
+{
+  struct tweak_model_scalar_cache_impl* cache_impl = (struct tweak_model_scalar_cache_impl*)cache;
+  const volatile struct scalar_value* current_value;
+  uint32_t entry_index = (uint32_t)handle - 1;
+  if ((uint32_t)handle == 0 || entry_index >= cache_impl->num_entries) {
+    return NULL;
+  }
+  struct scalar_entry* entry = get_entry(cache_impl, entry_index);
+  current_value = get_current_value(entry);
+  if (current_value->id == TWEAK_INVALID_ID || current_value->generation != (uint32_t)(handle >> 32)) {
+    return NULL;
+  }
+  return entry->item;
+}
+
+void tweak_model_scalar_cache_destroy(tweak_model_scalar_cache cache) {
+  struct tweak_model_scalar_cache_impl* cache_impl = (struct tweak_model_scalar_cache_impl*)cache;
+  struct scalar_table* table = cache_impl->table;
+  while (table != NULL) {
+    struct scalar_table* retired = table->retired;
+    free(table->slots);
+    free(table);
+    table = retired;
+  }
+  for (size_t ix = 0; ix < TWEAK_MODEL_SCALAR_CACHE_MAX_CHUNKS; ++ix) {
+    free(cache_impl->chunks[ix]);
+  }
+  free(cache_impl);
+}
@@ -0,0 +1,166 @@
+/**
+ * @file tweakmodel_scalar_cache.h
+ * @ingroup tweak-api
+ *
+ * @brief part of tweak2 application implementation.
+ *
+ * @copyright 2020-2022 Cogent Embedded, Inc. ALL RIGHTS RESERVED.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef TWEAK_MODEL_SCALAR_CACHE_H_INCLUDED
+#define TWEAK_MODEL_SCALAR_CACHE_H_INCLUDED
+
+#include <tweak2/types.h>
+#include <tweak2/variant.h>
+
+#include "tweakmodel.h"
+
+/*
+ * Lock free mirror of item types and scalar current values.
+ *
+ * Item values are kept in entries that never move, every entry is guarded
+ * by its own sequence counter (seqlock), so readers never block writers
+ * and never touch shared cache lines except entries they are reading.
+ * Item ids are mapped to entries by open addressing table.
+ *
+ * Handle is a direct reference to an entry tagged with entry's generation.
+ * Generation is bumped when entry is reused by another item, so
+ * handles of removed items are detected without any bookkeeping.
+ *
+ * Mutating methods aren't thread safe, they're supposed to be called
+ * while model_lock is held for writing, the same way as tweak_model_* methods.
+ * tweak_model_scalar_cache_load, tweak_model_scalar_cache_get_handle and
+ * tweak_model_scalar_cache_load_by_handle can be called from any thread at any time
+ * between tweak_model_scalar_cache_create and tweak_model_scalar_cache_destroy.
+ */
+
+struct tweak_model_scalar_cache_base {
+  int dummy; /* Empty structures are implementation specific. */
+             /* ANSI ISO C99 doesn't forbid nor explicitly allow them. */
+             /* GreenHills C compiler, MSVC and GCC in pedantic mode */
+             /* would issue a warning or an error */
+             /* if this dummy placeholder is removed. */
+};
+
+typedef struct tweak_model_scalar_cache_base *tweak_model_scalar_cache;
+
+/**
+ * @brief Create new cache instance.
+ *
+ * @return new cache instance or NULL.
+ */
+tweak_model_scalar_cache tweak_model_scalar_cache_create();
+
+/**
+ * @brief Add an item to the cache or replace its cached value.
+ *
+ * @param cache cache instance.
+ * @param id item id.
+ * @param value current value of the item. Only type is cached for non scalar values.
+ * @param item model item to resolve handles to.
+ *
+ * @return false if there was memory allocation error.
+ */
+bool tweak_model_scalar_cache_insert(tweak_model_scalar_cache cache, tweak_id id,
+  const tweak_variant* value, tweak_item* item);
+
+/**
+ * @brief Replace cached value of an existing item. This method never allocates memory.
+ *
+ * @param cache cache instance.
+ * @param id item id.
+ * @param value new value of the item.
+ */
+void tweak_model_scalar_cache_update(tweak_model_scalar_cache cache, tweak_id id,
+  const tweak_variant* value);
+
+/**
+ * @brief Remove an item from the cache.
+ *
+ * @param cache cache instance.
+ * @param id item id.
+ */
+void tweak_model_scalar_cache_remove(tweak_model_scalar_cache cache, tweak_id id);
+
+/**
+ * @brief Remove all items from the cache.
+ *
+ * @param cache cache instance.
+ */
+void tweak_model_scalar_cache_clear(tweak_model_scalar_cache cache);
+
+/**
+ * @brief Read type and, for scalar items, current value of an item.
+ * Doesn't take any locks and doesn't allocate memory.
+ *
+ * @param cache cache instance.
+ * @param id item id.
+ * @param value output parameter receiving current value. It is assigned
+ * only if the item has scalar type, otherwise it isn't altered.
+ *
+ * @return type of the item or TWEAK_VARIANT_TYPE_NULL if there's no such item.
+ */
+tweak_variant_type tweak_model_scalar_cache_load(tweak_model_scalar_cache cache, tweak_id id,
+  tweak_variant* value);
+
+/**
+ * @brief Get handle of an item. Doesn't take any locks and doesn't allocate memory.
+ *
+ * @param cache cache instance.
+ * @param id item id.
+ *
+ * @return handle or 0 if there's no such item.
+ */
+uint64_t tweak_model_scalar_cache_get_handle(tweak_model_scalar_cache cache, tweak_id id);
+
+/**
+ * @brief Same as tweak_model_scalar_cache_load, but the item is addressed by handle.
+ *
+ * @param cache cache instance.
+ * @param handle handle issued by tweak_model_scalar_cache_get_handle.
+ * @param id optional output parameter receiving item id.
+ * @param value optional output parameter receiving current value.
+ *
+ * @return type of the item or TWEAK_VARIANT_TYPE_NULL if the item has been removed.
+ */
+tweak_variant_type tweak_model_scalar_cache_load_by_handle(tweak_model_scalar_cache cache,
+  uint64_t handle, tweak_id* id, tweak_variant* value);
+
+/**
+ * @brief Resolve handle to model item. Unlike other lookups, this one isn't thread safe
+ * and shall be called while model_lock is held.
+ *
+ * @param cache cache instance.
+ * @param handle handle issued by tweak_model_scalar_cache_get_handle.
+ *
+ * @return item passed to tweak_model_scalar_cache_insert or NULL if the item has been removed.
+ */
+tweak_item* tweak_model_scalar_cache_get_item_by_handle(tweak_model_scalar_cache cache,
+  uint64_t handle);
+
+/**
+ * @brief Destroy cache and deallocate all resources associated with it.
+ *
+ * @param cache cache instance.
+ */
+void tweak_model_scalar_cache_destroy(tweak_model_scalar_cache cache);
+
+#endif
@@ -25,6 +25,8 @@
  * THE SOFTWARE.
  */
 
+
+#include <tweak2/intern.h>
 #include <tweak2/string.h>
 #include <tweak2/types.h>
 
@@ -32,107 +34,515 @@
 
 #include <assert.h>
 #include <limits.h>
+#include <stdlib.h>
+#include <string.h>
 
-#if defined(_MSC_BUILD)
-#pragma warning( push )
-#pragma warning( disable : 4127 )
-#pragma warning( disable : 4702 )
-#endif
-#include <uthash.h>
-
-struct uri_tweak_id_pair {
-  char* key;
+/*
+ * Index is a radix trie. Every edge is labelled with a non-empty string,
+ * labels of edges leaving a node start with distinct characters and
+ * a node that doesn't terminate an uri has at least two children.
+ * Children are kept sorted by first character of their labels,
+ * so a depth first walk visits uris in lexicographic order.
+ *
+ * Terminal nodes keep the interned uri, which is shared with the model
+ * and saves rebuilding the uri from labels on every walk.
+ */
+struct uri_trie_node {
+  /*
+   * Block of child_capacity pointers followed by child_capacity
+   * first characters of children labels, both sorted by the latter.
+   */
+  struct uri_trie_node** children;
+  tweak_interned_string key;
   tweak_id tweak_id;
-  UT_hash_handle hh;
+  uint16_t child_count;
+  uint16_t child_capacity;
+  size_t label_length;
+  /* label_length characters of the label follow the structure. */
+};
+
+enum {
+  TWEAK_MODEL_INDEX_MIN_CHILD_CAPACITY = 4,
+  TWEAK_MODEL_INDEX_MAX_CHILD_CAPACITY = UCHAR_MAX + 1
 };
 
 struct tweak_model_uri_to_tweak_id_index_impl {
   struct tweak_model_uri_to_tweak_id_index_base base;
-  struct uri_tweak_id_pair* pairs;
+  struct uri_trie_node* root;
 };
 
+static inline char* get_label(const struct uri_trie_node* node) {
+  return (char*)(node + 1);
+}
+
+static inline unsigned char* get_child_chars(const struct uri_trie_node* node) {
+  return (unsigned char*)(node->children + node->child_capacity);
+}
+
+static struct uri_trie_node* create_node(const char* label, size_t label_length) {
+  struct uri_trie_node* node = malloc(sizeof(*node) + label_length);
+  if (node) {
+    memset(node, 0, sizeof(*node));
+    node->tweak_id = TWEAK_INVALID_ID;
+    node->label_length = label_length;
+    memcpy(get_label(node), label, label_length);
+  }
+  return node;
+}
+
+static void destroy_node(struct uri_trie_node* node) {
+  for (uint16_t ix = 0; ix < node->child_count; ix++) {
+    destroy_node(node->children[ix]);
+  }
+  tweak_interned_string_release(node->key);
+  free(node->children);
+  free(node);
+}
+
+static int find_child(const struct uri_trie_node* node, unsigned char first_char) {
+  const unsigned char* child_chars = get_child_chars(node);
+  const unsigned char* found = node->child_count > 0
+    ? memchr(child_chars, first_char, node->child_count)
+    : NULL;
+  return found ? (int)(found - child_chars) : -1;
+}
+
+static bool reserve_children(struct uri_trie_node* node, uint16_t extra) {
+  size_t required = (size_t)node->child_count + extra;
+  if (required <= node->child_capacity) {
+    return true;
+  }
+  size_t capacity = node->child_capacity > 0
+    ? node->child_capacity * 2u
+    : TWEAK_MODEL_INDEX_MIN_CHILD_CAPACITY;
+  while (capacity < required) {
+    capacity *= 2;
+  }
+  if (capacity > TWEAK_MODEL_INDEX_MAX_CHILD_CAPACITY) {
+    capacity = TWEAK_MODEL_INDEX_MAX_CHILD_CAPACITY;
+  }
+  struct uri_trie_node** children = malloc(capacity * (sizeof(*children) + 1));
+  if (!children) {
+    return false;
+  }
+  if (node->child_count > 0) {
+    memcpy(children, node->children, node->child_count * sizeof(*children));
+    memcpy(children + capacity, get_child_chars(node), node->child_count);
+  }
+  free(node->children);
+  node->children = children;
+  node->child_capacity = (uint16_t)capacity;
+  return true;
+}
+
+/*
+ * Capacity for the new child should have been reserved beforehand.
+ */
+static void insert_child(struct uri_trie_node* node, struct uri_trie_node* child) {
+  assert(node->child_count < node->child_capacity);
+  unsigned char first_char = (unsigned char)get_label(child)[0];
+  unsigned char* child_chars = get_child_chars(node);
+  uint16_t pos = 0;
+  while (pos < node->child_count && child_chars[pos] < first_char) {
+    ++pos;
+  }
+  uint16_t tail = node->child_count - pos;
+  memmove(&node->children[pos + 1], &node->children[pos], tail * sizeof(node->children[0]));
+  memmove(&child_chars[pos + 1], &child_chars[pos], tail);
+  node->children[pos] = child;
+  child_chars[pos] = first_char;
+  ++node->child_count;
+}
+
+static void erase_child(struct uri_trie_node* node, int pos) {
+  unsigned char* child_chars = get_child_chars(node);
+  size_t tail = node->child_count - (size_t)pos - 1;
+  memmove(&node->children[pos], &node->children[pos + 1], tail * sizeof(node->children[0]));
+  memmove(&child_chars[pos], &child_chars[pos + 1], tail);
+  --node->child_count;
+}
+
+static size_t common_prefix_length(const char* str1, size_t length1, const char* str2, size_t length2) {
+  size_t length = length1 < length2 ? length1 : length2;
+  size_t ix = 0;
+  while (ix < length && str1[ix] == str2[ix]) {
+    ++ix;
+  }
+  return ix;
+}
+
+static size_t count_slashes(const char* str, size_t length) {
+  size_t count = 0;
+  for (size_t ix = 0; ix < length; ix++) {
+    if (str[ix] == '/') {
+      ++count;
+    }
+  }
+  return count;
+}
+
+/*
+ * Restores trie invariants for child at @p pos of @p node
+ * after its uri or one of its children has been removed.
+ */
+static void compact_child(struct uri_trie_node* node, int pos) {
+  struct uri_trie_node* child = node->children[pos];
+  if (child->key != NULL) {
+    return;
+  }
+  if (child->child_count == 0) {
+    erase_child(node, pos);
+    destroy_node(child);
+  } else if (child->child_count == 1) {
+    struct uri_trie_node* grandchild = child->children[0];
+    size_t label_length = child->label_length + grandchild->label_length;
+    struct uri_trie_node* merged = realloc(grandchild, sizeof(*merged) + label_length);
+    if (!merged) {
+      /* Trie stays valid, just a bit less compact */
+      return;
+    }
+    memmove(get_label(merged) + child->label_length, get_label(merged), merged->label_length);
+    memcpy(get_label(merged), get_label(child), child->label_length);
+    merged->label_length = label_length;
+    node->children[pos] = merged;
+    free(child->children);
+    free(child);
+  }
+}
+
+/*
+ * Finds the node whose subtree holds all uris starting with @p prefix.
+ * Returned node might extend the prefix past its end,
+ * @p slashes receives number of '/' characters along the path to it.
+ */
+static struct uri_trie_node* find_subtree(struct tweak_model_uri_to_tweak_id_index_impl* index_impl,
+  const char* prefix, size_t* slashes)
+{
+  struct uri_trie_node* node = index_impl->root;
+  size_t length = strlen(prefix);
+  *slashes = 0;
+  while (length > 0) {
+    int pos = find_child(node, (unsigned char)prefix[0]);
+    if (pos < 0) {
+      return NULL;
+    }
+    node = node->children[pos];
+    size_t common = common_prefix_length(get_label(node), node->label_length, prefix, length);
+    if (common < node->label_length && common < length) {
+      return NULL;
+    }
+    *slashes += count_slashes(get_label(node), node->label_length);
+    prefix += common;
+    length -= common;
+  }
+  return node;
+}
+
+static bool walk_node(const struct uri_trie_node* node,
+  tweak_model_uri_to_tweak_id_walk_proc walk_proc, void* cookie)
+{
+  if (node->key != NULL && !walk_proc(tweak_interned_string_c_str(node->key), node->tweak_id, cookie)) {
+    return false;
+  }
+  for (uint16_t ix = 0; ix < node->child_count; ix++) {
+    if (!walk_node(node->children[ix], walk_proc, cookie)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+struct glob_walk_context {
+  const char* pattern;
+  /*
+   * Unless pattern contains "**", matching uris have exactly
+   * as many '/' as the pattern, so deeper subtrees are skipped.
+   */
+  bool unbounded_depth;
+  size_t max_slashes;
+  tweak_model_uri_to_tweak_id_walk_proc walk_proc;
+  void* cookie;
+};
+
+static bool walk_glob_node(const struct uri_trie_node* node, size_t slashes,
+  const struct glob_walk_context* context)
+{
+  if (!context->unbounded_depth && slashes > context->max_slashes) {
+    return true;
+  }
+  if (node->key != NULL) {
+    const char* uri = tweak_interned_string_c_str(node->key);
+    if (tweak_model_uri_glob_match(context->pattern, uri)
+      && !context->walk_proc(uri, node->tweak_id, context->cookie))
+    {
+      return false;
+    }
+  }
+  for (uint16_t ix = 0; ix < node->child_count; ix++) {
+    const struct uri_trie_node* child = node->children[ix];
+    if (!walk_glob_node(child, slashes + count_slashes(get_label(child), child->label_length), context)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool tweak_model_uri_glob_match(const char* pattern, const char* uri) {
+  for (;;) {
+    switch (*pattern) {
+    case '\0':
+      return *uri == '\0';
+    case '?':
+      if (*uri == '\0' || *uri == '/') {
+        return false;
+      }
+      ++pattern;
+      ++uri;
+      break;
+    case '*':
+      if (pattern[1] == '*') {
+        while (*pattern == '*') {
+          ++pattern;
+        }
+        for (;; ++uri) {
+          if (tweak_model_uri_glob_match(pattern, uri)) {
+            return true;
+          }
+          if (*uri == '\0') {
+            return false;
+          }
+        }
+      } else {
+        ++pattern;
+        for (;; ++uri) {
+          if (tweak_model_uri_glob_match(pattern, uri)) {
+            return true;
+          }
+          if (*uri == '\0' || *uri == '/') {
+            return false;
+          }
+        }
+      }
+    default:
+      if (*pattern != *uri) {
+        return false;
+      }
+      ++pattern;
+      ++uri;
+      break;
+    }
+  }
+}
+
 tweak_model_uri_to_tweak_id_index tweak_model_uri_to_tweak_id_index_create() {
   struct tweak_model_uri_to_tweak_id_index_impl* index_impl = calloc(1, sizeof(*index_impl));
-  return index_impl ? &index_impl->base : NULL;
+  if (!index_impl) {
+    return NULL;
+  }
+  index_impl->root = create_node("", 0);
+  if (!index_impl->root) {
+    free(index_impl);
+    return NULL;
+  }
+  return &index_impl->base;
 }
 
 tweak_model_index_result tweak_model_uri_to_tweak_id_index_insert(tweak_model_uri_to_tweak_id_index index,
   const char *uri, tweak_id tweak_id)
 {
   struct tweak_model_uri_to_tweak_id_index_impl* index_impl = (struct tweak_model_uri_to_tweak_id_index_impl*)index;
-  struct uri_tweak_id_pair* pair = NULL;
-  HASH_FIND_STR(index_impl->pairs, uri, pair);
-  if (pair != NULL) {
+  struct uri_trie_node* node = index_impl->root;
+  struct uri_trie_node* split = NULL;
+  struct uri_trie_node* leaf = NULL;
+  int split_pos = -1;
+  size_t common = 0;
+  const char* tail = uri;
+  size_t tail_length = strlen(uri);
+
+  /*.. Find where uri leaves the trie, without changing anything yet */
+  while (tail_length > 0) {
+    int pos = find_child(node, (unsigned char)tail[0]);
+    if (pos < 0) {
+      break;
+    }
+    struct uri_trie_node* child = node->children[pos];
+    common = common_prefix_length(get_label(child), child->label_length, tail, tail_length);
+    if (common < child->label_length) {
+      split_pos = pos;
+      break;
+    }
+    node = child;
+    tail += common;
+    tail_length -= common;
+  }
+
+  if (split_pos < 0 && tail_length == 0 && node->key != NULL) {
     return TWEAK_MODEL_INDEX_KEY_ALREADY_EXISTS;
   }
-  pair = malloc(sizeof(*pair));
-  if (pair == NULL) {
-    return TWEAK_MODEL_INDEX_NO_MEMORY;
+
+  /*.. Allocate everything, so failure leaves the trie intact */
+  tweak_interned_string key = tweak_intern_string(uri);
+  if (!key) {
+    goto no_memory;
   }
-  pair->tweak_id = tweak_id;
-  size_t length = strlen(uri);
-  pair->key = strdup(uri);
-  if (pair->key == NULL) {
-    free(pair);
-    return TWEAK_MODEL_INDEX_NO_MEMORY;
+  if (split_pos >= 0) {
+    split = create_node(get_label(node->children[split_pos]), common);
+    if (!split || !reserve_children(split, tail_length > common ? 2 : 1)) {
+      goto no_memory;
+    }
+    tail += common;
+    tail_length -= common;
+  }
+  if (tail_length > 0) {
+    leaf = create_node(tail, tail_length);
+    if (!leaf || (!split && !reserve_children(node, 1))) {
+      goto no_memory;
+    }
+  }
+
+  if (split) {
+    struct uri_trie_node* child = node->children[split_pos];
+    memmove(get_label(child), get_label(child) + common, child->label_length - common);
+    child->label_length -= common;
+    insert_child(split, child);
+    node->children[split_pos] = split;
+    node = split;
+  }
+  if (leaf) {
+    insert_child(node, leaf);
+    node = leaf;
   }
-  HASH_ADD_KEYPTR(hh, index_impl->pairs, pair->key, length, pair);
+  node->key = key;
+  node->tweak_id = tweak_id;
   return TWEAK_MODEL_INDEX_SUCCESS;
+
+no_memory:
+  if (leaf) {
+    destroy_node(leaf);
+  }
+  if (split) {
+    destroy_node(split);
+  }
+  tweak_interned_string_release(key);
+  return TWEAK_MODEL_INDEX_NO_MEMORY;
 }
 
 bool tweak_model_uri_to_tweak_id_index_walk(tweak_model_uri_to_tweak_id_index index,
   tweak_model_uri_to_tweak_id_walk_proc walk_proc, void* cookie)
 {
-  bool result = true;
   struct tweak_model_uri_to_tweak_id_index_impl* index_impl = (struct tweak_model_uri_to_tweak_id_index_impl*)index;
-  struct uri_tweak_id_pair *pair = NULL;
-  struct uri_tweak_id_pair *tmp = NULL;
-  HASH_ITER(hh, index_impl->pairs, pair, tmp) {
-    if (!walk_proc(pair->key, pair->tweak_id, cookie)) {
-      result = false;
-      break;
-    }
+  return walk_node(index_impl->root, walk_proc, cookie);
+}
+
+bool tweak_model_uri_to_tweak_id_index_walk_subtree(tweak_model_uri_to_tweak_id_index index,
+  const char *prefix, tweak_model_uri_to_tweak_id_walk_proc walk_proc, void* cookie)
+{
+  struct tweak_model_uri_to_tweak_id_index_impl* index_impl = (struct tweak_model_uri_to_tweak_id_index_impl*)index;
+  size_t slashes;
+  struct uri_trie_node* node = find_subtree(index_impl, prefix, &slashes);
+  return node ? walk_node(node, walk_proc, cookie) : true;
+}
+
+bool tweak_model_uri_to_tweak_id_index_walk_glob(tweak_model_uri_to_tweak_id_index index,
+  const char *pattern, tweak_model_uri_to_tweak_id_walk_proc walk_proc, void* cookie)
+{
+  struct tweak_model_uri_to_tweak_id_index_impl* index_impl = (struct tweak_model_uri_to_tweak_id_index_impl*)index;
+  size_t prefix_length = strcspn(pattern, "*?");
+  char prefix_buffer[256];
+  char* prefix = prefix_length < sizeof(prefix_buffer) ? prefix_buffer : malloc(prefix_length + 1);
+  if (!prefix) {
+    return false;
+  }
+  memcpy(prefix, pattern, prefix_length);
+  prefix[prefix_length] = '\0';
+  size_t slashes;
+  struct uri_trie_node* node = find_subtree(index_impl, prefix, &slashes);
+  if (prefix != prefix_buffer) {
+    free(prefix);
   }
-  return result;
+  if (!node) {
+    return true;
+  }
+  struct glob_walk_context context = {
+    .pattern = pattern,
+    .unbounded_depth = strstr(pattern, "**") != NULL,
+    .max_slashes = count_slashes(pattern, strlen(pattern)),
+    .walk_proc = walk_proc,
+    .cookie = cookie
+  };
+  return walk_glob_node(node, slashes, &context);
 }
 
 tweak_id tweak_model_uri_to_tweak_id_index_lookup(tweak_model_uri_to_tweak_id_index index,
   const char *uri)
 {
   struct tweak_model_uri_to_tweak_id_index_impl* index_impl = (struct tweak_model_uri_to_tweak_id_index_impl*)index;
-  struct uri_tweak_id_pair* pair = NULL;
-  HASH_FIND_STR(index_impl->pairs, uri, pair);
-  return pair ? pair->tweak_id : TWEAK_INVALID_ID;
+  const struct uri_trie_node* node = index_impl->root;
+  size_t length = strlen(uri);
+  while (length > 0) {
+    int pos = find_child(node, (unsigned char)uri[0]);
+    if (pos < 0) {
+      return TWEAK_INVALID_ID;
+    }
+    node = node->children[pos];
+    if (node->label_length > length || memcmp(get_label(node), uri, node->label_length) != 0) {
+      return TWEAK_INVALID_ID;
+    }
+    uri += node->label_length;
+    length -= node->label_length;
+  }
+  return node->key != NULL ? node->tweak_id : TWEAK_INVALID_ID;
+}
+
+static tweak_model_index_result remove_from_subtree(struct uri_trie_node* node,
+  const char *tail, size_t tail_length)
+{
+  int pos = find_child(node, (unsigned char)tail[0]);
+  if (pos < 0) {
+    return TWEAK_MODEL_INDEX_KEY_NOT_FOUND;
+  }
+  struct uri_trie_node* child = node->children[pos];
+  if (child->label_length > tail_length || memcmp(get_label(child), tail, child->label_length) != 0) {
+    return TWEAK_MODEL_INDEX_KEY_NOT_FOUND;
+  }
+  tail += child->label_length;
+  tail_length -= child->label_length;
+  if (tail_length > 0) {
+    tweak_model_index_result result = remove_from_subtree(child, tail, tail_length);
+    if (result != TWEAK_MODEL_INDEX_SUCCESS) {
+      return result;
+    }
+  } else if (child->key != NULL) {
+    tweak_interned_string_release(child->key);
+    child->key = NULL;
+    child->tweak_id = TWEAK_INVALID_ID;
+  } else {
+    return TWEAK_MODEL_INDEX_KEY_NOT_FOUND;
+  }
+  compact_child(node, pos);
+  return TWEAK_MODEL_INDEX_SUCCESS;
 }
 
 tweak_model_index_result tweak_model_uri_to_tweak_id_index_remove(tweak_model_uri_to_tweak_id_index index,
   const char *uri)
 {
   struct tweak_model_uri_to_tweak_id_index_impl* index_impl = (struct tweak_model_uri_to_tweak_id_index_impl*)index;
-  struct uri_tweak_id_pair* pair = NULL;
-  HASH_FIND_STR(index_impl->pairs, uri, pair);
-  if (!pair) {
+  struct uri_trie_node* root = index_impl->root;
+  size_t length = strlen(uri);
+  if (length > 0) {
+    return remove_from_subtree(root, uri, length);
+  }
+  if (root->key == NULL) {
     return TWEAK_MODEL_INDEX_KEY_NOT_FOUND;
   }
-  HASH_DEL(index_impl->pairs, pair);
-  free(pair->key);
-  free(pair);
-
+  tweak_interned_string_release(root->key);
+  root->key = NULL;
+  root->tweak_id = TWEAK_INVALID_ID;
   return TWEAK_MODEL_INDEX_SUCCESS;
 }
 
 void tweak_model_uri_to_tweak_id_index_destroy(tweak_model_uri_to_tweak_id_index index) {
   struct tweak_model_uri_to_tweak_id_index_impl* index_impl = (struct tweak_model_uri_to_tweak_id_index_impl*)index;
-  struct uri_tweak_id_pair *pair = NULL;
-  struct uri_tweak_id_pair *tmp = NULL;
-  HASH_ITER(hh, index_impl->pairs, pair, tmp) {
-    HASH_DEL(index_impl->pairs, pair);
-    free(pair->key);
-    free(pair);
-  }
+  destroy_node(index_impl->root);
   free(index_impl);
 }
-
-#if defined(_MSC_BUILD)
-#pragma warning( pop )
-#endif
@@ -104,7 +104,7 @@ tweak_id tweak_model_uri_to_tweak_id_index_lookup(tweak_model_uri_to_tweak_id_in
 typedef bool (*tweak_model_uri_to_tweak_id_walk_proc)(const char *uri, tweak_id id, void* cookie);
 
 /**
- * @brief Enumerate all items in index.
+ * @brief Enumerate all items in index in lexicographic order of their uris.
  *
  * @param index index instance.
  * @param walk_proc callback to capture index entries.
@@ -115,6 +115,57 @@ typedef bool (*tweak_model_uri_to_tweak_id_walk_proc)(const char *uri, tweak_id
 bool tweak_model_uri_to_tweak_id_index_walk(tweak_model_uri_to_tweak_id_index index,
   tweak_model_uri_to_tweak_id_walk_proc walk_proc, void* cookie);
 
+/**
+ * @brief Enumerate items whose uris start with @p prefix in lexicographic order.
+ * Cost is proportional to length of @p prefix and number of matching items.
+ *
+ * @note Prefix is matched character by character, so "/a/b" matches
+ * "/a/bc" as well. Terminate prefix with '/' to select whole path segments.
+ *
+ * @param index index instance.
+ * @param prefix uri prefix. Empty string selects all items.
+ * @param walk_proc callback to capture index entries.
+ * @param cookie opaque pointer to pass into @p walk_proc.
+ *
+ * @return true if iteration hasn't been aborted.
+ */
+bool tweak_model_uri_to_tweak_id_index_walk_subtree(tweak_model_uri_to_tweak_id_index index,
+  const char *prefix, tweak_model_uri_to_tweak_id_walk_proc walk_proc, void* cookie);
+
+/**
+ * @brief Enumerate items whose uris match glob @p pattern in lexicographic order.
+ * See @p tweak_model_uri_glob_match for syntax.
+ *
+ * @details Only the subtree selected by the part of pattern preceding
+ * the first wildcard is visited. Unless the pattern contains "**",
+ * subtrees deeper than the pattern are skipped too.
+ *
+ * @param index index instance.
+ * @param pattern glob pattern.
+ * @param walk_proc callback to capture index entries.
+ * @param cookie opaque pointer to pass into @p walk_proc.
+ *
+ * @return true if iteration hasn't been aborted.
+ */
+bool tweak_model_uri_to_tweak_id_index_walk_glob(tweak_model_uri_to_tweak_id_index index,
+  const char *pattern, tweak_model_uri_to_tweak_id_walk_proc walk_proc, void* cookie);
+
+/**
+ * @brief Match uri against glob pattern.
+ *
+ * @details Pattern syntax:
+ * - '?' matches any single character except '/';
+ * - '*' matches any sequence of characters except '/', i.e. a part of one path segment;
+ * - "**" matches any sequence of characters, including '/';
+ * - any other character matches itself.
+ *
+ * @param pattern glob pattern.
+ * @param uri uri to check.
+ *
+ * @return true if @p uri matches @p pattern.
+ */
+bool tweak_model_uri_glob_match(const char* pattern, const char* uri);
+
 /**
  * @brief Remove an item from index.
  *
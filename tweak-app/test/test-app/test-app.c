@@ -37,6 +37,7 @@
 #include <tweak2/variant.h>
 #include <tweak2/thread.h>
 #include <tweak2/defaults.h>
+#include <tweak2/pickle_client.h>
 
 #include <acutest.h>
 #include <errno.h>
@@ -47,6 +48,10 @@
 #include <string.h>
 #include <time.h>
 
+#if defined(__linux__)
+#include <poll.h>
+#endif
+
 enum { NUM_TWEAKS = 1000 };
 
 enum { WAIT_MILLIS = 1000 };
@@ -571,9 +576,1095 @@ void test_wait_uri(void) {
   tweak_app_destroy_context(server_context);
 }
 
+static uint32_t count_subtree_items(tweak_app_context context, const char* prefix) {
+  uint32_t counter = 0U;
+  TEST_CHECK(tweak_app_traverse_subtree(context, prefix, &count_item_callback, &counter));
+  return counter;
+}
+
+static uint32_t count_glob_items(tweak_app_context context, const char* pattern) {
+  uint32_t counter = 0U;
+  TEST_CHECK(tweak_app_traverse_glob(context, pattern, &count_item_callback, &counter));
+  return counter;
+}
+
+enum { SUBTREE_GROUPS = 10 };
+enum { SUBTREE_ITEMS_PER_GROUP = 20 };
+
+void test_traverse_subtree(void) {
+  srand((unsigned)time(NULL));
+  char uri0[256];
+
+  int port = 32769 + rand() % 20000;
+  snprintf(uri0, sizeof(uri0), TWEAK_DEFAULT_ENDPOINT_TEMPLATE, port);
+
+  tweak_app_server_context server_context = tweak_app_create_server_context(
+    "nng", "role=server", uri0, NULL);
+  TEST_CHECK(server_context != NULL);
+
+  tweak_id group_ids[SUBTREE_ITEMS_PER_GROUP] = { 0 };
+  for (uint32_t group_no = 0; group_no < SUBTREE_GROUPS; ++group_no) {
+    for (uint32_t item_no = 0; item_no < SUBTREE_ITEMS_PER_GROUP; ++item_no) {
+      char uri[MAX_URI_LENGTH + 1];
+      snprintf(uri, sizeof(uri), "/camera_%" PRIu32 "/param_%" PRIu32, group_no, item_no);
+      tweak_variant value = TWEAK_VARIANT_INIT_EMPTY;
+      tweak_variant_assign_float(&value, (float)item_no);
+      tweak_id id = tweak_app_server_add_item(server_context, uri, "test", "test", &value, NULL);
+      TEST_CHECK(id != TWEAK_INVALID_ID);
+      if (group_no == 3) {
+        group_ids[item_no] = id;
+      }
+    }
+  }
+
+  TEST_CHECK(count_subtree_items(server_context, "") == SUBTREE_GROUPS * SUBTREE_ITEMS_PER_GROUP);
+  TEST_CHECK(count_subtree_items(server_context, "/camera_3/") == SUBTREE_ITEMS_PER_GROUP);
+  TEST_CHECK(count_subtree_items(server_context, "/camera_3/param_1") == 11);
+  TEST_CHECK(count_subtree_items(server_context, "/lidar/") == 0);
+  TEST_CHECK(count_glob_items(server_context, "/*/param_7") == SUBTREE_GROUPS);
+  TEST_CHECK(count_glob_items(server_context, "/camera_3/*") == SUBTREE_ITEMS_PER_GROUP);
+  TEST_CHECK(count_glob_items(server_context, "/**") == SUBTREE_GROUPS * SUBTREE_ITEMS_PER_GROUP);
+
+  for (uint32_t item_no = 0; item_no < SUBTREE_ITEMS_PER_GROUP; item_no += 2) {
+    TEST_CHECK(tweak_app_server_remove_item(server_context, group_ids[item_no]));
+  }
+  TEST_CHECK(count_subtree_items(server_context, "/camera_3/") == SUBTREE_ITEMS_PER_GROUP / 2);
+  TEST_CHECK(count_glob_items(server_context, "/*/param_?") == SUBTREE_GROUPS * 10 - 5);
+
+  tweak_app_destroy_context(server_context);
+}
+
+static uint32_t wait_item_count(tweak_app_context context, uint32_t expected_count, uint32_t millis) {
+  uint32_t count = count_items(context);
+  for (uint32_t elapsed = 0; count != expected_count && elapsed < millis; elapsed += 10) {
+    tweak_common_sleep(10);
+    count = count_items(context);
+  }
+  return count;
+}
+
+static tweak_id add_float_item(tweak_app_server_context server_context, const char* uri, float arg) {
+  tweak_variant value = TWEAK_VARIANT_INIT_EMPTY;
+  tweak_variant_assign_float(&value, arg);
+  return tweak_app_server_add_item(server_context, uri, "test", "test", &value, NULL);
+}
+
+void test_subscribe(void) {
+  srand((unsigned)time(NULL));
+  char uri0[256];
+
+  int port = 32769 + rand() % 20000;
+  snprintf(uri0, sizeof(uri0), TWEAK_DEFAULT_ENDPOINT_TEMPLATE, port);
+
+  tweak_app_server_context server_context = tweak_app_create_server_context(
+    "nng", "role=server", uri0, NULL);
+  TEST_CHECK(server_context != NULL);
+
+  tweak_id group_ids[SUBTREE_ITEMS_PER_GROUP] = { 0 };
+  for (uint32_t group_no = 0; group_no < SUBTREE_GROUPS; ++group_no) {
+    for (uint32_t item_no = 0; item_no < SUBTREE_ITEMS_PER_GROUP; ++item_no) {
+      char uri[MAX_URI_LENGTH + 1];
+      snprintf(uri, sizeof(uri), "/camera_%" PRIu32 "/param_%" PRIu32, group_no, item_no);
+      tweak_id id = add_float_item(server_context, uri, (float)item_no);
+      TEST_CHECK(id != TWEAK_INVALID_ID);
+      if (group_no == 3) {
+        group_ids[item_no] = id;
+      }
+    }
+  }
+
+  tweak_app_client_context client_context = tweak_app_create_client_context(
+    "nng", "role=client", uri0, NULL);
+  TEST_CHECK(client_context != NULL);
+  tweak_app_client_subscribe(client_context, "/camera_3/*; /camera_5/param_1?");
+
+  /* 20 items of camera_3 and param_10 ... param_19 of camera_5 */
+  uint32_t count = wait_item_count(client_context, SUBTREE_ITEMS_PER_GROUP + 10, 5 * WAIT_MILLIS);
+  TEST_CHECK(count == SUBTREE_ITEMS_PER_GROUP + 10);
+  TEST_MSG("count = %" PRIu32, count);
+
+  TEST_CHECK(add_float_item(server_context, "/lidar/range", 1.f) != TWEAK_INVALID_ID);
+  TEST_CHECK(add_float_item(server_context, "/camera_3/param_new", 1.f) != TWEAK_INVALID_ID);
+  TEST_CHECK(tweak_app_server_remove_item(server_context, group_ids[0]));
+  TEST_CHECK(tweak_app_server_remove_item(server_context, group_ids[1]));
+  const char* new_uri = "/camera_3/param_new";
+  tweak_app_error_code error_code = tweak_app_client_wait_uris(client_context, &new_uri, 1, NULL, 5 * WAIT_MILLIS);
+  TEST_CHECK(error_code == TWEAK_APP_SUCCESS);
+  count = wait_item_count(client_context, SUBTREE_ITEMS_PER_GROUP + 9, 5 * WAIT_MILLIS);
+  TEST_CHECK(count == SUBTREE_ITEMS_PER_GROUP + 9);
+  TEST_MSG("count = %" PRIu32, count);
+  TEST_CHECK(tweak_app_find_id(client_context, "/lidar/range") == TWEAK_INVALID_ID);
+
+  tweak_app_client_subscribe(client_context, "/camera_0/**;/lidar/range");
+  count = wait_item_count(client_context, SUBTREE_ITEMS_PER_GROUP + 1, 5 * WAIT_MILLIS);
+  TEST_CHECK(count == SUBTREE_ITEMS_PER_GROUP + 1);
+  TEST_MSG("count = %" PRIu32, count);
+  TEST_CHECK(tweak_app_find_id(client_context, "/camera_3/param_new") == TWEAK_INVALID_ID);
+
+  tweak_app_client_subscribe(client_context, NULL);
+  count = wait_item_count(client_context, SUBTREE_GROUPS * SUBTREE_ITEMS_PER_GROUP, 5 * WAIT_MILLIS);
+  TEST_CHECK(count == SUBTREE_GROUPS * SUBTREE_ITEMS_PER_GROUP);
+  TEST_MSG("count = %" PRIu32, count);
+
+  tweak_app_destroy_context(client_context);
+  tweak_app_destroy_context(server_context);
+}
+
+static bool wait_float_value(tweak_app_context context, const char* uri, float expected_value,
+  uint32_t millis)
+{
+  for (uint32_t elapsed = 0; elapsed <= millis; elapsed += 10) {
+    tweak_variant value = TWEAK_VARIANT_INIT_EMPTY;
+    tweak_id id = tweak_app_find_id(context, uri);
+    bool found = id != TWEAK_INVALID_ID
+      && tweak_app_item_clone_current_value(context, id, &value) == TWEAK_APP_SUCCESS
+      && value.type == TWEAK_VARIANT_TYPE_FLOAT
+      && value.value.fp32 == expected_value;
+    tweak_variant_destroy(&value);
+    if (found) {
+      return true;
+    }
+    tweak_common_sleep(10);
+  }
+  return false;
+}
+
+static void set_float_value(tweak_app_context context, const char* uri, float arg) {
+  tweak_variant value = TWEAK_VARIANT_INIT_EMPTY;
+  tweak_variant_assign_float(&value, arg);
+  TEST_CHECK(tweak_app_item_replace_current_value(context, tweak_app_find_id(context, uri), &value)
+    == TWEAK_APP_SUCCESS);
+}
+
+void test_multiple_clients(void) {
+  srand((unsigned)time(NULL));
+  char uri0[256];
+
+  int port = 32769 + rand() % 20000;
+  snprintf(uri0, sizeof(uri0), TWEAK_DEFAULT_ENDPOINT_TEMPLATE, port);
+
+  tweak_app_server_context server_context = tweak_app_create_server_context(
+    "nng", "role=server", uri0, NULL);
+  TEST_CHECK(server_context != NULL);
+
+  for (uint32_t group_no = 0; group_no < SUBTREE_GROUPS; ++group_no) {
+    for (uint32_t item_no = 0; item_no < SUBTREE_ITEMS_PER_GROUP; ++item_no) {
+      char uri[MAX_URI_LENGTH + 1];
+      snprintf(uri, sizeof(uri), "/camera_%" PRIu32 "/param_%" PRIu32, group_no, item_no);
+      TEST_CHECK(add_float_item(server_context, uri, (float)item_no) != TWEAK_INVALID_ID);
+    }
+  }
+
+  tweak_app_client_context first_client_context = tweak_app_create_client_context(
+    "nng", "role=client", uri0, NULL);
+  TEST_CHECK(first_client_context != NULL);
+  tweak_app_client_subscribe(first_client_context, "/camera_1/**");
+  uint32_t count = wait_item_count(first_client_context, SUBTREE_ITEMS_PER_GROUP, 5 * WAIT_MILLIS);
+  TEST_CHECK(count == SUBTREE_ITEMS_PER_GROUP);
+  TEST_MSG("count = %" PRIu32, count);
+
+  /* Transports that can't address clients individually broadcast all datagrams,
+   * so other client items aren't checked for absence */
+  tweak_app_client_context second_client_context = tweak_app_create_client_context(
+    "nng", "role=client", uri0, NULL);
+  TEST_CHECK(second_client_context != NULL);
+  tweak_app_client_subscribe(second_client_context, "/camera_2/**");
+  const char* second_uris[] = { "/camera_2/param_0", "/camera_2/param_19" };
+  TEST_CHECK(tweak_app_client_wait_uris(second_client_context, second_uris, 2, NULL, 5 * WAIT_MILLIS)
+    == TWEAK_APP_SUCCESS);
+
+  set_float_value(server_context, "/camera_1/param_0", 100.f);
+  set_float_value(server_context, "/camera_2/param_0", 200.f);
+  TEST_CHECK(wait_float_value(first_client_context, "/camera_1/param_0", 100.f, 5 * WAIT_MILLIS));
+  TEST_CHECK(wait_float_value(second_client_context, "/camera_2/param_0", 200.f, 5 * WAIT_MILLIS));
+
+  /* Change made by one client reaches server and every client subscribed to the item */
+  tweak_app_client_subscribe(second_client_context, "/camera_1/param_1");
+  const char* shared_uri = "/camera_1/param_1";
+  TEST_CHECK(tweak_app_client_wait_uris(second_client_context, &shared_uri, 1, NULL, 5 * WAIT_MILLIS)
+    == TWEAK_APP_SUCCESS);
+  set_float_value(second_client_context, shared_uri, 300.f);
+  TEST_CHECK(wait_float_value(server_context, shared_uri, 300.f, 5 * WAIT_MILLIS));
+  TEST_CHECK(wait_float_value(first_client_context, shared_uri, 300.f, 5 * WAIT_MILLIS));
+
+  tweak_app_destroy_context(second_client_context);
+
+  /* Remaining client is still served */
+  TEST_CHECK(add_float_item(server_context, "/camera_1/param_new", 1.f) != TWEAK_INVALID_ID);
+  const char* new_uri = "/camera_1/param_new";
+  TEST_CHECK(tweak_app_client_wait_uris(first_client_context, &new_uri, 1, NULL, 5 * WAIT_MILLIS)
+    == TWEAK_APP_SUCCESS);
+  set_float_value(server_context, "/camera_1/param_0", 400.f);
+  TEST_CHECK(wait_float_value(first_client_context, "/camera_1/param_0", 400.f, 5 * WAIT_MILLIS));
+
+  tweak_app_destroy_context(first_client_context);
+  tweak_app_destroy_context(server_context);
+}
+
+void test_shared_session_subscribe(void) {
+  srand((unsigned)time(NULL));
+  char uri0[256];
+
+  int port = 32769 + rand() % 20000;
+  snprintf(uri0, sizeof(uri0), TWEAK_DEFAULT_ENDPOINT_TEMPLATE, port);
+
+  /* Server serving all clients through a single session, as over stock nng or shm */
+  tweak_app_server_context server_context = tweak_app_create_server_context(
+    "nng", "role=server;broadcast", uri0, NULL);
+  TEST_CHECK(server_context != NULL);
+
+  for (uint32_t group_no = 0; group_no < SUBTREE_GROUPS; ++group_no) {
+    for (uint32_t item_no = 0; item_no < SUBTREE_ITEMS_PER_GROUP; ++item_no) {
+      char uri[MAX_URI_LENGTH + 1];
+      snprintf(uri, sizeof(uri), "/camera_%" PRIu32 "/param_%" PRIu32, group_no, item_no);
+      TEST_CHECK(add_float_item(server_context, uri, (float)item_no) != TWEAK_INVALID_ID);
+    }
+  }
+
+  tweak_app_client_context first_client_context = tweak_app_create_client_context(
+    "nng", "role=client", uri0, NULL);
+  TEST_CHECK(first_client_context != NULL);
+  tweak_app_client_subscribe(first_client_context, "/camera_1/**");
+  uint32_t count = wait_item_count(first_client_context, SUBTREE_GROUPS * SUBTREE_ITEMS_PER_GROUP,
+    5 * WAIT_MILLIS);
+  TEST_CHECK(count == SUBTREE_GROUPS * SUBTREE_ITEMS_PER_GROUP);
+  TEST_MSG("count = %" PRIu32, count);
+
+  /* Selection of one client can't retract items from another one */
+  tweak_app_client_context second_client_context = tweak_app_create_client_context(
+    "nng", "role=client", uri0, NULL);
+  TEST_CHECK(second_client_context != NULL);
+  tweak_app_client_subscribe(second_client_context, "/camera_2/**");
+  const char* second_uris[] = { "/camera_2/param_0", "/camera_2/param_19" };
+  TEST_CHECK(tweak_app_client_wait_uris(second_client_context, second_uris, 2, NULL, 5 * WAIT_MILLIS)
+    == TWEAK_APP_SUCCESS);
+
+  set_float_value(server_context, "/camera_1/param_0", 100.f);
+  TEST_CHECK(wait_float_value(first_client_context, "/camera_1/param_0", 100.f, 5 * WAIT_MILLIS));
+  TEST_CHECK(count_items(first_client_context) == SUBTREE_GROUPS * SUBTREE_ITEMS_PER_GROUP);
+
+  /* Change made by one client reaches the other one */
+  set_float_value(second_client_context, "/camera_2/param_1", 200.f);
+  TEST_CHECK(wait_float_value(first_client_context, "/camera_2/param_1", 200.f, 5 * WAIT_MILLIS));
+
+  tweak_app_destroy_context(second_client_context);
+  tweak_app_destroy_context(first_client_context);
+  tweak_app_destroy_context(server_context);
+}
+
+void test_server_restart(void) {
+  srand((unsigned)time(NULL));
+  char uri0[256];
+
+  int port = 32769 + rand() % 20000;
+  snprintf(uri0, sizeof(uri0), TWEAK_DEFAULT_ENDPOINT_TEMPLATE, port);
+
+  tweak_app_server_context server_context = tweak_app_create_server_context(
+    "nng", "role=server", uri0, NULL);
+  TEST_CHECK(server_context != NULL);
+  TEST_CHECK(add_float_item(server_context, "/restart/removed", 1.f) != TWEAK_INVALID_ID);
+  TEST_CHECK(add_float_item(server_context, "/restart/kept", 2.f) != TWEAK_INVALID_ID);
+
+  tweak_app_client_context client_context = tweak_app_create_client_context(
+    "nng", "role=client", uri0, NULL);
+  TEST_CHECK(client_context != NULL);
+  const char* first_uris[] = { "/restart/removed", "/restart/kept" };
+  TEST_CHECK(tweak_app_client_wait_uris(client_context, first_uris, 2, NULL, 5 * WAIT_MILLIS)
+    == TWEAK_APP_SUCCESS);
+
+  /* Restarted server has another model epoch, so items kept by client
+   * are dropped rather than resynchronized by ids of the previous model */
+  tweak_app_destroy_context(server_context);
+  server_context = tweak_app_create_server_context("nng", "role=server", uri0, NULL);
+  TEST_CHECK(server_context != NULL);
+  TEST_CHECK(add_float_item(server_context, "/restart/kept", 3.f) != TWEAK_INVALID_ID);
+  TEST_CHECK(add_float_item(server_context, "/restart/added", 4.f) != TWEAK_INVALID_ID);
+
+  const char* added_uri = "/restart/added";
+  TEST_CHECK(tweak_app_client_wait_uris(client_context, &added_uri, 1, NULL, 5 * WAIT_MILLIS)
+    == TWEAK_APP_SUCCESS);
+  TEST_CHECK(wait_float_value(client_context, "/restart/kept", 3.f, 5 * WAIT_MILLIS));
+  TEST_CHECK(tweak_app_find_id(client_context, "/restart/removed") == TWEAK_INVALID_ID);
+  TEST_CHECK(tweak_app_find_id(client_context, "/restart/kept")
+    == tweak_app_find_id(server_context, "/restart/kept"));
+
+  tweak_app_destroy_context(client_context);
+  tweak_app_destroy_context(server_context);
+}
+
+void test_server_restart_many_items(void) {
+  /* Items kept by client don't fit a single datagram */
+  enum { NUM_ITEMS = 70000 };
+  srand((unsigned)time(NULL));
+  char uri0[256];
+
+  int port = 32769 + rand() % 20000;
+  snprintf(uri0, sizeof(uri0), TWEAK_DEFAULT_ENDPOINT_TEMPLATE, port);
+
+  tweak_app_server_context server_context = tweak_app_create_server_context(
+    "nng", "role=server", uri0, NULL);
+  TEST_CHECK(server_context != NULL);
+  for (uint32_t item_no = 0; item_no < NUM_ITEMS; ++item_no) {
+    char uri[MAX_URI_LENGTH + 1];
+    snprintf(uri, sizeof(uri), "/many/param_%" PRIu32, item_no);
+    TEST_CHECK(add_float_item(server_context, uri, 1.f) != TWEAK_INVALID_ID);
+  }
+
+  tweak_app_client_context client_context = tweak_app_create_client_context(
+    "nng", "role=client", uri0, NULL);
+  TEST_CHECK(client_context != NULL);
+  uint32_t count = wait_item_count(client_context, NUM_ITEMS, 10 * WAIT_MILLIS);
+  TEST_CHECK(count == NUM_ITEMS);
+  TEST_MSG("count = %" PRIu32, count);
+
+  tweak_app_destroy_context(server_context);
+  server_context = tweak_app_create_server_context("nng", "role=server", uri0, NULL);
+  TEST_CHECK(server_context != NULL);
+  for (uint32_t item_no = 1; item_no <= NUM_ITEMS; ++item_no) {
+    char uri[MAX_URI_LENGTH + 1];
+    snprintf(uri, sizeof(uri), "/many/param_%" PRIu32, item_no);
+    TEST_CHECK(add_float_item(server_context, uri, 2.f) != TWEAK_INVALID_ID);
+  }
+
+  char last_uri[MAX_URI_LENGTH + 1];
+  snprintf(last_uri, sizeof(last_uri), "/many/param_%d", NUM_ITEMS);
+  TEST_CHECK(wait_float_value(client_context, last_uri, 2.f, 10 * WAIT_MILLIS));
+  count = wait_item_count(client_context, NUM_ITEMS, 10 * WAIT_MILLIS);
+  TEST_CHECK(count == NUM_ITEMS);
+  TEST_MSG("count = %" PRIu32, count);
+  TEST_CHECK(tweak_app_find_id(client_context, "/many/param_0") == TWEAK_INVALID_ID);
+
+  tweak_app_destroy_context(client_context);
+  tweak_app_destroy_context(server_context);
+}
+
+enum { RESYNC_MAX_ITEMS = 8 };
+
+/**
+ * Client side of the protocol driven by hand, so that items it has kept
+ * and requests server sends upon reconnect are observable.
+ */
+struct resync_peer {
+  tweak_common_mutex lock;
+  bool connected;
+  uint64_t model_epoch;
+  tweak_pickle_known_item known_items[RESYNC_MAX_ITEMS];
+  size_t known_items_size;
+  uint32_t add_count;
+  uint32_t change_count;
+  uint32_t remove_count;
+  tweak_id last_changed_id;
+  tweak_id last_removed_id;
+};
+
+static void resync_peer_connection_state(tweak_pickle_connection_state connection_state, void *cookie) {
+  struct resync_peer* peer = cookie;
+  tweak_common_mutex_lock(&peer->lock);
+  peer->connected = connection_state == TWEAK_PICKLE_CONNECTED;
+  tweak_common_mutex_unlock(&peer->lock);
+}
+
+static void resync_peer_features(tweak_pickle_features* features, void *cookie) {
+  struct resync_peer* peer = cookie;
+  tweak_common_mutex_lock(&peer->lock);
+  peer->model_epoch = features->model_epoch;
+  tweak_common_mutex_unlock(&peer->lock);
+}
+
+static void resync_peer_add_item(tweak_pickle_add_item *add_item, void *cookie) {
+  struct resync_peer* peer = cookie;
+  tweak_common_mutex_lock(&peer->lock);
+  ++peer->add_count;
+  if (peer->known_items_size < RESYNC_MAX_ITEMS) {
+    tweak_pickle_known_item* known_item = &peer->known_items[peer->known_items_size++];
+    known_item->id = add_item->id;
+    known_item->version = add_item->version;
+  }
+  tweak_common_mutex_unlock(&peer->lock);
+}
+
+static void resync_peer_change_item(tweak_pickle_change_item *change, void *cookie) {
+  struct resync_peer* peer = cookie;
+  tweak_common_mutex_lock(&peer->lock);
+  ++peer->change_count;
+  peer->last_changed_id = change->id;
+  tweak_common_mutex_unlock(&peer->lock);
+}
+
+static void resync_peer_remove_item(tweak_pickle_remove_item* remove_item, void *cookie) {
+  struct resync_peer* peer = cookie;
+  tweak_common_mutex_lock(&peer->lock);
+  ++peer->remove_count;
+  peer->last_removed_id = remove_item->id;
+  tweak_common_mutex_unlock(&peer->lock);
+}
+
+static tweak_pickle_client_endpoint connect_resync_peer(struct resync_peer* peer, const char* uri,
+  const tweak_pickle_subscribe* subscribe)
+{
+  tweak_pickle_client_descriptor client_descriptor = {
+    .context_type = "nng",
+    .params = "role=client",
+    .uri = uri,
+    .skeleton = {
+      .announce_features_listener = { .callback = &resync_peer_features, .cookie = peer },
+      .add_item_listener = { .callback = &resync_peer_add_item, .cookie = peer },
+      .change_item_listener = { .callback = &resync_peer_change_item, .cookie = peer },
+      .remove_item_listener = { .callback = &resync_peer_remove_item, .cookie = peer },
+      .connection_state_listener = { .callback = &resync_peer_connection_state, .cookie = peer }
+    }
+  };
+  tweak_pickle_client_endpoint endpoint = tweak_pickle_create_client_endpoint(&client_descriptor);
+  if (!endpoint) {
+    return NULL;
+  }
+  bool connected = false;
+  for (uint32_t elapsed = 0; !connected && elapsed <= 5 * WAIT_MILLIS; elapsed += 10) {
+    tweak_common_mutex_lock(&peer->lock);
+    connected = peer->connected;
+    tweak_common_mutex_unlock(&peer->lock);
+    if (!connected) {
+      tweak_common_sleep(10);
+    }
+  }
+  tweak_pickle_features features = { .features = TWEAK_VARIANT_STRING_EMPTY };
+  tweak_assign_string(&features.features, "{}");
+  bool success = connected
+    && tweak_pickle_client_announce_features(endpoint, &features) == TWEAK_PICKLE_SUCCESS
+    && tweak_pickle_client_subscribe(endpoint, subscribe) == TWEAK_PICKLE_SUCCESS;
+  tweak_variant_destroy_string(&features.features);
+  if (!success) {
+    tweak_pickle_destroy_client_endpoint(endpoint);
+    return NULL;
+  }
+  return endpoint;
+}
+
+static bool wait_resync_peer(struct resync_peer* peer, uint32_t add_count,
+  uint32_t change_count, uint32_t remove_count, uint32_t millis)
+{
+  for (uint32_t elapsed = 0; elapsed <= millis; elapsed += 10) {
+    tweak_common_mutex_lock(&peer->lock);
+    bool reached = peer->add_count >= add_count
+      && peer->change_count >= change_count
+      && peer->remove_count >= remove_count;
+    tweak_common_mutex_unlock(&peer->lock);
+    if (reached) {
+      return true;
+    }
+    tweak_common_sleep(10);
+  }
+  return false;
+}
+
+void test_server_reconnect(void) {
+  srand((unsigned)time(NULL));
+  char uri0[256];
+
+  int port = 32769 + rand() % 20000;
+  snprintf(uri0, sizeof(uri0), TWEAK_DEFAULT_ENDPOINT_TEMPLATE, port);
+
+  tweak_app_server_context server_context = tweak_app_create_server_context(
+    "nng", "role=server", uri0, NULL);
+  TEST_CHECK(server_context != NULL);
+  TEST_CHECK(add_float_item(server_context, "/reconnect/unchanged", 1.f) != TWEAK_INVALID_ID);
+  tweak_id changed_id = add_float_item(server_context, "/reconnect/changed", 2.f);
+  TEST_CHECK(changed_id != TWEAK_INVALID_ID);
+  tweak_id removed_id = add_float_item(server_context, "/reconnect/removed", 3.f);
+  TEST_CHECK(removed_id != TWEAK_INVALID_ID);
+
+  struct resync_peer peer = { .connected = false };
+  tweak_common_mutex_init(&peer.lock);
+  tweak_pickle_subscribe subscribe = { .uri_patterns = TWEAK_VARIANT_STRING_EMPTY };
+  tweak_pickle_client_endpoint endpoint = connect_resync_peer(&peer, uri0, &subscribe);
+  TEST_CHECK(endpoint != NULL);
+  TEST_CHECK(wait_resync_peer(&peer, 3, 0, 0, 5 * WAIT_MILLIS));
+  tweak_pickle_destroy_client_endpoint(endpoint);
+
+  tweak_common_mutex_lock(&peer.lock);
+  uint64_t model_epoch = peer.model_epoch;
+  subscribe.model_epoch = model_epoch;
+  subscribe.known_items = peer.known_items;
+  subscribe.known_items_size = peer.known_items_size;
+  peer.connected = false;
+  peer.add_count = 0;
+  peer.change_count = 0;
+  peer.remove_count = 0;
+  tweak_common_mutex_unlock(&peer.lock);
+  /* Hub without per peer addressing shares one session between clients,
+   * server can't resynchronize items then and announces epoch 0 */
+  if (model_epoch != 0) {
+    set_float_value(server_context, "/reconnect/changed", 4.f);
+    TEST_CHECK(tweak_app_server_remove_item(server_context, removed_id));
+
+    endpoint = connect_resync_peer(&peer, uri0, &subscribe);
+    TEST_CHECK(endpoint != NULL);
+    TEST_CHECK(wait_resync_peer(&peer, 0, 1, 1, 5 * WAIT_MILLIS));
+    /* Whatever else server would send has been sent by now */
+    tweak_common_sleep(WAIT_MILLIS / 4);
+    tweak_pickle_destroy_client_endpoint(endpoint);
+
+    tweak_common_mutex_lock(&peer.lock);
+    TEST_CHECK(peer.model_epoch == model_epoch);
+    TEST_CHECK(peer.add_count == 0);
+    TEST_CHECK(peer.change_count == 1);
+    TEST_CHECK(peer.last_changed_id == changed_id);
+    TEST_CHECK(peer.remove_count == 1);
+    TEST_CHECK(peer.last_removed_id == removed_id);
+    tweak_common_mutex_unlock(&peer.lock);
+  }
+
+  tweak_common_mutex_destroy(&peer.lock);
+  tweak_app_destroy_context(server_context);
+}
+
+static bool wait_vector_range(tweak_app_context context, tweak_id id, size_t offset,
+  const uint16_t* expected, size_t count, uint32_t millis)
+{
+  uint16_t buffer[8];
+  assert(count <= sizeof(buffer) / sizeof(buffer[0]));
+  for (uint32_t elapsed = 0; elapsed <= millis; elapsed += 10) {
+    if (tweak_app_item_load_vector_range(context, id, TWEAK_VARIANT_TYPE_VECTOR_UINT16,
+      offset, count, buffer) == TWEAK_APP_SUCCESS
+      && memcmp(buffer, expected, count * sizeof(buffer[0])) == 0)
+    {
+      return true;
+    }
+    tweak_common_sleep(10);
+  }
+  return false;
+}
+
+void test_vector_range(void) {
+  enum { VECTOR_SIZE = 1000 };
+  srand((unsigned)time(NULL));
+  char uri0[256];
+
+  int port = 32769 + rand() % 20000;
+  snprintf(uri0, sizeof(uri0), TWEAK_DEFAULT_ENDPOINT_TEMPLATE, port);
+
+  tweak_app_server_context server_context = tweak_app_create_server_context(
+    "nng", "role=server", uri0, NULL);
+  TEST_CHECK(server_context != NULL);
+  static uint16_t initial_value[VECTOR_SIZE];
+  tweak_variant value = TWEAK_VARIANT_INIT_EMPTY;
+  tweak_variant_assign_uint16_vector(&value, initial_value, VECTOR_SIZE);
+  tweak_id server_id = tweak_app_server_add_item(server_context, "/lut", "test", "test", &value, NULL);
+  TEST_CHECK(server_id != TWEAK_INVALID_ID);
+
+  tweak_app_client_context client_context = tweak_app_create_client_context(
+    "nng", "role=client", uri0, NULL);
+  TEST_CHECK(client_context != NULL);
+  const char* uri = "/lut";
+  tweak_id client_id = TWEAK_INVALID_ID;
+  TEST_CHECK(tweak_app_client_wait_uris(client_context, &uri, 1, &client_id, 5 * WAIT_MILLIS)
+    == TWEAK_APP_SUCCESS);
+
+  const uint16_t server_range[] = { 1, 2, 3 };
+  TEST_CHECK(tweak_app_item_store_vector_range(server_context, server_id,
+    TWEAK_VARIANT_TYPE_VECTOR_UINT16, 10, 3, server_range) == TWEAK_APP_SUCCESS);
+  const uint16_t expected_server_range[] = { 0, 1, 2, 3, 0 };
+  TEST_CHECK(wait_vector_range(client_context, client_id, 9, expected_server_range, 5, 5 * WAIT_MILLIS));
+
+  uint16_t buffer[2];
+  TEST_CHECK(tweak_app_item_load_vector_range(client_context, client_id,
+    TWEAK_VARIANT_TYPE_VECTOR_UINT16, VECTOR_SIZE - 1, 2, buffer) == TWEAK_APP_INVALID_ARGUMENT);
+  TEST_CHECK(tweak_app_item_load_vector_range(client_context, client_id,
+    TWEAK_VARIANT_TYPE_VECTOR_UINT32, 0, 1, buffer) == TWEAK_APP_TYPE_MISMATCH);
+  TEST_CHECK(tweak_app_item_store_vector_range(server_context, server_id,
+    TWEAK_VARIANT_TYPE_VECTOR_UINT16, VECTOR_SIZE, 1, buffer) == TWEAK_APP_INVALID_ARGUMENT);
+
+  const uint16_t client_range[] = { 4, 5 };
+  TEST_CHECK(tweak_app_item_store_vector_range(client_context, client_id,
+    TWEAK_VARIANT_TYPE_VECTOR_UINT16, VECTOR_SIZE - 2, 2, client_range) == TWEAK_APP_SUCCESS);
+  TEST_CHECK(wait_vector_range(server_context, server_id, VECTOR_SIZE - 2, client_range, 2, 5 * WAIT_MILLIS));
+  TEST_CHECK(wait_vector_range(server_context, server_id, 10, server_range, 3, 5 * WAIT_MILLIS));
+
+  tweak_variant_destroy(&value);
+  tweak_app_destroy_context(client_context);
+  tweak_app_destroy_context(server_context);
+}
+
+struct item_read_result {
+  unsigned calls;
+  bool uri_matches;
+  bool description_matches;
+  float current_value;
+};
+
+static void check_item_view(const tweak_app_item_view* view, void* cookie) {
+  struct item_read_result* result = cookie;
+  ++result->calls;
+  result->uri_matches = strcmp(view->uri, "/float") == 0;
+  result->description_matches = strcmp(tweak_variant_string_c_str(view->description), "description") == 0;
+  result->current_value = view->current_value->type == TWEAK_VARIANT_TYPE_FLOAT
+    ? view->current_value->value.fp32 : -1.f;
+}
+
+void test_item_read(void) {
+  srand((unsigned)time(NULL));
+  char uri0[256];
+
+  int port = 32769 + rand() % 20000;
+  snprintf(uri0, sizeof(uri0), TWEAK_DEFAULT_ENDPOINT_TEMPLATE, port);
+
+  tweak_app_server_context server_context = tweak_app_create_server_context(
+    "nng", "role=server", uri0, NULL);
+  TEST_CHECK(server_context != NULL);
+  tweak_variant value = TWEAK_VARIANT_INIT_EMPTY;
+  tweak_variant_assign_float(&value, 1.5f);
+  tweak_id server_id = tweak_app_server_add_item(server_context, "/float", "description", "", &value, NULL);
+  TEST_CHECK(server_id != TWEAK_INVALID_ID);
+
+  struct item_read_result result = { 0 };
+  TEST_CHECK(tweak_app_item_read(server_context, server_id, &check_item_view, &result) == TWEAK_APP_SUCCESS);
+  TEST_CHECK(result.calls == 1);
+  TEST_CHECK(result.uri_matches);
+  TEST_CHECK(result.description_matches);
+  TEST_CHECK(result.current_value == 1.5f);
+
+  memset(&result, 0, sizeof(result));
+  TEST_CHECK(tweak_app_item_read(server_context, server_id + 1, &check_item_view, &result)
+    == TWEAK_APP_ITEM_NOT_FOUND);
+  TEST_CHECK(result.calls == 0);
+
+  tweak_app_client_context client_context = tweak_app_create_client_context(
+    "nng", "role=client", uri0, NULL);
+  TEST_CHECK(client_context != NULL);
+  const char* uri = "/float";
+  tweak_id client_id = TWEAK_INVALID_ID;
+  TEST_CHECK(tweak_app_client_wait_uris(client_context, &uri, 1, &client_id, 5 * WAIT_MILLIS)
+    == TWEAK_APP_SUCCESS);
+
+  memset(&result, 0, sizeof(result));
+  TEST_CHECK(tweak_app_item_read(client_context, client_id, &check_item_view, &result) == TWEAK_APP_SUCCESS);
+  TEST_CHECK(result.calls == 1);
+  TEST_CHECK(result.uri_matches);
+  TEST_CHECK(result.current_value == 1.5f);
+
+  tweak_variant_destroy(&value);
+  tweak_app_destroy_context(client_context);
+  tweak_app_destroy_context(server_context);
+}
+
+void test_replace_values(void) {
+  enum { NUM_ITEMS = 40 };
+  srand((unsigned)time(NULL));
+  char uri0[256];
+
+  int port = 32769 + rand() % 20000;
+  snprintf(uri0, sizeof(uri0), TWEAK_DEFAULT_ENDPOINT_TEMPLATE, port);
+
+  tweak_app_server_context server_context = tweak_app_create_server_context(
+    "nng", "role=server", uri0, NULL);
+  TEST_CHECK(server_context != NULL);
+  tweak_id ids[NUM_ITEMS];
+  char uris[NUM_ITEMS][32];
+  for (size_t ix = 0; ix < NUM_ITEMS; ix++) {
+    snprintf(uris[ix], sizeof(uris[ix]), "/gain_%zu", ix);
+    ids[ix] = add_float_item(server_context, uris[ix], 0.f);
+    TEST_CHECK(ids[ix] != TWEAK_INVALID_ID);
+  }
+
+  tweak_app_client_context client_context = tweak_app_create_client_context(
+    "nng", "role=client", uri0, NULL);
+  TEST_CHECK(client_context != NULL);
+  const char* last_uri = uris[NUM_ITEMS - 1];
+  TEST_CHECK(tweak_app_client_wait_uris(client_context, &last_uri, 1, NULL, 5 * WAIT_MILLIS)
+    == TWEAK_APP_SUCCESS);
+
+  tweak_variant values[NUM_ITEMS];
+  for (size_t ix = 0; ix < NUM_ITEMS; ix++) {
+    values[ix] = (tweak_variant)TWEAK_VARIANT_INIT_EMPTY;
+    tweak_variant_assign_float(&values[ix], (float)ix + 1.f);
+  }
+  TEST_CHECK(tweak_app_item_replace_values(server_context, ids, values, NUM_ITEMS) == TWEAK_APP_SUCCESS);
+  for (size_t ix = 0; ix < NUM_ITEMS; ix++) {
+    tweak_variant_destroy(&values[ix]);
+    TEST_CHECK(wait_float_value(client_context, uris[ix], (float)ix + 1.f, 5 * WAIT_MILLIS));
+  }
+
+  tweak_id bad_ids[] = { ids[0], TWEAK_INVALID_ID };
+  for (size_t ix = 0; ix < 2; ix++) {
+    tweak_variant_assign_float(&values[ix], -1.f);
+  }
+  TEST_CHECK(tweak_app_item_replace_values(server_context, bad_ids, values, 2) == TWEAK_APP_ITEM_NOT_FOUND);
+  TEST_CHECK(wait_float_value(server_context, uris[0], 1.f, 0));
+
+  tweak_id client_ids[2];
+  const char* client_uris[2] = { uris[0], uris[1] };
+  TEST_CHECK(tweak_app_client_wait_uris(client_context, client_uris, 2, client_ids, 5 * WAIT_MILLIS)
+    == TWEAK_APP_SUCCESS);
+  TEST_CHECK(tweak_app_item_replace_values(client_context, client_ids, values, 2) == TWEAK_APP_SUCCESS);
+  TEST_CHECK(wait_float_value(server_context, uris[0], -1.f, 5 * WAIT_MILLIS));
+  TEST_CHECK(wait_float_value(server_context, uris[1], -1.f, 5 * WAIT_MILLIS));
+  for (size_t ix = 0; ix < 2; ix++) {
+    tweak_variant_destroy(&values[ix]);
+  }
+
+  tweak_app_destroy_context(client_context);
+  tweak_app_destroy_context(server_context);
+}
+
+struct callback_gate {
+  tweak_common_mutex lock;
+  tweak_common_cond cond;
+  bool open;
+  tweak_id last_id;
+  float last_value;
+};
+
+static void gated_item_changed_handler(tweak_app_context context,
+  tweak_id id, tweak_variant* value, void *cookie)
+{
+  (void)context;
+  struct callback_gate* gate = cookie;
+  tweak_common_mutex_lock(&gate->lock);
+  while (!gate->open) {
+    tweak_common_cond_wait(&gate->cond, &gate->lock);
+  }
+  gate->last_id = id;
+  gate->last_value = value->value.fp32;
+  tweak_common_mutex_unlock(&gate->lock);
+}
+
+static void wait_callback_stats(tweak_app_server_context server_context, uint64_t change_count,
+  uint64_t callback_count, tweak_app_server_callback_stats* stats, uint32_t millis)
+{
+  tweak_app_server_get_callback_stats(server_context, stats);
+  for (uint32_t elapsed = 0;
+    (stats->change_count < change_count || stats->callback_count < callback_count) && elapsed < millis;
+    elapsed += 10)
+  {
+    tweak_common_sleep(10);
+    tweak_app_server_get_callback_stats(server_context, stats);
+  }
+}
+
+void test_callback_executor(void) {
+  srand((unsigned)time(NULL));
+  char uri0[256];
+
+  int port = 32769 + rand() % 20000;
+  snprintf(uri0, sizeof(uri0), TWEAK_DEFAULT_ENDPOINT_TEMPLATE, port);
+
+  struct callback_gate gate = { .open = false };
+  tweak_common_mutex_init(&gate.lock);
+  tweak_common_cond_init(&gate.cond);
+  tweak_app_server_callbacks server_callbacks = {
+    .cookie = &gate,
+    .on_current_value_changed = &gated_item_changed_handler,
+    .callback_dispatch = TWEAK_APP_CALLBACK_DISPATCH_EXECUTOR
+  };
+  tweak_app_server_context server_context = tweak_app_create_server_context(
+    "nng", "role=server", uri0, &server_callbacks);
+  TEST_CHECK(server_context != NULL);
+  tweak_id gain_id = add_float_item(server_context, "/gain", 0.f);
+  TEST_CHECK(add_float_item(server_context, "/offset", 0.f) != TWEAK_INVALID_ID);
+
+  tweak_app_client_context client_context = tweak_app_create_client_context(
+    "nng", "role=client", uri0, NULL);
+  TEST_CHECK(client_context != NULL);
+  const char* uris[] = { "/gain", "/offset" };
+  TEST_CHECK(tweak_app_client_wait_uris(client_context, uris, 2, NULL, 5 * WAIT_MILLIS)
+    == TWEAK_APP_SUCCESS);
+
+  /* Callback on /gain is stuck, requests are still applied */
+  set_float_value(client_context, "/gain", 1.f);
+  set_float_value(client_context, "/offset", 2.f);
+  TEST_CHECK(wait_float_value(server_context, "/offset", 2.f, 5 * WAIT_MILLIS));
+  set_float_value(client_context, "/gain", 3.f);
+  TEST_CHECK(wait_float_value(server_context, "/gain", 3.f, 5 * WAIT_MILLIS));
+  set_float_value(client_context, "/gain", 4.f);
+  TEST_CHECK(wait_float_value(server_context, "/gain", 4.f, 5 * WAIT_MILLIS));
+
+  tweak_app_server_callback_stats stats;
+  wait_callback_stats(server_context, 4, 0, &stats, 5 * WAIT_MILLIS);
+  TEST_CHECK(stats.change_count == 4);
+  TEST_CHECK(stats.callback_count == 0);
+
+  tweak_common_mutex_lock(&gate.lock);
+  gate.open = true;
+  tweak_common_cond_broadcast(&gate.cond);
+  tweak_common_mutex_unlock(&gate.lock);
+
+  /* Second and third change of /gain are coalesced */
+  wait_callback_stats(server_context, 4, 3, &stats, 5 * WAIT_MILLIS);
+  TEST_CHECK(stats.callback_count == 3);
+  TEST_MSG("callback_count = %" PRIu64, stats.callback_count);
+  TEST_CHECK(stats.callback_max_ns > 0);
+  TEST_CHECK(stats.callback_total_ns >= stats.callback_max_ns);
+  tweak_common_mutex_lock(&gate.lock);
+  TEST_CHECK(gate.last_id == gain_id);
+  TEST_CHECK(gate.last_value == 4.f);
+  tweak_common_mutex_unlock(&gate.lock);
+
+  tweak_app_destroy_context(client_context);
+  tweak_app_destroy_context(server_context);
+  tweak_common_cond_destroy(&gate.cond);
+  tweak_common_mutex_destroy(&gate.lock);
+}
+
+static bool is_event_fd_readable(int event_fd) {
+#if defined(__linux__)
+  struct pollfd pollfd = { .fd = event_fd, .events = POLLIN };
+  return poll(&pollfd, 1, 0) == 1 && (pollfd.revents & POLLIN) != 0;
+#else
+  (void)event_fd;
+  return false;
+#endif
+}
+
+void test_drain_changes(void) {
+  enum { NUM_ITEMS = 100 };
+  enum { DRAIN_CHUNK = 16 };
+  srand((unsigned)time(NULL));
+  char uri0[256];
+
+  int port = 32769 + rand() % 20000;
+  snprintf(uri0, sizeof(uri0), TWEAK_DEFAULT_ENDPOINT_TEMPLATE, port);
+
+  tweak_app_server_context server_context = tweak_app_create_server_context(
+    "nng", "role=server", uri0, NULL);
+  TEST_CHECK(server_context != NULL);
+  tweak_id ids[NUM_ITEMS];
+  char uris[NUM_ITEMS][32];
+  for (size_t ix = 0; ix < NUM_ITEMS; ix++) {
+    snprintf(uris[ix], sizeof(uris[ix]), "/drain_%zu", ix);
+    ids[ix] = add_float_item(server_context, uris[ix], 0.f);
+    TEST_CHECK(ids[ix] != TWEAK_INVALID_ID);
+  }
+
+  tweak_app_client_context client_context = tweak_app_create_client_context(
+    "nng", "role=client", uri0, NULL);
+  TEST_CHECK(client_context != NULL);
+  const char* last_uri = uris[NUM_ITEMS - 1];
+  TEST_CHECK(tweak_app_client_wait_uris(client_context, &last_uri, 1, NULL, 5 * WAIT_MILLIS)
+    == TWEAK_APP_SUCCESS);
+
+  int event_fd = tweak_app_get_event_fd(client_context);
+#if defined(__linux__)
+  TEST_CHECK(event_fd >= 0);
+#endif
+  TEST_CHECK(tweak_app_get_event_fd(client_context) == event_fd);
+  TEST_CHECK(!is_event_fd_readable(event_fd));
+
+  /* Every item is changed twice, each id shall be drained once */
+  for (size_t ix = 0; ix < NUM_ITEMS; ix++) {
+    set_float_value(server_context, uris[ix], 1.f);
+    set_float_value(server_context, uris[ix], 2.f);
+  }
+  for (size_t ix = 0; ix < NUM_ITEMS; ix++) {
+    TEST_CHECK(wait_float_value(client_context, uris[ix], 2.f, 5 * WAIT_MILLIS));
+  }
+#if defined(__linux__)
+  TEST_CHECK(is_event_fd_readable(event_fd));
+#endif
+
+  bool drained[NUM_ITEMS] = { false };
+  size_t total = 0;
+  tweak_id chunk[DRAIN_CHUNK];
+  size_t count;
+  while ((count = tweak_app_drain_changes(client_context, chunk, DRAIN_CHUNK)) > 0) {
+    TEST_CHECK(count <= DRAIN_CHUNK);
+    for (size_t ix = 0; ix < count; ix++) {
+      for (size_t item_no = 0; item_no < NUM_ITEMS; item_no++) {
+        if (ids[item_no] == chunk[ix]) {
+          TEST_CHECK(!drained[item_no]);
+          drained[item_no] = true;
+          ++total;
+        }
+      }
+    }
+  }
+  TEST_CHECK(total == NUM_ITEMS);
+  TEST_MSG("total = %zu", total);
+  TEST_CHECK(!is_event_fd_readable(event_fd));
+
+  tweak_app_destroy_context(client_context);
+  tweak_app_destroy_context(server_context);
+}
+
+struct poll_callback_state {
+  uint32_t count;
+  float last_value;
+};
+
+static void poll_item_changed_handler(tweak_app_context context,
+  tweak_id id, tweak_variant* value, void *cookie)
+{
+  (void)context;
+  (void)id;
+  struct poll_callback_state* state = cookie;
+  ++state->count;
+  state->last_value = value->value.fp32;
+}
+
+static bool poll_until_float_value(tweak_app_context polled_context, tweak_app_context context,
+  const char* uri, float expected_value, uint32_t millis)
+{
+  for (uint32_t elapsed = 0; elapsed <= millis; elapsed += 10) {
+    while (tweak_app_poll(polled_context, 1000)) {}
+    if (wait_float_value(context, uri, expected_value, 0)) {
+      return true;
+    }
+    tweak_common_sleep(10);
+  }
+  return false;
+}
+
+void test_poll_mode(void) {
+  enum { NUM_ITEMS = 10 };
+  srand((unsigned)time(NULL));
+  char uri0[256];
+
+  int port = 32769 + rand() % 20000;
+  snprintf(uri0, sizeof(uri0), TWEAK_DEFAULT_ENDPOINT_TEMPLATE, port);
+
+  /* Callback state is accessed by polling thread only */
+  struct poll_callback_state callback_state = { 0 };
+  tweak_app_server_callbacks server_callbacks = {
+    .cookie = &callback_state,
+    .on_current_value_changed = &poll_item_changed_handler,
+    .callback_dispatch = TWEAK_APP_CALLBACK_DISPATCH_EXECUTOR,
+    .io_mode = TWEAK_APP_IO_MODE_POLL
+  };
+  tweak_app_server_context server_context = tweak_app_create_server_context(
+    "nng", "role=server", uri0, &server_callbacks);
+  TEST_CHECK(server_context != NULL);
+  TEST_CHECK(tweak_app_set_queue_policy(server_context, TWEAK_APP_QUEUE_POLICY_BLOCK)
+    == TWEAK_APP_INVALID_ARGUMENT);
+  TEST_CHECK(tweak_app_set_queue_policy(server_context, TWEAK_APP_QUEUE_POLICY_MERGE)
+    == TWEAK_APP_SUCCESS);
+  char uris[NUM_ITEMS][32];
+  for (size_t ix = 0; ix < NUM_ITEMS; ix++) {
+    snprintf(uris[ix], sizeof(uris[ix]), "/poll_%zu", ix);
+    TEST_CHECK(add_float_item(server_context, uris[ix], 0.f) != TWEAK_INVALID_ID);
+  }
+
+  tweak_app_client_context client_context = tweak_app_create_client_context(
+    "nng", "role=client", uri0, NULL);
+  TEST_CHECK(client_context != NULL);
+  TEST_CHECK(!tweak_app_poll(client_context, 1000));
+
+  /* Nothing is sent to client unless server is polled */
+  tweak_common_sleep(WAIT_MILLIS / 5);
+  TEST_CHECK(count_items(client_context) == 0);
+  TEST_CHECK(poll_until_float_value(server_context, client_context, uris[NUM_ITEMS - 1], 0.f, 5 * WAIT_MILLIS));
+
+  /* Requests of client are applied by transport, callback is invoked by polling thread */
+  set_float_value(client_context, uris[0], 5.f);
+  TEST_CHECK(wait_float_value(server_context, uris[0], 5.f, 5 * WAIT_MILLIS));
+  TEST_CHECK(callback_state.count == 0);
+  while (tweak_app_poll(server_context, 1000)) {}
+  TEST_CHECK(callback_state.count == 1);
+  TEST_CHECK(callback_state.last_value == 5.f);
+
+  /* Zero budget runs a single job */
+  for (size_t ix = 0; ix < NUM_ITEMS; ix++) {
+    set_float_value(server_context, uris[ix], 7.f);
+  }
+  TEST_CHECK(tweak_app_poll(server_context, 0));
+  tweak_app_flush_queue(server_context);
+  for (size_t ix = 0; ix < NUM_ITEMS; ix++) {
+    TEST_CHECK(wait_float_value(client_context, uris[ix], 7.f, 5 * WAIT_MILLIS));
+  }
+  TEST_CHECK(!tweak_app_poll(server_context, 1000));
+
+  tweak_app_destroy_context(client_context);
+  tweak_app_destroy_context(server_context);
+}
+
+static size_t count_float_values(tweak_app_context context, char (*uris)[32], size_t uris_size,
+  float expected_value)
+{
+  size_t count = 0;
+  for (size_t ix = 0; ix < uris_size; ix++) {
+    count += wait_float_value(context, uris[ix], expected_value, 0) ? 1 : 0;
+  }
+  return count;
+}
+
+void test_queue_drop_count(void) {
+  enum { NUM_ITEMS = 250 };
+  srand((unsigned)time(NULL));
+  char uri0[256];
+
+  int port = 32769 + rand() % 20000;
+  snprintf(uri0, sizeof(uri0), TWEAK_DEFAULT_ENDPOINT_TEMPLATE, port);
+
+  tweak_app_server_callbacks server_callbacks = {
+    .io_mode = TWEAK_APP_IO_MODE_POLL
+  };
+  tweak_app_server_context server_context = tweak_app_create_server_context(
+    "nng", "role=server", uri0, &server_callbacks);
+  TEST_CHECK(server_context != NULL);
+  char uris[NUM_ITEMS][32];
+  for (size_t ix = 0; ix < NUM_ITEMS; ix++) {
+    snprintf(uris[ix], sizeof(uris[ix]), "/drop_%zu", ix);
+    TEST_CHECK(add_float_item(server_context, uris[ix], 0.f) != TWEAK_INVALID_ID);
+  }
+  TEST_CHECK(tweak_app_set_queue_policy(server_context, TWEAK_APP_QUEUE_POLICY_DROP)
+    == TWEAK_APP_SUCCESS);
+
+  tweak_app_client_context client_context = tweak_app_create_client_context(
+    "nng", "role=client", uri0, NULL);
+  TEST_CHECK(client_context != NULL);
+  TEST_CHECK(poll_until_float_value(server_context, client_context, uris[NUM_ITEMS - 1], 0.f, 5 * WAIT_MILLIS));
+  TEST_CHECK(tweak_app_get_queue_drop_count(server_context) == 0);
+
+  /* Queue isn't drained unless server is polled. Changes beyond its size
+   * are deferred till it's drained, ones beyond twice its size are dropped */
+  for (size_t ix = 0; ix < NUM_ITEMS; ix++) {
+    set_float_value(server_context, uris[ix], 1.f);
+  }
+  uint64_t drop_count = tweak_app_get_queue_drop_count(server_context);
+  TEST_CHECK(drop_count > 0);
+  TEST_CHECK(drop_count < NUM_ITEMS);
+
+  /* Last change has been dropped, so it isn't merged into a pending one */
+  set_float_value(server_context, uris[NUM_ITEMS - 1], 2.f);
+  TEST_CHECK(tweak_app_get_queue_drop_count(server_context) == drop_count + 1);
+  TEST_CHECK(wait_float_value(server_context, uris[NUM_ITEMS - 1], 2.f, 0));
+
+  /* Every change that hasn't been dropped reaches the client, deferred ones included */
+  size_t sent_count = NUM_ITEMS - (size_t)drop_count;
+  for (uint32_t elapsed = 0; elapsed <= 5 * WAIT_MILLIS; elapsed += 10) {
+    while (tweak_app_poll(server_context, 1000)) {}
+    if (count_float_values(client_context, uris, NUM_ITEMS, 1.f) == sent_count) {
+      break;
+    }
+    tweak_common_sleep(10);
+  }
+  TEST_CHECK(count_float_values(client_context, uris, NUM_ITEMS, 1.f) == sent_count);
+  TEST_MSG("sent_count = %zu", sent_count);
+
+  /* Dropped value reaches the client with the next change of the item */
+  set_float_value(server_context, uris[NUM_ITEMS - 1], 3.f);
+  TEST_CHECK(poll_until_float_value(server_context, client_context, uris[NUM_ITEMS - 1], 3.f, 5 * WAIT_MILLIS));
+  TEST_CHECK(tweak_app_get_queue_drop_count(server_context) == drop_count + 1);
+
+  tweak_app_destroy_context(client_context);
+  tweak_app_destroy_context(server_context);
+}
+
 TEST_LIST = {
    { "test-invalid-uri", test_invalid_uri },
    { "test-app", test_app },
    { "test-wait-uri", test_wait_uri },
+   { "test-traverse-subtree", test_traverse_subtree },
+   { "test-subscribe", test_subscribe },
+   { "test-multiple-clients", test_multiple_clients },
+   { "test-shared-session-subscribe", test_shared_session_subscribe },
+   { "test-server-restart", test_server_restart },
+   { "test-server-restart-many-items", test_server_restart_many_items },
+   { "test-server-reconnect", test_server_reconnect },
+   { "test-vector-range", test_vector_range },
+   { "test-item-read", test_item_read },
+   { "test-replace-values", test_replace_values },
+   { "test-callback-executor", test_callback_executor },
+   { "test-drain-changes", test_drain_changes },
+   { "test-poll-mode", test_poll_mode },
+   { "test-queue-drop-count", test_queue_drop_count },
    { NULL, NULL }     /* zeroed record marking the end of the list */
 };
@@ -38,6 +38,10 @@
 
 #define VECTORS_SUPPORTED_JSON "{\"vectors\": true}"
 #define VECTORS_NOT_SUPPORTED_JSON "{\"vectors\": false}"
+#define CHANGE_ITEMS_SUPPORTED_JSON "{\"vectors\": true, \"change_items\": true}"
+#define ADD_ITEMS_SUPPORTED_JSON "{\"vectors\": true, \"add_items\": true}"
+#define PACKED_VECTORS_SUPPORTED_JSON "{\"vectors\": true, \"packed_vectors\": true}"
+#define PARTIAL_CHANGES_SUPPORTED_JSON "{\"vectors\": true, \"partial_changes\": true}"
 
 void test_features(void) {
     tweak_variant_string vectors_supported_vs = TWEAK_VARIANT_STRING_EMPTY;
@@ -64,8 +68,125 @@ void test_features(void) {
     TEST_CHECK(deserialized_t.vectors);
 }
 
+void test_features_change_items(void) {
+    tweak_variant_string legacy_vs = TWEAK_VARIANT_STRING_EMPTY;
+    tweak_assign_string(&legacy_vs, VECTORS_SUPPORTED_JSON);
+    tweak_variant_string change_items_supported_vs = TWEAK_VARIANT_STRING_EMPTY;
+    tweak_assign_string(&change_items_supported_vs, CHANGE_ITEMS_SUPPORTED_JSON);
+
+    struct tweak_app_features legacy = { 0 };
+    struct tweak_app_features change_items_supported = { 0 };
+
+    TEST_CHECK(tweak_app_features_from_json(&legacy_vs, &legacy));
+    TEST_CHECK(tweak_app_features_from_json(&change_items_supported_vs, &change_items_supported));
+
+    TEST_CHECK(legacy.vectors);
+    TEST_CHECK(!legacy.change_items);
+    TEST_CHECK(change_items_supported.change_items);
+
+    struct tweak_app_features combined = tweak_app_features_combine(&change_items_supported, &legacy);
+    TEST_CHECK(combined.vectors);
+    TEST_CHECK(!combined.change_items);
+
+    struct tweak_app_features defaults = { 0 };
+    tweak_app_features_init_default(&defaults);
+    tweak_variant_string serialized = tweak_app_features_to_json(&defaults);
+    struct tweak_app_features deserialized = { 0 };
+    TEST_CHECK(tweak_app_features_from_json(&serialized, &deserialized));
+    TEST_CHECK(deserialized.change_items);
+
+    tweak_variant_destroy_string(&serialized);
+    tweak_variant_destroy_string(&change_items_supported_vs);
+    tweak_variant_destroy_string(&legacy_vs);
+}
+
+void test_features_add_items(void) {
+    tweak_variant_string add_items_supported_vs = TWEAK_VARIANT_STRING_EMPTY;
+    tweak_assign_string(&add_items_supported_vs, ADD_ITEMS_SUPPORTED_JSON);
+
+    struct tweak_app_features add_items_supported = { 0 };
+    TEST_CHECK(tweak_app_features_from_json(&add_items_supported_vs, &add_items_supported));
+    TEST_CHECK(add_items_supported.add_items);
+    TEST_CHECK(!add_items_supported.change_items);
+
+    struct tweak_app_features minimal = { 0 };
+    tweak_app_features_init_minimal(&minimal);
+    TEST_CHECK(!tweak_app_features_combine(&add_items_supported, &minimal).add_items);
+
+    struct tweak_app_features defaults = { 0 };
+    tweak_app_features_init_default(&defaults);
+    tweak_variant_string serialized = tweak_app_features_to_json(&defaults);
+    struct tweak_app_features deserialized = { 0 };
+    TEST_CHECK(tweak_app_features_from_json(&serialized, &deserialized));
+    TEST_CHECK(deserialized.add_items);
+
+    tweak_variant_destroy_string(&serialized);
+    tweak_variant_destroy_string(&add_items_supported_vs);
+}
+
+void test_features_packed_vectors(void) {
+    tweak_variant_string packed_vectors_supported_vs = TWEAK_VARIANT_STRING_EMPTY;
+    tweak_assign_string(&packed_vectors_supported_vs, PACKED_VECTORS_SUPPORTED_JSON);
+
+    struct tweak_app_features packed_vectors_supported = { 0 };
+    TEST_CHECK(tweak_app_features_from_json(&packed_vectors_supported_vs, &packed_vectors_supported));
+    TEST_CHECK(packed_vectors_supported.packed_vectors);
+    TEST_CHECK(!packed_vectors_supported.add_items);
+
+    struct tweak_app_features add_items_only = { 0 };
+    tweak_variant_string add_items_supported_vs = TWEAK_VARIANT_STRING_EMPTY;
+    tweak_assign_string(&add_items_supported_vs, ADD_ITEMS_SUPPORTED_JSON);
+    TEST_CHECK(tweak_app_features_from_json(&add_items_supported_vs, &add_items_only));
+    TEST_CHECK(!add_items_only.packed_vectors);
+    TEST_CHECK(!tweak_app_features_combine(&packed_vectors_supported, &add_items_only).packed_vectors);
+
+    struct tweak_app_features defaults = { 0 };
+    tweak_app_features_init_default(&defaults);
+    tweak_variant_string serialized = tweak_app_features_to_json(&defaults);
+    struct tweak_app_features deserialized = { 0 };
+    TEST_CHECK(tweak_app_features_from_json(&serialized, &deserialized));
+    TEST_CHECK(deserialized.packed_vectors);
+    TEST_CHECK(deserialized.add_items);
+    TEST_CHECK(deserialized.change_items);
+
+    tweak_variant_destroy_string(&serialized);
+    tweak_variant_destroy_string(&add_items_supported_vs);
+    tweak_variant_destroy_string(&packed_vectors_supported_vs);
+}
+
+void test_features_partial_changes(void) {
+    tweak_variant_string partial_changes_supported_vs = TWEAK_VARIANT_STRING_EMPTY;
+    tweak_assign_string(&partial_changes_supported_vs, PARTIAL_CHANGES_SUPPORTED_JSON);
+    tweak_variant_string legacy_vs = TWEAK_VARIANT_STRING_EMPTY;
+    tweak_assign_string(&legacy_vs, PACKED_VECTORS_SUPPORTED_JSON);
+
+    struct tweak_app_features partial_changes_supported = { 0 };
+    struct tweak_app_features legacy = { 0 };
+    TEST_CHECK(tweak_app_features_from_json(&partial_changes_supported_vs, &partial_changes_supported));
+    TEST_CHECK(tweak_app_features_from_json(&legacy_vs, &legacy));
+    TEST_CHECK(partial_changes_supported.partial_changes);
+    TEST_CHECK(!legacy.partial_changes);
+    TEST_CHECK(!tweak_app_features_combine(&partial_changes_supported, &legacy).partial_changes);
+
+    struct tweak_app_features defaults = { 0 };
+    tweak_app_features_init_default(&defaults);
+    tweak_variant_string serialized = tweak_app_features_to_json(&defaults);
+    struct tweak_app_features deserialized = { 0 };
+    TEST_CHECK(tweak_app_features_from_json(&serialized, &deserialized));
+    TEST_CHECK(deserialized.partial_changes);
+    TEST_CHECK(deserialized.packed_vectors);
+
+    tweak_variant_destroy_string(&serialized);
+    tweak_variant_destroy_string(&legacy_vs);
+    tweak_variant_destroy_string(&partial_changes_supported_vs);
+}
+
 TEST_LIST = {
    { "test_features", test_features },
+   { "test_features_change_items", test_features_change_items },
+   { "test_features_add_items", test_features_add_items },
+   { "test_features_packed_vectors", test_features_packed_vectors },
+   { "test_features_partial_changes", test_features_partial_changes },
    { NULL, NULL }     /* zeroed record marking the end of the list */
 };
 
@@ -0,0 +1,161 @@
+/**
+ * @file test-model-bench.c
+ * @ingroup tweak-app-implementation-test
+ *
+ * @brief microbenchmark for tweak2 model registration and teardown.
+ *
+ * @copyright 2020-2022 Cogent Embedded, Inc. ALL RIGHTS RESERVED.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/**
+ * @defgroup tweak-app-implementation-test Test implementation for tweak-app internal interfaces.
+ */
+
+#include <tweak2/log.h>
+#include <tweak2/string.h>
+#include <tweak2/thread.h>
+#include <tweak2/variant.h>
+
+#include "tweakmodel.h"
+#include "tweakmodel_uri_to_tweak_id_index.h"
+
+#include <acutest.h>
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+enum { NUM_TWEAKS = 100000 };
+enum { NUM_ROUNDS = 3 };
+enum { NUM_CHURN_ITERATIONS = 10 };
+
+static double get_nanos_per_op(uint64_t nanos, uint64_t num_ops) {
+  return num_ops ? (double)nanos / (double)num_ops : 0.;
+}
+
+static void make_uri(char* buff, size_t size, tweak_id id) {
+  snprintf(buff, size, "/bench/group_%" PRIu64 "/item_%" PRIu64, id / 100, id % 100);
+}
+
+static void register_item(tweak_model model, tweak_model_uri_to_tweak_id_index index, tweak_id id) {
+  char buff[128];
+  make_uri(buff, sizeof(buff), id);
+  tweak_variant_string uri = TWEAK_VARIANT_STRING_EMPTY;
+  tweak_variant_string description = TWEAK_VARIANT_STRING_EMPTY;
+  tweak_variant_string meta = TWEAK_VARIANT_STRING_EMPTY;
+  tweak_variant value = TWEAK_VARIANT_INIT_EMPTY;
+  tweak_assign_string(&uri, buff);
+  tweak_assign_string(&description, "Benchmark item");
+  tweak_variant_assign_float(&value, (float)id);
+  TEST_CHECK(tweak_model_create_item(model, id, &uri, &description, &meta,
+    &value, &value, NULL) == TWEAK_MODEL_SUCCESS);
+  TEST_CHECK(tweak_model_uri_to_tweak_id_index_insert(index, buff, id)
+    == TWEAK_MODEL_INDEX_SUCCESS);
+  tweak_variant_destroy_string(&uri);
+  tweak_variant_destroy_string(&description);
+  tweak_variant_destroy_string(&meta);
+  tweak_variant_destroy(&value);
+}
+
+static void unregister_item(tweak_model model, tweak_model_uri_to_tweak_id_index index, tweak_id id) {
+  char buff[128];
+  make_uri(buff, sizeof(buff), id);
+  TEST_CHECK(tweak_model_uri_to_tweak_id_index_remove(index, buff) == TWEAK_MODEL_INDEX_SUCCESS);
+  TEST_CHECK(tweak_model_remove_item(model, id) == TWEAK_MODEL_SUCCESS);
+}
+
+/*
+ * Startup registration of many items and shutdown of the whole model.
+ */
+void test_model_bulk_bench(void) {
+  for (int round = 0; round < NUM_ROUNDS; round++) {
+    tweak_common_timestamp start;
+    tweak_common_timestamp middle;
+    tweak_common_timestamp end;
+    tweak_model model = tweak_model_create();
+    tweak_model_uri_to_tweak_id_index index = tweak_model_uri_to_tweak_id_index_create();
+    TEST_CHECK(model != NULL);
+    TEST_CHECK(index != NULL);
+
+    tweak_common_timestamp_now(&start);
+    for (tweak_id id = 1; id <= NUM_TWEAKS; id++) {
+      register_item(model, index, id);
+    }
+    tweak_common_timestamp_now(&middle);
+    tweak_model_uri_to_tweak_id_index_destroy(index);
+    tweak_model_destroy(model);
+    tweak_common_timestamp_now(&end);
+
+    TWEAK_LOG_TEST("%d items: registration %.1f ns, teardown %.1f ns per item",
+      NUM_TWEAKS,
+      get_nanos_per_op(tweak_common_timestamp_subtract_timestamps(&middle, &start), NUM_TWEAKS),
+      get_nanos_per_op(tweak_common_timestamp_subtract_timestamps(&end, &middle), NUM_TWEAKS));
+  }
+}
+
+/*
+ * Removing and adding items on a populated model shall reuse released nodes.
+ */
+void test_model_churn_bench(void) {
+  tweak_common_timestamp start;
+  tweak_common_timestamp end;
+  tweak_model model = tweak_model_create();
+  tweak_model_uri_to_tweak_id_index index = tweak_model_uri_to_tweak_id_index_create();
+  TEST_CHECK(model != NULL);
+  TEST_CHECK(index != NULL);
+
+  for (tweak_id id = 1; id <= NUM_TWEAKS; id++) {
+    register_item(model, index, id);
+  }
+
+  tweak_common_timestamp_now(&start);
+  for (int itr = 0; itr < NUM_CHURN_ITERATIONS; itr++) {
+    for (tweak_id id = 1; id <= NUM_TWEAKS; id += 2) {
+      unregister_item(model, index, id);
+    }
+    for (tweak_id id = 1; id <= NUM_TWEAKS; id += 2) {
+      register_item(model, index, id);
+    }
+  }
+  tweak_common_timestamp_now(&end);
+
+  for (tweak_id id = 1; id <= NUM_TWEAKS; id++) {
+    char buff[128];
+    make_uri(buff, sizeof(buff), id);
+    tweak_item* item = tweak_model_find_item_by_id(model, id);
+    TEST_CHECK(item != NULL && item->id == id);
+    TEST_CHECK(tweak_model_uri_to_tweak_id_index_lookup(index, buff) == id);
+  }
+
+  tweak_model_uri_to_tweak_id_index_destroy(index);
+  tweak_model_destroy(model);
+
+  TWEAK_LOG_TEST("%d items: remove or add %.1f ns per operation",
+    NUM_TWEAKS,
+    get_nanos_per_op(tweak_common_timestamp_subtract_timestamps(&end, &start),
+      (uint64_t)NUM_CHURN_ITERATIONS * NUM_TWEAKS));
+}
+
+TEST_LIST = {
+   { "test_model_bulk_bench", test_model_bulk_bench },
+   { "test_model_churn_bench", test_model_churn_bench },
+   { NULL, NULL }     /* zeroed record marking the end of the list */
+};
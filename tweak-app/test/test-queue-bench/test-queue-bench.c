@@ -0,0 +1,168 @@
+/**
+ * @file test-queue-bench.c
+ * @ingroup tweak-app-implementation-test
+ *
+ * @brief microbenchmark for tweak2 application io queue.
+ *
+ * @copyright 2020-2022 Cogent Embedded, Inc. ALL RIGHTS RESERVED.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/**
+ * @defgroup tweak-app-implementation-test Test implementation for tweak-app internal interfaces.
+ */
+
+#include <tweak2/log.h>
+#include <tweak2/thread.h>
+
+#include "tweakappqueue.h"
+
+#include <acutest.h>
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+enum { MAX_PENDING = 65536 };
+enum { NUM_PRODUCERS = 4 };
+enum { NUM_PRODUCER_ITERATIONS = 200000 };
+
+static void bench_job(tweak_id id, void* cookie) {
+  (void)id;
+  (void)cookie;
+}
+
+static double get_nanos_per_op(uint64_t nanos, uint64_t num_ops) {
+  return num_ops ? (double)nanos / (double)num_ops : 0.;
+}
+
+/*
+ * Push cost shall not depend on number of jobs already pending.
+ * Every batch is pushed in full before it's pulled, so the last
+ * pushes of the largest batch face MAX_PENDING pending jobs.
+ */
+void test_queue_push_bench(void) {
+  static tweak_id out;
+  struct job_queue* job_queue = tweak_app_queue_create(MAX_PENDING);
+  TEST_CHECK(job_queue != NULL);
+  for (size_t num_pending = 256; num_pending <= MAX_PENDING; num_pending *= 4) {
+    tweak_common_timestamp start;
+    tweak_common_timestamp middle;
+    tweak_common_timestamp end;
+    tweak_common_timestamp_now(&start);
+    for (tweak_id id = 1; id <= num_pending; id++) {
+      struct job job = { .job_proc = &bench_job, .tweak_id = id, .cookie = &out };
+      tweak_app_queue_push(job_queue, &job);
+    }
+    tweak_common_timestamp_now(&middle);
+    for (tweak_id id = 1; id <= num_pending; id++) {
+      struct job job = { .job_proc = &bench_job, .tweak_id = id, .cookie = &out };
+      tweak_app_queue_push(job_queue, &job);
+    }
+    tweak_common_timestamp_now(&end);
+
+    struct pull_jobs_result pull_jobs_result = tweak_app_queue_pull(job_queue);
+    TEST_CHECK(!pull_jobs_result.is_stopped);
+    TEST_CHECK(pull_jobs_result.job_array->size == num_pending);
+
+    TWEAK_LOG_TEST("%zu pending jobs: unique push %.1f ns, duplicate push %.1f ns",
+      num_pending,
+      get_nanos_per_op(tweak_common_timestamp_subtract_timestamps(&middle, &start), num_pending),
+      get_nanos_per_op(tweak_common_timestamp_subtract_timestamps(&end, &middle), num_pending));
+  }
+  tweak_app_queue_stop(job_queue);
+  tweak_app_queue_destroy(job_queue);
+}
+
+struct producer_context {
+  struct job_queue* job_queue;
+  tweak_id base_id;
+};
+
+static void* producer(void* arg) {
+  static tweak_id out;
+  struct producer_context* context = arg;
+  for (uint32_t ix = 0; ix < NUM_PRODUCER_ITERATIONS; ix++) {
+    struct job job = {
+      .job_proc = &bench_job,
+      .tweak_id = context->base_id + (ix % (MAX_PENDING / NUM_PRODUCERS)),
+      .cookie = &out
+    };
+    tweak_app_queue_push(context->job_queue, &job);
+  }
+  return NULL;
+}
+
+static void* consumer(void* arg) {
+  struct job_queue* job_queue = arg;
+  for (;;) {
+    struct pull_jobs_result pull_jobs_result = tweak_app_queue_pull(job_queue);
+    if (pull_jobs_result.is_stopped) {
+      break;
+    }
+    for (size_t ix = 0; ix < pull_jobs_result.job_array->size; ix++) {
+      const struct job* job = &pull_jobs_result.job_array->jobs[ix];
+      job->job_proc(job->tweak_id, job->cookie);
+    }
+  }
+  return NULL;
+}
+
+/*
+ * Producers setting thousands of distinct items between two pulls
+ * shall not serialize behind the queue lock for long.
+ */
+void test_queue_producers_bench(void) {
+  struct producer_context contexts[NUM_PRODUCERS];
+  tweak_common_thread producers[NUM_PRODUCERS];
+  tweak_common_thread consumer_thread;
+  tweak_common_timestamp start;
+  tweak_common_timestamp end;
+  struct job_queue* job_queue = tweak_app_queue_create(MAX_PENDING);
+  TEST_CHECK(job_queue != NULL);
+  TEST_CHECK(tweak_common_thread_create(&consumer_thread, &consumer, job_queue)
+    == TWEAK_COMMON_THREAD_SUCCESS);
+  tweak_common_timestamp_now(&start);
+  for (size_t ix = 0; ix < NUM_PRODUCERS; ix++) {
+    contexts[ix].job_queue = job_queue;
+    contexts[ix].base_id = (tweak_id)(ix * (MAX_PENDING / NUM_PRODUCERS)) + 1;
+    TEST_CHECK(tweak_common_thread_create(&producers[ix], &producer, &contexts[ix])
+      == TWEAK_COMMON_THREAD_SUCCESS);
+  }
+  for (size_t ix = 0; ix < NUM_PRODUCERS; ix++) {
+    tweak_common_thread_join(producers[ix], NULL);
+  }
+  tweak_common_timestamp_now(&end);
+  tweak_app_queue_wait_empty(job_queue);
+  tweak_app_queue_stop(job_queue);
+  tweak_common_thread_join(consumer_thread, NULL);
+  tweak_app_queue_destroy(job_queue);
+
+  TWEAK_LOG_TEST("%d producers: %.1f ns per push",
+    NUM_PRODUCERS,
+    get_nanos_per_op(tweak_common_timestamp_subtract_timestamps(&end, &start),
+      (uint64_t)NUM_PRODUCERS * NUM_PRODUCER_ITERATIONS));
+}
+
+TEST_LIST = {
+   { "test_queue_push_bench", test_queue_push_bench },
+   { "test_queue_producers_bench", test_queue_producers_bench },
+   { NULL, NULL }     /* zeroed record marking the end of the list */
+};
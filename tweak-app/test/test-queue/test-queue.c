@@ -203,8 +203,198 @@ void test_queue(void) {
   }
 }
 
+void test_queue_deduplication(void) {
+  enum { NUM_PENDING = 5000 };
+  static tweak_id outs[2];
+  struct job_queue* job_queue = tweak_app_queue_create(NUM_PENDING * JOB_ARR_SIZE * 2);
+  TEST_CHECK(job_queue != NULL);
+  for (int pass = 0; pass < 3; pass++) {
+    for (tweak_id id = 1; id <= NUM_PENDING; id++) {
+      for (size_t ix = 0; ix < JOB_ARR_SIZE; ix++) {
+        for (size_t cookie_ix = 0; cookie_ix < 2; cookie_ix++) {
+          struct job job = {
+            .tweak_id = id,
+            .job_proc = jobs[ix],
+            .cookie = &outs[cookie_ix]
+          };
+          tweak_app_queue_push(job_queue, &job);
+          tweak_app_queue_push(job_queue, &job);
+        }
+      }
+    }
+    struct pull_jobs_result pull_jobs_result = tweak_app_queue_pull(job_queue);
+    TEST_CHECK(!pull_jobs_result.is_stopped);
+    const struct job_array* job_array = pull_jobs_result.job_array;
+    TEST_CHECK(job_array->size == NUM_PENDING * JOB_ARR_SIZE * 2);
+    for (size_t ix = 0; ix < job_array->size; ix++) {
+      const struct job* job = &job_array->jobs[ix];
+      size_t expected_ix = ix / 2;
+      TEST_CHECK(job->tweak_id == (expected_ix / JOB_ARR_SIZE) + 1);
+      TEST_CHECK(job->job_proc == jobs[expected_ix % JOB_ARR_SIZE]);
+      TEST_CHECK(job->cookie == &outs[ix % 2]);
+    }
+  }
+  tweak_app_queue_stop(job_queue);
+  tweak_app_queue_destroy(job_queue);
+}
+
+void test_queue_policies(void) {
+  enum { QUEUE_SIZE = 4 };
+  static tweak_id out;
+  struct job_queue* job_queue = tweak_app_queue_create(QUEUE_SIZE);
+  TEST_CHECK(job_queue != NULL);
+
+  /* Jobs that don't fit are deferred to the next pull, ones beyond that are dropped */
+  TEST_CHECK(tweak_app_queue_set_policy(job_queue, JOB_QUEUE_POLICY_DROP));
+  for (tweak_id id = 1; id <= QUEUE_SIZE * 2 + 2; id++) {
+    struct job job = { .job_proc = &job1, .tweak_id = id, .cookie = &out };
+    TEST_CHECK(tweak_app_queue_push(job_queue, &job) == (id <= QUEUE_SIZE * 2));
+  }
+  for (tweak_id id = 1; id <= QUEUE_SIZE * 2; id++) {
+    struct job job = { .job_proc = &job1, .tweak_id = id, .cookie = &out };
+    TEST_CHECK(tweak_app_queue_push(job_queue, &job));
+  }
+  TEST_CHECK(tweak_app_queue_get_overflow_count(job_queue) == QUEUE_SIZE + 2);
+  TEST_CHECK(tweak_app_queue_get_drop_count(job_queue) == 2);
+  struct pull_jobs_result pull_jobs_result = tweak_app_queue_pull(job_queue);
+  TEST_CHECK(pull_jobs_result.job_array->size == QUEUE_SIZE);
+  pull_jobs_result = tweak_app_queue_try_pull(job_queue);
+  TEST_CHECK(pull_jobs_result.job_array != NULL);
+  TEST_CHECK(pull_jobs_result.job_array->size == QUEUE_SIZE);
+  for (size_t ix = 0; ix < pull_jobs_result.job_array->size; ix++) {
+    TEST_CHECK(pull_jobs_result.job_array->jobs[ix].tweak_id == QUEUE_SIZE + ix + 1);
+  }
+  TEST_CHECK(tweak_app_queue_try_pull(job_queue).job_array == NULL);
+
+  /* Every job of a batch that doesn't fit is counted */
+  struct job jobs[QUEUE_SIZE * 2 + 2];
+  for (size_t ix = 0; ix < QUEUE_SIZE * 2 + 2; ix++) {
+    jobs[ix] = (struct job) { .job_proc = &job1, .tweak_id = ix + 1, .cookie = &out };
+  }
+  TEST_CHECK(!tweak_app_queue_push_batch(job_queue, jobs, QUEUE_SIZE * 2 + 2));
+  TEST_CHECK(tweak_app_queue_get_drop_count(job_queue) == 4);
+  pull_jobs_result = tweak_app_queue_pull(job_queue);
+  TEST_CHECK(pull_jobs_result.job_array->size == QUEUE_SIZE);
+  pull_jobs_result = tweak_app_queue_pull(job_queue);
+  TEST_CHECK(pull_jobs_result.job_array->size == QUEUE_SIZE);
+
+  TEST_CHECK(tweak_app_queue_set_policy(job_queue, JOB_QUEUE_POLICY_MERGE));
+  for (int pass = 0; pass < 2; pass++) {
+    for (tweak_id id = 1; id <= QUEUE_SIZE * 2; id++) {
+      struct job job = { .job_proc = &job1, .tweak_id = id, .cookie = &out };
+      TEST_CHECK(tweak_app_queue_push(job_queue, &job));
+    }
+  }
+  TEST_CHECK(tweak_app_queue_get_overflow_count(job_queue) == 2 + QUEUE_SIZE * 2);
+  TEST_CHECK(tweak_app_queue_get_drop_count(job_queue) == 4);
+  pull_jobs_result = tweak_app_queue_pull(job_queue);
+  TEST_CHECK(pull_jobs_result.job_array->size == QUEUE_SIZE * 2);
+  for (size_t ix = 0; ix < pull_jobs_result.job_array->size; ix++) {
+    TEST_CHECK(pull_jobs_result.job_array->jobs[ix].tweak_id == ix + 1);
+  }
+
+  tweak_app_queue_stop(job_queue);
+  tweak_app_queue_destroy(job_queue);
+}
+
+static void range_job(tweak_id id, size_t offset, size_t count, void* cookie) {
+  tweak_id* pout = cookie;
+  *pout += id * 100 + offset * 10 + count;
+}
+
+void test_queue_range_jobs(void) {
+  static tweak_id out;
+  struct job_queue* job_queue = tweak_app_queue_create(16);
+  TEST_CHECK(job_queue != NULL);
+  for (int pass = 0; pass < 2; pass++) {
+    struct job whole = { .job_proc = &job1, .tweak_id = 1, .cookie = &out };
+    struct job range1 = { .range_job_proc = &range_job, .tweak_id = 1, .offset = 2, .count = 3, .cookie = &out };
+    struct job range2 = { .range_job_proc = &range_job, .tweak_id = 1, .offset = 2, .count = 4, .cookie = &out };
+    TEST_CHECK(tweak_app_queue_push(job_queue, &whole));
+    TEST_CHECK(tweak_app_queue_push(job_queue, &range1));
+    TEST_CHECK(tweak_app_queue_push(job_queue, &range2));
+  }
+  struct pull_jobs_result pull_jobs_result = tweak_app_queue_pull(job_queue);
+  TEST_CHECK(pull_jobs_result.job_array->size == 3);
+  out = 0;
+  tweak_app_queue_run_job(&pull_jobs_result.job_array->jobs[1]);
+  TEST_CHECK(out == 123);
+  tweak_app_queue_run_job(&pull_jobs_result.job_array->jobs[2]);
+  TEST_CHECK(out == 123 + 124);
+  tweak_app_queue_run_job(&pull_jobs_result.job_array->jobs[0]);
+  TEST_CHECK(out == 17 % 19);
+  tweak_app_queue_stop(job_queue);
+  tweak_app_queue_destroy(job_queue);
+}
+
+void test_queue_push_batch(void) {
+  enum { QUEUE_SIZE = 4, BATCH_SIZE = 6 };
+  static tweak_id out;
+  struct job batch[BATCH_SIZE];
+  for (size_t ix = 0; ix < BATCH_SIZE; ix++) {
+    struct job job = { .job_proc = &job1, .tweak_id = ix / 2 + 1, .cookie = &out };
+    batch[ix] = job;
+  }
+  struct job_queue* job_queue = tweak_app_queue_create(QUEUE_SIZE);
+  TEST_CHECK(job_queue != NULL);
+
+  TEST_CHECK(tweak_app_queue_push_batch(job_queue, batch, BATCH_SIZE));
+  TEST_CHECK(tweak_app_queue_push_batch(job_queue, batch, BATCH_SIZE));
+  struct pull_jobs_result pull_jobs_result = tweak_app_queue_pull(job_queue);
+  TEST_CHECK(pull_jobs_result.job_array->size == BATCH_SIZE / 2);
+  for (size_t ix = 0; ix < pull_jobs_result.job_array->size; ix++) {
+    TEST_CHECK(pull_jobs_result.job_array->jobs[ix].tweak_id == ix + 1);
+  }
+
+  for (size_t ix = 0; ix < BATCH_SIZE; ix++) {
+    batch[ix].tweak_id = ix + 1;
+  }
+  TEST_CHECK(tweak_app_queue_push_batch(job_queue, batch, BATCH_SIZE));
+  pull_jobs_result = tweak_app_queue_pull(job_queue);
+  TEST_CHECK(pull_jobs_result.job_array->size == BATCH_SIZE);
+
+  TEST_CHECK(tweak_app_queue_set_policy(job_queue, JOB_QUEUE_POLICY_DROP));
+  TEST_CHECK(tweak_app_queue_push_batch(job_queue, batch, BATCH_SIZE));
+  pull_jobs_result = tweak_app_queue_pull(job_queue);
+  TEST_CHECK(pull_jobs_result.job_array->size == QUEUE_SIZE);
+  pull_jobs_result = tweak_app_queue_pull(job_queue);
+  TEST_CHECK(pull_jobs_result.job_array->size == BATCH_SIZE - QUEUE_SIZE);
+
+  tweak_app_queue_stop(job_queue);
+  tweak_app_queue_destroy(job_queue);
+}
+
+void test_queue_try_pull(void) {
+  static tweak_id out;
+  struct job_queue* job_queue = tweak_app_queue_create(4);
+  TEST_CHECK(job_queue != NULL);
+
+  struct pull_jobs_result pull_jobs_result = tweak_app_queue_try_pull(job_queue);
+  TEST_CHECK(pull_jobs_result.job_array == NULL);
+  TEST_CHECK(!pull_jobs_result.is_stopped);
+
+  struct job job = { .job_proc = &job1, .tweak_id = 1, .cookie = &out };
+  TEST_CHECK(tweak_app_queue_push(job_queue, &job));
+  pull_jobs_result = tweak_app_queue_try_pull(job_queue);
+  TEST_CHECK(pull_jobs_result.job_array != NULL);
+  TEST_CHECK(pull_jobs_result.job_array->size == 1);
+  pull_jobs_result = tweak_app_queue_try_pull(job_queue);
+  TEST_CHECK(pull_jobs_result.job_array == NULL);
+
+  tweak_app_queue_stop(job_queue);
+  pull_jobs_result = tweak_app_queue_try_pull(job_queue);
+  TEST_CHECK(pull_jobs_result.job_array == NULL);
+  TEST_CHECK(pull_jobs_result.is_stopped);
+  tweak_app_queue_destroy(job_queue);
+}
+
 TEST_LIST = {
    { "test_queue", test_queue },
+   { "test_queue_deduplication", test_queue_deduplication },
+   { "test_queue_policies", test_queue_policies },
+   { "test_queue_range_jobs", test_queue_range_jobs },
+   { "test_queue_push_batch", test_queue_push_batch },
+   { "test_queue_try_pull", test_queue_try_pull },
    { NULL, NULL }     /* zeroed record marking the end of the list */
 };
 
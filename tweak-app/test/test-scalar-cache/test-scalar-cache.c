@@ -0,0 +1,395 @@
+/**
+ * @file test-scalar-cache.c
+ * @ingroup tweak-app-implementation-test
+ *
+ * @brief part of test suite to test tweak2 application implementation.
+ *
+ * @copyright 2020-2022 Cogent Embedded, Inc. ALL RIGHTS RESERVED.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/**
+ * @defgroup tweak-app-implementation-test Test implementation for tweak-app internal interfaces.
+ */
+
+#include <tweak2/log.h>
+#include <tweak2/string.h>
+#include <tweak2/thread.h>
+#include <tweak2/variant.h>
+
+#include "tweakmodel.h"
+#include "tweakmodel_scalar_cache.h"
+
+#include <acutest.h>
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+enum { NUM_TWEAKS = 10000 };
+enum { NUM_BENCH_TWEAKS = 256 };
+enum { NUM_BENCH_READS = 1000000 };
+enum { MAX_READERS = 8 };
+enum { NUM_WRITER_ITERATIONS = 200000 };
+
+static uint64_t make_pattern(uint32_t arg) {
+  return ((uint64_t)arg << 32) | arg;
+}
+
+static bool check_pattern(uint64_t arg) {
+  return (uint32_t)(arg >> 32) == (uint32_t)arg;
+}
+
+void test_scalar_cache(void) {
+  tweak_model_scalar_cache cache = tweak_model_scalar_cache_create();
+  TEST_CHECK(cache != NULL);
+
+  tweak_variant value = TWEAK_VARIANT_INIT_EMPTY;
+  for (uint32_t ix = 0; ix < NUM_TWEAKS; ix++) {
+    tweak_variant_assign_uint32(&value, ix);
+    TEST_CHECK(tweak_model_scalar_cache_insert(cache, ix + 1, &value, NULL));
+  }
+
+  tweak_variant string_value = TWEAK_VARIANT_INIT_EMPTY;
+  tweak_variant_assign_string(&string_value, "string");
+  TEST_CHECK(tweak_model_scalar_cache_insert(cache, NUM_TWEAKS + 1, &string_value, NULL));
+  tweak_variant_destroy(&string_value);
+
+  for (uint32_t ix = 0; ix < NUM_TWEAKS; ix++) {
+    tweak_variant result = TWEAK_VARIANT_INIT_EMPTY;
+    TEST_CHECK(tweak_model_scalar_cache_load(cache, ix + 1, &result) == TWEAK_VARIANT_TYPE_UINT32);
+    TEST_CHECK(result.type == TWEAK_VARIANT_TYPE_UINT32);
+    TEST_CHECK(result.value.uint32 == ix);
+  }
+
+  tweak_variant result = TWEAK_VARIANT_INIT_EMPTY;
+  TEST_CHECK(tweak_model_scalar_cache_load(cache, NUM_TWEAKS + 1, &result) == TWEAK_VARIANT_TYPE_STRING);
+  TEST_CHECK(result.type == TWEAK_VARIANT_TYPE_NULL);
+  TEST_CHECK(tweak_model_scalar_cache_load(cache, NUM_TWEAKS + 2, &result) == TWEAK_VARIANT_TYPE_NULL);
+  TEST_CHECK(tweak_model_scalar_cache_load(cache, TWEAK_INVALID_ID, &result) == TWEAK_VARIANT_TYPE_NULL);
+
+  tweak_variant_assign_double(&value, 3.14);
+  tweak_model_scalar_cache_update(cache, 1, &value);
+  TEST_CHECK(tweak_model_scalar_cache_load(cache, 1, &result) == TWEAK_VARIANT_TYPE_DOUBLE);
+  TEST_CHECK(result.value.fp64 == 3.14);
+
+  tweak_model_scalar_cache_update(cache, NUM_TWEAKS + 2, &value);
+  TEST_CHECK(tweak_model_scalar_cache_load(cache, NUM_TWEAKS + 2, &result) == TWEAK_VARIANT_TYPE_NULL);
+
+  for (uint32_t ix = 0; ix < NUM_TWEAKS; ix += 2) {
+    tweak_model_scalar_cache_remove(cache, ix + 1);
+  }
+  for (uint32_t ix = 0; ix < NUM_TWEAKS; ix++) {
+    tweak_variant_type expected = (ix % 2) ? TWEAK_VARIANT_TYPE_UINT32 : TWEAK_VARIANT_TYPE_NULL;
+    TEST_CHECK(tweak_model_scalar_cache_load(cache, ix + 1, &result) == expected);
+  }
+
+  /* Removed slots are reused by new items */
+  for (uint32_t ix = 0; ix < NUM_TWEAKS; ix += 2) {
+    tweak_variant_assign_sint16(&value, (int16_t)ix);
+    TEST_CHECK(tweak_model_scalar_cache_insert(cache, NUM_TWEAKS + ix + 3, &value, NULL));
+  }
+  for (uint32_t ix = 0; ix < NUM_TWEAKS; ix += 2) {
+    TEST_CHECK(tweak_model_scalar_cache_load(cache, NUM_TWEAKS + ix + 3, &result) == TWEAK_VARIANT_TYPE_SINT16);
+    TEST_CHECK(result.value.sint16 == (int16_t)ix);
+    TEST_CHECK(tweak_model_scalar_cache_load(cache, ix + 1, &result) == TWEAK_VARIANT_TYPE_NULL);
+  }
+
+  tweak_model_scalar_cache_clear(cache);
+  for (uint32_t ix = 0; ix < 2 * NUM_TWEAKS; ix++) {
+    TEST_CHECK(tweak_model_scalar_cache_load(cache, ix + 1, &result) == TWEAK_VARIANT_TYPE_NULL);
+  }
+
+  tweak_variant_assign_bool(&value, true);
+  TEST_CHECK(tweak_model_scalar_cache_insert(cache, 2, &value, NULL));
+  TEST_CHECK(tweak_model_scalar_cache_load(cache, 2, &result) == TWEAK_VARIANT_TYPE_BOOL);
+  TEST_CHECK(result.value.b);
+
+  tweak_model_scalar_cache_destroy(cache);
+}
+
+void test_scalar_cache_handles(void) {
+  tweak_model_scalar_cache cache = tweak_model_scalar_cache_create();
+  TEST_CHECK(cache != NULL);
+
+  static tweak_item items[NUM_TWEAKS];
+  static uint64_t handles[NUM_TWEAKS];
+  tweak_variant value = TWEAK_VARIANT_INIT_EMPTY;
+  for (uint32_t ix = 0; ix < NUM_TWEAKS; ix++) {
+    tweak_variant_assign_uint32(&value, ix);
+    TEST_CHECK(tweak_model_scalar_cache_insert(cache, ix + 1, &value, &items[ix]));
+    handles[ix] = tweak_model_scalar_cache_get_handle(cache, ix + 1);
+    TEST_CHECK(handles[ix] != 0);
+  }
+  TEST_CHECK(tweak_model_scalar_cache_get_handle(cache, NUM_TWEAKS + 1) == 0);
+  TEST_CHECK(tweak_model_scalar_cache_get_handle(cache, TWEAK_INVALID_ID) == 0);
+
+  for (uint32_t ix = 0; ix < NUM_TWEAKS; ix++) {
+    tweak_variant result = TWEAK_VARIANT_INIT_EMPTY;
+    tweak_id id = TWEAK_INVALID_ID;
+    TEST_CHECK(tweak_model_scalar_cache_load_by_handle(cache, handles[ix], &id, &result)
+      == TWEAK_VARIANT_TYPE_UINT32);
+    TEST_CHECK(id == ix + 1);
+    TEST_CHECK(result.value.uint32 == ix);
+    TEST_CHECK(tweak_model_scalar_cache_get_item_by_handle(cache, handles[ix]) == &items[ix]);
+  }
+  tweak_variant result = TWEAK_VARIANT_INIT_EMPTY;
+  TEST_CHECK(tweak_model_scalar_cache_load_by_handle(cache, 0, NULL, &result) == TWEAK_VARIANT_TYPE_NULL);
+  TEST_CHECK(tweak_model_scalar_cache_get_item_by_handle(cache, 0) == NULL);
+  TEST_CHECK(tweak_model_scalar_cache_load_by_handle(cache, UINT64_MAX, NULL, &result) == TWEAK_VARIANT_TYPE_NULL);
+  TEST_CHECK(tweak_model_scalar_cache_get_item_by_handle(cache, UINT64_MAX) == NULL);
+
+  /* Handles follow value updates */
+  tweak_variant_assign_float(&value, 1.5f);
+  tweak_model_scalar_cache_update(cache, 1, &value);
+  TEST_CHECK(tweak_model_scalar_cache_load_by_handle(cache, handles[0], NULL, &result) == TWEAK_VARIANT_TYPE_FLOAT);
+  TEST_CHECK(result.value.fp32 == 1.5f);
+
+  /* Handles of removed items are invalidated even if their entries are reused */
+  for (uint32_t ix = 0; ix < NUM_TWEAKS; ix += 2) {
+    tweak_model_scalar_cache_remove(cache, ix + 1);
+  }
+  for (uint32_t ix = 0; ix < NUM_TWEAKS; ix += 2) {
+    tweak_variant_assign_uint32(&value, ix);
+    TEST_CHECK(tweak_model_scalar_cache_insert(cache, NUM_TWEAKS + ix + 1, &value, &items[ix]));
+  }
+  for (uint32_t ix = 0; ix < NUM_TWEAKS; ix++) {
+    bool removed = (ix % 2) == 0;
+    TEST_CHECK(tweak_model_scalar_cache_load_by_handle(cache, handles[ix], NULL, &result)
+      == (removed ? TWEAK_VARIANT_TYPE_NULL : TWEAK_VARIANT_TYPE_UINT32));
+    TEST_CHECK(tweak_model_scalar_cache_get_item_by_handle(cache, handles[ix])
+      == (removed ? NULL : &items[ix]));
+  }
+
+  /* Reinserted item gets new handle */
+  tweak_variant_assign_uint32(&value, 42);
+  TEST_CHECK(tweak_model_scalar_cache_insert(cache, 1, &value, &items[0]));
+  uint64_t handle = tweak_model_scalar_cache_get_handle(cache, 1);
+  TEST_CHECK(handle != 0 && handle != handles[0]);
+  TEST_CHECK(tweak_model_scalar_cache_load_by_handle(cache, handles[0], NULL, &result) == TWEAK_VARIANT_TYPE_NULL);
+  TEST_CHECK(tweak_model_scalar_cache_load_by_handle(cache, handle, NULL, &result) == TWEAK_VARIANT_TYPE_UINT32);
+  TEST_CHECK(result.value.uint32 == 42);
+
+  tweak_model_scalar_cache_clear(cache);
+  for (uint32_t ix = 0; ix < NUM_TWEAKS; ix++) {
+    TEST_CHECK(tweak_model_scalar_cache_load_by_handle(cache, handles[ix], NULL, &result) == TWEAK_VARIANT_TYPE_NULL);
+  }
+  TEST_CHECK(tweak_model_scalar_cache_load_by_handle(cache, handle, NULL, &result) == TWEAK_VARIANT_TYPE_NULL);
+
+  tweak_model_scalar_cache_destroy(cache);
+}
+
+struct consistency_context {
+  tweak_model_scalar_cache cache;
+  volatile bool stop;
+  uint64_t num_reads;
+  uint64_t num_errors;
+};
+
+static void* consistency_reader(void* arg) {
+  struct consistency_context* context = arg;
+  uint64_t num_reads = 0;
+  uint64_t num_errors = 0;
+  while (!context->stop) {
+    for (tweak_id id = 1; id <= NUM_BENCH_TWEAKS; id++) {
+      tweak_variant value = TWEAK_VARIANT_INIT_EMPTY;
+      tweak_variant_type type = tweak_model_scalar_cache_load(context->cache, id, &value);
+      ++num_reads;
+      if (type != TWEAK_VARIANT_TYPE_UINT64 || !check_pattern(value.value.uint64)) {
+        ++num_errors;
+      }
+    }
+  }
+  context->num_reads = num_reads;
+  context->num_errors = num_errors;
+  return NULL;
+}
+
+void test_scalar_cache_consistency(void) {
+  tweak_common_thread threads[MAX_READERS];
+  struct consistency_context contexts[MAX_READERS];
+  tweak_model_scalar_cache cache = tweak_model_scalar_cache_create();
+  TEST_CHECK(cache != NULL);
+
+  tweak_variant value = TWEAK_VARIANT_INIT_EMPTY;
+  for (tweak_id id = 1; id <= NUM_BENCH_TWEAKS; id++) {
+    tweak_variant_assign_uint64(&value, make_pattern(0));
+    TEST_CHECK(tweak_model_scalar_cache_insert(cache, id, &value, NULL));
+  }
+
+  for (size_t ix = 0; ix < MAX_READERS; ix++) {
+    contexts[ix].cache = cache;
+    contexts[ix].stop = false;
+    TEST_CHECK(tweak_common_thread_create(&threads[ix], &consistency_reader, &contexts[ix])
+      == TWEAK_COMMON_THREAD_SUCCESS);
+  }
+
+  /* Items being stored besides the ones readers are looking at force table to grow */
+  for (uint32_t ix = 1; ix <= NUM_WRITER_ITERATIONS; ix++) {
+    tweak_variant_assign_uint64(&value, make_pattern(ix));
+    tweak_model_scalar_cache_update(cache, (ix % NUM_BENCH_TWEAKS) + 1, &value);
+    if (ix % 16 == 0) {
+      TEST_CHECK(tweak_model_scalar_cache_insert(cache, NUM_BENCH_TWEAKS + ix, &value, NULL));
+    }
+    if (ix % 32 == 0) {
+      tweak_model_scalar_cache_remove(cache, NUM_BENCH_TWEAKS + ix - 16);
+    }
+  }
+
+  for (size_t ix = 0; ix < MAX_READERS; ix++) {
+    contexts[ix].stop = true;
+    tweak_common_thread_join(threads[ix], NULL);
+    TEST_CHECK(contexts[ix].num_errors == 0);
+    TWEAK_LOG_TEST("Reader %zu: %" PRIu64 " reads, %" PRIu64 " errors", ix,
+      contexts[ix].num_reads, contexts[ix].num_errors);
+  }
+
+  tweak_model_scalar_cache_destroy(cache);
+}
+
+struct bench_context {
+  tweak_model_scalar_cache cache;
+  const uint64_t* handles;
+  tweak_model model;
+  tweak_common_rwlock* model_lock;
+  double checksum;
+};
+
+static void* bench_scalar_cache_reader(void* arg) {
+  struct bench_context* context = arg;
+  double checksum = 0.;
+  for (uint32_t ix = 0; ix < NUM_BENCH_READS; ix++) {
+    tweak_variant value = TWEAK_VARIANT_INIT_EMPTY;
+    tweak_model_scalar_cache_load(context->cache, (ix % NUM_BENCH_TWEAKS) + 1, &value);
+    checksum += value.value.fp64;
+  }
+  context->checksum = checksum;
+  return NULL;
+}
+
+static void* bench_handle_reader(void* arg) {
+  struct bench_context* context = arg;
+  double checksum = 0.;
+  for (uint32_t ix = 0; ix < NUM_BENCH_READS; ix++) {
+    tweak_variant value = TWEAK_VARIANT_INIT_EMPTY;
+    tweak_model_scalar_cache_load_by_handle(context->cache, context->handles[ix % NUM_BENCH_TWEAKS],
+      NULL, &value);
+    checksum += value.value.fp64;
+  }
+  context->checksum = checksum;
+  return NULL;
+}
+
+static void* bench_rwlock_reader(void* arg) {
+  struct bench_context* context = arg;
+  double checksum = 0.;
+  for (uint32_t ix = 0; ix < NUM_BENCH_READS; ix++) {
+    tweak_variant value = TWEAK_VARIANT_INIT_EMPTY;
+    tweak_common_rwlock_read_lock(context->model_lock);
+    tweak_item* item = tweak_model_find_item_by_id(context->model, (ix % NUM_BENCH_TWEAKS) + 1);
+    if (item != NULL) {
+      value = tweak_variant_copy(&item->current_value);
+    }
+    tweak_common_rwlock_read_unlock(context->model_lock);
+    checksum += value.value.fp64;
+    tweak_variant_destroy(&value);
+  }
+  context->checksum = checksum;
+  return NULL;
+}
+
+static uint64_t run_readers(tweak_common_thread_routine routine, struct bench_context* contexts,
+  size_t num_readers)
+{
+  tweak_common_thread threads[MAX_READERS];
+  tweak_common_timestamp start;
+  tweak_common_timestamp end;
+  tweak_common_timestamp_now(&start);
+  for (size_t ix = 0; ix < num_readers; ix++) {
+    TEST_CHECK(tweak_common_thread_create(&threads[ix], routine, &contexts[ix])
+      == TWEAK_COMMON_THREAD_SUCCESS);
+  }
+  for (size_t ix = 0; ix < num_readers; ix++) {
+    tweak_common_thread_join(threads[ix], NULL);
+    TEST_CHECK(contexts[ix].checksum == contexts[0].checksum);
+  }
+  tweak_common_timestamp_now(&end);
+  return tweak_common_timestamp_subtract_timestamps(&end, &start);
+}
+
+void test_scalar_cache_bench(void) {
+  struct bench_context contexts[MAX_READERS];
+  uint64_t handles[NUM_BENCH_TWEAKS];
+  tweak_common_rwlock model_lock;
+  tweak_model model = tweak_model_create();
+  tweak_model_scalar_cache cache = tweak_model_scalar_cache_create();
+  TEST_CHECK(model != NULL);
+  TEST_CHECK(cache != NULL);
+  TEST_CHECK(tweak_common_rwlock_init(&model_lock) == TWEAK_COMMON_THREAD_SUCCESS);
+
+  tweak_variant_string uri = TWEAK_VARIANT_STRING_EMPTY;
+  tweak_variant value = TWEAK_VARIANT_INIT_EMPTY;
+  for (tweak_id id = 1; id <= NUM_BENCH_TWEAKS; id++) {
+    char buff[128] = { 0 };
+    sprintf(buff, "/bench/item_%" PRIu64 "", id);
+    tweak_assign_string(&uri, buff);
+    tweak_variant_assign_double(&value, (double)id);
+    TEST_CHECK(tweak_model_create_item(model, id, &uri, &uri, &uri, &value, &value, NULL)
+      == TWEAK_MODEL_SUCCESS);
+    TEST_CHECK(tweak_model_scalar_cache_insert(cache, id, &value,
+      tweak_model_find_item_by_id(model, id)));
+    handles[id - 1] = tweak_model_scalar_cache_get_handle(cache, id);
+  }
+  tweak_variant_destroy_string(&uri);
+
+  for (size_t ix = 0; ix < MAX_READERS; ix++) {
+    contexts[ix].cache = cache;
+    contexts[ix].handles = handles;
+    contexts[ix].model = model;
+    contexts[ix].model_lock = &model_lock;
+    contexts[ix].checksum = 0.;
+  }
+
+  for (size_t num_readers = 1; num_readers <= MAX_READERS; num_readers *= 2) {
+    uint64_t cache_nanos = run_readers(&bench_scalar_cache_reader, contexts, num_readers);
+    uint64_t handle_nanos = run_readers(&bench_handle_reader, contexts, num_readers);
+    uint64_t rwlock_nanos = run_readers(&bench_rwlock_reader, contexts, num_readers);
+    uint64_t num_reads = (uint64_t)num_readers * NUM_BENCH_READS;
+    TWEAK_LOG_TEST("%zu reader(s): scalar cache %.1f Mreads/s, handles %.1f Mreads/s,"
+      " rwlock + hash + copy %.1f Mreads/s",
+      num_readers,
+      cache_nanos ? (double)num_reads * 1e3 / (double)cache_nanos : 0.,
+      handle_nanos ? (double)num_reads * 1e3 / (double)handle_nanos : 0.,
+      rwlock_nanos ? (double)num_reads * 1e3 / (double)rwlock_nanos : 0.);
+  }
+
+  tweak_common_rwlock_destroy(&model_lock);
+  tweak_model_scalar_cache_destroy(cache);
+  tweak_model_destroy(model);
+}
+
+TEST_LIST = {
+   { "test_scalar_cache", test_scalar_cache },
+   { "test_scalar_cache_handles", test_scalar_cache_handles },
+   { "test_scalar_cache_consistency", test_scalar_cache_consistency },
+   { "test_scalar_cache_bench", test_scalar_cache_bench },
+   { NULL, NULL }     /* zeroed record marking the end of the list */
+};
@@ -0,0 +1,102 @@
+/**
+ * @file test-subscription.c
+ * @ingroup tweak-app-implementation-test
+ *
+ * @brief part of test suite to test tweak2 application implementation.
+ *
+ * @copyright 2020-2023 Cogent Embedded, Inc. ALL RIGHTS RESERVED.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/**
+ * @defgroup tweak-app-implementation-test Test implementation for tweak-app internal interfaces.
+ */
+
+#include <tweak2/string.h>
+#include "tweakappsubscription.h"
+#include "tweakmodel_uri_to_tweak_id_index.h"
+
+#include <acutest.h>
+#include <stdio.h>
+
+static bool count_walk_proc(const char *uri, tweak_id id, void* cookie) {
+  (void)uri;
+  (void)id;
+  ++*(uint32_t*)cookie;
+  return true;
+}
+
+void test_uri_filter(void) {
+  struct tweak_app_uri_filter filter;
+
+  TEST_CHECK(tweak_app_uri_filter_init(&filter, NULL));
+  TEST_CHECK(filter.size == 0);
+  TEST_CHECK(tweak_app_uri_filter_match(&filter, "/a/b"));
+  tweak_app_uri_filter_destroy(&filter);
+
+  TEST_CHECK(tweak_app_uri_filter_init(&filter, " ; "));
+  TEST_CHECK(filter.size == 0);
+  tweak_app_uri_filter_destroy(&filter);
+
+  TEST_CHECK(tweak_app_uri_filter_init(&filter, "/a/b;*"));
+  TEST_CHECK(filter.size == 0);
+  TEST_CHECK(tweak_app_uri_filter_match(&filter, "/c"));
+  tweak_app_uri_filter_destroy(&filter);
+
+  TEST_CHECK(tweak_app_uri_filter_init(&filter, "/camera/exposure_* ;; /isp/**"));
+  TEST_CHECK(filter.size == 2);
+  TEST_CHECK(strcmp(filter.patterns[0], "/camera/exposure_*") == 0);
+  TEST_CHECK(strcmp(filter.patterns[1], "/isp/**") == 0);
+  TEST_CHECK(tweak_app_uri_filter_match(&filter, "/camera/exposure_time"));
+  TEST_CHECK(tweak_app_uri_filter_match(&filter, "/isp/gain/red"));
+  TEST_CHECK(!tweak_app_uri_filter_match(&filter, "/camera/gain"));
+  TEST_CHECK(!tweak_app_uri_filter_match(&filter, "/camera/exposure_time/min"));
+
+  tweak_model_uri_to_tweak_id_index index = tweak_model_uri_to_tweak_id_index_create();
+  TEST_CHECK(index != NULL);
+  const char* uris[] = {
+    "/camera/exposure_time",
+    "/camera/exposure_mode",
+    "/camera/gain",
+    "/isp/gain/red",
+    "/isp/gain/blue",
+    "/lidar/range"
+  };
+  for (size_t ix = 0; ix < sizeof(uris) / sizeof(uris[0]); ++ix) {
+    TEST_CHECK(tweak_model_uri_to_tweak_id_index_insert(index, uris[ix], ix + 1) == TWEAK_MODEL_INDEX_SUCCESS);
+  }
+  uint32_t count = 0;
+  TEST_CHECK(tweak_app_uri_filter_walk(&filter, index, &count_walk_proc, &count));
+  TEST_CHECK(count == 4);
+  tweak_app_uri_filter_destroy(&filter);
+
+  TEST_CHECK(tweak_app_uri_filter_init(&filter, ""));
+  count = 0;
+  TEST_CHECK(tweak_app_uri_filter_walk(&filter, index, &count_walk_proc, &count));
+  TEST_CHECK(count == 6);
+  tweak_app_uri_filter_destroy(&filter);
+
+  tweak_model_uri_to_tweak_id_index_destroy(index);
+}
+
+TEST_LIST = {
+   { "test-uri-filter", test_uri_filter },
+   { NULL, NULL }     /* zeroed record marking the end of the list */
+};
@@ -56,6 +56,13 @@ tweak_id ids[NUM_TWEAKS];
 tweak_variant_string uris[NUM_TWEAKS];
 tweak_variant values[NUM_TWEAKS];
 
+static bool count_items_proc(tweak_item* item, void* cookie) {
+  size_t* count = cookie;
+  TEST_CHECK(item->cold != NULL);
+  ++*count;
+  return true;
+}
+
 void test_model(void) {
   srand((unsigned)time(NULL));
   tweak_model model = tweak_model_create();
@@ -79,7 +86,7 @@ void test_model(void) {
       tweak_id tweak_id = ids[ix];
       tweak_item* item = tweak_model_find_item_by_id(model, tweak_id);
       TEST_CHECK(tweak_id == item->id);
-      TEST_CHECK(strcmp(tweak_variant_string_c_str(&uris[ix]), tweak_variant_string_c_str(&item->uri)) == 0);
+      TEST_CHECK(strcmp(tweak_variant_string_c_str(&uris[ix]), tweak_interned_string_c_str(item->cold->uri)) == 0);
       TEST_CHECK(item->current_value.type == TWEAK_VARIANT_TYPE_FLOAT);
       TEST_CHECK(item->current_value.value.fp32 == values[ix].value.fp32);
     }
@@ -118,6 +125,9 @@ void test_model(void) {
       TEST_CHECK(ec == TWEAK_MODEL_SUCCESS);
     }
   }
+  size_t count = 0;
+  TEST_CHECK(tweak_model_walk_items(model, &count_items_proc, &count));
+  TEST_CHECK(count == NUM_TWEAKS);
   tweak_model_destroy(model);
 }
 
@@ -120,7 +120,122 @@ void test_uri_to_index(void) {
   tweak_model_uri_to_tweak_id_index_destroy(index);
 }
 
+enum { NUM_GROUPS = 20 };
+enum { NUM_ITEMS_PER_GROUP = 50 };
+
+struct walk_result {
+  size_t count;
+  char last_uri[MAX_URI_LENGTH + 1];
+  bool ordered;
+};
+
+static bool collect_walk_proc(const char *uri, tweak_id id, void* cookie) {
+  struct walk_result* result = cookie;
+  TEST_CHECK(id != TWEAK_INVALID_ID);
+  if (result->count > 0 && strcmp(result->last_uri, uri) >= 0) {
+    result->ordered = false;
+  }
+  strcpy(result->last_uri, uri);
+  ++result->count;
+  return true;
+}
+
+static size_t count_subtree(tweak_model_uri_to_tweak_id_index index, const char* prefix) {
+  struct walk_result result = { .ordered = true };
+  TEST_CHECK(tweak_model_uri_to_tweak_id_index_walk_subtree(index, prefix, &collect_walk_proc, &result));
+  TEST_CHECK(result.ordered);
+  return result.count;
+}
+
+static size_t count_glob(tweak_model_uri_to_tweak_id_index index, const char* pattern) {
+  struct walk_result result = { .ordered = true };
+  TEST_CHECK(tweak_model_uri_to_tweak_id_index_walk_glob(index, pattern, &collect_walk_proc, &result));
+  TEST_CHECK(result.ordered);
+  return result.count;
+}
+
+static void make_uri(char* uri, uint32_t group_no, uint32_t item_no) {
+  sprintf(uri, "/group_%" PRIu32 "/item_%" PRIu32 "/value", group_no, item_no);
+}
+
+void test_uri_subtree(void) {
+  tweak_model_uri_to_tweak_id_index index = tweak_model_uri_to_tweak_id_index_create();
+  char uri[MAX_URI_LENGTH + 1];
+  for (uint32_t group_no = 0; group_no < NUM_GROUPS; ++group_no) {
+    for (uint32_t item_no = 0; item_no < NUM_ITEMS_PER_GROUP; ++item_no) {
+      make_uri(uri, group_no, item_no);
+      TEST_CHECK(tweak_model_uri_to_tweak_id_index_insert(index, uri, gen_id()) == TWEAK_MODEL_INDEX_SUCCESS);
+    }
+  }
+  TEST_CHECK(tweak_model_uri_to_tweak_id_index_insert(index, "/group_1", gen_id()) == TWEAK_MODEL_INDEX_SUCCESS);
+
+  TEST_CHECK(count_subtree(index, "") == NUM_GROUPS * NUM_ITEMS_PER_GROUP + 1);
+  TEST_CHECK(count_subtree(index, "/group_1/") == NUM_ITEMS_PER_GROUP);
+  /* "/group_1" itself, "/group_1/..." and "/group_10/..." to "/group_19/..." */
+  TEST_CHECK(count_subtree(index, "/group_1") == 1 + 11 * NUM_ITEMS_PER_GROUP);
+  TEST_CHECK(count_subtree(index, "/group_2/item_3") == 11);
+  TEST_CHECK(count_subtree(index, "/group_2/item_3/value") == 1);
+  TEST_CHECK(count_subtree(index, "/group_2/item_3/value/") == 0);
+  TEST_CHECK(count_subtree(index, "/group_2/item_x") == 0);
+  TEST_CHECK(count_subtree(index, "/nothing") == 0);
+
+  /*.. Removal merges nodes back, remaining entries should stay reachable */
+  for (uint32_t group_no = 0; group_no < NUM_GROUPS; ++group_no) {
+    for (uint32_t item_no = 0; item_no < NUM_ITEMS_PER_GROUP; item_no += 2) {
+      make_uri(uri, group_no, item_no);
+      TEST_CHECK(tweak_model_uri_to_tweak_id_index_remove(index, uri) == TWEAK_MODEL_INDEX_SUCCESS);
+      TEST_CHECK(tweak_model_uri_to_tweak_id_index_remove(index, uri) == TWEAK_MODEL_INDEX_KEY_NOT_FOUND);
+    }
+  }
+  TEST_CHECK(tweak_model_uri_to_tweak_id_index_remove(index, "/group_1/") == TWEAK_MODEL_INDEX_KEY_NOT_FOUND);
+  TEST_CHECK(tweak_model_uri_to_tweak_id_index_remove(index, "/group_1") == TWEAK_MODEL_INDEX_SUCCESS);
+  for (uint32_t group_no = 0; group_no < NUM_GROUPS; ++group_no) {
+    for (uint32_t item_no = 0; item_no < NUM_ITEMS_PER_GROUP; ++item_no) {
+      make_uri(uri, group_no, item_no);
+      tweak_id id = tweak_model_uri_to_tweak_id_index_lookup(index, uri);
+      TEST_CHECK((id != TWEAK_INVALID_ID) == (item_no % 2 == 1));
+    }
+  }
+  TEST_CHECK(count_subtree(index, "") == NUM_GROUPS * NUM_ITEMS_PER_GROUP / 2);
+  TEST_CHECK(count_subtree(index, "/group_1/") == NUM_ITEMS_PER_GROUP / 2);
+  tweak_model_uri_to_tweak_id_index_destroy(index);
+}
+
+void test_uri_glob(void) {
+  TEST_CHECK(tweak_model_uri_glob_match("/a/b", "/a/b"));
+  TEST_CHECK(!tweak_model_uri_glob_match("/a/b", "/a/bc"));
+  TEST_CHECK(tweak_model_uri_glob_match("/a/*", "/a/bc"));
+  TEST_CHECK(!tweak_model_uri_glob_match("/a/*", "/a/b/c"));
+  TEST_CHECK(tweak_model_uri_glob_match("/a/*/c", "/a/b/c"));
+  TEST_CHECK(tweak_model_uri_glob_match("/a/**", "/a/b/c"));
+  TEST_CHECK(tweak_model_uri_glob_match("/**/c", "/a/b/c"));
+  TEST_CHECK(!tweak_model_uri_glob_match("/**/c", "/a/b/cd"));
+  TEST_CHECK(tweak_model_uri_glob_match("/a/?", "/a/b"));
+  TEST_CHECK(!tweak_model_uri_glob_match("/a?b", "/a/b"));
+  TEST_CHECK(tweak_model_uri_glob_match("*", ""));
+
+  tweak_model_uri_to_tweak_id_index index = tweak_model_uri_to_tweak_id_index_create();
+  char uri[MAX_URI_LENGTH + 1];
+  for (uint32_t group_no = 0; group_no < NUM_GROUPS; ++group_no) {
+    for (uint32_t item_no = 0; item_no < NUM_ITEMS_PER_GROUP; ++item_no) {
+      make_uri(uri, group_no, item_no);
+      TEST_CHECK(tweak_model_uri_to_tweak_id_index_insert(index, uri, gen_id()) == TWEAK_MODEL_INDEX_SUCCESS);
+    }
+  }
+  TEST_CHECK(count_glob(index, "/group_1/*/value") == NUM_ITEMS_PER_GROUP);
+  TEST_CHECK(count_glob(index, "/group_1*/*/value") == 11 * NUM_ITEMS_PER_GROUP);
+  TEST_CHECK(count_glob(index, "/group_?/item_1/value") == 10);
+  TEST_CHECK(count_glob(index, "/*/item_7/*") == NUM_GROUPS);
+  TEST_CHECK(count_glob(index, "/**/value") == NUM_GROUPS * NUM_ITEMS_PER_GROUP);
+  TEST_CHECK(count_glob(index, "/group_3/**") == NUM_ITEMS_PER_GROUP);
+  TEST_CHECK(count_glob(index, "/*/*") == 0);
+  TEST_CHECK(count_glob(index, "/group_3/item_4/value") == 1);
+  tweak_model_uri_to_tweak_id_index_destroy(index);
+}
+
 TEST_LIST = {
    { "test-uri-to-index", test_uri_to_index },
+   { "test-uri-subtree", test_uri_subtree },
+   { "test-uri-glob", test_uri_glob },
    { NULL, NULL }     /* zeroed record marking the end of the list */
 };
@@ -0,0 +1,182 @@
+/**
+ * @file atomic.h
+ * @ingroup tweak-api
+ *
+ * @brief Cross platform wrapper for atomic operations and memory fences.
+ *
+ * @copyright 2020-2022 Cogent Embedded, Inc. ALL RIGHTS RESERVED.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/**
+ * @defgroup tweak-api Tweak API
+ * Part of library API. Can be used by user to develop applications
+ */
+
+#ifndef TWEAK_ATOMIC_H_INCLUDED
+#define TWEAK_ATOMIC_H_INCLUDED
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#if defined(_MSC_BUILD)
+#include <windows.h>
+#include <intrin.h>
+#endif
+
+/*
+ * Loads have acquire semantics, stores have release semantics,
+ * read-modify-write operations are sequentially consistent.
+ *
+ * TI_ARM_R5F with legacy toolchain has no compiler support for atomics.
+ * It's single core, so volatile access is sufficient for loads and stores,
+ * while read-modify-write operations run with interrupts disabled.
+ * Tasks run in privileged mode there, so they're allowed to do that.
+ */
+
+#if !defined(_MSC_BUILD) && !defined(__GNUC__) && !defined(__clang__) \
+  && !defined(__TI_COMPILER_VERSION__)
+#error "Atomic operations aren't implemented for this compiler"
+#endif
+
+static inline uint32_t tweak_common_atomic_load_u32(const volatile uint32_t* ptr) {
+#if defined(_MSC_BUILD)
+#if defined(_M_IX86) || defined(_M_X64)
+  uint32_t result = *ptr;
+  _ReadWriteBarrier();
+  return result;
+#else
+  return (uint32_t)InterlockedCompareExchange((volatile LONG*)ptr, 0, 0);
+#endif
+#elif defined(__GNUC__) || defined(__clang__)
+  return __atomic_load_n(ptr, __ATOMIC_ACQUIRE);
+#else
+  return *ptr;
+#endif
+}
+
+static inline void tweak_common_atomic_store_u32(volatile uint32_t* ptr, uint32_t value) {
+#if defined(_MSC_BUILD)
+#if defined(_M_IX86) || defined(_M_X64)
+  _ReadWriteBarrier();
+  *ptr = value;
+#else
+  InterlockedExchange((volatile LONG*)ptr, (LONG)value);
+#endif
+#elif defined(__GNUC__) || defined(__clang__)
+  __atomic_store_n(ptr, value, __ATOMIC_RELEASE);
+#else
+  *ptr = value;
+#endif
+}
+
+static inline uint32_t tweak_common_atomic_fetch_add_u32(volatile uint32_t* ptr, uint32_t value) {
+#if defined(_MSC_BUILD)
+  return (uint32_t)InterlockedExchangeAdd((volatile LONG*)ptr, (LONG)value);
+#elif defined(__GNUC__) || defined(__clang__)
+  return __atomic_fetch_add(ptr, value, __ATOMIC_SEQ_CST);
+#else
+  uint32_t state = _disable_interrupts();
+  uint32_t result = *ptr;
+  *ptr = result + value;
+  _restore_interrupts(state);
+  return result;
+#endif
+}
+
+/**
+ * @brief Stores @p desired to @p ptr if it holds @p expected.
+ *
+ * @return true if the value has been replaced.
+ */
+static inline bool tweak_common_atomic_compare_exchange_u32(volatile uint32_t* ptr,
+  uint32_t expected, uint32_t desired)
+{
+#if defined(_MSC_BUILD)
+  return (uint32_t)InterlockedCompareExchange((volatile LONG*)ptr, (LONG)desired, (LONG)expected)
+    == expected;
+#elif defined(__GNUC__) || defined(__clang__)
+  return __atomic_compare_exchange_n(ptr, &expected, desired, false,
+    __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST);
+#else
+  uint32_t state = _disable_interrupts();
+  bool result = *ptr == expected;
+  if (result) {
+    *ptr = desired;
+  }
+  _restore_interrupts(state);
+  return result;
+#endif
+}
+
+static inline void* tweak_common_atomic_load_ptr(void* const volatile* ptr) {
+#if defined(_MSC_BUILD)
+#if defined(_M_IX86) || defined(_M_X64)
+  void* result = *ptr;
+  _ReadWriteBarrier();
+  return result;
+#else
+  return InterlockedCompareExchangePointer((void* volatile*)ptr, NULL, NULL);
+#endif
+#elif defined(__GNUC__) || defined(__clang__)
+  return __atomic_load_n(ptr, __ATOMIC_ACQUIRE);
+#else
+  return *ptr;
+#endif
+}
+
+static inline void tweak_common_atomic_store_ptr(void* volatile* ptr, void* value) {
+#if defined(_MSC_BUILD)
+#if defined(_M_IX86) || defined(_M_X64)
+  _ReadWriteBarrier();
+  *ptr = value;
+#else
+  InterlockedExchangePointer(ptr, value);
+#endif
+#elif defined(__GNUC__) || defined(__clang__)
+  __atomic_store_n(ptr, value, __ATOMIC_RELEASE);
+#else
+  *ptr = value;
+#endif
+}
+
+/**
+ * @brief Prevents reordering of preceding loads with subsequent loads and stores.
+ */
+static inline void tweak_common_atomic_fence_acquire(void) {
+#if defined(_MSC_BUILD)
+  MemoryBarrier();
+#elif defined(__GNUC__) || defined(__clang__)
+  __atomic_thread_fence(__ATOMIC_ACQUIRE);
+#endif
+}
+
+/**
+ * @brief Prevents reordering of preceding loads and stores with subsequent stores.
+ */
+static inline void tweak_common_atomic_fence_release(void) {
+#if defined(_MSC_BUILD)
+  MemoryBarrier();
+#elif defined(__GNUC__) || defined(__clang__)
+  __atomic_thread_fence(__ATOMIC_RELEASE);
+#endif
+}
+
+#endif /* TWEAK_ATOMIC_H_INCLUDED */
@@ -56,11 +56,18 @@ enum {
   TWEAK_VARIANT_SMALL_BUFFER_SIZE =  TWEAK_VARIANT_NUMBER_INLINE_QWORDS * sizeof (uint64_t)
 };
 
+/**
+ * @brief Heap block of large buffer. Opaque, shared by copies of the buffer.
+ */
+struct tweak_variant_shared_buffer;
+
 /**
  * @brief Untyped container for variable length data.
  * Designed as underlying layer for variable length vector data in @see tweak_variant
  * instances.
  * Keeps small data buffers on stack, resorts to heap storage for larger data blocks.
+ * Heap blocks are reference counted: copies share the same block until one of them
+ * is modified through @see tweak_buffer_get_data (copy-on-write).
  */
 #pragma pack(push, 1)
 struct tweak_variant_buffer {
@@ -77,10 +84,10 @@ struct tweak_variant_buffer {
     uint8_t small_buffer[ TWEAK_VARIANT_SMALL_BUFFER_SIZE ];
 
     /**
-     * @brief If capacity > TWEAK_VARIANT_SMALL_BUFFER_SIZE,
-     * the data will be on heap.
+     * @brief If size > TWEAK_VARIANT_SMALL_BUFFER_SIZE,
+     * the data will be on heap, shared by copies of this buffer.
      */
-    uint8_t* large_buffer;
+    struct tweak_variant_shared_buffer* large_buffer;
   } buffers;
 };
 #pragma pack(pop)
@@ -116,6 +123,8 @@ void tweak_buffer_swap(struct tweak_variant_buffer* buffer1, struct tweak_varian
 
 /**
  * @brief Clones source buffer. Needed to implement variant copy.
+ * Large buffers aren't copied, the clone shares heap block with @p source_buffer.
+ *
  * @param[in] source_buffer Buffer to clone.
  *
  * @return copy of buffer. Has to be released with @see tweak_buffer_destroy.
@@ -141,6 +150,10 @@ const void* tweak_buffer_get_data_const(const struct tweak_variant_buffer* buffe
 /**
  * @brief Get pointer to underlying buffer to pass into external API.
  *
+ * If heap block of @p buffer is shared with its copies, it's copied first,
+ * so that copies aren't affected by modifications. Use
+ * @see tweak_buffer_get_data_const for read only access.
+ *
  * @param[in] buffer The buffer instance to access.
  * @return pointer to C-style array.
  */
@@ -0,0 +1,158 @@
+/**
+ * @file idmap.h
+ * @ingroup tweak-api
+ *
+ * @brief Hash table keyed by item ids.
+ *
+ * @copyright 2020-2023 Cogent Embedded, Inc. ALL RIGHTS RESERVED.
+ *
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/**
+ * @defgroup tweak-api Tweak API
+ * Part of library API. Can be used by user to develop applications
+ */
+
+#ifndef TWEAK_IDMAP_H_INCLUDED
+#define TWEAK_IDMAP_H_INCLUDED
+
+#include <tweak2/types.h>
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Entry of @p tweak_id_map.
+ */
+struct tweak_id_map_entry {
+  /**
+   * @brief Key, TWEAK_INVALID_ID marks free slot.
+   */
+  tweak_id id;
+  /**
+   * @brief Value associated with @p id. Not used when map serves as a set.
+   */
+  size_t value;
+};
+
+/**
+ * @brief Map of item ids to values, open addressing table with linear probing.
+ *
+ * @details Zeroed instance is a valid empty map. Instance isn't thread safe,
+ * the user shall serialize access to it.
+ */
+struct tweak_id_map {
+  struct tweak_id_map_entry* entries;
+  size_t capacity;
+  size_t size;
+};
+
+/**
+ * @brief Look up value associated with @p id.
+ *
+ * @param map map instance.
+ * @param id id to look up.
+ * @param[out] value receives value associated with @p id if it's found.
+ * Can be NULL.
+ *
+ * @return true if @p id has been inserted before.
+ */
+bool tweak_id_map_find(const struct tweak_id_map* map, tweak_id id, size_t* value);
+
+/**
+ * @brief Check whether @p id is in the map.
+ *
+ * @param map map instance.
+ * @param id id to look up.
+ *
+ * @return true if @p id has been inserted before.
+ */
+bool tweak_id_map_contains(const struct tweak_id_map* map, tweak_id id);
+
+/**
+ * @brief Associate @p value with @p id. Value of an id that's there
+ * already is replaced.
+ *
+ * @param map map instance.
+ * @param id id to add, can't be TWEAK_INVALID_ID.
+ * @param value value to associate with @p id.
+ *
+ * @return false if there was memory allocation error.
+ */
+bool tweak_id_map_insert(struct tweak_id_map* map, tweak_id id, size_t value);
+
+/**
+ * @brief Remove @p id from the map.
+ *
+ * @param map map instance.
+ * @param id id to remove.
+ *
+ * @return true if @p id has been in the map.
+ */
+bool tweak_id_map_remove(struct tweak_id_map* map, tweak_id id);
+
+/**
+ * @brief Callback to walk over entries of a map.
+ *
+ * @param id key of the entry.
+ * @param value value associated with @p id.
+ * @param cookie opaque pointer passed to @p tweak_id_map_walk.
+ *
+ * @return false to stop the walk.
+ */
+typedef bool (*tweak_id_map_walk_proc)(tweak_id id, size_t value, void* cookie);
+
+/**
+ * @brief Walk over entries of the map in no particular order.
+ * The map shouldn't be altered during the walk.
+ *
+ * @param map map instance.
+ * @param walk_proc callback to capture entries.
+ * @param cookie opaque pointer to pass into @p walk_proc.
+ *
+ * @return false if @p walk_proc returned false.
+ */
+bool tweak_id_map_walk(const struct tweak_id_map* map,
+  tweak_id_map_walk_proc walk_proc, void* cookie);
+
+/**
+ * @brief Remove all entries, keeping allocated memory.
+ *
+ * @param map map instance.
+ */
+void tweak_id_map_clear(struct tweak_id_map* map);
+
+/**
+ * @brief Release memory held by @p map.
+ *
+ * @param map map instance.
+ */
+void tweak_id_map_destroy(struct tweak_id_map* map);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,145 @@
+/**
+ * @file intern.h
+ * @ingroup tweak-api
+ *
+ * @brief Process wide table of shared immutable strings.
+ *
+ * @copyright 2020-2023 Cogent Embedded, Inc. ALL RIGHTS RESERVED.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/**
+ * @defgroup tweak-api Tweak API
+ * Part of library API. Can be used by user to develop applications
+ */
+
+#ifndef TWEAK_INTERN_H_INCLUDED
+#define TWEAK_INTERN_H_INCLUDED
+
+#include <tweak2/string.h>
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Handle to an interned string.
+ *
+ * @details Every distinct string has at most one instance in the table,
+ * so two handles obtained for equal strings are equal pointers.
+ * Instances are immutable and reference counted. Table is shared
+ * by all users within the process and is thread safe.
+ */
+typedef const struct tweak_interned_string_impl* tweak_interned_string;
+
+/**
+ * @brief Hash function used by the table.
+ *
+ * Can be used to look up plain strings in containers keyed by
+ * @p tweak_interned_string_hash of interned ones.
+ *
+ * @param[in] str characters to hash.
+ * @param[in] length number of characters in @p str.
+ *
+ * @return hash value.
+ */
+uint32_t tweak_string_hash(const char* str, size_t length);
+
+/**
+ * @brief Obtain an interned instance of string @p str.
+ *
+ * @param[in] str C string.
+ *
+ * @return handle owning a reference, or NULL if there's no memory.
+ * Caller should pass it to @p tweak_interned_string_release when done.
+ */
+tweak_interned_string tweak_intern_string(const char* str);
+
+/**
+ * @brief Same as @p tweak_intern_string, for a string of known length.
+ *
+ * @param[in] str characters of the string, doesn't need to be terminated.
+ * @param[in] length number of characters in @p str.
+ *
+ * @return handle owning a reference, or NULL if there's no memory.
+ */
+tweak_interned_string tweak_intern_string_n(const char* str, size_t length);
+
+/**
+ * @brief Add a reference to an interned string.
+ *
+ * @param[in] string handle already owned by caller.
+ *
+ * @return @p string.
+ */
+tweak_interned_string tweak_interned_string_acquire(tweak_interned_string string);
+
+/**
+ * @brief Drop a reference. Instance is removed from the table
+ * when last reference is gone.
+ *
+ * @param[in] string handle owned by caller. NULL is ignored.
+ */
+void tweak_interned_string_release(tweak_interned_string string);
+
+/**
+ * @brief Get pointer to characters of an interned string.
+ *
+ * @param[in] string interned string.
+ *
+ * @return '\0' terminated C string. Valid as long as caller owns @p string.
+ */
+const char* tweak_interned_string_c_str(tweak_interned_string string);
+
+/**
+ * @brief Get length of an interned string.
+ *
+ * @param[in] string interned string.
+ *
+ * @return length without '\0' terminator.
+ */
+size_t tweak_interned_string_length(tweak_interned_string string);
+
+/**
+ * @brief Get hash of an interned string computed when it has been interned.
+ *
+ * @param[in] string interned string.
+ *
+ * @return same value as @p tweak_string_hash would return for its characters.
+ */
+uint32_t tweak_interned_string_hash(tweak_interned_string string);
+
+/**
+ * @brief Copy an interned string to a @p tweak_variant_string.
+ *
+ * @param[in] string interned string.
+ *
+ * @return duplicate string. User becomes new owner.
+ */
+tweak_variant_string tweak_interned_string_copy(tweak_interned_string string);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -56,6 +56,17 @@ typedef uint64_t tweak_common_nanoseconds;
 #define TWEAK_COMMON_TIMESPAN_INFINITE UINT64_MAX
 #define TWEAK_DEFAULT_STACK_SIZE (32 * 1024)
 
+/**
+ * @brief Storage class of variables having separate instance in each thread.
+ */
+#if defined(_MSC_BUILD)
+#define TWEAK_COMMON_THREAD_LOCAL __declspec(thread)
+#elif defined(__STDC_VERSION__) && __STDC_VERSION__ >= 201112L
+#define TWEAK_COMMON_THREAD_LOCAL _Thread_local
+#else
+#define TWEAK_COMMON_THREAD_LOCAL __thread
+#endif
+
 typedef void *(*tweak_common_thread_routine)(void *);
 
 #if defined(TI_ARM_R5F)
@@ -46,6 +46,18 @@ extern "C" {
  */
 tweak_id tweak_common_genid();
 
+/**
+ * @brief Obtain 64 bits from platform entropy source.
+ *
+ * @details Unlike @ref tweak_common_genid, result differs between
+ * process restarts, so it can seed identifiers that shall not
+ * repeat across runs. Falls back to high resolution clocks
+ * when no entropy source is available.
+ *
+ * @return Random value.
+ */
+uint64_t tweak_common_random_seed();
+
 #ifdef __cplusplus
 }
 #endif
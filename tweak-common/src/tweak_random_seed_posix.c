@@ -0,0 +1,88 @@
+/**
+ * @file tweak_random_seed_posix.c
+ * @ingroup tweak-api
+ *
+ * @brief Random seed from the kernel entropy pool on POSIX systems.
+ *
+ * @copyright 2020-2023 Cogent Embedded, Inc. ALL RIGHTS RESERVED.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#if !defined(_GNU_SOURCE)
+#define _GNU_SOURCE
+#endif
+
+#include <tweak2/util.h>
+
+#include <fcntl.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <time.h>
+#include <unistd.h>
+
+#if defined(HAVE_GETRANDOM)
+#include <sys/random.h>
+#endif
+
+static uint64_t mix64(uint64_t value) {
+  value ^= value >> 30;
+  value *= UINT64_C(0xbf58476d1ce4e5b9);
+  value ^= value >> 27;
+  value *= UINT64_C(0x94d049bb133111eb);
+  value ^= value >> 31;
+  return value;
+}
+
+static bool read_entropy(uint64_t* value) {
+#if defined(HAVE_GETRANDOM)
+  if (getrandom(value, sizeof(*value), GRND_NONBLOCK) == (ssize_t)sizeof(*value)) {
+    return true;
+  }
+#endif
+  int fd = open("/dev/urandom", O_RDONLY | O_CLOEXEC);
+  if (fd < 0) {
+    return false;
+  }
+  ssize_t nread = read(fd, value, sizeof(*value));
+  close(fd);
+  return nread == (ssize_t)sizeof(*value);
+}
+
+static uint64_t clock_ns(clockid_t clock_id) {
+  struct timespec ts = { 0 };
+  clock_gettime(clock_id, &ts);
+  return (uint64_t)ts.tv_sec * UINT64_C(1000000000) + (uint64_t)ts.tv_nsec;
+}
+
+uint64_t tweak_common_random_seed() {
+  uint64_t value = 0;
+  if (read_entropy(&value)) {
+    return value;
+  }
+  /*
+   * No entropy source available, e.g. early boot or chroot without /dev.
+   * Boot time jitter of the monotonic clock, wall clock, pid and
+   * stack address still differ between runs on most systems.
+   */
+  value = mix64(clock_ns(CLOCK_MONOTONIC));
+  value ^= mix64(clock_ns(CLOCK_REALTIME) + UINT64_C(0x9e3779b97f4a7c15));
+  value ^= mix64(((uint64_t)getpid() << 32) ^ (uint64_t)(uintptr_t)&value);
+  return value;
+}
@@ -0,0 +1,46 @@
+/**
+ * @file tweak_random_seed_sysbios.c
+ * @ingroup tweak-api
+ *
+ * @brief Random seed from timestamp counter on TI SYS/BIOS.
+ *
+ * @copyright 2020-2023 Cogent Embedded, Inc. ALL RIGHTS RESERVED.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <tweak2/util.h>
+
+#include <xdc/std.h>
+#include <xdc/runtime/Types.h>
+#include <xdc/runtime/Timestamp.h>
+#include <ti/sysbios/knl/Clock.h>
+
+/**
+ * @note SYS/BIOS has no entropy source. Cycle counter sampled after boot
+ * varies with peripheral and IPC initialization timing, which is enough
+ * to tell restarts apart, but not suitable for anything security related.
+ */
+uint64_t tweak_common_random_seed() {
+  Types_Timestamp64 timestamp = { 0 };
+  Timestamp_get64(&timestamp);
+  uint64_t value = ((uint64_t)timestamp.hi << 32) | timestamp.lo;
+  value ^= (uint64_t)Clock_getTicks() * UINT64_C(0x9e3779b97f4a7c15);
+  return value;
+}
@@ -0,0 +1,44 @@
+/**
+ * @file tweak_random_seed_winapi.c
+ * @ingroup tweak-api
+ *
+ * @brief Random seed from the system CSPRNG on Windows.
+ *
+ * @copyright 2020-2023 Cogent Embedded, Inc. ALL RIGHTS RESERVED.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#define _CRT_RAND_S
+#include <stdlib.h>
+
+#include <tweak2/util.h>
+
+#include <windows.h>
+
+uint64_t tweak_common_random_seed() {
+  unsigned int lo = 0;
+  unsigned int hi = 0;
+  if (rand_s(&lo) == 0 && rand_s(&hi) == 0) {
+    return ((uint64_t)hi << 32) | lo;
+  }
+  LARGE_INTEGER counter = { 0 };
+  QueryPerformanceCounter(&counter);
+  return ((uint64_t)GetCurrentProcessId() << 32) ^ (uint64_t)counter.QuadPart;
+}
@@ -0,0 +1,46 @@
+/**
+ * @file tweak_random_seed_zephyr.c
+ * @ingroup tweak-api
+ *
+ * @brief Random seed from Zephyr entropy subsystem.
+ *
+ * @copyright 2020-2023 Cogent Embedded, Inc. ALL RIGHTS RESERVED.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <tweak2/util.h>
+
+#include <zephyr/kernel.h>
+#if defined(CONFIG_ENTROPY_HAS_DRIVER)
+#if __has_include(<zephyr/random/random.h>)
+#include <zephyr/random/random.h>
+#else
+#include <zephyr/random/rand32.h> /* Zephyr < 3.5 */
+#endif
+#endif
+
+uint64_t tweak_common_random_seed() {
+  uint64_t value = 0;
+#if defined(CONFIG_ENTROPY_HAS_DRIVER)
+  sys_rand_get(&value, sizeof(value));
+#endif
+  /* Without entropy driver cycle counter and uptime are the only sources */
+  return value ^ ((uint64_t)k_cycle_get_32() << 32) ^ (uint64_t)k_uptime_ticks();
+}
@@ -25,41 +25,79 @@
  * THE SOFTWARE.
  */
 
+#include <tweak2/atomic.h>
 #include <tweak2/buffer.h>
 #include <tweak2/string.h>
 #include <tweak2/log.h>
 
-struct tweak_variant_buffer tweak_buffer_create(const void* source, size_t size) {
-  assert(size > 0);
-  struct tweak_variant_buffer result = { 0 };
-  void* dest;
-  if (size <= sizeof(result.buffers.small_buffer)) {
-    dest = result.buffers.small_buffer;
-  } else {
-    result.buffers.large_buffer = malloc(size);
-    if (!result.buffers.large_buffer) {
-        TWEAK_FATAL("malloc() return NULL");
-    }
-    dest = result.buffers.large_buffer;
+struct tweak_variant_shared_buffer {
+  /**
+   * @brief Number of buffer instances referring to this block.
+   */
+  volatile uint32_t ref_count;
+  /**
+   * @brief Keeps data aligned for vectors of 64 bit items.
+   */
+  uint32_t padding;
+  /**
+   * @brief Buffer contents.
+   */
+  uint8_t data[];
+};
+
+static struct tweak_variant_shared_buffer* create_shared_buffer(const void* source, size_t size) {
+  if (size > SIZE_MAX - sizeof(struct tweak_variant_shared_buffer)) {
+    TWEAK_FATAL("Buffer size %zu is too large", size);
   }
+  struct tweak_variant_shared_buffer* shared_buffer =
+    malloc(sizeof(struct tweak_variant_shared_buffer) + size);
+  if (!shared_buffer) {
+    TWEAK_FATAL("malloc() return NULL");
+  }
+  shared_buffer->ref_count = 1;
+  shared_buffer->padding = 0;
   if (source != NULL) {
-    memcpy(dest, source, size);
+    memcpy(shared_buffer->data, source, size);
   } else {
-    memset(dest, 0, size);
+    memset(shared_buffer->data, 0, size);
   }
+  return shared_buffer;
+}
+
+static void release_shared_buffer(struct tweak_variant_shared_buffer* shared_buffer) {
+  if (tweak_common_atomic_fetch_add_u32(&shared_buffer->ref_count, (uint32_t)-1) == 1) {
+    free(shared_buffer);
+  }
+}
+
+static inline bool is_large(const struct tweak_variant_buffer* buffer) {
+  return buffer->size > sizeof(buffer->buffers.small_buffer);
+}
+
+struct tweak_variant_buffer tweak_buffer_create(const void* source, size_t size) {
+  assert(size > 0);
+  struct tweak_variant_buffer result = { 0 };
   result.size = size;
+  if (is_large(&result)) {
+    result.buffers.large_buffer = create_shared_buffer(source, size);
+  } else if (source != NULL) {
+    memcpy(result.buffers.small_buffer, source, size);
+  }
   return result;
 }
 
 struct tweak_variant_buffer tweak_buffer_clone(const struct tweak_variant_buffer* source_buffer) {
   assert(source_buffer != NULL);
-  return tweak_buffer_create(tweak_buffer_get_data_const(source_buffer), tweak_buffer_get_size(source_buffer));
+  if (is_large(source_buffer)) {
+    tweak_common_atomic_fetch_add_u32(&source_buffer->buffers.large_buffer->ref_count, 1);
+  }
+  return *source_buffer;
 }
 
 void tweak_buffer_destroy(struct tweak_variant_buffer* buffer) {
   assert(buffer != NULL);
-  if (buffer->size > sizeof(buffer->buffers.small_buffer)) {
-    free(buffer->buffers.large_buffer);
+  if (is_large(buffer)) {
+    release_shared_buffer(buffer->buffers.large_buffer);
   }
   memset(buffer, 0, sizeof(*buffer));
 }
@@ -79,14 +117,22 @@ size_t tweak_buffer_get_size(const struct tweak_variant_buffer* buffer) {
 
 const void* tweak_buffer_get_data_const(const struct tweak_variant_buffer* buffer) {
   assert(buffer != NULL);
-  return buffer->size <= sizeof(buffer->buffers.small_buffer)
-      ? buffer->buffers.small_buffer
-      : buffer->buffers.large_buffer;
+  return is_large(buffer)
+      ? buffer->buffers.large_buffer->data
+      : buffer->buffers.small_buffer;
 }
 
 void* tweak_buffer_get_data(struct tweak_variant_buffer* buffer) {
   assert(buffer != NULL);
-  return buffer->size <= sizeof(buffer->buffers.small_buffer)
-      ? buffer->buffers.small_buffer
-      : buffer->buffers.large_buffer;
+  if (!is_large(buffer)) {
+    return buffer->buffers.small_buffer;
+  }
+  struct tweak_variant_shared_buffer* shared_buffer = buffer->buffers.large_buffer;
+  /* Only owners of references can add new ones, so sole owner
+   * can't see the counter grow while it modifies the data */
+  if (tweak_common_atomic_load_u32(&shared_buffer->ref_count) != 1) {
+    buffer->buffers.large_buffer = create_shared_buffer(shared_buffer->data, buffer->size);
+    release_shared_buffer(shared_buffer);
+  }
+  return buffer->buffers.large_buffer->data;
 }
@@ -0,0 +1,156 @@
+/**
+ * @file tweakidmap.c
+ * @ingroup tweak-api
+ *
+ * @brief Hash table keyed by item ids.
+ *
+ * @copyright 2020-2023 Cogent Embedded, Inc. ALL RIGHTS RESERVED.
+ *
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <tweak2/idmap.h>
+#include <tweak2/log.h>
+
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+
+enum { TWEAK_ID_MAP_INITIAL_CAPACITY = 64 };
+
+static size_t get_home_slot(const struct tweak_id_map* map, tweak_id id) {
+  /* Fibonacci hashing, ids are sequential numbers most of the time */
+  return (size_t)((id * UINT64_C(11400714819323198485)) >> 32) & (map->capacity - 1);
+}
+
+static size_t find_slot(const struct tweak_id_map* map, tweak_id id) {
+  size_t slot = get_home_slot(map, id);
+  while (map->entries[slot].id != id && map->entries[slot].id != TWEAK_INVALID_ID) {
+    slot = (slot + 1) & (map->capacity - 1);
+  }
+  return slot;
+}
+
+static bool grow(struct tweak_id_map* map) {
+  struct tweak_id_map grown = {
+    .capacity = map->capacity ? map->capacity * 2 : TWEAK_ID_MAP_INITIAL_CAPACITY,
+    .size = map->size
+  };
+  grown.entries = calloc(grown.capacity, sizeof(*grown.entries));
+  if (!grown.entries) {
+    TWEAK_LOG_ERROR("calloc() returned NULL");
+    return false;
+  }
+  for (size_t ix = 0; ix < map->capacity; ++ix) {
+    if (map->entries[ix].id != TWEAK_INVALID_ID) {
+      grown.entries[find_slot(&grown, map->entries[ix].id)] = map->entries[ix];
+    }
+  }
+  free(map->entries);
+  *map = grown;
+  return true;
+}
+
+bool tweak_id_map_find(const struct tweak_id_map* map, tweak_id id, size_t* value) {
+  if (map->size == 0) {
+    return false;
+  }
+  const struct tweak_id_map_entry* entry = &map->entries[find_slot(map, id)];
+  if (entry->id != id) {
+    return false;
+  }
+  if (value) {
+    *value = entry->value;
+  }
+  return true;
+}
+
+bool tweak_id_map_contains(const struct tweak_id_map* map, tweak_id id) {
+  return tweak_id_map_find(map, id, NULL);
+}
+
+bool tweak_id_map_insert(struct tweak_id_map* map, tweak_id id, size_t value) {
+  assert(id != TWEAK_INVALID_ID);
+  /* Load factor is kept below 1/2 */
+  if ((map->size + 1) * 2 > map->capacity && !grow(map)) {
+    return false;
+  }
+  struct tweak_id_map_entry* entry = &map->entries[find_slot(map, id)];
+  if (entry->id == TWEAK_INVALID_ID) {
+    entry->id = id;
+    ++map->size;
+  }
+  entry->value = value;
+  return true;
+}
+
+bool tweak_id_map_remove(struct tweak_id_map* map, tweak_id id) {
+  if (map->size == 0) {
+    return false;
+  }
+  size_t hole = find_slot(map, id);
+  if (map->entries[hole].id != id) {
+    return false;
+  }
+  /* Shift following entries of the probe sequence back, so there's no need in tombstones */
+  size_t mask = map->capacity - 1;
+  size_t slot = hole;
+  for (;;) {
+    slot = (slot + 1) & mask;
+    if (map->entries[slot].id == TWEAK_INVALID_ID) {
+      break;
+    }
+    size_t home = get_home_slot(map, map->entries[slot].id);
+    if (((slot - home) & mask) >= ((slot - hole) & mask)) {
+      map->entries[hole] = map->entries[slot];
+      hole = slot;
+    }
+  }
+  map->entries[hole].id = TWEAK_INVALID_ID;
+  map->entries[hole].value = 0;
+  --map->size;
+  return true;
+}
+
+bool tweak_id_map_walk(const struct tweak_id_map* map,
+  tweak_id_map_walk_proc walk_proc, void* cookie)
+{
+  for (size_t ix = 0; ix < map->capacity; ++ix) {
+    const struct tweak_id_map_entry* entry = &map->entries[ix];
+    if (entry->id != TWEAK_INVALID_ID && !walk_proc(entry->id, entry->value, cookie)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+void tweak_id_map_clear(struct tweak_id_map* map) {
+  if (map->entries) {
+    memset(map->entries, 0, map->capacity * sizeof(*map->entries));
+  }
+  map->size = 0;
+}
+
+void tweak_id_map_destroy(struct tweak_id_map* map) {
+  free(map->entries);
+  map->entries = NULL;
+  map->capacity = 0;
+  map->size = 0;
+}
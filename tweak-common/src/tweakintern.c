@@ -0,0 +1,232 @@
+/**
+ * @file tweakintern.c
+ * @ingroup tweak-api
+ *
+ * @brief Process wide table of shared immutable strings.
+ *
+ * @copyright 2020-2023 Cogent Embedded, Inc. ALL RIGHTS RESERVED.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <tweak2/intern.h>
+#include <tweak2/atomic.h>
+#include <tweak2/thread.h>
+
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+
+enum {
+  TWEAK_INTERN_INITIAL_BUCKET_COUNT = 64
+};
+
+/*
+ * Characters of the string, with terminator, follow the structure.
+ */
+struct tweak_interned_string_impl {
+  struct tweak_interned_string_impl* next;
+  volatile uint32_t ref_count;
+  uint32_t hash;
+  size_t length;
+};
+
+/*
+ * Library has no init function, so the mutex guarding the table
+ * is initialized by whichever thread interns a string first.
+ */
+static struct {
+  tweak_common_mutex lock;
+  struct tweak_interned_string_impl** buckets;
+  size_t bucket_count;
+  size_t count;
+} s_table;
+
+static void lock_init(void) {
+  tweak_common_mutex_init(&s_table.lock);
+}
+
+#if defined(_MSC_BUILD) || defined(TI_ARM_R5F)
+/* No pthread_once on these platforms */
+static volatile uint32_t lock_init_state = 0;
+
+static void lock_init_once(void) {
+  if (tweak_common_atomic_compare_exchange_u32(&lock_init_state, 0, 1)) {
+    lock_init();
+    tweak_common_atomic_store_u32(&lock_init_state, 2);
+  } else {
+    while (tweak_common_atomic_load_u32(&lock_init_state) != 2) {
+      tweak_common_sleep(0);
+    }
+  }
+}
+#else
+static pthread_once_t lock_init_once_control = PTHREAD_ONCE_INIT;
+
+static void lock_init_once(void) {
+  pthread_once(&lock_init_once_control, lock_init);
+}
+#endif
+
+static void table_lock(void) {
+  lock_init_once();
+  tweak_common_mutex_lock(&s_table.lock);
+}
+
+static void table_unlock(void) {
+  tweak_common_mutex_unlock(&s_table.lock);
+}
+
+static inline char* get_chars(const struct tweak_interned_string_impl* entry) {
+  return (char*)(entry + 1);
+}
+
+static bool grow_table(void) {
+  size_t bucket_count = s_table.bucket_count != 0
+    ? s_table.bucket_count * 2
+    : TWEAK_INTERN_INITIAL_BUCKET_COUNT;
+  struct tweak_interned_string_impl** buckets = calloc(bucket_count, sizeof(*buckets));
+  if (!buckets) {
+    return false;
+  }
+  for (size_t ix = 0; ix < s_table.bucket_count; ix++) {
+    struct tweak_interned_string_impl* entry = s_table.buckets[ix];
+    while (entry) {
+      struct tweak_interned_string_impl* next = entry->next;
+      size_t bucket = entry->hash & (bucket_count - 1);
+      entry->next = buckets[bucket];
+      buckets[bucket] = entry;
+      entry = next;
+    }
+  }
+  free(s_table.buckets);
+  s_table.buckets = buckets;
+  s_table.bucket_count = bucket_count;
+  return true;
+}
+
+uint32_t tweak_string_hash(const char* str, size_t length) {
+  /* FNV-1a */
+  uint32_t hash = 2166136261u;
+  for (size_t ix = 0; ix < length; ix++) {
+    hash ^= (uint8_t)str[ix];
+    hash *= 16777619u;
+  }
+  return hash;
+}
+
+tweak_interned_string tweak_intern_string(const char* str) {
+  assert(str);
+  return tweak_intern_string_n(str, strlen(str));
+}
+
+tweak_interned_string tweak_intern_string_n(const char* str, size_t length) {
+  assert(str);
+  uint32_t hash = tweak_string_hash(str, length);
+  struct tweak_interned_string_impl* entry = NULL;
+  table_lock();
+  if (s_table.bucket_count != 0) {
+    entry = s_table.buckets[hash & (s_table.bucket_count - 1)];
+    while (entry) {
+      if (entry->hash == hash && entry->length == length
+        && memcmp(get_chars(entry), str, length) == 0)
+      {
+        tweak_common_atomic_fetch_add_u32(&entry->ref_count, 1);
+        goto exit;
+      }
+      entry = entry->next;
+    }
+  }
+  if (s_table.count >= s_table.bucket_count && !grow_table()) {
+    TWEAK_LOG_ERROR("Can't grow interned string table");
+    goto exit;
+  }
+  entry = malloc(sizeof(*entry) + length + 1);
+  if (!entry) {
+    TWEAK_LOG_ERROR("Can't allocate interned string");
+    goto exit;
+  }
+  entry->ref_count = 1;
+  entry->hash = hash;
+  entry->length = length;
+  memcpy(get_chars(entry), str, length);
+  get_chars(entry)[length] = '\0';
+  size_t bucket = hash & (s_table.bucket_count - 1);
+  entry->next = s_table.buckets[bucket];
+  s_table.buckets[bucket] = entry;
+  ++s_table.count;
+exit:
+  table_unlock();
+  return entry;
+}
+
+tweak_interned_string tweak_interned_string_acquire(tweak_interned_string string) {
+  assert(string);
+  struct tweak_interned_string_impl* entry = (struct tweak_interned_string_impl*)string;
+  /* Caller owns a reference, so entry can't leave the table meanwhile */
+  tweak_common_atomic_fetch_add_u32(&entry->ref_count, 1);
+  return string;
+}
+
+void tweak_interned_string_release(tweak_interned_string string) {
+  if (!string) {
+    return;
+  }
+  struct tweak_interned_string_impl* entry = (struct tweak_interned_string_impl*)string;
+  /* Last reference is dropped under the lock, so lookups can't revive the entry */
+  table_lock();
+  if (tweak_common_atomic_fetch_add_u32(&entry->ref_count, (uint32_t)-1) == 1) {
+    struct tweak_interned_string_impl** link =
+      &s_table.buckets[entry->hash & (s_table.bucket_count - 1)];
+    while (*link != entry) {
+      link = &(*link)->next;
+    }
+    *link = entry->next;
+    free(entry);
+    if (--s_table.count == 0) {
+      free(s_table.buckets);
+      s_table.buckets = NULL;
+      s_table.bucket_count = 0;
+    }
+  }
+  table_unlock();
+}
+
+const char* tweak_interned_string_c_str(tweak_interned_string string) {
+  assert(string);
+  return get_chars(string);
+}
+
+size_t tweak_interned_string_length(tweak_interned_string string) {
+  assert(string);
+  return string->length;
+}
+
+uint32_t tweak_interned_string_hash(tweak_interned_string string) {
+  assert(string);
+  return string->hash;
+}
+
+tweak_variant_string tweak_interned_string_copy(tweak_interned_string string) {
+  tweak_variant_string result = TWEAK_VARIANT_STRING_EMPTY;
+  if (string) {
+    tweak_assign_string(&result, get_chars(string));
+  }
+  return result;
+}
@@ -866,9 +866,10 @@ bool tweak_variant_is_equal(const tweak_variant* arg1, const tweak_variant* arg2
   case TWEAK_VARIANT_TYPE_VECTOR_FLOAT:
   case TWEAK_VARIANT_TYPE_VECTOR_DOUBLE:
     if (arg1->value.buffer.size == arg2->value.buffer.size) {
-      return memcmp(tweak_buffer_get_data_const(&arg1->value.buffer),
-                    tweak_buffer_get_data_const(&arg2->value.buffer),
-                    arg1->value.buffer.size) == 0;
+      const void* data1 = tweak_buffer_get_data_const(&arg1->value.buffer);
+      const void* data2 = tweak_buffer_get_data_const(&arg2->value.buffer);
+      /* Copies of large buffer share the same data */
+      return data1 == data2 || memcmp(data1, data2, arg1->value.buffer.size) == 0;
     } else {
       return false;
     }
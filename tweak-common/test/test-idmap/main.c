@@ -0,0 +1,84 @@
+/**
+ * @file main.c
+ * @ingroup tweak-api
+ * @brief test suite for id map.
+ *
+ * @copyright 2020-2023 Cogent Embedded, Inc. ALL RIGHTS RESERVED.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+
+#include <tweak2/idmap.h>
+
+#include <acutest.h>
+#include <inttypes.h>
+#include <stdio.h>
+
+enum { NUM_IDS = 10000 };
+
+static bool sum_walk_proc(tweak_id id, size_t value, void* cookie) {
+  TEST_CHECK_(value == id * 2, "value of %" PRIu64, id);
+  *(uint64_t*)cookie += id;
+  return true;
+}
+
+void test_id_map(void) {
+  struct tweak_id_map map = { 0 };
+  TEST_CHECK(!tweak_id_map_contains(&map, 1));
+  TEST_CHECK(!tweak_id_map_remove(&map, 1));
+
+  for (tweak_id id = 1; id <= NUM_IDS; ++id) {
+    TEST_CHECK_(tweak_id_map_insert(&map, id, 0), "insert %" PRIu64, id);
+  }
+  /* Inserting an id again replaces its value */
+  for (tweak_id id = 1; id <= NUM_IDS; ++id) {
+    TEST_CHECK_(tweak_id_map_insert(&map, id, (size_t)id * 2), "replace %" PRIu64, id);
+  }
+  TEST_CHECK(map.size == NUM_IDS);
+
+  /* Remove every odd id, then check that probe sequences of remaining ones are intact */
+  for (tweak_id id = 1; id <= NUM_IDS; id += 2) {
+    TEST_CHECK(tweak_id_map_remove(&map, id));
+  }
+  TEST_CHECK(map.size == NUM_IDS / 2);
+  for (tweak_id id = 1; id <= NUM_IDS; ++id) {
+    size_t value = 0;
+    bool found = tweak_id_map_find(&map, id, &value);
+    TEST_CHECK_(found == (id % 2 == 0), "find %" PRIu64, id);
+    TEST_CHECK_(!found || value == id * 2, "value of %" PRIu64, id);
+  }
+
+  uint64_t sum = 0;
+  TEST_CHECK(tweak_id_map_walk(&map, &sum_walk_proc, &sum));
+  TEST_CHECK(sum == (uint64_t)(NUM_IDS / 2) * (NUM_IDS / 2 + 1));
+
+  tweak_id_map_clear(&map);
+  TEST_CHECK(map.size == 0);
+  TEST_CHECK(!tweak_id_map_contains(&map, 2));
+  TEST_CHECK(tweak_id_map_insert(&map, UINT64_MAX, 1));
+  TEST_CHECK(tweak_id_map_contains(&map, UINT64_MAX));
+
+  tweak_id_map_destroy(&map);
+}
+
+TEST_LIST = {
+   { "test_id_map", test_id_map },
+   { NULL, NULL }     /* zeroed record marking the end of the list */
+};
@@ -0,0 +1,122 @@
+/**
+ * @file main.c
+ * @ingroup tweak-api
+ * @brief test suite for interned strings.
+ *
+ * @copyright 2020-2023 Cogent Embedded, Inc. ALL RIGHTS RESERVED.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <tweak2/string.h>
+
+#include <tweak2/intern.h>
+#include <tweak2/thread.h>
+
+#include <acutest.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+enum { NUM_STRINGS = 10000 };
+enum { NUM_THREADS = 4 };
+
+static const char* const long_uri =
+  "/very/long/hierarchical/uri/that/does/not/fit/into/inline/buffer/of/tweak/variant/string"
+  "/because/it/is/longer/than/one/hundred/and/twenty/eight/characters/in/total";
+
+void test_intern(void) {
+  tweak_interned_string s1 = tweak_intern_string("/a/b/c");
+  char buff[] = "/a/b/c/d";
+  tweak_interned_string s2 = tweak_intern_string_n(buff, 6);
+  TEST_CHECK(s1 != NULL);
+  TEST_CHECK(s1 == s2);
+  TEST_CHECK(strcmp(tweak_interned_string_c_str(s1), "/a/b/c") == 0);
+  TEST_CHECK(tweak_interned_string_length(s1) == 6);
+  TEST_CHECK(tweak_interned_string_hash(s1) == tweak_string_hash("/a/b/c", 6));
+
+  tweak_interned_string s3 = tweak_intern_string(buff);
+  TEST_CHECK(s3 != s1);
+
+  tweak_interned_string s4 = tweak_intern_string(long_uri);
+  tweak_variant_string copy = tweak_interned_string_copy(s4);
+  TEST_CHECK(strcmp(tweak_variant_string_c_str(&copy), long_uri) == 0);
+  tweak_variant_destroy_string(&copy);
+
+  tweak_interned_string_release(s4);
+  tweak_interned_string_release(s3);
+  tweak_interned_string_release(s2);
+  TEST_CHECK(strcmp(tweak_interned_string_c_str(s1), "/a/b/c") == 0);
+  TEST_CHECK(tweak_interned_string_acquire(s1) == s1);
+  tweak_interned_string_release(s1);
+  tweak_interned_string_release(s1);
+  tweak_interned_string_release(NULL);
+}
+
+void test_intern_many(void) {
+  static tweak_interned_string strings[NUM_STRINGS];
+  char buff[64];
+  for (size_t ix = 0; ix < NUM_STRINGS; ix++) {
+    sprintf(buff, "/item/%" PRIu64 "", (uint64_t)ix);
+    strings[ix] = tweak_intern_string(buff);
+    TEST_CHECK(strings[ix] != NULL);
+  }
+  for (size_t ix = 0; ix < NUM_STRINGS; ix++) {
+    sprintf(buff, "/item/%" PRIu64 "", (uint64_t)ix);
+    tweak_interned_string string = tweak_intern_string(buff);
+    TEST_CHECK(string == strings[ix]);
+    tweak_interned_string_release(string);
+  }
+  for (size_t ix = 0; ix < NUM_STRINGS; ix++) {
+    tweak_interned_string_release(strings[ix]);
+  }
+}
+
+static void* intern_thread_proc(void* arg) {
+  (void)arg;
+  char buff[64];
+  for (int itr = 0; itr < 100; itr++) {
+    for (size_t ix = 0; ix < 100; ix++) {
+      sprintf(buff, "/shared/%" PRIu64 "", (uint64_t)ix);
+      tweak_interned_string string = tweak_intern_string(buff);
+      TEST_CHECK(string != NULL && strcmp(tweak_interned_string_c_str(string), buff) == 0);
+      tweak_interned_string_release(string);
+    }
+  }
+  return NULL;
+}
+
+void test_intern_threads(void) {
+  tweak_common_thread threads[NUM_THREADS];
+  for (size_t ix = 0; ix < NUM_THREADS; ix++) {
+    TEST_CHECK(tweak_common_thread_create(&threads[ix], &intern_thread_proc, NULL)
+      == TWEAK_COMMON_THREAD_SUCCESS);
+  }
+  for (size_t ix = 0; ix < NUM_THREADS; ix++) {
+    tweak_common_thread_join(threads[ix], NULL);
+  }
+}
+
+TEST_LIST = {
+   { "test_intern", test_intern },
+   { "test_intern_many", test_intern_many },
+   { "test_intern_threads", test_intern_threads },
+   { NULL, NULL }     /* zeroed record marking the end of the list */
+};
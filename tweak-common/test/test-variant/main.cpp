@@ -282,6 +282,33 @@ void test_to_json()
 
 }
 
+void test_variant_copy_on_write()
+{
+   std::vector<double> data(Size);
+   for (size_t ix = 0; ix < data.size(); ++ix) {
+      data[ix] = static_cast<double>(ix);
+   }
+   tweak_variant original = TWEAK_VARIANT_INIT_EMPTY;
+   tweak_variant_assign_double_vector(&original, data.data(), data.size());
+   TEST_CHECK(tweak_buffer_get_size(&original.value.buffer) > TWEAK_VARIANT_SMALL_BUFFER_SIZE);
+
+   tweak_variant copy = tweak_variant_copy(&original);
+   TEST_CHECK(tweak_buffer_get_data_const(&copy.value.buffer) == tweak_buffer_get_data_const(&original.value.buffer));
+   TEST_CHECK(tweak_variant_is_equal(&copy, &original));
+
+   double* copy_data = static_cast<double*>(tweak_buffer_get_data(&copy.value.buffer));
+   TEST_CHECK(copy_data != tweak_buffer_get_data_const(&original.value.buffer));
+   copy_data[0] = -1.;
+   TEST_CHECK(!tweak_variant_is_equal(&copy, &original));
+   TEST_CHECK(static_cast<const double*>(tweak_buffer_get_data_const(&original.value.buffer))[0] == 0.);
+   /* Sole owner modifies its data in place */
+   TEST_CHECK(tweak_buffer_get_data(&copy.value.buffer) == copy_data);
+
+   tweak_variant_destroy(&original);
+   TEST_CHECK(static_cast<const double*>(tweak_buffer_get_data_const(&copy.value.buffer))[1] == 1.);
+   tweak_variant_destroy(&copy);
+}
+
 void test_common_variant_sint8()
 {
    test_to_from_string<int8_t>();
@@ -403,5 +430,6 @@ TEST_LIST = {
     {"test_common_variant_uint64", test_common_variant_uint64},
     {"test_common_variant_float", test_common_variant_float},
     {"test_common_variant_double", test_common_variant_double},
+    {"test_variant_copy_on_write", test_variant_copy_on_write},
     {NULL, NULL} /* zeroed record marking the end of the list */
 };
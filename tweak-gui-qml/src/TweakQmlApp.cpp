@@ -117,6 +117,58 @@ int TweakApplication::rowCount(const QModelIndex &parent) const
     return result;
 }
 
+namespace
+{
+struct ItemDataRequest
+{
+    int role;
+    const QString &connectionName;
+    QVariant result;
+    tweak_variant_type itemType;
+    QString meta;
+};
+
+/* Runs under the model lock of the client context: only fields needed for
+ * the requested role are converted, anything else is done after the read. */
+void readItemData(const tweak_app_item_view *view, void *cookie)
+{
+    ItemDataRequest *request = static_cast<ItemDataRequest *>(cookie);
+    switch (request->role)
+    {
+    case Qt::DisplayRole:
+        request->result = from_tweak_variant(view->current_value).toString();
+        break;
+
+    case TweakApplication::ValueRole:
+        request->result = from_tweak_variant(view->current_value);
+        break;
+
+    case TweakApplication::UriRole:
+    case TweakApplication::isFavoriteRole:
+        request->result = "/" + request->connectionName + QString(view->uri);
+        break;
+
+    case TweakApplication::DefaultValueRole:
+        request->result = from_tweak_variant(view->default_value);
+        break;
+
+    case TweakApplication::DescriptionRole:
+    case Qt::ToolTipRole:
+        request->result = from_tweak_string(view->description);
+        break;
+
+    case TweakApplication::MetaRole:
+        request->itemType = view->current_value->type;
+        request->meta = from_tweak_string(view->meta);
+        break;
+
+    default:
+        qWarning("Unknown role requested in TweakApplication::data(): %d", request->role);
+        break;
+    }
+}
+}
+
 QVariant TweakApplication::data(const QModelIndex &index, int role) const
 {
     Q_D(const TweakApplication);
@@ -148,60 +200,36 @@ QVariant TweakApplication::data(const QModelIndex &index, int role) const
         name = itr->getName();
     }
 
+    ItemDataRequest request{role, name, QVariant(), TWEAK_VARIANT_TYPE_NULL, QString()};
+    tweak_app_error_code errorCode = tweak_app_item_read(clientContext, id.tweakId, &readItemData, &request);
+    if (errorCode != TWEAK_APP_SUCCESS && errorCode != TWEAK_APP_SUCCESS_LAST_KNOWN_VALUE)
+    {
+        return QVariant();
+    }
+
     QVariant result;
-    tweak_app_item_snapshot *sn = tweak_app_item_get_snapshot(clientContext, id.tweakId);
-    if (sn)
+    switch (role)
     {
-        const QString uri = "/" + name + from_tweak_string(&sn->uri);
-        switch (role)
+    case MetaRole:
         {
-        case Qt::DisplayRole:
-            result = from_tweak_variant(&sn->current_value).toString();
-            break;
-
-        case ValueRole:
-            result = from_tweak_variant(&sn->current_value);
-            break;
-
-        case UriRole:
-            result = uri;
-            break;
-
-        case DefaultValueRole:
-            result = from_tweak_variant(&sn->default_value);
-            break;
-
-        case DescriptionRole:
-        case Qt::ToolTipRole:
-            result = from_tweak_string(&sn->description);
-            break;
-
-        case MetaRole:
-            {
-                tweak_variant_type item_type = sn->current_value.type;
-                QString meta = from_tweak_string(&sn->meta);
-                MetadataCacheKey key{item_type, meta};
-                auto itr = metadataCache.find(key);
-                if (itr == metadataCache.end()) {
-                    itr = metadataCache.insert(key,
-                        MetadataCacheItem(d->metadataParser.parse(item_type, meta)));
-                }
-                result = (itr != metadataCache.end())
-                    ? QVariant::fromValue(&*itr.value())
-                    : QVariant();
-            } break;
-
-        case isFavoriteRole:
-            result = isFavorite(uri);
-            break;
-
-        default:
-            qWarning("Unknown role requested in TweakApplication::data(): %d", role);
-            break;
-        }
-
-        tweak_app_release_snapshot(clientContext, sn);
-        sn = nullptr;
+            MetadataCacheKey key{request.itemType, request.meta};
+            auto itr = metadataCache.find(key);
+            if (itr == metadataCache.end()) {
+                itr = metadataCache.insert(key,
+                    MetadataCacheItem(d->metadataParser.parse(request.itemType, request.meta)));
+            }
+            result = (itr != metadataCache.end())
+                ? QVariant::fromValue(&*itr.value())
+                : QVariant();
+        } break;
+
+    case isFavoriteRole:
+        result = isFavorite(request.result.toString());
+        break;
+
+    default:
+        result = request.result;
+        break;
     }
 
     return result;
@@ -632,9 +632,10 @@ std::function<void()> createRandomItem(const std::string &arg) {
   abort();
 }
 
-void button_handler(tweak_id tweak_id, void* cookie) {
+void button_handler(tweak_id tweak_id, const struct tweak_item_value_view* value, void* cookie) {
+  (void) tweak_id;
   (void) cookie;
-  if (tweak_get_scalar_bool(tweak_id)) {
+  if (value->scalar.b) {
     fprintf(stderr, "Button pressed\n");
   }
 }
@@ -682,7 +683,7 @@ std::vector<std::function<void()>> createItems() {
   struct tweak_add_item_ex_desc desc = {};
   desc.uri = "/test/test3";
   desc.description = "permanent test value";
-  desc.item_change_listener = &button_handler;
+  desc.item_change_listener_ex = &button_handler;
   desc.meta = "{\"control\": \"button\", \"caption\": \"Push Me!\"}";
   desc.cookie = NULL;
   tweak_add_scalar_bool_ex(&desc, false);
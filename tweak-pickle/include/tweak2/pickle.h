@@ -88,6 +88,10 @@ typedef struct {
    * @brief Default value.
    */
   tweak_variant default_value;
+  /**
+   * @brief Version of @p current_value assigned by server model, 0 if unknown.
+   */
+  uint64_t version;
 } tweak_pickle_add_item;
 
 /**
@@ -106,6 +110,21 @@ typedef struct {
    * @brief Updated value for tweak's @p current_value field.
    */
   tweak_variant value;
+  /**
+   * @brief Version of @p value assigned by server model.
+   * 0 if unknown, always 0 in requests sent by client.
+   */
+  uint64_t version;
+  /**
+   * @brief If true, @p value is a vector replacing items of tweak's
+   * @p current_value starting from @p offset, the rest of items is kept.
+   * Peer shall announce "partial_changes" feature to receive such requests.
+   */
+  bool partial;
+  /**
+   * @brief Index of the first vector item replaced by partial @p value.
+   */
+  uint64_t offset;
 } tweak_pickle_change_item;
 
 /**
@@ -121,6 +140,20 @@ typedef struct {
   tweak_id id;
 } tweak_pickle_remove_item;
 
+/**
+ * @brief Item kept by client since the previous connection.
+ */
+typedef struct {
+  /**
+   * @brief Internal tweak id.
+   */
+  tweak_id id;
+  /**
+   * @brief Version of item's current value known to client.
+   */
+  uint64_t version;
+} tweak_pickle_known_item;
+
 /**
  * @brief This structure contains all fields for subscribe request.
  *
@@ -131,11 +164,35 @@ typedef struct {
   /**
    * @brief Uri patterns to subscribe separated by semicolon.
    *
-   * @details Currently only "*" is supported.
-   * Complex pattern collections such as "/aaaa/bbb*;/ccc/dddd*"
-   * are planned for future releases.
+   * @details Patterns are globs, '?' matches a single character except '/',
+   * '*' matches any sequence of characters except '/', "**" matches any sequence.
+   * Example: "/camera/exposure_*;/isp/gain?". Empty string, "*" or "**"
+   * select all items. Server sends add_item, change_item and remove_item
+   * requests only for selected items. Subsequent subscribe requests replace
+   * the selection: items which don't match anymore are removed by remove_item requests,
+   * newly matching items are announced by add_item requests.
    */
   tweak_variant_string uri_patterns;
+  /**
+   * @brief Epoch of server model @p known_items have been received from.
+   * 0 if client has no items to resynchronize.
+   */
+  uint64_t model_epoch;
+  /**
+   * @brief Items client has kept since the previous connection.
+   *
+   * @details If @p model_epoch matches the one server has announced,
+   * server sends add_item requests only for selected items missing from this array,
+   * remove_item requests for items it doesn't have or doesn't select anymore and
+   * change_item requests for items whose version differs.
+   * On server side the array is owned by endpoint and released once listener returns,
+   * listener can take it over by resetting the field to NULL.
+   */
+  tweak_pickle_known_item* known_items;
+  /**
+   * @brief Number of elements in @p known_items.
+   */
+  size_t known_items_size;
 } tweak_pickle_subscribe;
 
 /**
@@ -154,6 +211,14 @@ typedef struct {
    * are planned for future releases.
    */
   tweak_variant_string features;
+  /**
+   * @brief Identifies server model instance, versions of items
+   * are comparable only within the same epoch.
+   *
+   * @details Set by server only. 0 if server can't resynchronize
+   * items kept by client, client shall drop them then.
+   */
+  uint64_t model_epoch;
 } tweak_pickle_features;
 
 /**
@@ -278,6 +278,21 @@ tweak_pickle_call_result
   tweak_pickle_client_announce_features(tweak_pickle_client_endpoint client_endpoint,
     const tweak_pickle_features* features);
 
+/**
+ * @brief Select encoding of vector values sent by this endpoint.
+ *
+ * @details Packed encoding carries numeric vectors as a single little-endian block.
+ * It shall be enabled only after server has announced @p packed_vectors feature.
+ * Inbound vectors are decoded in either encoding regardless of this setting.
+ * Disabled by default.
+ *
+ * @param[in] client_endpoint Endpoint instance created by
+ * @p tweak_pickle_create_client_endpoint call.
+ * @param[in] packed_vectors true to use packed encoding.
+ */
+void tweak_pickle_client_set_packed_vectors(tweak_pickle_client_endpoint client_endpoint,
+  bool packed_vectors);
+
 /**
  * @brief Push item's current value update to server side.
  *
@@ -47,6 +47,50 @@ extern "C" {
  */
 typedef struct tweak_pickle_endpoint_base *tweak_pickle_server_endpoint;
 
+/**
+ * @brief Identifier of a single client attached to server endpoint.
+ *
+ * @details Transports that can't tell clients apart report all
+ * of them as a single client @p TWEAK_PICKLE_ALL_PEERS.
+ */
+typedef uint32_t tweak_pickle_peer;
+
+/**
+ * @brief Pseudo peer standing for every client attached to server endpoint.
+ */
+#define TWEAK_PICKLE_ALL_PEERS ((tweak_pickle_peer)0)
+
+/**
+ * @brief Signature of a callback tracking individual clients.
+ *
+ * @param[in] peer client which state has changed.
+ * @param[in] connection_state new state of the client.
+ * @param[in] cookie an opaque pointer to user context.
+ */
+typedef void (*tweak_pickle_peer_state_callback)(tweak_pickle_peer peer,
+  tweak_pickle_connection_state connection_state, void *cookie);
+
+/**
+ * @brief Listener of individual clients attaching to server endpoint
+ * and detaching from it.
+ *
+ * @details Requests from a client are dispatched to skeleton listeners
+ * only after it has been reported as @p TWEAK_PICKLE_CONNECTED,
+ * @see tweak_pickle_server_get_sender.
+ */
+typedef struct {
+  /**
+   * @brief User provided callback, can be NULL.
+   */
+  tweak_pickle_peer_state_callback callback;
+
+  /**
+   * @brief Pointer to a user defined data structure
+   * encapsulating context for the @p callback.
+   */
+  void *cookie;
+} tweak_pickle_peer_state_listener;
+
 /**
  * @brief Signature of a callback to invoke user implementation of
  * @p tweak_pickle_client_subscribe call.
@@ -134,11 +178,21 @@ typedef struct {
   tweak_pickle_change_item_listener change_item_listener;
 
   /**
-   * @brief Connection state listener.
+   * @brief Connection state listener. Reports @p TWEAK_PICKLE_CONNECTED
+   * when the first client attaches and @p TWEAK_PICKLE_DISCONNECTED
+   * when the last one detaches.
    *
    * @see tweak_pickle_connection_state_listener.
    */
   tweak_pickle_connection_state_listener connection_state_listener;
+
+  /**
+   * @brief Listener of individual clients.
+   * Either this one or @p connection_state_listener shall be provided.
+   *
+   * @see tweak_pickle_peer_state_listener.
+   */
+  tweak_pickle_peer_state_listener peer_state_listener;
 } tweak_pickle_server_skeleton;
 
 
@@ -204,6 +258,39 @@ tweak_pickle_server_endpoint tweak_pickle_create_server_endpoint(
     const tweak_pickle_server_descriptor* server_descriptor);
 
 
+/**
+ * @brief Get client which has sent the request being dispatched.
+ *
+ * @details Requests are dispatched to skeleton listeners from a single
+ * receive thread, so the result is valid only when called from
+ * a skeleton listener during its invocation.
+ *
+ * @param[in] server_endpoint Endpoint instance created by
+ * @p tweak_pickle_create_server_endpoint call.
+ *
+ * @return sender of the request, as reported by @p peer_state_listener.
+ */
+tweak_pickle_peer tweak_pickle_server_get_sender(tweak_pickle_server_endpoint server_endpoint);
+
+/**
+ * @brief Create endpoint delivering messages to a single client.
+ *
+ * @details All @p tweak_pickle_server_* calls sending messages accept
+ * the new endpoint. Its @p packed_vectors setting is independent from
+ * the one of @p server_endpoint. Skeleton listeners aren't invoked on its behalf.
+ * It shall be destroyed with @p tweak_pickle_destroy_server_endpoint
+ * before @p server_endpoint is.
+ *
+ * @param[in] server_endpoint Endpoint instance created by
+ * @p tweak_pickle_create_server_endpoint call.
+ * @param[in] peer client reported by @p peer_state_listener. If it's
+ * @p TWEAK_PICKLE_ALL_PEERS, messages are delivered to every client.
+ *
+ * @return valid endpoint instance or @p NULL if there's no memory.
+ */
+tweak_pickle_server_endpoint tweak_pickle_server_create_peer_endpoint(
+  tweak_pickle_server_endpoint server_endpoint, tweak_pickle_peer peer);
+
 /**
  * @brief Notify client about set of features supported by this server.
  *
@@ -225,6 +312,21 @@ tweak_pickle_call_result
   tweak_pickle_server_announce_features(tweak_pickle_server_endpoint server_endpoint,
     const tweak_pickle_features* features);
 
+/**
+ * @brief Select encoding of vector values sent by this endpoint.
+ *
+ * @details Packed encoding carries numeric vectors as a single little-endian block.
+ * It shall be enabled only after client has announced @p packed_vectors feature.
+ * Inbound vectors are decoded in either encoding regardless of this setting.
+ * Disabled by default.
+ *
+ * @param[in] server_endpoint Endpoint instance created by
+ * @p tweak_pickle_create_server_endpoint call.
+ * @param[in] packed_vectors true to use packed encoding.
+ */
+void tweak_pickle_server_set_packed_vectors(tweak_pickle_server_endpoint server_endpoint,
+  bool packed_vectors);
+
 /**
  * @brief Call this in order to forward item creation event to client endpoint.
  *
@@ -243,6 +345,29 @@ tweak_pickle_call_result
   tweak_pickle_server_add_item(tweak_pickle_server_endpoint server_endpoint,
     const tweak_pickle_add_item *add_item);
 
+/**
+ * @brief Forward creation of several items to client endpoint in a single datagram.
+ *
+ * @details This call is equivalent to a sequence of @p tweak_pickle_server_add_item
+ * calls, but it's understood only by clients that have announced @p add_items
+ * feature. Client side dispatches these items to its @p add_item_listener
+ * in the same order.
+ *
+ * @param[in] server_endpoint Endpoint instance created by
+ * @p tweak_pickle_create_server_endpoint call.
+ * @param[in] items array of records containing all fields of the tweaks.
+ * @param[in] count number of elements in @p items array.
+ *
+ * @return @p TWEAK_PICKLE_SUCCESS if there wasn't any errors.
+ * @p TWEAK_PICKLE_BAD_PARAMETER if @p items is @p NULL
+ * or @p count is zero
+ * or any of @p items doesn't meet requirements of @p tweak_pickle_server_add_item.
+ * @p TWEAK_PICKLE_REMOTE_ERROR if disconnected.
+ */
+tweak_pickle_call_result
+  tweak_pickle_server_add_items(tweak_pickle_server_endpoint server_endpoint,
+    const tweak_pickle_add_item *items, size_t count);
+
 /**
  * @brief Push tweak value update to client side.
  *
@@ -263,6 +388,29 @@ tweak_pickle_call_result
   tweak_pickle_server_change_item(tweak_pickle_server_endpoint server_endpoint,
     const tweak_pickle_change_item *change);
 
+/**
+ * @brief Push several tweak value updates to client side in a single datagram.
+ *
+ * @details This call is equivalent to a sequence of @p tweak_pickle_server_change_item
+ * calls, but it's understood only by clients that have announced @p change_items
+ * feature. Client side dispatches these updates to its @p change_item_listener
+ * in the same order.
+ *
+ * @param[in] server_endpoint Endpoint instance created by
+ * @p tweak_pickle_create_server_endpoint call.
+ * @param[in] changes array of pairs of tweak id and value being sent to client.
+ * @param[in] count number of elements in @p changes array.
+ *
+ * @return @p TWEAK_PICKLE_SUCCESS if there wasn't any errors.
+ * @p TWEAK_PICKLE_BAD_PARAMETER if @p changes is @p NULL
+ * or @p count is zero
+ * or any of @p changes has value equivalent to @p NULL variant value.
+ * @p TWEAK_PICKLE_REMOTE_ERROR if disconnected.
+ */
+tweak_pickle_call_result
+  tweak_pickle_server_change_items(tweak_pickle_server_endpoint server_endpoint,
+    const tweak_pickle_change_item *changes, size_t count);
+
 /**
  * @brief Call this in order to forward item removal event to client endpoint.
  *
@@ -282,7 +430,8 @@ tweak_pickle_call_result
  * @brief Destroy an endpoint and deallocate all resources associated with it.
  *
  * @param[in] server_endpoint An endpoint instance created by
- * @p tweak_pickle_create_server_endpoint call.
+ * @p tweak_pickle_create_server_endpoint or
+ * @p tweak_pickle_server_create_peer_endpoint call.
  */
 void tweak_pickle_destroy_server_endpoint(
     tweak_pickle_server_endpoint server_endpoint);
@@ -2,7 +2,7 @@
 set -e
 
 python3 ../nanopb-0.4.5/generator/nanopb_generator.py tweak.proto
-mkdir autogen
+mkdir -p autogen
 cp ./tweak.pb.h ./autogen
 cp ./tweak.pb.c ./autogen
 cp /app/nanopb-0.4.5/pb_common.c ./autogen
@@ -42,12 +42,18 @@ PB_BIND(tweak_pb_buffer_double, tweak_pb_buffer_double, AUTO)
 PB_BIND(tweak_pb_add_item, tweak_pb_add_item, AUTO)
 
 
+PB_BIND(tweak_pb_add_items, tweak_pb_add_items, AUTO)
+
+
 PB_BIND(tweak_pb_subscribe, tweak_pb_subscribe, AUTO)
 
 
 PB_BIND(tweak_pb_change_item, tweak_pb_change_item, AUTO)
 
 
+PB_BIND(tweak_pb_change_items, tweak_pb_change_items, AUTO)
+
+
 PB_BIND(tweak_pb_remove_item, tweak_pb_remove_item, AUTO)
 
 
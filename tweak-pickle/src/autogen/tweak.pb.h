@@ -10,18 +10,31 @@
 #endif
 
 /* Struct definitions */
+/* Body of batched "add item" request.
+Sent instead of a sequence of add_item requests
+if remote endpoint has announced "add_items" feature. */
+typedef struct _tweak_pb_add_items { 
+    pb_callback_t items; 
+} tweak_pb_add_items;
+
 /* Body of "announce_features" request. */
 typedef struct _tweak_pb_announce_features { 
     /* Comma separated list of features */
     pb_callback_t features; 
+    /* Identifies server model instance, item versions
+are only comparable within the same epoch.
+0 if server can't resynchronize client's items. */
+    uint64_t model_epoch; 
 } tweak_pb_announce_features;
 
 typedef struct _tweak_pb_buffer_double { 
     pb_callback_t buffer; 
+    pb_callback_t packed; 
 } tweak_pb_buffer_double;
 
 typedef struct _tweak_pb_buffer_float { 
     pb_callback_t buffer; 
+    pb_callback_t packed; 
 } tweak_pb_buffer_float;
 
 typedef struct _tweak_pb_buffer_raw { 
@@ -30,14 +43,17 @@ typedef struct _tweak_pb_buffer_raw {
 
 typedef struct _tweak_pb_buffer_sint16 { 
     pb_callback_t buffer; 
+    pb_callback_t packed; 
 } tweak_pb_buffer_sint16;
 
 typedef struct _tweak_pb_buffer_sint32 { 
     pb_callback_t buffer; 
+    pb_callback_t packed; 
 } tweak_pb_buffer_sint32;
 
 typedef struct _tweak_pb_buffer_sint64 { 
     pb_callback_t buffer; 
+    pb_callback_t packed; 
 } tweak_pb_buffer_sint64;
 
 typedef struct _tweak_pb_buffer_string { 
@@ -46,19 +62,38 @@ typedef struct _tweak_pb_buffer_string {
 
 typedef struct _tweak_pb_buffer_uint16 { 
     pb_callback_t buffer; 
+    pb_callback_t packed; 
 } tweak_pb_buffer_uint16;
 
 typedef struct _tweak_pb_buffer_uint32 { 
     pb_callback_t buffer; 
+    pb_callback_t packed; 
 } tweak_pb_buffer_uint32;
 
 typedef struct _tweak_pb_buffer_uint64 { 
     pb_callback_t buffer; 
+    pb_callback_t packed; 
 } tweak_pb_buffer_uint64;
 
+/* Body of batched change of several tweaks' current values.
+Sent instead of a sequence of change_item requests
+if remote endpoint has announced "change_items" feature. */
+typedef struct _tweak_pb_change_items { 
+    pb_callback_t changes; 
+} tweak_pb_change_items;
+
 /* Body of "subscribe" request. */
 typedef struct _tweak_pb_subscribe { 
     pb_callback_t uri_patterns; 
+    /* Epoch of server model client has kept items of
+since the previous connection. 0 if there are none. */
+    uint64_t model_epoch; 
+    /* Items kept by client as little-endian uint64 pairs
+of tweak_id and version. Server announces only items
+missing from this list, removes the ones it doesn't have
+anymore and changes the ones having another version.
+Ignored unless model_epoch matches server one. */
+    pb_callback_t known_items; 
 } tweak_pb_subscribe;
 
 /* Body of "remove item" request. */
@@ -115,6 +150,9 @@ recognizable by GUI. */
     /* Tweak default value */
     bool has_default_value;
     tweak_pb_value default_value; 
+    /* Version of current value assigned by server model,
+see announce_features.model_epoch. 0 if unknown. */
+    uint64_t version; 
 } tweak_pb_add_item;
 
 /* Body of singular change of tweak's current value.
@@ -125,6 +163,17 @@ typedef struct _tweak_pb_change_item {
     /* new value. */
     bool has_value;
     tweak_pb_value value; 
+    /* Version of new value assigned by server model.
+0 if unknown or sent by client. */
+    uint64_t version; 
+    /* If set, value is a vector replacing items of tweak's
+current value starting from offset, the rest is kept.
+Sent instead of whole value if remote endpoint
+has announced "partial_changes" feature.
+Partial changes always have version 0. */
+    bool partial; 
+    /* Index of the first vector item replaced by partial value. */
+    uint64_t offset; 
 } tweak_pb_change_item;
 
 /* Envelope for messages being sent by client endpoint
@@ -149,6 +198,8 @@ typedef struct _tweak_pb_server_node_message {
         tweak_pb_change_item change_item;
         tweak_pb_remove_item remove_item;
         tweak_pb_announce_features announce_features;
+        tweak_pb_change_items change_items;
+        tweak_pb_add_items add_items;
     } request; 
 } tweak_pb_server_node_message;
 
@@ -161,53 +212,70 @@ extern "C" {
 #define tweak_pb_value_init_default              {{{NULL}, NULL}, 0, {0}}
 #define tweak_pb_buffer_string_init_default      {{{NULL}, NULL}}
 #define tweak_pb_buffer_raw_init_default         {{{NULL}, NULL}}
-#define tweak_pb_buffer_sint16_init_default      {{{NULL}, NULL}}
-#define tweak_pb_buffer_sint32_init_default      {{{NULL}, NULL}}
-#define tweak_pb_buffer_sint64_init_default      {{{NULL}, NULL}}
-#define tweak_pb_buffer_uint16_init_default      {{{NULL}, NULL}}
-#define tweak_pb_buffer_uint32_init_default      {{{NULL}, NULL}}
-#define tweak_pb_buffer_uint64_init_default      {{{NULL}, NULL}}
-#define tweak_pb_buffer_float_init_default       {{{NULL}, NULL}}
-#define tweak_pb_buffer_double_init_default      {{{NULL}, NULL}}
-#define tweak_pb_add_item_init_default           {0, {{NULL}, NULL}, false, tweak_pb_value_init_default, {{NULL}, NULL}, {{NULL}, NULL}, false, tweak_pb_value_init_default}
-#define tweak_pb_subscribe_init_default          {{{NULL}, NULL}}
-#define tweak_pb_change_item_init_default        {0, false, tweak_pb_value_init_default}
+#define tweak_pb_buffer_sint16_init_default      {{{NULL}, NULL}, {{NULL}, NULL}}
+#define tweak_pb_buffer_sint32_init_default      {{{NULL}, NULL}, {{NULL}, NULL}}
+#define tweak_pb_buffer_sint64_init_default      {{{NULL}, NULL}, {{NULL}, NULL}}
+#define tweak_pb_buffer_uint16_init_default      {{{NULL}, NULL}, {{NULL}, NULL}}
+#define tweak_pb_buffer_uint32_init_default      {{{NULL}, NULL}, {{NULL}, NULL}}
+#define tweak_pb_buffer_uint64_init_default      {{{NULL}, NULL}, {{NULL}, NULL}}
+#define tweak_pb_buffer_float_init_default       {{{NULL}, NULL}, {{NULL}, NULL}}
+#define tweak_pb_buffer_double_init_default      {{{NULL}, NULL}, {{NULL}, NULL}}
+#define tweak_pb_add_item_init_default           {0, {{NULL}, NULL}, false, tweak_pb_value_init_default, {{NULL}, NULL}, {{NULL}, NULL}, false, tweak_pb_value_init_default, 0}
+#define tweak_pb_add_items_init_default          {{{NULL}, NULL}}
+#define tweak_pb_subscribe_init_default          {{{NULL}, NULL}, 0, {{NULL}, NULL}}
+#define tweak_pb_change_item_init_default        {0, false, tweak_pb_value_init_default, 0, 0, 0}
+#define tweak_pb_change_items_init_default       {{{NULL}, NULL}}
 #define tweak_pb_remove_item_init_default        {0}
-#define tweak_pb_announce_features_init_default  {{{NULL}, NULL}}
+#define tweak_pb_announce_features_init_default  {{{NULL}, NULL}, 0}
 #define tweak_pb_client_node_message_init_default {{{NULL}, NULL}, 0, {tweak_pb_subscribe_init_default}}
 #define tweak_pb_server_node_message_init_default {{{NULL}, NULL}, 0, {tweak_pb_add_item_init_default}}
 #define tweak_pb_value_init_zero                 {{{NULL}, NULL}, 0, {0}}
 #define tweak_pb_buffer_string_init_zero         {{{NULL}, NULL}}
 #define tweak_pb_buffer_raw_init_zero            {{{NULL}, NULL}}
-#define tweak_pb_buffer_sint16_init_zero         {{{NULL}, NULL}}
-#define tweak_pb_buffer_sint32_init_zero         {{{NULL}, NULL}}
-#define tweak_pb_buffer_sint64_init_zero         {{{NULL}, NULL}}
-#define tweak_pb_buffer_uint16_init_zero         {{{NULL}, NULL}}
-#define tweak_pb_buffer_uint32_init_zero         {{{NULL}, NULL}}
-#define tweak_pb_buffer_uint64_init_zero         {{{NULL}, NULL}}
-#define tweak_pb_buffer_float_init_zero          {{{NULL}, NULL}}
-#define tweak_pb_buffer_double_init_zero         {{{NULL}, NULL}}
-#define tweak_pb_add_item_init_zero              {0, {{NULL}, NULL}, false, tweak_pb_value_init_zero, {{NULL}, NULL}, {{NULL}, NULL}, false, tweak_pb_value_init_zero}
-#define tweak_pb_subscribe_init_zero             {{{NULL}, NULL}}
-#define tweak_pb_change_item_init_zero           {0, false, tweak_pb_value_init_zero}
+#define tweak_pb_buffer_sint16_init_zero         {{{NULL}, NULL}, {{NULL}, NULL}}
+#define tweak_pb_buffer_sint32_init_zero         {{{NULL}, NULL}, {{NULL}, NULL}}
+#define tweak_pb_buffer_sint64_init_zero         {{{NULL}, NULL}, {{NULL}, NULL}}
+#define tweak_pb_buffer_uint16_init_zero         {{{NULL}, NULL}, {{NULL}, NULL}}
+#define tweak_pb_buffer_uint32_init_zero         {{{NULL}, NULL}, {{NULL}, NULL}}
+#define tweak_pb_buffer_uint64_init_zero         {{{NULL}, NULL}, {{NULL}, NULL}}
+#define tweak_pb_buffer_float_init_zero          {{{NULL}, NULL}, {{NULL}, NULL}}
+#define tweak_pb_buffer_double_init_zero         {{{NULL}, NULL}, {{NULL}, NULL}}
+#define tweak_pb_add_item_init_zero              {0, {{NULL}, NULL}, false, tweak_pb_value_init_zero, {{NULL}, NULL}, {{NULL}, NULL}, false, tweak_pb_value_init_zero, 0}
+#define tweak_pb_add_items_init_zero             {{{NULL}, NULL}}
+#define tweak_pb_subscribe_init_zero             {{{NULL}, NULL}, 0, {{NULL}, NULL}}
+#define tweak_pb_change_item_init_zero           {0, false, tweak_pb_value_init_zero, 0, 0, 0}
+#define tweak_pb_change_items_init_zero          {{{NULL}, NULL}}
 #define tweak_pb_remove_item_init_zero           {0}
-#define tweak_pb_announce_features_init_zero     {{{NULL}, NULL}}
+#define tweak_pb_announce_features_init_zero     {{{NULL}, NULL}, 0}
 #define tweak_pb_client_node_message_init_zero   {{{NULL}, NULL}, 0, {tweak_pb_subscribe_init_zero}}
 #define tweak_pb_server_node_message_init_zero   {{{NULL}, NULL}, 0, {tweak_pb_add_item_init_zero}}
 
 /* Field tags (for use in manual encoding/decoding) */
+#define tweak_pb_add_items_items_tag             1
 #define tweak_pb_announce_features_features_tag  1
+#define tweak_pb_announce_features_model_epoch_tag 2
 #define tweak_pb_buffer_double_buffer_tag        2
+#define tweak_pb_buffer_double_packed_tag        3
 #define tweak_pb_buffer_float_buffer_tag         2
+#define tweak_pb_buffer_float_packed_tag         3
 #define tweak_pb_buffer_raw_data_tag             1
 #define tweak_pb_buffer_sint16_buffer_tag        2
+#define tweak_pb_buffer_sint16_packed_tag        3
 #define tweak_pb_buffer_sint32_buffer_tag        2
+#define tweak_pb_buffer_sint32_packed_tag        3
 #define tweak_pb_buffer_sint64_buffer_tag        2
+#define tweak_pb_buffer_sint64_packed_tag        3
 #define tweak_pb_buffer_string_data_tag          1
 #define tweak_pb_buffer_uint16_buffer_tag        2
+#define tweak_pb_buffer_uint16_packed_tag        3
 #define tweak_pb_buffer_uint32_buffer_tag        2
+#define tweak_pb_buffer_uint32_packed_tag        3
 #define tweak_pb_buffer_uint64_buffer_tag        2
+#define tweak_pb_buffer_uint64_packed_tag        3
+#define tweak_pb_change_items_changes_tag        1
 #define tweak_pb_subscribe_uri_patterns_tag      1
+#define tweak_pb_subscribe_model_epoch_tag       2
+#define tweak_pb_subscribe_known_items_tag       3
 #define tweak_pb_remove_item_tweak_id_tag        1
 #define tweak_pb_value_is_null_tag               1
 #define tweak_pb_value_scalar_bool_tag           2
@@ -238,8 +306,12 @@ extern "C" {
 #define tweak_pb_add_item_description_tag        4
 #define tweak_pb_add_item_meta_tag               5
 #define tweak_pb_add_item_default_value_tag      6
+#define tweak_pb_add_item_version_tag            7
 #define tweak_pb_change_item_tweak_id_tag        1
 #define tweak_pb_change_item_value_tag           2
+#define tweak_pb_change_item_version_tag         3
+#define tweak_pb_change_item_partial_tag         4
+#define tweak_pb_change_item_offset_tag          5
 #define tweak_pb_client_node_message_subscribe_tag 1
 #define tweak_pb_client_node_message_change_item_tag 2
 #define tweak_pb_client_node_message_announce_features_tag 3
@@ -247,6 +319,8 @@ extern "C" {
 #define tweak_pb_server_node_message_change_item_tag 2
 #define tweak_pb_server_node_message_remove_item_tag 3
 #define tweak_pb_server_node_message_announce_features_tag 4
+#define tweak_pb_server_node_message_change_items_tag 5
+#define tweak_pb_server_node_message_add_items_tag 6
 
 /* Struct field encoding specification for nanopb */
 #define tweak_pb_value_FIELDLIST(X, a) \
@@ -298,42 +372,50 @@ X(a, CALLBACK, SINGULAR, BYTES,    data,              1)
 #define tweak_pb_buffer_raw_DEFAULT NULL
 
 #define tweak_pb_buffer_sint16_FIELDLIST(X, a) \
-X(a, CALLBACK, REPEATED, SINT32,   buffer,            2)
+X(a, CALLBACK, REPEATED, SINT32,   buffer,            2) \
+X(a, CALLBACK, SINGULAR, BYTES,    packed,            3)
 #define tweak_pb_buffer_sint16_CALLBACK pb_default_field_callback
 #define tweak_pb_buffer_sint16_DEFAULT NULL
 
 #define tweak_pb_buffer_sint32_FIELDLIST(X, a) \
-X(a, CALLBACK, REPEATED, SINT32,   buffer,            2)
+X(a, CALLBACK, REPEATED, SINT32,   buffer,            2) \
+X(a, CALLBACK, SINGULAR, BYTES,    packed,            3)
 #define tweak_pb_buffer_sint32_CALLBACK pb_default_field_callback
 #define tweak_pb_buffer_sint32_DEFAULT NULL
 
 #define tweak_pb_buffer_sint64_FIELDLIST(X, a) \
-X(a, CALLBACK, REPEATED, SINT64,   buffer,            2)
+X(a, CALLBACK, REPEATED, SINT64,   buffer,            2) \
+X(a, CALLBACK, SINGULAR, BYTES,    packed,            3)
 #define tweak_pb_buffer_sint64_CALLBACK pb_default_field_callback
 #define tweak_pb_buffer_sint64_DEFAULT NULL
 
 #define tweak_pb_buffer_uint16_FIELDLIST(X, a) \
-X(a, CALLBACK, REPEATED, UINT32,   buffer,            2)
+X(a, CALLBACK, REPEATED, UINT32,   buffer,            2) \
+X(a, CALLBACK, SINGULAR, BYTES,    packed,            3)
 #define tweak_pb_buffer_uint16_CALLBACK pb_default_field_callback
 #define tweak_pb_buffer_uint16_DEFAULT NULL
 
 #define tweak_pb_buffer_uint32_FIELDLIST(X, a) \
-X(a, CALLBACK, REPEATED, UINT32,   buffer,            2)
+X(a, CALLBACK, REPEATED, UINT32,   buffer,            2) \
+X(a, CALLBACK, SINGULAR, BYTES,    packed,            3)
 #define tweak_pb_buffer_uint32_CALLBACK pb_default_field_callback
 #define tweak_pb_buffer_uint32_DEFAULT NULL
 
 #define tweak_pb_buffer_uint64_FIELDLIST(X, a) \
-X(a, CALLBACK, REPEATED, UINT64,   buffer,            2)
+X(a, CALLBACK, REPEATED, UINT64,   buffer,            2) \
+X(a, CALLBACK, SINGULAR, BYTES,    packed,            3)
 #define tweak_pb_buffer_uint64_CALLBACK pb_default_field_callback
 #define tweak_pb_buffer_uint64_DEFAULT NULL
 
 #define tweak_pb_buffer_float_FIELDLIST(X, a) \
-X(a, CALLBACK, REPEATED, FLOAT,    buffer,            2)
+X(a, CALLBACK, REPEATED, FLOAT,    buffer,            2) \
+X(a, CALLBACK, SINGULAR, BYTES,    packed,            3)
 #define tweak_pb_buffer_float_CALLBACK pb_default_field_callback
 #define tweak_pb_buffer_float_DEFAULT NULL
 
 #define tweak_pb_buffer_double_FIELDLIST(X, a) \
-X(a, CALLBACK, REPEATED, DOUBLE,   buffer,            2)
+X(a, CALLBACK, REPEATED, DOUBLE,   buffer,            2) \
+X(a, CALLBACK, SINGULAR, BYTES,    packed,            3)
 #define tweak_pb_buffer_double_CALLBACK pb_default_field_callback
 #define tweak_pb_buffer_double_DEFAULT NULL
 
@@ -343,31 +425,50 @@ X(a, CALLBACK, SINGULAR, STRING,   uri,               2) \
 X(a, STATIC,   OPTIONAL, MESSAGE,  current_value,     3) \
 X(a, CALLBACK, SINGULAR, STRING,   description,       4) \
 X(a, CALLBACK, SINGULAR, STRING,   meta,              5) \
-X(a, STATIC,   OPTIONAL, MESSAGE,  default_value,     6)
+X(a, STATIC,   OPTIONAL, MESSAGE,  default_value,     6) \
+X(a, STATIC,   SINGULAR, UINT64,   version,           7)
 #define tweak_pb_add_item_CALLBACK pb_default_field_callback
 #define tweak_pb_add_item_DEFAULT NULL
 #define tweak_pb_add_item_current_value_MSGTYPE tweak_pb_value
 #define tweak_pb_add_item_default_value_MSGTYPE tweak_pb_value
 
+#define tweak_pb_add_items_FIELDLIST(X, a) \
+X(a, CALLBACK, REPEATED, MESSAGE,  items,             1)
+#define tweak_pb_add_items_CALLBACK pb_default_field_callback
+#define tweak_pb_add_items_DEFAULT NULL
+#define tweak_pb_add_items_items_MSGTYPE tweak_pb_add_item
+
 #define tweak_pb_subscribe_FIELDLIST(X, a) \
-X(a, CALLBACK, SINGULAR, STRING,   uri_patterns,      1)
+X(a, CALLBACK, SINGULAR, STRING,   uri_patterns,      1) \
+X(a, STATIC,   SINGULAR, UINT64,   model_epoch,       2) \
+X(a, CALLBACK, SINGULAR, BYTES,    known_items,       3)
 #define tweak_pb_subscribe_CALLBACK pb_default_field_callback
 #define tweak_pb_subscribe_DEFAULT NULL
 
 #define tweak_pb_change_item_FIELDLIST(X, a) \
 X(a, STATIC,   SINGULAR, UINT64,   tweak_id,          1) \
-X(a, STATIC,   OPTIONAL, MESSAGE,  value,             2)
+X(a, STATIC,   OPTIONAL, MESSAGE,  value,             2) \
+X(a, STATIC,   SINGULAR, UINT64,   version,           3) \
+X(a, STATIC,   SINGULAR, BOOL,     partial,           4) \
+X(a, STATIC,   SINGULAR, UINT64,   offset,            5)
 #define tweak_pb_change_item_CALLBACK NULL
 #define tweak_pb_change_item_DEFAULT NULL
 #define tweak_pb_change_item_value_MSGTYPE tweak_pb_value
 
+#define tweak_pb_change_items_FIELDLIST(X, a) \
+X(a, CALLBACK, REPEATED, MESSAGE,  changes,           1)
+#define tweak_pb_change_items_CALLBACK pb_default_field_callback
+#define tweak_pb_change_items_DEFAULT NULL
+#define tweak_pb_change_items_changes_MSGTYPE tweak_pb_change_item
+
 #define tweak_pb_remove_item_FIELDLIST(X, a) \
 X(a, STATIC,   SINGULAR, UINT64,   tweak_id,          1)
 #define tweak_pb_remove_item_CALLBACK NULL
 #define tweak_pb_remove_item_DEFAULT NULL
 
 #define tweak_pb_announce_features_FIELDLIST(X, a) \
-X(a, CALLBACK, SINGULAR, STRING,   features,          1)
+X(a, CALLBACK, SINGULAR, STRING,   features,          1) \
+X(a, STATIC,   SINGULAR, UINT64,   model_epoch,       2)
 #define tweak_pb_announce_features_CALLBACK pb_default_field_callback
 #define tweak_pb_announce_features_DEFAULT NULL
 
@@ -385,13 +486,17 @@ X(a, STATIC,   ONEOF,    MSG_W_CB, (request,announce_features,request.announce_f
 X(a, STATIC,   ONEOF,    MSG_W_CB, (request,add_item,request.add_item),   1) \
 X(a, STATIC,   ONEOF,    MSG_W_CB, (request,change_item,request.change_item),   2) \
 X(a, STATIC,   ONEOF,    MSG_W_CB, (request,remove_item,request.remove_item),   3) \
-X(a, STATIC,   ONEOF,    MSG_W_CB, (request,announce_features,request.announce_features),   4)
+X(a, STATIC,   ONEOF,    MSG_W_CB, (request,announce_features,request.announce_features),   4) \
+X(a, STATIC,   ONEOF,    MSG_W_CB, (request,change_items,request.change_items),   5) \
+X(a, STATIC,   ONEOF,    MSG_W_CB, (request,add_items,request.add_items),   6)
 #define tweak_pb_server_node_message_CALLBACK NULL
 #define tweak_pb_server_node_message_DEFAULT NULL
 #define tweak_pb_server_node_message_request_add_item_MSGTYPE tweak_pb_add_item
 #define tweak_pb_server_node_message_request_change_item_MSGTYPE tweak_pb_change_item
 #define tweak_pb_server_node_message_request_remove_item_MSGTYPE tweak_pb_remove_item
 #define tweak_pb_server_node_message_request_announce_features_MSGTYPE tweak_pb_announce_features
+#define tweak_pb_server_node_message_request_change_items_MSGTYPE tweak_pb_change_items
+#define tweak_pb_server_node_message_request_add_items_MSGTYPE tweak_pb_add_items
 
 extern const pb_msgdesc_t tweak_pb_value_msg;
 extern const pb_msgdesc_t tweak_pb_buffer_string_msg;
@@ -405,8 +510,10 @@ extern const pb_msgdesc_t tweak_pb_buffer_uint64_msg;
 extern const pb_msgdesc_t tweak_pb_buffer_float_msg;
 extern const pb_msgdesc_t tweak_pb_buffer_double_msg;
 extern const pb_msgdesc_t tweak_pb_add_item_msg;
+extern const pb_msgdesc_t tweak_pb_add_items_msg;
 extern const pb_msgdesc_t tweak_pb_subscribe_msg;
 extern const pb_msgdesc_t tweak_pb_change_item_msg;
+extern const pb_msgdesc_t tweak_pb_change_items_msg;
 extern const pb_msgdesc_t tweak_pb_remove_item_msg;
 extern const pb_msgdesc_t tweak_pb_announce_features_msg;
 extern const pb_msgdesc_t tweak_pb_client_node_message_msg;
@@ -425,8 +532,10 @@ extern const pb_msgdesc_t tweak_pb_server_node_message_msg;
 #define tweak_pb_buffer_float_fields &tweak_pb_buffer_float_msg
 #define tweak_pb_buffer_double_fields &tweak_pb_buffer_double_msg
 #define tweak_pb_add_item_fields &tweak_pb_add_item_msg
+#define tweak_pb_add_items_fields &tweak_pb_add_items_msg
 #define tweak_pb_subscribe_fields &tweak_pb_subscribe_msg
 #define tweak_pb_change_item_fields &tweak_pb_change_item_msg
+#define tweak_pb_change_items_fields &tweak_pb_change_items_msg
 #define tweak_pb_remove_item_fields &tweak_pb_remove_item_msg
 #define tweak_pb_announce_features_fields &tweak_pb_announce_features_msg
 #define tweak_pb_client_node_message_fields &tweak_pb_client_node_message_msg
@@ -445,8 +554,10 @@ extern const pb_msgdesc_t tweak_pb_server_node_message_msg;
 /* tweak_pb_buffer_float_size depends on runtime parameters */
 /* tweak_pb_buffer_double_size depends on runtime parameters */
 /* tweak_pb_add_item_size depends on runtime parameters */
+/* tweak_pb_add_items_size depends on runtime parameters */
 /* tweak_pb_subscribe_size depends on runtime parameters */
 /* tweak_pb_change_item_size depends on runtime parameters */
+/* tweak_pb_change_items_size depends on runtime parameters */
 /* tweak_pb_announce_features_size depends on runtime parameters */
 /* tweak_pb_client_node_message_size depends on runtime parameters */
 /* tweak_pb_server_node_message_size depends on runtime parameters */
@@ -26,6 +26,7 @@
  * THE SOFTWARE.
  */
 
+#include <tweak2/atomic.h>
 #include <tweak2/log.h>
 #include <tweak2/pickle.h>
 #include <tweak2/pickle_client.h>
@@ -39,12 +40,15 @@
 #include "tweakpickle_pb_util.h"
 
 #include <stdlib.h>
+#include <string.h>
 #include <inttypes.h>
 
 struct tweak_pickle_endpoint_client_impl {
   struct tweak_pickle_endpoint_base base;
   tweak_wire_connection wire_connection;
   tweak_pickle_client_skeleton skeleton;
+  /* Nonzero if vectors shall be encoded as packed little-endian blocks */
+  volatile uint32_t packed_vectors;
 };
 
 static void client_connection_state_listener(tweak_wire_connection connection,
@@ -133,6 +137,9 @@ static void client_connection_state_listener(tweak_wire_connection connection,
 struct decoded_server_node_message {
   pb_size_t tag;
 
+  /* change_items and add_items requests are dispatched item by item while being decoded */
+  struct tweak_pickle_endpoint_client_impl* endpoint;
+
   union {
     tweak_pickle_add_item add_item;
 
@@ -157,7 +164,7 @@ static void client_receive_listener(const uint8_t* buffer,
 
   pb_istream_t stream = pb_istream_from_buffer(buffer, size);
 
-  struct decoded_server_node_message decoded_server_node_message = { 0 };
+  struct decoded_server_node_message decoded_server_node_message = { .endpoint = endpoint };
 
   tweak_pb_server_node_message message = {
     .cb_request = {
@@ -193,6 +200,12 @@ static void client_receive_listener(const uint8_t* buffer,
       TRIGGER_EVENT(endpoint->skeleton.announce_features_listener, &decoded_server_node_message.body.announce_features);
       tweak_variant_destroy_string(&decoded_server_node_message.body.announce_features.features);
     break;
+    case tweak_pb_server_node_message_change_items_tag:
+      TWEAK_LOG_TRACE("Inbound change_items request has been dispatched");
+      break;
+    case tweak_pb_server_node_message_add_items_tag:
+      TWEAK_LOG_TRACE("Inbound add_items request has been dispatched");
+      break;
     default:
       TWEAK_LOG_WARN("Should never happen.\n"
                      "Unrecognized tags should cause error in pb_decode()\n"
@@ -216,6 +229,7 @@ static bool decode_announce_features_request(pb_istream_t *stream, tweak_pb_anno
     TWEAK_LOG_WARN("Can't decode inbound announce_features request");
     return false;
   }
+  decoded_server_node_message->body.announce_features.model_epoch = announce_features->model_epoch;
   return true;
 }
 
@@ -252,6 +266,7 @@ static bool decode_server_add_item_request(pb_istream_t *stream,
   }
 
   decoded_server_node_message->body.add_item.id = add_item->tweak_id;
+  decoded_server_node_message->body.add_item.version = add_item->version;
   if (tweak_pickle_pb_is_scalar(&add_item->current_value)) {
     decoded_server_node_message->body.add_item.current_value = tweak_pickle_pb_value_to_variant(&add_item->current_value);
   }
@@ -261,6 +276,49 @@ static bool decode_server_add_item_request(pb_istream_t *stream,
   return true;
 }
 
+static void destroy_decoded_add_item(tweak_pickle_add_item *add_item) {
+  tweak_variant_destroy_string(&add_item->uri);
+  tweak_variant_destroy_string(&add_item->meta);
+  tweak_variant_destroy_string(&add_item->description);
+  tweak_variant_destroy(&add_item->default_value);
+  tweak_variant_destroy(&add_item->current_value);
+}
+
+static bool decode_server_add_items_element(pb_istream_t *stream, const pb_field_t *field,
+  void **arg)
+{
+  TWEAK_LOG_TRACE_ENTRY("stream = %p, field = %p, arg = %p", stream, field, arg);
+  (void)field;
+  struct decoded_server_node_message *decoded_server_node_message =
+    *(struct decoded_server_node_message **)arg;
+  struct tweak_pickle_endpoint_client_impl* endpoint = decoded_server_node_message->endpoint;
+  tweak_pb_add_item add_item = tweak_pb_add_item_init_zero;
+  tweak_pickle_add_item *item = &decoded_server_node_message->body.add_item;
+  memset(item, 0, sizeof(*item));
+  if (!decode_server_add_item_request(stream, &add_item, decoded_server_node_message)) {
+    return false;
+  }
+  tweak_pickle_trace_add_item_req("Inbound", item);
+  TRIGGER_EVENT(endpoint->skeleton.add_item_listener, item);
+  destroy_decoded_add_item(item);
+  return true;
+}
+
+static bool decode_server_add_items_request(pb_istream_t *stream,
+  tweak_pb_add_items *add_items,
+  struct decoded_server_node_message *decoded_server_node_message)
+{
+  TWEAK_LOG_TRACE_ENTRY("stream = %p, add_items = %p, decoded_server_node_message = %p",
+    stream, add_items, decoded_server_node_message);
+  add_items->items.funcs.decode = &decode_server_add_items_element;
+  add_items->items.arg = decoded_server_node_message;
+  if (!pb_decode(stream, tweak_pb_add_items_fields, add_items)) {
+    TWEAK_LOG_WARN("Can't decode add_items request");
+    return false;
+  }
+  return true;
+}
+
 static bool decode_server_change_item_request(pb_istream_t *stream,
   tweak_pb_change_item *change_item,
   struct decoded_server_node_message *decoded_server_node_message)
@@ -276,12 +334,51 @@ static bool decode_server_change_item_request(pb_istream_t *stream,
   }
 
   decoded_server_node_message->body.change_item.id = change_item->tweak_id;
+  decoded_server_node_message->body.change_item.version = change_item->version;
+  decoded_server_node_message->body.change_item.partial = change_item->partial;
+  decoded_server_node_message->body.change_item.offset = change_item->offset;
   if (tweak_pickle_pb_is_scalar(&change_item->value)) {
     decoded_server_node_message->body.change_item.value = tweak_pickle_pb_value_to_variant(&change_item->value);
   }
   return true;
 }
 
+static bool decode_server_change_items_element(pb_istream_t *stream, const pb_field_t *field,
+  void **arg)
+{
+  TWEAK_LOG_TRACE_ENTRY("stream = %p, field = %p, arg = %p", stream, field, arg);
+  (void)field;
+  struct decoded_server_node_message *decoded_server_node_message =
+    *(struct decoded_server_node_message **)arg;
+  struct tweak_pickle_endpoint_client_impl* endpoint = decoded_server_node_message->endpoint;
+  tweak_pb_change_item change_item = tweak_pb_change_item_init_zero;
+  tweak_pickle_change_item *change = &decoded_server_node_message->body.change_item;
+  *change = (tweak_pickle_change_item) { .id = TWEAK_INVALID_ID };
+  if (!decode_server_change_item_request(stream, &change_item, decoded_server_node_message)) {
+    tweak_variant_destroy(&change->value);
+    return false;
+  }
+  tweak_pickle_trace_change_item_req("Inbound", change);
+  TRIGGER_EVENT(endpoint->skeleton.change_item_listener, change);
+  tweak_variant_destroy(&change->value);
+  return true;
+}
+
+static bool decode_server_change_items_request(pb_istream_t *stream,
+  tweak_pb_change_items *change_items,
+  struct decoded_server_node_message *decoded_server_node_message)
+{
+  TWEAK_LOG_TRACE_ENTRY("stream = %p, change_items = %p, decoded_server_node_message = %p",
+    stream, change_items, decoded_server_node_message);
+  change_items->changes.funcs.decode = &decode_server_change_items_element;
+  change_items->changes.arg = decoded_server_node_message;
+  if (!pb_decode(stream, tweak_pb_change_items_fields, change_items)) {
+    TWEAK_LOG_WARN("Can't decode change_items request");
+    return false;
+  }
+  return true;
+}
+
 static bool decode_server_remove_item_request(pb_istream_t *stream,
   tweak_pb_remove_item *remove_item,
   struct decoded_server_node_message *decoded_server_node_message)
@@ -322,6 +419,16 @@ static bool decode_server_request(pb_istream_t *stream, const pb_field_t *field,
     rv = decode_server_remove_item_request(stream,
       (tweak_pb_remove_item *)field->pData, decoded_server_node_message);
     break;
+  case tweak_pb_server_node_message_add_items_tag:
+    TWEAK_LOG_TRACE("Invoking decode_server_add_items_request");
+    rv = decode_server_add_items_request(stream,
+      (tweak_pb_add_items *)field->pData, decoded_server_node_message);
+    break;
+  case tweak_pb_server_node_message_change_items_tag:
+    TWEAK_LOG_TRACE("Invoking decode_server_change_items_request");
+    rv = decode_server_change_items_request(stream,
+      (tweak_pb_change_items *)field->pData, decoded_server_node_message);
+    break;
   case tweak_pb_server_node_message_announce_features_tag:
     rv = decode_announce_features_request(stream, (tweak_pb_announce_features *)field->pData,
       decoded_server_node_message);
@@ -343,7 +450,7 @@ static tweak_pickle_call_result
     (struct tweak_pickle_endpoint_client_impl*)client_endpoint;
 
   tweak_pickle_call_result result = tweak_pickle_send_message(endpoint_client_impl->wire_connection,
-    tweak_pb_client_node_message_fields, message);
+    TWEAK_WIRE_ALL_PEERS, tweak_pb_client_node_message_fields, message);
 
   TWEAK_LOG_TRACE("tweak_pickle_send_message returned %d", result);
 
@@ -388,11 +495,16 @@ tweak_pickle_call_result
       ? tweak_variant_string_c_str(&subscribe->uri_patterns)
       : "*");
 
+  tweak_pickle_subscribe no_known_items = { 0 };
+  const tweak_pickle_subscribe* known_items = subscribe ? subscribe : &no_known_items;
+
   tweak_pb_client_node_message message = {
     .which_request = tweak_pb_client_node_message_subscribe_tag,
     .request = {
       .subscribe = {
-        .uri_patterns = tweak_pickle_pb_make_string_encode_callback(&uri_patterns)
+        .uri_patterns = tweak_pickle_pb_make_string_encode_callback(&uri_patterns),
+        .model_epoch = known_items->model_epoch,
+        .known_items = tweak_pickle_pb_make_known_items_encode_callback(known_items)
       }
     }
   };
@@ -410,6 +522,19 @@ tweak_pickle_call_result
   return result;
 }
 
+void tweak_pickle_client_set_packed_vectors(tweak_pickle_client_endpoint client_endpoint,
+  bool packed_vectors)
+{
+  TWEAK_LOG_TRACE_ENTRY("client_endpoint = %p, packed_vectors = %d",
+    client_endpoint, packed_vectors);
+  if (!client_endpoint) {
+    return;
+  }
+  struct tweak_pickle_endpoint_client_impl *endpoint_client_impl =
+    (struct tweak_pickle_endpoint_client_impl *)client_endpoint;
+  tweak_common_atomic_store_u32(&endpoint_client_impl->packed_vectors, packed_vectors ? 1 : 0);
+}
+
 tweak_pickle_call_result
   tweak_pickle_client_change_item(tweak_pickle_client_endpoint client_endpoint,
                                   const tweak_pickle_change_item *change)
@@ -423,13 +548,19 @@ tweak_pickle_call_result
     return TWEAK_PICKLE_BAD_PARAMETER;
   }
 
+  struct tweak_pickle_endpoint_client_impl *endpoint_client_impl =
+    (struct tweak_pickle_endpoint_client_impl *)client_endpoint;
+  bool packed_vectors = tweak_common_atomic_load_u32(&endpoint_client_impl->packed_vectors) != 0;
+
   tweak_pb_client_node_message message = {
     .which_request = tweak_pb_client_node_message_change_item_tag,
     .request = {
       .change_item = {
         .tweak_id = change->id,
         .has_value = true,
-        .value = tweak_pickle_pb_variant_to_value(&change->value)
+        .value = tweak_pickle_pb_variant_to_value(&change->value, packed_vectors),
+        .partial = change->partial,
+        .offset = change->offset
       }
     }
   };
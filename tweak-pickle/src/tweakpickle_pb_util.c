@@ -54,6 +54,7 @@ void tweak_pickle_trace_add_item_req(const char* direction, const tweak_pickle_a
     " .meta=\"%s\","
     " .current_value=\"%s\","
     " .default_value=\"%s\","
+    " .version=%" PRIu64 ","
     "}"
     , direction
     , add_item->id
@@ -62,6 +63,7 @@ void tweak_pickle_trace_add_item_req(const char* direction, const tweak_pickle_a
     , tweak_variant_string_c_str(&add_item->meta)
     , tweak_variant_string_c_str(&current_value_str)
     , tweak_variant_string_c_str(&default_value_str)
+    , add_item->version
   );
   tweak_variant_destroy_string(&default_value_str);
   tweak_variant_destroy_string(&current_value_str);
@@ -74,11 +76,17 @@ void tweak_pickle_trace_change_item_req(const char* direction, const tweak_pickl
   TWEAK_LOG_TRACE("%s request: change_item"
     " {"
     " .id=%" PRId64 ","
-    " .value=\"%s\""
+    " .value=\"%s\","
+    " .version=%" PRIu64 ","
+    " .partial=%s,"
+    " .offset=%" PRIu64
     " }"
     , direction
     , change_item->id
-    , tweak_variant_string_c_str(&value_str));
+    , tweak_variant_string_c_str(&value_str)
+    , change_item->version
+    , change_item->partial ? "true" : "false"
+    , change_item->offset);
     tweak_variant_destroy_string(&value_str);
 }
 
@@ -97,20 +105,26 @@ void tweak_pickle_trace_subscribe_req(const char* direction, const tweak_pickle_
   assert(direction);
   TWEAK_LOG_TRACE("%s request: subscribe"
     " {"
-    " .uri_patterns=\"%s\""
+    " .uri_patterns=\"%s\","
+    " .model_epoch=%" PRIu64 ","
+    " .known_items_size=%zu"
     " }",
     direction,
-    subscribe ? tweak_variant_string_c_str(&subscribe->uri_patterns) : "*");
+    subscribe ? tweak_variant_string_c_str(&subscribe->uri_patterns) : "*",
+    subscribe ? subscribe->model_epoch : 0,
+    subscribe ? subscribe->known_items_size : 0);
 }
 
 void tweak_pickle_trace_announce_features_req(const char* direction, const tweak_pickle_features* features) {
   assert(direction);
   TWEAK_LOG_TRACE("%s request: announce_features"
     " {"
-    " .features=\"%s\""
+    " .features=\"%s\","
+    " .model_epoch=%" PRIu64
     " }",
     direction,
-    tweak_variant_string_c_str(&features->features));
+    tweak_variant_string_c_str(&features->features),
+    features->model_epoch);
 }
 
 #endif
@@ -302,7 +316,7 @@ static bool pb_variant_encode_raw_buffer(pb_ostream_t *stream,
   tweak_variant *variant = *(tweak_variant *const *)arg;
   struct tweak_variant_buffer *buffer = &variant->value.buffer;
 
-  const int8_t* data = tweak_buffer_get_data(buffer);
+  const int8_t* data = tweak_buffer_get_data_const(buffer);
   size_t size = tweak_buffer_get_size(buffer);
 
   if (!pb_encode_string(stream, (pb_byte_t *)data, size))
@@ -349,6 +363,87 @@ static bool pb_variant_decode_raw_buffer(pb_istream_t *stream,
   return true;
 }
 
+/*
+ * Packed vectors travel as a single little-endian block,
+ * so on little-endian hosts both directions are plain memcpy.
+ */
+static bool is_little_endian_host(void) {
+  const uint16_t probe = 1;
+  return *(const uint8_t*)&probe == 1;
+}
+
+static void reverse_bytes(uint8_t *dst, const uint8_t *src, size_t element_size) {
+  for (size_t ix = 0; ix < element_size; ix++) {
+    dst[ix] = src[element_size - 1 - ix];
+  }
+}
+
+static bool pb_variant_encode_packed_buffer(pb_ostream_t *stream,
+  const pb_field_t *field, void *const *arg)
+{
+  const tweak_variant *variant = *(const tweak_variant *const *)arg;
+  const struct tweak_variant_buffer *buffer = &variant->value.buffer;
+  const uint8_t *data = tweak_buffer_get_data_const(buffer);
+  size_t size = tweak_buffer_get_size(buffer);
+
+  if (!pb_encode_tag_for_field(stream, field))
+    return false;
+
+  /* Empty vector has no elements to swap */
+  if (is_little_endian_host() || size == 0)
+    return pb_encode_string(stream, data, size);
+
+  size_t element_size = size / tweak_variant_get_item_count(variant);
+  if (!pb_encode_varint(stream, size))
+    return false;
+
+  for (size_t offset = 0; offset < size; offset += element_size) {
+    uint8_t element[sizeof(uint64_t)];
+    reverse_bytes(element, data + offset, element_size);
+    if (!pb_write(stream, element, element_size))
+      return false;
+  }
+  return true;
+}
+
+static bool pb_variant_decode_packed_buffer(pb_istream_t *stream,
+  size_t element_size, struct tweak_variant_buffer *buffer)
+{
+  uint32_t size;
+  if (!pb_decode_varint32(stream, &size))
+    return false;
+
+  if (size > stream->bytes_left || size % element_size != 0) {
+    TWEAK_LOG_WARN("Malformed packed vector of %" PRIu32 " bytes", size);
+    return false;
+  }
+
+  if (size == 0) {
+    /* Empty vector is kept as an empty buffer */
+    tweak_buffer_destroy(buffer);
+    return true;
+  }
+
+  struct tweak_variant_buffer result = tweak_buffer_create(NULL, size);
+  uint8_t *data = tweak_buffer_get_data(&result);
+  if (!pb_read(stream, data, size)) {
+    tweak_buffer_destroy(&result);
+    return false;
+  }
+
+  if (!is_little_endian_host()) {
+    for (size_t offset = 0; offset < size; offset += element_size) {
+      uint8_t element[sizeof(uint64_t)];
+      memcpy(element, data + offset, element_size);
+      reverse_bytes(data + offset, element, element_size);
+    }
+  }
+
+  tweak_buffer_swap(buffer, &result);
+  tweak_buffer_destroy(&result);
+  return true;
+}
+
 #define IMPLEMENT_BUFFER_ENCODER_DECODER(C_TYPE, SUFFIX, ENCODER, DECODER, TARGET_TYPE)           \
 static bool pb_variant_encode_##SUFFIX##_buffer(pb_ostream_t *stream,                             \
   const pb_field_t *field, void *const *arg)                                                      \
@@ -368,43 +463,30 @@ static bool pb_variant_encode_##SUFFIX##_buffer(pb_ostream_t *stream,
   return true;                                                                                    \
 }                                                                                                 \
                                                                                                   \
-static void append_##SUFFIX##_value_to_buffer(struct tweak_variant_buffer *target,                \
-  C_TYPE value, size_t* count, size_t* capacity)                                                  \
+static void append_##SUFFIX##_value(C_TYPE** values, C_TYPE value, size_t* count,                 \
+  size_t* capacity)                                                                               \
 {                                                                                                 \
-  const size_t small_buffer_capacity = sizeof(target->buffers.small_buffer) / sizeof(value);      \
-  C_TYPE* data = (C_TYPE*)tweak_buffer_get_data(target);                                          \
-  size_t new_count = *count;                                                                      \
-  size_t new_capacity = *capacity;                                                                \
-  if (new_capacity == 0) {                                                                        \
-    new_capacity = small_buffer_capacity;                                                         \
-  }                                                                                               \
-  ++new_count;                                                                                    \
-  if (new_count > new_capacity) {                                                                 \
-    new_capacity = new_capacity * 3 / 2;                                                          \
-    if (*capacity <= small_buffer_capacity) {                                                     \
-      uint8_t* large_buffer = malloc(sizeof(value) * new_capacity);                               \
-      memcpy(large_buffer, target->buffers.small_buffer, target->size);                           \
-      target->buffers.large_buffer = large_buffer;                                                \
-    } else {                                                                                      \
-      target->buffers.large_buffer =                                                              \
-        realloc(target->buffers.large_buffer, sizeof(value) * new_capacity);                      \
-      if (!target->buffers.large_buffer) {                                                        \
-        TWEAK_FATAL("malloc() return NULL");                                                      \
-      }                                                                                           \
+  if (*count == *capacity) {                                                                      \
+    size_t new_capacity = *capacity > 0                                                           \
+      ? *capacity * 3 / 2                                                                         \
+      : TWEAK_VARIANT_SMALL_BUFFER_SIZE / sizeof(value);                                          \
+    C_TYPE* new_values = realloc(*values, sizeof(value) * new_capacity);                          \
+    if (!new_values) {                                                                            \
+      TWEAK_FATAL("realloc() return NULL");                                                       \
     }                                                                                             \
-    data = (C_TYPE*)target->buffers.large_buffer;                                                 \
+    *values = new_values;                                                                         \
+    *capacity = new_capacity;                                                                     \
   }                                                                                               \
-  target->size = new_count * sizeof(value);                                                       \
-  data[new_count - 1] = value;                                                                    \
-  *count = new_count;                                                                             \
-  *capacity = new_capacity;                                                                       \
+  (*values)[(*count)++] = value;                                                                  \
 }                                                                                                 \
                                                                                                   \
 static bool pb_variant_decode_##SUFFIX##_buffer(pb_istream_t *stream,                             \
   const pb_field_t *field, struct tweak_variant_buffer *buffer)                                   \
 {                                                                                                 \
   (void)field;                                                                                    \
+  bool success = false;                                                                           \
   TARGET_TYPE value = 0;                                                                          \
+  C_TYPE* values = NULL;                                                                          \
   size_t count = 0;                                                                               \
   size_t capacity = 0;                                                                            \
   struct tweak_variant_buffer result = { 0 };                                                     \
@@ -413,14 +495,31 @@ static bool pb_variant_decode_##SUFFIX##_buffer(pb_istream_t *stream,
     bool eof;                                                                                     \
     uint32_t tag;                                                                                 \
     if (!pb_decode_tag(stream, &wire_type, &tag, &eof))                                           \
-      return false;                                                                               \
+      goto exit;                                                                                  \
+    if (tag == tweak_pb_buffer_##SUFFIX##_packed_tag) {                                           \
+      tweak_buffer_destroy(&result);                                                              \
+      if (wire_type != PB_WT_STRING                                                               \
+        || !pb_variant_decode_packed_buffer(stream, sizeof(C_TYPE), &result))                     \
+      {                                                                                           \
+        goto exit;                                                                                \
+      }                                                                                           \
+      continue;                                                                                   \
+    }                                                                                             \
     if (!DECODER(stream, &value))                                                                 \
-      return false;                                                                               \
-    append_##SUFFIX##_value_to_buffer(&result, (C_TYPE)value, &count, &capacity);                 \
+      goto exit;                                                                                  \
+    append_##SUFFIX##_value(&values, (C_TYPE)value, &count, &capacity);                           \
+  }                                                                                               \
+  /* Unpacked items are collected apart, so buffer is allocated once */                           \
+  if (count > 0) {                                                                                \
+    tweak_buffer_destroy(&result);                                                                \
+    result = tweak_buffer_create(values, count * sizeof(C_TYPE));                                 \
   }                                                                                               \
   tweak_buffer_swap(buffer, &result);                                                             \
+  success = true;                                                                                 \
+exit:                                                                                             \
   tweak_buffer_destroy(&result);                                                                  \
-  return true;                                                                                    \
+  free(values);                                                                                   \
+  return success;                                                                                 \
 }
 
 IMPLEMENT_BUFFER_ENCODER_DECODER(int16_t, sint16,  pb_encode_fixed32, pb_decode_fixed32, int32_t)
@@ -432,7 +531,7 @@ IMPLEMENT_BUFFER_ENCODER_DECODER(uint64_t, uint64, pb_encode_fixed64, pb_decode_
 IMPLEMENT_BUFFER_ENCODER_DECODER(float, float, pb_encode_fixed32, pb_decode_fixed32, float)
 IMPLEMENT_BUFFER_ENCODER_DECODER(double, double, pb_encode_fixed64, pb_decode_fixed64, double)
 
-tweak_pb_value tweak_pickle_pb_variant_to_value(const tweak_variant *src) {
+tweak_pb_value tweak_pickle_pb_variant_to_value(const tweak_variant *src, bool packed_vectors) {
   assert(src);
   tweak_pb_value result = tweak_pb_value_init_default;
   switch (src->type) {
@@ -496,18 +595,33 @@ tweak_pb_value tweak_pickle_pb_variant_to_value(const tweak_variant *src) {
     break;
   case TWEAK_VARIANT_TYPE_VECTOR_SINT16:
     result.which_values = tweak_pb_value_sint16_buffer_tag;
-    result.values.sint16_buffer.buffer.arg = (void*)src;
-    result.values.sint16_buffer.buffer.funcs.encode = &pb_variant_encode_sint16_buffer;
+    if (packed_vectors) {
+      result.values.sint16_buffer.packed.arg = (void*)src;
+      result.values.sint16_buffer.packed.funcs.encode = &pb_variant_encode_packed_buffer;
+    } else {
+      result.values.sint16_buffer.buffer.arg = (void*)src;
+      result.values.sint16_buffer.buffer.funcs.encode = &pb_variant_encode_sint16_buffer;
+    }
     break;
   case TWEAK_VARIANT_TYPE_VECTOR_SINT32:
     result.which_values = tweak_pb_value_sint32_buffer_tag;
-    result.values.sint32_buffer.buffer.arg = (void*)src;
-    result.values.sint32_buffer.buffer.funcs.encode = &pb_variant_encode_sint32_buffer;
+    if (packed_vectors) {
+      result.values.sint32_buffer.packed.arg = (void*)src;
+      result.values.sint32_buffer.packed.funcs.encode = &pb_variant_encode_packed_buffer;
+    } else {
+      result.values.sint32_buffer.buffer.arg = (void*)src;
+      result.values.sint32_buffer.buffer.funcs.encode = &pb_variant_encode_sint32_buffer;
+    }
     break;
   case TWEAK_VARIANT_TYPE_VECTOR_SINT64:
     result.which_values = tweak_pb_value_sint64_buffer_tag;
-    result.values.sint64_buffer.buffer.arg = (void*)src;
-    result.values.sint64_buffer.buffer.funcs.encode = &pb_variant_encode_sint64_buffer;
+    if (packed_vectors) {
+      result.values.sint64_buffer.packed.arg = (void*)src;
+      result.values.sint64_buffer.packed.funcs.encode = &pb_variant_encode_packed_buffer;
+    } else {
+      result.values.sint64_buffer.buffer.arg = (void*)src;
+      result.values.sint64_buffer.buffer.funcs.encode = &pb_variant_encode_sint64_buffer;
+    }
     break;
   case TWEAK_VARIANT_TYPE_VECTOR_UINT8:
     result.which_values = tweak_pb_value_uint8_buffer_tag;
@@ -516,28 +630,53 @@ tweak_pb_value tweak_pickle_pb_variant_to_value(const tweak_variant *src) {
     break;
   case TWEAK_VARIANT_TYPE_VECTOR_UINT16:
     result.which_values = tweak_pb_value_uint16_buffer_tag;
-    result.values.uint16_buffer.buffer.arg = (void*)src;
-    result.values.uint16_buffer.buffer.funcs.encode = &pb_variant_encode_uint16_buffer;
+    if (packed_vectors) {
+      result.values.uint16_buffer.packed.arg = (void*)src;
+      result.values.uint16_buffer.packed.funcs.encode = &pb_variant_encode_packed_buffer;
+    } else {
+      result.values.uint16_buffer.buffer.arg = (void*)src;
+      result.values.uint16_buffer.buffer.funcs.encode = &pb_variant_encode_uint16_buffer;
+    }
     break;
   case TWEAK_VARIANT_TYPE_VECTOR_UINT32:
     result.which_values = tweak_pb_value_uint32_buffer_tag;
-    result.values.uint32_buffer.buffer.arg = (void*)src;
-    result.values.uint32_buffer.buffer.funcs.encode = &pb_variant_encode_uint32_buffer;
+    if (packed_vectors) {
+      result.values.uint32_buffer.packed.arg = (void*)src;
+      result.values.uint32_buffer.packed.funcs.encode = &pb_variant_encode_packed_buffer;
+    } else {
+      result.values.uint32_buffer.buffer.arg = (void*)src;
+      result.values.uint32_buffer.buffer.funcs.encode = &pb_variant_encode_uint32_buffer;
+    }
     break;
   case TWEAK_VARIANT_TYPE_VECTOR_UINT64:
     result.which_values = tweak_pb_value_uint64_buffer_tag;
-    result.values.uint64_buffer.buffer.arg = (void*)src;
-    result.values.uint64_buffer.buffer.funcs.encode = &pb_variant_encode_uint64_buffer;
+    if (packed_vectors) {
+      result.values.uint64_buffer.packed.arg = (void*)src;
+      result.values.uint64_buffer.packed.funcs.encode = &pb_variant_encode_packed_buffer;
+    } else {
+      result.values.uint64_buffer.buffer.arg = (void*)src;
+      result.values.uint64_buffer.buffer.funcs.encode = &pb_variant_encode_uint64_buffer;
+    }
     break;
   case TWEAK_VARIANT_TYPE_VECTOR_FLOAT:
     result.which_values = tweak_pb_value_fp32_buffer_tag;
-    result.values.fp32_buffer.buffer.arg = (void*)src;
-    result.values.fp32_buffer.buffer.funcs.encode = &pb_variant_encode_float_buffer;
+    if (packed_vectors) {
+      result.values.fp32_buffer.packed.arg = (void*)src;
+      result.values.fp32_buffer.packed.funcs.encode = &pb_variant_encode_packed_buffer;
+    } else {
+      result.values.fp32_buffer.buffer.arg = (void*)src;
+      result.values.fp32_buffer.buffer.funcs.encode = &pb_variant_encode_float_buffer;
+    }
     break;
   case TWEAK_VARIANT_TYPE_VECTOR_DOUBLE:
     result.which_values = tweak_pb_value_fp64_buffer_tag;
-    result.values.fp64_buffer.buffer.arg = (void*)src;
-    result.values.fp64_buffer.buffer.funcs.encode = &pb_variant_encode_double_buffer;
+    if (packed_vectors) {
+      result.values.fp64_buffer.packed.arg = (void*)src;
+      result.values.fp64_buffer.packed.funcs.encode = &pb_variant_encode_packed_buffer;
+    } else {
+      result.values.fp64_buffer.buffer.arg = (void*)src;
+      result.values.fp64_buffer.buffer.funcs.encode = &pb_variant_encode_double_buffer;
+    }
     break;
   default:
     TWEAK_LOG_WARN("%s: Unknown tag %d", __func__, src->type);
@@ -545,62 +684,47 @@ tweak_pb_value tweak_pickle_pb_variant_to_value(const tweak_variant *src) {
   return result;
 }
 
-enum { DEFAULT_ENCODE_BUFFER_SIZE = 4 * (1 << 10) };
-
 tweak_pickle_call_result tweak_pickle_send_message(
-    tweak_wire_connection wire_connection, const pb_msgdesc_t *fields,
-    const void *src_struct)
+    tweak_wire_connection wire_connection, tweak_wire_peer peer,
+    const pb_msgdesc_t *fields, const void *src_struct)
 {
   assert(wire_connection);
   assert(fields);
   assert(src_struct);
 
-  tweak_pickle_call_result result = TWEAK_PICKLE_REMOTE_ERROR;
-
-  uint8_t inline_buffer[DEFAULT_ENCODE_BUFFER_SIZE];
-  uint8_t *buffer = NULL;
-
   /* Estimate size first */
   pb_ostream_t sizestream = {0};
-  size_t datagram_size;
-  pb_ostream_t stream;
-
   if (!pb_encode(&sizestream, fields, src_struct))
   {
-    goto error;
+    return TWEAK_PICKLE_REMOTE_ERROR;
   }
 
-  datagram_size = sizestream.bytes_written;
+  size_t datagram_size = sizestream.bytes_written;
 
-  /* Avoid heap traffic if possible, but airbag is included */
-  buffer = datagram_size < sizeof(inline_buffer) ? inline_buffer
-                                                 : calloc(1, datagram_size);
-
-  if (!buffer)
-  { /* heap alloc failed */
-    goto error;
+  /* Encode straight into backend's outbound message */
+  tweak_wire_tx_buffer tx_buffer;
+  if (tweak_wire_acquire_tx_buffer(wire_connection, datagram_size, &tx_buffer) !=
+      TWEAK_WIRE_SUCCESS)
+  {
+    return TWEAK_PICKLE_REMOTE_ERROR;
   }
 
-  stream = pb_ostream_from_buffer(buffer, datagram_size);
+  tx_buffer.peer = peer;
+
+  pb_ostream_t stream = pb_ostream_from_buffer(tx_buffer.data, datagram_size);
   if (!pb_encode(&stream, fields, src_struct))
   {
-    goto error;
+    tweak_wire_release_tx_buffer(wire_connection, &tx_buffer);
+    return TWEAK_PICKLE_REMOTE_ERROR;
   }
 
-  if (tweak_wire_transmit(wire_connection, buffer, datagram_size) !=
+  if (tweak_wire_commit(wire_connection, &tx_buffer, stream.bytes_written) !=
       TWEAK_WIRE_SUCCESS)
   {
-    goto error;
+    return TWEAK_PICKLE_REMOTE_ERROR;
   }
 
-  result = TWEAK_PICKLE_SUCCESS;
-
-error:
-  if (buffer != inline_buffer)
-  {
-    free(buffer);
-  }
-  return result;
+  return TWEAK_PICKLE_SUCCESS;
 }
 
 void tweak_pickle_pb_reserve_string(size_t length,
@@ -721,3 +845,106 @@ pb_callback_t tweak_pickle_pb_make_variant_decode_callback(
   };
   return result;
 }
+
+/* Known item is encoded as two little-endian uint64: tweak_id and version */
+enum { TWEAK_PICKLE_KNOWN_ITEM_SIZE = 2 * sizeof(uint64_t) };
+
+static void store_u64_le(uint8_t *dst, uint64_t value) {
+  for (size_t ix = 0; ix < sizeof(value); ix++) {
+    dst[ix] = (uint8_t)(value >> (8 * ix));
+  }
+}
+
+static uint64_t load_u64_le(const uint8_t *src) {
+  uint64_t value = 0;
+  for (size_t ix = 0; ix < sizeof(value); ix++) {
+    value |= (uint64_t)src[ix] << (8 * ix);
+  }
+  return value;
+}
+
+static bool tweak_pickle_pb_encode_known_items(pb_ostream_t *stream,
+  const pb_field_t *field, void *const *arg)
+{
+  const tweak_pickle_subscribe *subscribe = *(const tweak_pickle_subscribe *const *)arg;
+  if (subscribe->known_items_size == 0) {
+    return true;
+  }
+
+  if (!pb_encode_tag_for_field(stream, field))
+    return false;
+
+  if (!pb_encode_varint(stream, subscribe->known_items_size * TWEAK_PICKLE_KNOWN_ITEM_SIZE))
+    return false;
+
+  for (size_t ix = 0; ix < subscribe->known_items_size; ix++) {
+    uint8_t element[TWEAK_PICKLE_KNOWN_ITEM_SIZE];
+    store_u64_le(element, subscribe->known_items[ix].id);
+    store_u64_le(element + sizeof(uint64_t), subscribe->known_items[ix].version);
+    if (!pb_write(stream, element, sizeof(element)))
+      return false;
+  }
+  return true;
+}
+
+static bool tweak_pickle_pb_decode_known_items(pb_istream_t *stream,
+  const pb_field_t *field, void **arg)
+{
+  (void)field;
+  tweak_pickle_subscribe *subscribe = *(tweak_pickle_subscribe **)arg;
+  size_t size = stream->bytes_left;
+  if (size % TWEAK_PICKLE_KNOWN_ITEM_SIZE != 0) {
+    TWEAK_LOG_WARN("Malformed known_items of %zu bytes", size);
+    return false;
+  }
+
+  free(subscribe->known_items);
+  subscribe->known_items = NULL;
+  subscribe->known_items_size = 0;
+
+  size_t count = size / TWEAK_PICKLE_KNOWN_ITEM_SIZE;
+  tweak_pickle_known_item *known_items = calloc(count, sizeof(*known_items));
+  if (!known_items) {
+    TWEAK_LOG_ERROR("calloc() returned NULL");
+    return false;
+  }
+
+  for (size_t ix = 0; ix < count; ix++) {
+    uint8_t element[TWEAK_PICKLE_KNOWN_ITEM_SIZE];
+    if (!pb_read(stream, element, sizeof(element))) {
+      free(known_items);
+      return false;
+    }
+    known_items[ix].id = load_u64_le(element);
+    known_items[ix].version = load_u64_le(element + sizeof(uint64_t));
+  }
+  subscribe->known_items = known_items;
+  subscribe->known_items_size = count;
+  return true;
+}
+
+pb_callback_t tweak_pickle_pb_make_known_items_encode_callback(
+  const tweak_pickle_subscribe *arg)
+{
+  assert(arg);
+  pb_callback_t result = {
+      .funcs = {
+        .encode = &tweak_pickle_pb_encode_known_items
+      },
+      .arg = (void *)arg
+  };
+  return result;
+}
+
+pb_callback_t tweak_pickle_pb_make_known_items_decode_callback(
+  tweak_pickle_subscribe *arg)
+{
+  assert(arg);
+  pb_callback_t result = {
+      .funcs = {
+        .decode = &tweak_pickle_pb_decode_known_items
+      },
+      .arg = arg
+  };
+  return result;
+}
@@ -83,11 +83,17 @@ pb_callback_t tweak_pickle_pb_make_string_encode_callback(
 pb_callback_t tweak_pickle_pb_make_variant_decode_callback(
   tweak_variant *arg);
 
+pb_callback_t tweak_pickle_pb_make_known_items_encode_callback(
+  const tweak_pickle_subscribe *arg);
+
+pb_callback_t tweak_pickle_pb_make_known_items_decode_callback(
+  tweak_pickle_subscribe *arg);
+
 tweak_variant tweak_pickle_pb_value_to_variant(tweak_pb_value *src);
 
-tweak_pb_value tweak_pickle_pb_variant_to_value(const tweak_variant *src);
+tweak_pb_value tweak_pickle_pb_variant_to_value(const tweak_variant *src, bool packed_vectors);
 
 tweak_pickle_call_result tweak_pickle_send_message(tweak_wire_connection wire_connection,
-  const pb_msgdesc_t *fields, const void *src_struct);
+  tweak_wire_peer peer, const pb_msgdesc_t *fields, const void *src_struct);
 
 #endif
@@ -26,6 +26,7 @@
  * THE SOFTWARE.
  */
 
+#include <tweak2/atomic.h>
 #include <tweak2/pickle.h>
 #include <tweak2/pickle_server.h>
 #include <tweak2/wire.h>
@@ -45,12 +46,24 @@ struct tweak_pickle_endpoint_server_impl {
   struct tweak_pickle_endpoint_base base;
   tweak_wire_connection wire_connection;
   tweak_pickle_server_skeleton skeleton;
+  /* Nonzero if vectors shall be encoded as packed little-endian blocks */
+  volatile uint32_t packed_vectors;
+  /* Endpoint sharing wire_connection, NULL unless made by
+   * tweak_pickle_server_create_peer_endpoint */
+  struct tweak_pickle_endpoint_server_impl* owner;
+  /* Destination of outbound messages */
+  tweak_pickle_peer peer;
+  /* Sender of the request being dispatched, touched by receive thread only */
+  tweak_pickle_peer sender;
+  /* Number of attached peers, drives connection_state_listener */
+  volatile uint32_t peer_count;
 };
 
-static void server_connection_state_listener(tweak_wire_connection connection,
-  tweak_wire_connection_state connection_state, void* arg);
+static void server_peer_state_listener(tweak_wire_connection connection,
+  tweak_wire_peer peer, tweak_wire_connection_state connection_state, void* arg);
 
-static void server_receive_listener(const uint8_t *buffer, size_t size, void* arg);
+static void server_receive_listener(tweak_wire_peer peer, const uint8_t *buffer,
+  size_t size, void* arg);
 
 tweak_pickle_server_endpoint tweak_pickle_create_server_endpoint(
   const tweak_pickle_server_descriptor* server_descriptor)
@@ -64,8 +77,11 @@ tweak_pickle_server_endpoint tweak_pickle_create_server_endpoint(
     " .skeleton={ ... }}",
     server_descriptor->context_type, server_descriptor->params, server_descriptor->uri);
 
-  if (!server_descriptor->skeleton.connection_state_listener.callback) {
-    TWEAK_LOG_ERROR("server_descriptor->skeleton.connection_state_listener.callback");
+  if (!server_descriptor->skeleton.connection_state_listener.callback
+    && !server_descriptor->skeleton.peer_state_listener.callback)
+  {
+    TWEAK_LOG_ERROR("server_descriptor->skeleton.connection_state_listener.callback"
+      " and server_descriptor->skeleton.peer_state_listener.callback are both NULL");
     return TWEAK_PICKLE_INVALID_ENDPOINT;
   }
 
@@ -83,15 +99,17 @@ tweak_pickle_server_endpoint tweak_pickle_create_server_endpoint(
   }
 
   endpoint_server_impl->skeleton = server_descriptor->skeleton;
+  endpoint_server_impl->peer = TWEAK_PICKLE_ALL_PEERS;
+  endpoint_server_impl->sender = TWEAK_PICKLE_ALL_PEERS;
 
   endpoint_server_impl->wire_connection =
-    tweak_wire_create_connection(server_descriptor->context_type,
+    tweak_wire_create_peer_connection(server_descriptor->context_type,
     server_descriptor->params, server_descriptor->uri,
-    &server_connection_state_listener, endpoint_server_impl,
+    &server_peer_state_listener, endpoint_server_impl,
     &server_receive_listener, endpoint_server_impl);
 
   if (endpoint_server_impl->wire_connection == TWEAK_WIRE_INVALID_CONNECTION) {
-    TWEAK_LOG_ERROR("tweak_wire_create_connection() returned TWEAK_WIRE_INVALID_CONNECTION");
+    TWEAK_LOG_ERROR("tweak_wire_create_peer_connection() returned TWEAK_WIRE_INVALID_CONNECTION");
     free(endpoint_server_impl);
     return TWEAK_PICKLE_INVALID_ENDPOINT;
   }
@@ -99,21 +117,35 @@ tweak_pickle_server_endpoint tweak_pickle_create_server_endpoint(
   return &endpoint_server_impl->base;
 }
 
-static void server_connection_state_listener(tweak_wire_connection connection,
-  tweak_wire_connection_state connection_state, void* arg)
+static void server_peer_state_listener(tweak_wire_connection connection,
+  tweak_wire_peer peer, tweak_wire_connection_state connection_state, void* arg)
 {
-  TWEAK_LOG_TRACE_ENTRY("connection = %p, connection_state = 0x%X, arg = %p",
-    connection, connection_state, arg);
+  TWEAK_LOG_TRACE_ENTRY("connection = %p, peer = %u, connection_state = 0x%X, arg = %p",
+    connection, peer, connection_state, arg);
   (void)connection;
   struct tweak_pickle_endpoint_server_impl* endpoint =
     (struct tweak_pickle_endpoint_server_impl*)arg;
 
   switch (connection_state) {
   case TWEAK_WIRE_DISCONNECTED:
-    TRIGGER_EVENT(endpoint->skeleton.connection_state_listener, TWEAK_PICKLE_DISCONNECTED);
+    if (endpoint->skeleton.peer_state_listener.callback) {
+      TRIGGER_EVENT(endpoint->skeleton.peer_state_listener, peer, TWEAK_PICKLE_DISCONNECTED);
+    }
+    if (tweak_common_atomic_fetch_add_u32(&endpoint->peer_count, (uint32_t)-1) == 1
+      && endpoint->skeleton.connection_state_listener.callback)
+    {
+      TRIGGER_EVENT(endpoint->skeleton.connection_state_listener, TWEAK_PICKLE_DISCONNECTED);
+    }
     break;
   case TWEAK_WIRE_CONNECTED:
-    TRIGGER_EVENT(endpoint->skeleton.connection_state_listener, TWEAK_PICKLE_CONNECTED);
+    if (tweak_common_atomic_fetch_add_u32(&endpoint->peer_count, 1) == 0
+      && endpoint->skeleton.connection_state_listener.callback)
+    {
+      TRIGGER_EVENT(endpoint->skeleton.connection_state_listener, TWEAK_PICKLE_CONNECTED);
+    }
+    if (endpoint->skeleton.peer_state_listener.callback) {
+      TRIGGER_EVENT(endpoint->skeleton.peer_state_listener, peer, TWEAK_PICKLE_CONNECTED);
+    }
     break;
   default:
     TWEAK_FATAL("Inside client_connection_state_listener: Unknown enumeration value: %d",
@@ -157,11 +189,16 @@ static bool decode_client_subscribe_request(pb_istream_t *stream, tweak_pb_subsc
   subscribe->uri_patterns = tweak_pickle_pb_make_string_decode_callback(
     &decoded_client_node_message->body.subscribe.uri_patterns
   );
+  subscribe->known_items = tweak_pickle_pb_make_known_items_decode_callback(
+    &decoded_client_node_message->body.subscribe
+  );
   if (!pb_decode(stream, tweak_pb_subscribe_fields, subscribe)) {
     tweak_variant_destroy_string(&decoded_client_node_message->body.subscribe.uri_patterns);
+    free(decoded_client_node_message->body.subscribe.known_items);
     TWEAK_LOG_WARN("Can't decode inbound subscribe request");
     return false;
   }
+  decoded_client_node_message->body.subscribe.model_epoch = subscribe->model_epoch;
   return true;
 }
 
@@ -179,6 +216,8 @@ static bool decode_client_change_item_request(pb_istream_t *stream, tweak_pb_cha
   }
 
   decoded_client_node_message->body.change_item.id = change_item->tweak_id;
+  decoded_client_node_message->body.change_item.partial = change_item->partial;
+  decoded_client_node_message->body.change_item.offset = change_item->offset;
   if (tweak_pickle_pb_is_scalar(&change_item->value)) {
     decoded_client_node_message->body.change_item.value = tweak_pickle_pb_value_to_variant(&change_item->value);
   }
@@ -213,14 +252,16 @@ static bool decode_client_request(pb_istream_t *stream, const pb_field_t *field,
   return rv;
 }
 
-static void server_receive_listener(const uint8_t *buffer, size_t size,
-  void* arg)
+static void server_receive_listener(tweak_wire_peer peer, const uint8_t *buffer,
+  size_t size, void* arg)
 {
-  TWEAK_LOG_TRACE_ENTRY("buffer = %p, size = 0x%X, arg=%p",
-    buffer, size, arg);
+  TWEAK_LOG_TRACE_ENTRY("peer = %u, buffer = %p, size = 0x%X, arg=%p",
+    peer, buffer, size, arg);
   struct tweak_pickle_endpoint_server_impl* endpoint =
     (struct tweak_pickle_endpoint_server_impl*)arg;
 
+  endpoint->sender = peer;
+
   pb_istream_t stream = pb_istream_from_buffer(buffer, size);
   struct decoded_client_node_message decoded_client_node_message = { 0 };
 
@@ -238,6 +279,8 @@ static void server_receive_listener(const uint8_t *buffer, size_t size,
     case tweak_pb_client_node_message_subscribe_tag:
       tweak_pickle_trace_subscribe_req("Inbound", &decoded_client_node_message.body.subscribe);
       TRIGGER_EVENT(endpoint->skeleton.subscribe_listener, &decoded_client_node_message.body.subscribe);
+      tweak_variant_destroy_string(&decoded_client_node_message.body.subscribe.uri_patterns);
+      free(decoded_client_node_message.body.subscribe.known_items);
       break;
     case tweak_pb_client_node_message_change_item_tag:
       tweak_pickle_trace_change_item_req("Inbound", &decoded_client_node_message.body.change_item);
@@ -271,56 +314,122 @@ static tweak_pickle_call_result
 
   tweak_pickle_call_result result =
     tweak_pickle_send_message(endpoint_server_impl->wire_connection,
-    tweak_pb_server_node_message_fields, message);
+    endpoint_server_impl->peer, tweak_pb_server_node_message_fields, message);
 
   TWEAK_LOG_TRACE("tweak_pickle_send_message returned %d", result);
   return result;
 }
 
-tweak_pickle_call_result
-  tweak_pickle_server_add_item(tweak_pickle_server_endpoint server_endpoint,
-    const tweak_pickle_add_item *add_item)
-{
-  TWEAK_LOG_TRACE_ENTRY("server_endpoint = %p, add_item=%p",
-    server_endpoint, add_item);
+static bool check_add_item(const tweak_pickle_add_item *add_item) {
   if (!add_item) {
     TWEAK_LOG_ERROR("add_item is NULL");
-    return TWEAK_PICKLE_BAD_PARAMETER;
+    return false;
   }
 
   if (add_item->id == TWEAK_INVALID_ID) {
     TWEAK_LOG_ERROR("add_item->tweak_id == TWEAK_INVALID_ID");
-    return TWEAK_PICKLE_BAD_PARAMETER;
+    return false;
   }
 
   if (tweak_variant_string_is_empty(&add_item->uri)) {
     TWEAK_LOG_ERROR("add_item->uri is empty");
-    return TWEAK_PICKLE_BAD_PARAMETER;
+    return false;
   }
 
   if (add_item->current_value.type == TWEAK_VARIANT_TYPE_NULL) {
     TWEAK_LOG_ERROR("add_item->current_value.type == TWEAK_VARIANT_TYPE_NULL");
-    return TWEAK_PICKLE_BAD_PARAMETER;
+    return false;
+  }
+
+  return true;
+}
+
+static bool use_packed_vectors(tweak_pickle_server_endpoint server_endpoint) {
+  struct tweak_pickle_endpoint_server_impl *endpoint_server_impl =
+    (struct tweak_pickle_endpoint_server_impl *)server_endpoint;
+  return tweak_common_atomic_load_u32(&endpoint_server_impl->packed_vectors) != 0;
+}
+
+void tweak_pickle_server_set_packed_vectors(tweak_pickle_server_endpoint server_endpoint,
+  bool packed_vectors)
+{
+  TWEAK_LOG_TRACE_ENTRY("server_endpoint = %p, packed_vectors = %d",
+    server_endpoint, packed_vectors);
+  if (!server_endpoint) {
+    return;
   }
+  struct tweak_pickle_endpoint_server_impl *endpoint_server_impl =
+    (struct tweak_pickle_endpoint_server_impl *)server_endpoint;
+  tweak_common_atomic_store_u32(&endpoint_server_impl->packed_vectors, packed_vectors ? 1 : 0);
+}
+
+tweak_pickle_peer tweak_pickle_server_get_sender(tweak_pickle_server_endpoint server_endpoint) {
+  assert(server_endpoint);
+  struct tweak_pickle_endpoint_server_impl *endpoint_server_impl =
+    (struct tweak_pickle_endpoint_server_impl *)server_endpoint;
+  return endpoint_server_impl->sender;
+}
 
+tweak_pickle_server_endpoint tweak_pickle_server_create_peer_endpoint(
+  tweak_pickle_server_endpoint server_endpoint, tweak_pickle_peer peer)
+{
+  TWEAK_LOG_TRACE_ENTRY("server_endpoint = %p, peer = %u", server_endpoint, peer);
+  assert(server_endpoint);
+  struct tweak_pickle_endpoint_server_impl *owner =
+    (struct tweak_pickle_endpoint_server_impl *)server_endpoint;
+  if (owner->owner) {
+    owner = owner->owner;
+  }
+
+  struct tweak_pickle_endpoint_server_impl* endpoint_server_impl =
+    calloc(1, sizeof(*endpoint_server_impl));
+
+  if (!endpoint_server_impl) {
+    TWEAK_LOG_ERROR("calloc() returned NULL");
+    return TWEAK_PICKLE_INVALID_ENDPOINT;
+  }
+
+  endpoint_server_impl->wire_connection = owner->wire_connection;
+  endpoint_server_impl->owner = owner;
+  endpoint_server_impl->peer = peer;
+  endpoint_server_impl->sender = TWEAK_PICKLE_ALL_PEERS;
+  return &endpoint_server_impl->base;
+}
+
+static tweak_pb_add_item make_pb_add_item(const tweak_pickle_add_item *add_item, bool packed_vectors) {
   bool has_default_value = add_item->default_value.type != TWEAK_VARIANT_TYPE_NULL;
   tweak_pb_value default_value = tweak_pb_value_init_default;
   if (has_default_value) {
-    default_value = tweak_pickle_pb_variant_to_value(&add_item->default_value);
+    default_value = tweak_pickle_pb_variant_to_value(&add_item->default_value, packed_vectors);
   }
+  tweak_pb_add_item pb_add_item = {
+    .tweak_id = add_item->id,
+    .uri = tweak_pickle_pb_make_string_encode_callback(&add_item->uri),
+    .description = tweak_pickle_pb_make_string_encode_callback(&add_item->description),
+    .meta = tweak_pickle_pb_make_string_encode_callback(&add_item->meta),
+    .has_default_value = has_default_value,
+    .default_value = default_value,
+    .has_current_value = true,
+    .current_value = tweak_pickle_pb_variant_to_value(&add_item->current_value, packed_vectors),
+    .version = add_item->version
+  };
+  return pb_add_item;
+}
+
+tweak_pickle_call_result
+  tweak_pickle_server_add_item(tweak_pickle_server_endpoint server_endpoint,
+    const tweak_pickle_add_item *add_item)
+{
+  TWEAK_LOG_TRACE_ENTRY("server_endpoint = %p, add_item=%p",
+    server_endpoint, add_item);
+  if (!check_add_item(add_item)) {
+    return TWEAK_PICKLE_BAD_PARAMETER;
+  }
+
   tweak_pb_server_node_message message = {
     .which_request = tweak_pb_server_node_message_add_item_tag,
     .request = {
-      .add_item = {
-        .tweak_id = add_item->id,
-        .uri = tweak_pickle_pb_make_string_encode_callback(&add_item->uri),
-        .description = tweak_pickle_pb_make_string_encode_callback(&add_item->description),
-        .meta = tweak_pickle_pb_make_string_encode_callback(&add_item->meta),
-        .has_default_value = has_default_value,
-        .default_value = default_value,
-        .has_current_value = true,
-        .current_value = tweak_pickle_pb_variant_to_value(&add_item->current_value)
-      }
+      .add_item = make_pb_add_item(add_item, use_packed_vectors(server_endpoint))
     }
   };
   tweak_pickle_trace_add_item_req("Outbound", add_item);
@@ -333,6 +442,71 @@ tweak_pickle_call_result
   return result;
 }
 
+struct add_items_encode_context {
+  const tweak_pickle_add_item *items;
+  size_t count;
+  bool packed_vectors;
+};
+
+static bool encode_add_items(pb_ostream_t *stream, const pb_field_t *field, void *const *arg) {
+  const struct add_items_encode_context* context = *arg;
+  for (size_t ix = 0; ix < context->count; ++ix) {
+    tweak_pb_add_item add_item = make_pb_add_item(&context->items[ix], context->packed_vectors);
+    if (!pb_encode_tag_for_field(stream, field)) {
+      return false;
+    }
+    if (!pb_encode_submessage(stream, tweak_pb_add_item_fields, &add_item)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+tweak_pickle_call_result
+  tweak_pickle_server_add_items(tweak_pickle_server_endpoint server_endpoint,
+    const tweak_pickle_add_item *items, size_t count)
+{
+  TWEAK_LOG_TRACE_ENTRY("server_endpoint = %p, items = %p, count = %zu",
+    server_endpoint, items, count);
+  if (!items || count == 0) {
+    return TWEAK_PICKLE_BAD_PARAMETER;
+  }
+
+  for (size_t ix = 0; ix < count; ++ix) {
+    if (!check_add_item(&items[ix])) {
+      return TWEAK_PICKLE_BAD_PARAMETER;
+    }
+    tweak_pickle_trace_add_item_req("Outbound", &items[ix]);
+  }
+
+  struct add_items_encode_context context = {
+    .items = items,
+    .count = count,
+    .packed_vectors = use_packed_vectors(server_endpoint)
+  };
+
+  tweak_pb_server_node_message message = {
+    .which_request = tweak_pb_server_node_message_add_items_tag,
+    .request = {
+      .add_items = {
+        .items = {
+          .funcs = {
+            .encode = &encode_add_items
+          },
+          .arg = &context
+        }
+      }
+    }
+  };
+  tweak_pickle_call_result result = encode_and_transmit_server_message(server_endpoint, &message);
+  if (result == TWEAK_PICKLE_SUCCESS) {
+    TWEAK_LOG_TRACE("Server message has been encoded and transmitted");
+  } else {
+    TWEAK_LOG_TRACE("Server message hasn't been delivered");
+  }
+  return result;
+}
+
 tweak_pickle_call_result
   tweak_pickle_server_announce_features(tweak_pickle_server_endpoint server_endpoint,
     const tweak_pickle_features* features)
@@ -344,7 +518,8 @@ tweak_pickle_call_result
     .which_request = tweak_pb_server_node_message_announce_features_tag,
     .request = {
       .announce_features = {
-        .features =  tweak_pickle_pb_make_string_encode_callback(&features->features)
+        .features =  tweak_pickle_pb_make_string_encode_callback(&features->features),
+        .model_epoch = features->model_epoch
       }
     }
   };
@@ -379,7 +554,10 @@ tweak_pickle_call_result
       .change_item = {
         .tweak_id = change->id,
         .has_value = true,
-        .value = tweak_pickle_pb_variant_to_value(&change->value)
+        .value = tweak_pickle_pb_variant_to_value(&change->value, use_packed_vectors(server_endpoint)),
+        .version = change->version,
+        .partial = change->partial,
+        .offset = change->offset
       }
     }
   };
@@ -393,6 +571,79 @@ tweak_pickle_call_result
   return result;
 }
 
+struct change_items_encode_context {
+  const tweak_pickle_change_item *changes;
+  size_t count;
+  bool packed_vectors;
+};
+
+static bool encode_change_items(pb_ostream_t *stream, const pb_field_t *field, void *const *arg) {
+  const struct change_items_encode_context* context = *arg;
+  for (size_t ix = 0; ix < context->count; ++ix) {
+    const tweak_pickle_change_item *change = &context->changes[ix];
+    tweak_pb_change_item change_item = {
+      .tweak_id = change->id,
+      .has_value = true,
+      .value = tweak_pickle_pb_variant_to_value(&change->value, context->packed_vectors),
+      .version = change->version,
+      .partial = change->partial,
+      .offset = change->offset
+    };
+    if (!pb_encode_tag_for_field(stream, field)) {
+      return false;
+    }
+    if (!pb_encode_submessage(stream, tweak_pb_change_item_fields, &change_item)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+tweak_pickle_call_result
+  tweak_pickle_server_change_items(tweak_pickle_server_endpoint server_endpoint,
+    const tweak_pickle_change_item *changes, size_t count)
+{
+  TWEAK_LOG_TRACE_ENTRY("server_endpoint = %p, changes = %p, count = %zu",
+    server_endpoint, changes, count);
+  if (!changes || count == 0) {
+    return TWEAK_PICKLE_BAD_PARAMETER;
+  }
+
+  for (size_t ix = 0; ix < count; ++ix) {
+    if (changes[ix].value.type == TWEAK_VARIANT_TYPE_NULL) {
+      return TWEAK_PICKLE_BAD_PARAMETER;
+    }
+    tweak_pickle_trace_change_item_req("Outbound", &changes[ix]);
+  }
+
+  struct change_items_encode_context context = {
+    .changes = changes,
+    .count = count,
+    .packed_vectors = use_packed_vectors(server_endpoint)
+  };
+
+  tweak_pb_server_node_message message = {
+    .which_request = tweak_pb_server_node_message_change_items_tag,
+    .request = {
+      .change_items = {
+        .changes = {
+          .funcs = {
+            .encode = &encode_change_items
+          },
+          .arg = &context
+        }
+      }
+    }
+  };
+  tweak_pickle_call_result result = encode_and_transmit_server_message(server_endpoint, &message);
+  if (result == TWEAK_PICKLE_SUCCESS) {
+    TWEAK_LOG_TRACE("Server message has been encoded and transmitted");
+  } else {
+    TWEAK_LOG_TRACE("Server message hasn't been delivered");
+  }
+  return result;
+}
+
 tweak_pickle_call_result
   tweak_pickle_server_remove_item(tweak_pickle_server_endpoint server_endpoint,
     const tweak_pickle_remove_item* remove_item)
@@ -424,7 +675,15 @@ void tweak_pickle_destroy_server_endpoint(
   struct tweak_pickle_endpoint_server_impl* endpoint_server_impl =
     (struct tweak_pickle_endpoint_server_impl*) server_endpoint;
 
-  TRIGGER_EVENT(endpoint_server_impl->skeleton.connection_state_listener, TWEAK_PICKLE_DISCONNECTED);
+  if (endpoint_server_impl->owner) {
+    /* Connection is owned by endpoint it has been made of */
+    free(server_endpoint);
+    return;
+  }
+
+  if (endpoint_server_impl->skeleton.connection_state_listener.callback) {
+    TRIGGER_EVENT(endpoint_server_impl->skeleton.connection_state_listener, TWEAK_PICKLE_DISCONNECTED);
+  }
 
   tweak_wire_destroy_connection(endpoint_server_impl->wire_connection);
   endpoint_server_impl->wire_connection = NULL;
@@ -365,7 +365,18 @@ bool compareVectors(const tweak_variant* vec1, const tweak_variant* vec2) {
 }
 
 template<typename Q>
-void test_pickle_q() {
+tweak_variant generateTestVector(uint32_t size) {
+  if (size > 0) {
+    return VectorGen<Q>::generateRandomTweakVector(size);
+  }
+  /* Variant API doesn't create empty vectors, though they can be received from peers */
+  tweak_variant result = VectorGen<Q>::generateRandomTweakVector(1);
+  tweak_buffer_destroy(&result.value.buffer);
+  return result;
+}
+
+template<typename Q>
+void test_pickle_q(bool packed_vectors = false, uint32_t size = 100) {
   int port = 32769 + rand() % 20000;
   std::string uri0;
   uri0 = generateNngUri(port);
@@ -411,8 +422,11 @@ void test_pickle_q() {
   clientTestContext.wait_answers();
   serverTestContext.wait_answers();
 
-  tweak_variant current_value = VectorGen<Q>::generateRandomTweakVector(100);
-  tweak_variant default_value = VectorGen<Q>::generateRandomTweakVector(100);
+  tweak_pickle_server_set_packed_vectors(sep, packed_vectors);
+  tweak_pickle_client_set_packed_vectors(cep, packed_vectors);
+
+  tweak_variant current_value = generateTestVector<Q>(size);
+  tweak_variant default_value = generateTestVector<Q>(size);
 
   tweak_pickle_add_item new_item = {};
   new_item.uri = create_variant_string("X");
@@ -432,13 +446,13 @@ void test_pickle_q() {
   tweak_variant_destroy(&current_value);
   tweak_variant_destroy(&default_value);
 
-  tweak_variant server_value = VectorGen<Q>::generateRandomTweakVector(100);
+  tweak_variant server_value = generateTestVector<Q>(size);
 
   tweak_pickle_change_item server_change_item = {};
   server_change_item.id = 17;
   server_change_item.value = server_value;
 
-  tweak_variant client_value = VectorGen<Q>::generateRandomTweakVector(100);
+  tweak_variant client_value = generateTestVector<Q>(size);
 
   clientTestContext.reset_answer_count(1);
   tweak_pickle_server_change_item(sep, &server_change_item);
@@ -512,6 +526,50 @@ void test_pickle_double() {
     test_pickle_q<double>();
 }
 
+void test_pickle_packed_uint16() {
+    test_pickle_q<uint16_t>(true);
+}
+
+void test_pickle_packed_uint32() {
+    test_pickle_q<uint32_t>(true);
+}
+
+void test_pickle_packed_uint64() {
+    test_pickle_q<uint64_t>(true);
+}
+
+void test_pickle_packed_sint16() {
+    test_pickle_q<int16_t>(true);
+}
+
+void test_pickle_packed_sint32() {
+    test_pickle_q<int32_t>(true);
+}
+
+void test_pickle_packed_sint64() {
+    test_pickle_q<int64_t>(true);
+}
+
+void test_pickle_packed_float() {
+    test_pickle_q<float>(true);
+}
+
+void test_pickle_packed_double() {
+    test_pickle_q<double>(true);
+}
+
+void test_pickle_empty_uint16() {
+    test_pickle_q<uint16_t>(false, 0);
+}
+
+void test_pickle_packed_empty_uint16() {
+    test_pickle_q<uint16_t>(true, 0);
+}
+
+void test_pickle_packed_empty_double() {
+    test_pickle_q<double>(true, 0);
+}
+
 const char* TEST_STRING1 = "The three national symbols of England are the St. George's cross "
 "(usually seen as a flag), the red rose and the Three Lions crest (usually seen as a badge). "
 "The red rose is widely recognised as the national flower of England. The red rose is on the "
@@ -673,6 +731,17 @@ TEST_LIST = {
    { "test-pickle_sint64", test_pickle_sint64 },
    { "test-pickle_float", test_pickle_float },
    { "test-pickle_double", test_pickle_double },
+   { "test-pickle_packed_uint16", test_pickle_packed_uint16 },
+   { "test-pickle_packed_uint32", test_pickle_packed_uint32 },
+   { "test-pickle_packed_uint64", test_pickle_packed_uint64 },
+   { "test-pickle_packed_sint16", test_pickle_packed_sint16 },
+   { "test-pickle_packed_sint32", test_pickle_packed_sint32 },
+   { "test-pickle_packed_sint64", test_pickle_packed_sint64 },
+   { "test-pickle_packed_float", test_pickle_packed_float },
+   { "test-pickle_packed_double", test_pickle_packed_double },
+   { "test-pickle_empty_uint16", test_pickle_empty_uint16 },
+   { "test-pickle_packed_empty_uint16", test_pickle_packed_empty_uint16 },
+   { "test-pickle_packed_empty_double", test_pickle_packed_empty_double },
    { "test_pickle_string", test_pickle_string },
      { NULL, NULL }     /* zeroed record marking the end of the list */
 };
@@ -64,6 +64,23 @@ typedef enum {
   TWEAK_WIRE_ERROR_TIMEOUT,
 } tweak_wire_error_code;
 
+/**
+ * @ingroup tweak-internal
+ *
+ * @brief Identifier of a single peer attached to a connection.
+ *
+ * @details Backends which can't address peers individually report
+ * all of them as a single peer TWEAK_WIRE_ALL_PEERS.
+ */
+typedef uint32_t tweak_wire_peer;
+
+/**
+ * @ingroup tweak-internal
+ *
+ * @brief Pseudo peer standing for every peer attached to a connection.
+ */
+#define TWEAK_WIRE_ALL_PEERS ((tweak_wire_peer)0)
+
 /**
  * @brief virtual method definition for transmit procedure.
  *
@@ -90,6 +107,94 @@ typedef tweak_wire_error_code (*tweak_wire_transmit_proc)(
 typedef void (*tweak_wire_destroy_proc)(
   struct tweak_wire_connection_base* connection);
 
+/**
+ * @ingroup tweak-internal
+ *
+ * @brief Size of tweak_wire_tx_buffer::inline_data.
+ */
+#define TWEAK_WIRE_TX_BUFFER_INLINE_SIZE 256
+
+/**
+ * @ingroup tweak-internal
+ *
+ * @brief Writable buffer lent by the backend for a single outbound datagram.
+ *
+ * @details @p data may point into the descriptor itself, so it shall not be
+ * copied between tweak_wire_acquire_tx_buffer() and tweak_wire_commit().
+ */
+typedef struct {
+  /**
+   * @brief Payload area. Backend specific header, if any,
+   * is already reserved in front of it.
+   */
+  uint8_t *data;
+  /**
+   * @brief Number of bytes available at @p data.
+   */
+  size_t capacity;
+  /**
+   * @brief Backend specific handle, e.g. nng message.
+   */
+  void *opaque;
+  /**
+   * @brief Destination of the datagram. tweak_wire_acquire_tx_buffer()
+   * sets it to TWEAK_WIRE_ALL_PEERS, caller may narrow it down to a peer
+   * reported by tweak_wire_peer_state_listener before commit.
+   */
+  tweak_wire_peer peer;
+  /**
+   * @brief Payload area of small datagrams for backends that can't lend
+   * their own buffers, so they don't need heap allocation.
+   */
+  uint8_t inline_data[TWEAK_WIRE_TX_BUFFER_INLINE_SIZE];
+} tweak_wire_tx_buffer;
+
+/**
+ * @brief virtual method definition for tx buffer acquisition.
+ *
+ * @param[in] connection Instance associated with connection.
+ * @param[in] capacity Requested size of payload area.
+ * @param[out] tx_buffer Buffer descriptor to fill.
+ * @return TWEAK_WIRE_SUCCESS or TWEAK_WIRE_ERROR.
+ */
+typedef tweak_wire_error_code (*tweak_wire_acquire_tx_buffer_proc)(
+  struct tweak_wire_connection_base* connection,
+  size_t capacity, tweak_wire_tx_buffer *tx_buffer);
+
+/**
+ * @brief virtual method definition for transmitting acquired tx buffer.
+ * Buffer is consumed regardless of the result.
+ *
+ * @param[in] connection Instance associated with connection.
+ * @param[in] tx_buffer Buffer acquired with tweak_wire_acquire_tx_buffer_proc.
+ * @param[in] size Number of payload bytes to transmit, not greater than capacity.
+ * @return same as tweak_wire_transmit_proc.
+ */
+typedef tweak_wire_error_code (*tweak_wire_commit_proc)(
+  struct tweak_wire_connection_base* connection,
+  tweak_wire_tx_buffer *tx_buffer, size_t size);
+
+/**
+ * @brief virtual method definition for releasing acquired tx buffer
+ * without transmitting it.
+ *
+ * @param[in] connection Instance associated with connection.
+ * @param[in] tx_buffer Buffer acquired with tweak_wire_acquire_tx_buffer_proc.
+ */
+typedef void (*tweak_wire_release_tx_buffer_proc)(
+  struct tweak_wire_connection_base* connection,
+  tweak_wire_tx_buffer *tx_buffer);
+
+/**
+ * @brief virtual method definition for querying number of failed
+ * asynchronous transmit requests.
+ *
+ * @param[in] connection Instance associated with connection.
+ * @return number of requests that failed after transmit has returned success.
+ */
+typedef uint64_t (*tweak_wire_get_tx_failures_proc)(
+  struct tweak_wire_connection_base* connection);
+
 /**
  * @brief base class for all backends.
  *
@@ -110,6 +215,42 @@ struct tweak_wire_connection_base {
    * @see tweak_wire_destroy_proc.
    */
   tweak_wire_destroy_proc destroy_proc;
+  /**
+   * @brief Lend writable buffer for an outbound datagram.
+   * Optional. If it is NULL, tweak-wire provides heap buffers
+   * and transmits them with transmit_proc.
+   *
+   * @see tweak_wire_acquire_tx_buffer_proc.
+   */
+  tweak_wire_acquire_tx_buffer_proc acquire_tx_buffer_proc;
+  /**
+   * @brief Transmit buffer lent by acquire_tx_buffer_proc.
+   * Shall be provided along with acquire_tx_buffer_proc.
+   *
+   * @see tweak_wire_commit_proc.
+   */
+  tweak_wire_commit_proc commit_proc;
+  /**
+   * @brief Drop buffer lent by acquire_tx_buffer_proc.
+   * Shall be provided along with acquire_tx_buffer_proc.
+   *
+   * @see tweak_wire_release_tx_buffer_proc.
+   */
+  tweak_wire_release_tx_buffer_proc release_tx_buffer_proc;
+  /**
+   * @brief Report number of failed asynchronous transmit requests.
+   * Optional. If it is NULL, backend transmits synchronously
+   * and reports every failure as transmit result.
+   *
+   * @see tweak_wire_get_tx_failures_proc.
+   */
+  tweak_wire_get_tx_failures_proc get_tx_failures_proc;
+  /**
+   * @brief Listeners of tweak_wire_create_peer_connection() for backends
+   * which don't report peers themselves. Owned by tweak-wire, backends
+   * shall leave it NULL.
+   */
+  void *peer_adapter;
 };
 
 /**
@@ -179,16 +320,57 @@ typedef void (*tweak_wire_connection_state_listener)(
  */
 typedef void (*tweak_wire_receive_listener)(const uint8_t *buffer, size_t size, void *cookie);
 
+/**
+ * @ingroup tweak-internal
+ *
+ * @brief Function signature for registering as
+ * a listener of individual peers attaching and detaching.
+ *
+ * @param[in] connection Connection instance.
+ * @param[in] peer Peer which state has changed.
+ * @param[in] connection_state New state of the peer.
+ * @param[in] cookie Value passed as peer_state_cookie parameter
+ * to tweak_wire_create_peer_connection() call.
+ */
+typedef void (*tweak_wire_peer_state_listener)(
+    tweak_wire_connection connection,
+    tweak_wire_peer peer,
+    tweak_wire_connection_state connection_state,
+    void* cookie);
+
+/**
+ * @ingroup tweak-internal
+ *
+ * @brief Function signature for registering as
+ * receive inbound packets listener aware of their senders.
+ *
+ * @param[in] peer Peer which has sent the datagram.
+ * @param[in] buffer Pointer to data received.
+ * @param[in] size Size of data pointed by @p buffer.
+ * @param[in] cookie value passed as receive_listener_cookie parameter
+ * to tweak_wire_create_peer_connection() call.
+ */
+typedef void (*tweak_wire_peer_receive_listener)(tweak_wire_peer peer,
+  const uint8_t *buffer, size_t size, void *cookie);
+
 /**
  * @ingroup tweak-internal
  *
  * @brief Creates new instance of the connection.
  *
- * @param[in] connection_type One of "nng", "serial". Type is case-sensitive.
+ * @param[in] connection_type One of "nng", "rpmsg", "shm". Type is case-sensitive.
  * @param[in] params Additional params for backend seperated by semicolon ';'.
- * Only mutually exclusive "role=server" and "role=client"
- * are currently recognized for IP-based connections.
+ * Mutually exclusive "role=server" and "role=client"
+ * are mandatory for IP-based connections. Optional "tx_queue=N"
+ * makes transmit asynchronous with up to N datagrams in flight;
+ * transmit returns TWEAK_WIRE_ERROR_TIMEOUT if all of them stay busy
+ * for too long. Example: "role=server;tx_queue=32". Optional "broadcast"
+ * makes server treat all clients as a single peer, as it does when nng
+ * hub can't address them.
+ * "shm" backend needs role as well and accepts optional "ring_size=N",
+ * a power of two size in bytes of each ring, that is used by server only.
  * @param[in] uri Connection URI for the given network backend. NULL means default..
+ * "shm" backend expects "shm://name" and requires both peers to run on the same host.
  * @param[in] connection_state_listener Application provided callback
  * that is called when connection state is changed.
  * This listener is optional, so it can be NULL if notification
@@ -208,6 +390,37 @@ tweak_wire_connection tweak_wire_create_connection(
     void *connection_state_cookie, tweak_wire_receive_listener receive_listener,
     void *receive_listener_cookie);
 
+/**
+ * @ingroup tweak-internal
+ *
+ * @brief Same as tweak_wire_create_connection(), but reports every peer
+ * attached to the connection separately.
+ *
+ * @details Only "nng" backend in server role can serve several peers at once.
+ * It reports each of them by its own id if nng hub protocol supports
+ * addressing of individual pipes. Otherwise, as well as with point to point
+ * backends, all peers are reported as a single TWEAK_WIRE_ALL_PEERS peer
+ * which is connected while at least one of them is attached.
+ * Datagrams addressed to a single peer then reach every one of them.
+ *
+ * @param[in] connection_type same as for tweak_wire_create_connection().
+ * @param[in] params same as for tweak_wire_create_connection().
+ * @param[in] uri same as for tweak_wire_create_connection().
+ * @param[in] peer_state_listener Application provided callback
+ * that is called when a peer attaches or detaches. Optional.
+ * @param[in] peer_state_cookie Arbitrary pointer being passed to
+ * @p peer_state_listener.
+ * @param[in] receive_listener Mandatory listener for inbound datagrams.
+ * @param[in] receive_listener_cookie Arbitrary pointer being passed to
+ * @p receive_listener.
+ * @return connection handle or TWEAK_WIRE_INVALID_CONNECTION.
+ */
+tweak_wire_connection tweak_wire_create_peer_connection(
+    const char *connection_type, const char *params, const char *uri,
+    tweak_wire_peer_state_listener peer_state_listener,
+    void *peer_state_cookie, tweak_wire_peer_receive_listener receive_listener,
+    void *receive_listener_cookie);
+
 /**
  * @ingroup tweak-internal
  *
@@ -234,6 +447,69 @@ tweak_wire_connection tweak_wire_create_connection(
 tweak_wire_error_code tweak_wire_transmit(tweak_wire_connection connection,
                                           const uint8_t *buffer, size_t size);
 
+/**
+ * @ingroup tweak-internal
+ *
+ * @brief Borrows writable buffer for an outbound datagram.
+ *
+ * @details Allows the caller to serialize datagram directly into
+ * backend's outbound message and avoid extra copy made by tweak_wire_transmit().
+ * Every acquired buffer shall be passed either to tweak_wire_commit()
+ * or to tweak_wire_release_tx_buffer().
+ *
+ * @param[in] connection Instance associated with connection.
+ * @param[in] capacity Maximum number of payload bytes caller is going to write.
+ * @param[out] tx_buffer Buffer descriptor. @p tx_buffer->data points to
+ * at least @p capacity writable bytes on success.
+ * @return
+ * - TWEAK_WIRE_SUCCESS If the buffer is acquired,
+ * - TWEAK_WIRE_ERROR If there was memory allocation or library error.
+ */
+tweak_wire_error_code tweak_wire_acquire_tx_buffer(tweak_wire_connection connection,
+                                                   size_t capacity, tweak_wire_tx_buffer *tx_buffer);
+
+/**
+ * @ingroup tweak-internal
+ *
+ * @brief Transmits datagram written into buffer acquired by tweak_wire_acquire_tx_buffer().
+ *
+ * @details Behaves like tweak_wire_transmit(). The buffer is consumed regardless of the
+ * result and shall not be used after this call.
+ *
+ * @param[in] connection Instance associated with connection.
+ * @param[in] tx_buffer Buffer acquired by tweak_wire_acquire_tx_buffer().
+ * @param[in] size Number of payload bytes written to @p tx_buffer->data.
+ * @return same as tweak_wire_transmit().
+ */
+tweak_wire_error_code tweak_wire_commit(tweak_wire_connection connection,
+                                        tweak_wire_tx_buffer *tx_buffer, size_t size);
+
+/**
+ * @ingroup tweak-internal
+ *
+ * @brief Releases buffer acquired by tweak_wire_acquire_tx_buffer() without transmitting it.
+ *
+ * @param[in] connection Instance associated with connection.
+ * @param[in] tx_buffer Buffer acquired by tweak_wire_acquire_tx_buffer().
+ */
+void tweak_wire_release_tx_buffer(tweak_wire_connection connection,
+                                  tweak_wire_tx_buffer *tx_buffer);
+
+/**
+ * @ingroup tweak-internal
+ *
+ * @brief Returns number of asynchronous transmit requests that have failed
+ * since the connection was created.
+ *
+ * @details With "tx_queue=N" transmit returns once the datagram is queued,
+ * so failures detected later by the backend aren't reported to the caller.
+ * They are counted instead. Synchronous connections always return zero.
+ *
+ * @param[in] connection Instance associated with connection.
+ * @return number of failed requests.
+ */
+uint64_t tweak_wire_get_tx_failures(tweak_wire_connection connection);
+
 /**
  * @ingroup tweak-internal
  *
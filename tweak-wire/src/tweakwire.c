@@ -35,6 +35,11 @@
 #include "tweakwire_rpmsg.h"
 #endif
 
+#if defined(WITH_WIRE_SHM)
+#include "tweakwire_shm.h"
+#endif
+
+#include <stdlib.h>
 #include <string.h>
 
 tweak_wire_connection tweak_wire_create_connection(
@@ -61,18 +66,152 @@ tweak_wire_connection tweak_wire_create_connection(
             receive_listener_cookie);
    }
 #endif
+#if defined(WITH_WIRE_SHM)
+   if (strcmp(connection_type, "shm") == 0) {
+      return tweak_wire_create_shm_connection(connection_type, params, uri,
+            connection_state_listener, connection_state_cookie, receive_listener,
+            receive_listener_cookie);
+   }
+#endif
 
    return TWEAK_WIRE_INVALID_CONNECTION;
 }
 
+/*
+ * Forwards events of a backend which can't tell peers apart
+ * to peer aware listeners, on behalf of a single TWEAK_WIRE_ALL_PEERS peer.
+ */
+struct peer_adapter {
+  tweak_wire_peer_state_listener peer_state_listener;
+  void *peer_state_cookie;
+  tweak_wire_peer_receive_listener receive_listener;
+  void *receive_listener_cookie;
+};
+
+static void adapter_state_listener(tweak_wire_connection connection,
+  tweak_wire_connection_state connection_state, void* cookie)
+{
+  struct peer_adapter *peer_adapter = cookie;
+  if (peer_adapter->peer_state_listener) {
+    peer_adapter->peer_state_listener(connection, TWEAK_WIRE_ALL_PEERS, connection_state,
+      peer_adapter->peer_state_cookie);
+  }
+}
+
+static void adapter_receive_listener(const uint8_t *buffer, size_t size, void *cookie) {
+  struct peer_adapter *peer_adapter = cookie;
+  peer_adapter->receive_listener(TWEAK_WIRE_ALL_PEERS, buffer, size,
+    peer_adapter->receive_listener_cookie);
+}
+
+tweak_wire_connection tweak_wire_create_peer_connection(
+    const char *connection_type, const char *params, const char *uri,
+    tweak_wire_peer_state_listener peer_state_listener,
+    void *peer_state_cookie, tweak_wire_peer_receive_listener receive_listener,
+    void *receive_listener_cookie)
+{
+   if (!connection_type || !receive_listener) {
+      return TWEAK_WIRE_INVALID_CONNECTION;
+   }
+
+#if defined(WITH_WIRE_NNG)
+   if (strcmp(connection_type, "nng") == 0) {
+      return tweak_wire_create_nng_peer_connection(connection_type, params, uri,
+            peer_state_listener, peer_state_cookie, receive_listener,
+            receive_listener_cookie);
+   }
+#endif
+
+   struct peer_adapter *peer_adapter = calloc(1, sizeof(*peer_adapter));
+   if (!peer_adapter) {
+      return TWEAK_WIRE_INVALID_CONNECTION;
+   }
+   peer_adapter->peer_state_listener = peer_state_listener;
+   peer_adapter->peer_state_cookie = peer_state_cookie;
+   peer_adapter->receive_listener = receive_listener;
+   peer_adapter->receive_listener_cookie = receive_listener_cookie;
+
+   tweak_wire_connection connection = tweak_wire_create_connection(connection_type,
+      params, uri, &adapter_state_listener, peer_adapter,
+      &adapter_receive_listener, peer_adapter);
+   if (connection == TWEAK_WIRE_INVALID_CONNECTION) {
+      free(peer_adapter);
+      return TWEAK_WIRE_INVALID_CONNECTION;
+   }
+   connection->peer_adapter = peer_adapter;
+   return connection;
+}
+
 tweak_wire_error_code tweak_wire_transmit(tweak_wire_connection connection,
   const uint8_t *buffer, size_t size)
 {
   return connection->transmit_proc(connection, buffer, size);
 }
 
+static void free_tx_buffer_data(tweak_wire_tx_buffer *tx_buffer) {
+  if (tx_buffer->data != tx_buffer->inline_data) {
+    free(tx_buffer->data);
+  }
+  tx_buffer->data = NULL;
+}
+
+tweak_wire_error_code tweak_wire_acquire_tx_buffer(tweak_wire_connection connection,
+  size_t capacity, tweak_wire_tx_buffer *tx_buffer)
+{
+  tx_buffer->peer = TWEAK_WIRE_ALL_PEERS;
+  if (connection->acquire_tx_buffer_proc) {
+    return connection->acquire_tx_buffer_proc(connection, capacity, tx_buffer);
+  }
+
+  /* Backend can't lend its own buffers, transmit_proc will copy this one. */
+  if (capacity <= sizeof(tx_buffer->inline_data)) {
+    tx_buffer->data = tx_buffer->inline_data;
+  } else {
+    tx_buffer->data = malloc(capacity);
+    if (!tx_buffer->data) {
+      return TWEAK_WIRE_ERROR;
+    }
+  }
+  tx_buffer->capacity = capacity;
+  tx_buffer->opaque = NULL;
+  return TWEAK_WIRE_SUCCESS;
+}
+
+tweak_wire_error_code tweak_wire_commit(tweak_wire_connection connection,
+  tweak_wire_tx_buffer *tx_buffer, size_t size)
+{
+  if (connection->commit_proc) {
+    return connection->commit_proc(connection, tx_buffer, size);
+  }
+
+  tweak_wire_error_code result = connection->transmit_proc(connection, tx_buffer->data, size);
+  free_tx_buffer_data(tx_buffer);
+  return result;
+}
+
+void tweak_wire_release_tx_buffer(tweak_wire_connection connection,
+  tweak_wire_tx_buffer *tx_buffer)
+{
+  if (connection->release_tx_buffer_proc) {
+    connection->release_tx_buffer_proc(connection, tx_buffer);
+    return;
+  }
+
+  free_tx_buffer_data(tx_buffer);
+}
+
+uint64_t tweak_wire_get_tx_failures(tweak_wire_connection connection) {
+  if (connection->get_tx_failures_proc) {
+    return connection->get_tx_failures_proc(connection);
+  }
+  return 0;
+}
+
 void tweak_wire_destroy_connection(tweak_wire_connection connection) {
   if (connection) {
+    /* Backend may call listeners until it's destroyed */
+    void *peer_adapter = connection->peer_adapter;
     connection->destroy_proc(connection);
+    free(peer_adapter);
   }
 }
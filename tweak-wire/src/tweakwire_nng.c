@@ -30,6 +30,7 @@
 
 #include "tweakwire_nng.h"
 
+#include <assert.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -45,6 +46,32 @@
 
 #define TWEAK_WIRE_FINALIZING 100
 
+/*
+ * Upper bound for "tx_queue" connection parameter.
+ */
+#define TWEAK_WIRE_MAX_TX_QUEUE_SIZE 1024
+
+struct transport;
+
+/*
+ * Single in-flight asynchronous transmit request.
+ */
+struct transmit_slot
+{
+  /*
+   * nng async interface owned by this slot.
+   */
+  nng_aio *aio;
+  /*
+   * Transport this slot belongs to.
+   */
+  struct transport *transport;
+  /*
+   * Index of this slot in transport's slot array.
+   */
+  size_t index;
+};
+
 /*
  * This structure contains all
  * context needed to maintain a single
@@ -56,10 +83,6 @@ struct transport
    * nng socket for both client and server instances.
    */
   nng_socket socket;
-  /*
-   * nng async interface for transmit queue.
-   */
-  nng_aio *transmit_aio;
   /*
    * nng async interface for receive queue.
    */
@@ -68,6 +91,39 @@ struct transport
    * Receive queue shouldn't submit new io requests if this flag is true.
    */
   volatile bool is_finalizing;
+  /*
+   * Number of transmit requests that may be in flight simultaneously.
+   * Zero selects synchronous transmit.
+   */
+  size_t tx_queue_size;
+  /*
+   * Asynchronous transmit requests, tx_queue_size entries.
+   */
+  struct transmit_slot *tx_slots;
+  /*
+   * Stack of indices of idle entries in tx_slots.
+   */
+  size_t *tx_free_slots;
+  /*
+   * Number of valid entries in tx_free_slots.
+   */
+  size_t tx_num_free_slots;
+  /*
+   * Number of asynchronous transmit requests that have failed.
+   */
+  uint64_t tx_failures;
+  /*
+   * Value of tx_failures when they were logged last time.
+   */
+  uint64_t tx_failures_logged;
+  /*
+   * Guards tx_free_slots, tx_num_free_slots, tx_failures and tx_failures_logged.
+   */
+  tweak_common_mutex tx_lock;
+  /*
+   * Signalled when a transmit slot becomes idle.
+   */
+  tweak_common_cond tx_cond;
 };
 
 /*
@@ -103,6 +159,32 @@ struct tweak_wire_connection_nng
    */
     void *receive_listener_cookie;
     /*
+   * Pointer to peer state listener callback.
+   */
+    tweak_wire_peer_state_listener peer_state_listener;
+    /*
+   * Opaque pointer that is being passed to peer state listener.
+   */
+    void *peer_state_listener_cookie;
+    /*
+   * Pointer to receive listener callback aware of senders.
+   * Either this one or receive_listener is set.
+   */
+    tweak_wire_peer_receive_listener peer_receive_listener;
+    /*
+   * Opaque pointer that is being passed to peer receive listener.
+   */
+    void *peer_receive_listener_cookie;
+    /*
+   * True if hub protocol delivers messages to the pipe set on them,
+   * so peers can be reported and addressed individually.
+   */
+    bool addressing;
+    /*
+   * True if "broadcast" parameter forbids addressing peers individually.
+   */
+    bool broadcast;
+    /*
    * Discriminator for the following union.
    */
     bool is_server;
@@ -133,6 +215,29 @@ struct tweak_wire_connection_nng
 tweak_wire_error_code tweak_wire_nng_transmit(tweak_wire_connection connection,
                                               const uint8_t *buffer, size_t size);
 
+/**
+ * @brief lend nng message body as tx buffer.
+ */
+tweak_wire_error_code tweak_wire_nng_acquire_tx_buffer(tweak_wire_connection connection,
+                                                       size_t capacity, tweak_wire_tx_buffer *tx_buffer);
+
+/**
+ * @brief transmit nng message lent by tweak_wire_nng_acquire_tx_buffer.
+ */
+tweak_wire_error_code tweak_wire_nng_commit(tweak_wire_connection connection,
+                                            tweak_wire_tx_buffer *tx_buffer, size_t size);
+
+/**
+ * @brief free nng message lent by tweak_wire_nng_acquire_tx_buffer.
+ */
+void tweak_wire_nng_release_tx_buffer(tweak_wire_connection connection,
+                                      tweak_wire_tx_buffer *tx_buffer);
+
+/**
+ * @brief number of failed asynchronous transmit requests.
+ */
+uint64_t tweak_wire_nng_get_tx_failures(tweak_wire_connection connection);
+
 /**
  * @brief Destroy connection with nng backend.
  */
@@ -148,7 +253,10 @@ static void on_connection_lost(nng_pipe pipe, nng_pipe_ev pipe_event, void* arg)
 static void recv_async_callback(void* arg);
 
 static void
-transmit_async_callback(void* arg);
+transmit_slot_callback(void* arg);
+
+static bool parse_params(const char *params, bool *server_role, size_t *tx_queue_size,
+  bool *broadcast);
 
 static tweak_wire_error_code start_dialer(struct tweak_wire_connection_nng *connection_nng,
   const char *uri);
@@ -156,64 +264,50 @@ static tweak_wire_error_code start_dialer(struct tweak_wire_connection_nng *conn
 static tweak_wire_error_code start_listener(struct tweak_wire_connection_nng *connection_nng,
   const char *uri);
 
-tweak_wire_connection tweak_wire_create_nng_connection(
-    const char *connection_type, const char *params, const char *uri,
-    tweak_wire_connection_state_listener connection_state_listener,
-    void *connection_state_cookie, tweak_wire_receive_listener receive_listener,
-    void *receive_listener_cookie)
+/*
+ * Starts connection which listeners have been set by caller.
+ * Frees it on failure.
+ */
+static tweak_wire_connection start_connection(const char *connection_type,
+  const char *params, const char *uri, struct tweak_wire_connection_nng *connection)
 {
-  TWEAK_LOG_TRACE_ENTRY("connection_type=\"%s\", params=\"%s\", uri=\"%s\","
-    " connection_state_listener=%p, connection_state_cookie=%p,"
-    " receive_listener=%p, receive_listener_cookie=%p",
-    connection_type, params, uri,
-    connection_state_listener, connection_state_cookie,
-    receive_listener, receive_listener_cookie);
-
   if (strcmp("nng", connection_type) != 0) {
     TWEAK_LOG_ERROR("Connection type must be '%s' for this backend but '%s' was provided.", "nng", connection_type);
+    free(connection);
     return TWEAK_WIRE_INVALID_CONNECTION;
   }
 
   bool server_role;
+  size_t tx_queue_size;
+  bool broadcast;
 
   if (params) {
-    if (strcmp("role=server", params) == 0) {
-      TWEAK_LOG_TRACE("nng set to \"listen\" mode");
-      server_role = true;
-    } else if (strcmp("role=client", params) == 0) {
-      TWEAK_LOG_TRACE("nng set to \"connect\" mode");
-      server_role = false;
-    } else {
+    if (!parse_params(params, &server_role, &tx_queue_size, &broadcast)) {
       TWEAK_LOG_ERROR("Can't parse connection params: \"%s\"", params);
+      free(connection);
       return TWEAK_WIRE_INVALID_CONNECTION;
     }
+    TWEAK_LOG_TRACE("nng set to \"%s\" mode, tx_queue = %zu",
+      server_role ? "listen" : "connect", tx_queue_size);
   } else {
     TWEAK_LOG_ERROR("Connection params is NULL");
+    free(connection);
     return TWEAK_WIRE_INVALID_CONNECTION;
   }
 
   if (!uri) {
     TWEAK_LOG_ERROR("uri is NULL");
+    free(connection);
     return TWEAK_WIRE_INVALID_CONNECTION;
   }
 
-  if (!receive_listener) {
-    TWEAK_LOG_ERROR("Mandatory parameter receive_listener is NULL");
-    return TWEAK_WIRE_INVALID_CONNECTION;
-  }
-
-  struct tweak_wire_connection_nng *connection = calloc(1, sizeof(*connection));
-
   int rv = tweak_common_mutex_init(&connection->peers_lock);
   if (rv != TWEAK_COMMON_THREAD_SUCCESS) {
     free(connection);
     return TWEAK_WIRE_INVALID_CONNECTION;
   }
-  connection->state_listener = connection_state_listener;
-  connection->state_listener_cookie = connection_state_cookie;
-
-  connection->receive_listener = receive_listener;
-  connection->receive_listener_cookie = receive_listener_cookie;
+  connection->transport.tx_queue_size = tx_queue_size;
+  connection->broadcast = broadcast;
 
   if (server_role) {
     if (start_listener(connection, uri) != TWEAK_WIRE_SUCCESS) {
@@ -231,12 +325,168 @@ tweak_wire_connection tweak_wire_create_nng_connection(
 
   connection->base.transmit_proc = &tweak_wire_nng_transmit;
   connection->base.destroy_proc = &tweak_wire_destroy_nng_connection;
+  connection->base.acquire_tx_buffer_proc = &tweak_wire_nng_acquire_tx_buffer;
+  connection->base.commit_proc = &tweak_wire_nng_commit;
+  connection->base.release_tx_buffer_proc = &tweak_wire_nng_release_tx_buffer;
+  connection->base.get_tx_failures_proc = &tweak_wire_nng_get_tx_failures;
 
   return &connection->base;
 }
 
+tweak_wire_connection tweak_wire_create_nng_connection(
+    const char *connection_type, const char *params, const char *uri,
+    tweak_wire_connection_state_listener connection_state_listener,
+    void *connection_state_cookie, tweak_wire_receive_listener receive_listener,
+    void *receive_listener_cookie)
+{
+  TWEAK_LOG_TRACE_ENTRY("connection_type=\"%s\", params=\"%s\", uri=\"%s\","
+    " connection_state_listener=%p, connection_state_cookie=%p,"
+    " receive_listener=%p, receive_listener_cookie=%p",
+    connection_type, params, uri,
+    connection_state_listener, connection_state_cookie,
+    receive_listener, receive_listener_cookie);
+
+  if (!receive_listener) {
+    TWEAK_LOG_ERROR("Mandatory parameter receive_listener is NULL");
+    return TWEAK_WIRE_INVALID_CONNECTION;
+  }
+
+  struct tweak_wire_connection_nng *connection = calloc(1, sizeof(*connection));
+  if (!connection) {
+    TWEAK_LOG_ERROR("calloc() returned NULL");
+    return TWEAK_WIRE_INVALID_CONNECTION;
+  }
+
+  connection->state_listener = connection_state_listener;
+  connection->state_listener_cookie = connection_state_cookie;
+
+  connection->receive_listener = receive_listener;
+  connection->receive_listener_cookie = receive_listener_cookie;
+
+  return start_connection(connection_type, params, uri, connection);
+}
+
+tweak_wire_connection tweak_wire_create_nng_peer_connection(
+    const char *connection_type, const char *params, const char *uri,
+    tweak_wire_peer_state_listener peer_state_listener,
+    void *peer_state_cookie, tweak_wire_peer_receive_listener receive_listener,
+    void *receive_listener_cookie)
+{
+  TWEAK_LOG_TRACE_ENTRY("connection_type=\"%s\", params=\"%s\", uri=\"%s\","
+    " peer_state_listener=%p, peer_state_cookie=%p,"
+    " receive_listener=%p, receive_listener_cookie=%p",
+    connection_type, params, uri,
+    peer_state_listener, peer_state_cookie,
+    receive_listener, receive_listener_cookie);
+
+  if (!receive_listener) {
+    TWEAK_LOG_ERROR("Mandatory parameter receive_listener is NULL");
+    return TWEAK_WIRE_INVALID_CONNECTION;
+  }
+
+  struct tweak_wire_connection_nng *connection = calloc(1, sizeof(*connection));
+  if (!connection) {
+    TWEAK_LOG_ERROR("calloc() returned NULL");
+    return TWEAK_WIRE_INVALID_CONNECTION;
+  }
+
+  connection->peer_state_listener = peer_state_listener;
+  connection->peer_state_listener_cookie = peer_state_cookie;
+
+  connection->peer_receive_listener = receive_listener;
+  connection->peer_receive_listener_cookie = receive_listener_cookie;
+
+  return start_connection(connection_type, params, uri, connection);
+}
+
+/*
+ * Parses semicolon separated list of parameters.
+ * "role=server" or "role=client" is mandatory,
+ * optional "tx_queue=N" enables asynchronous transmit
+ * with up to N datagrams in flight, optional "broadcast" makes server
+ * treat all clients as a single peer even if hub can address them.
+ */
+static bool parse_params(const char *params, bool *server_role, size_t *tx_queue_size,
+  bool *broadcast)
+{
+  bool has_role = false;
+  *tx_queue_size = 0;
+  *broadcast = false;
+  const char *token = params;
+  while (*token) {
+    const char *delimiter = strchr(token, ';');
+    size_t token_length = delimiter ? (size_t)(delimiter - token) : strlen(token);
+    if (token_length == strlen("role=server") && strncmp(token, "role=server", token_length) == 0) {
+      *server_role = true;
+      has_role = true;
+    } else if (token_length == strlen("role=client") && strncmp(token, "role=client", token_length) == 0) {
+      *server_role = false;
+      has_role = true;
+    } else if (token_length > strlen("tx_queue=") && strncmp(token, "tx_queue=", strlen("tx_queue=")) == 0) {
+      char *end = NULL;
+      unsigned long value = strtoul(token + strlen("tx_queue="), &end, 10);
+      if (end != token + token_length || value > TWEAK_WIRE_MAX_TX_QUEUE_SIZE) {
+        TWEAK_LOG_ERROR("tx_queue must be a number in range [0, %d]", TWEAK_WIRE_MAX_TX_QUEUE_SIZE);
+        return false;
+      }
+      *tx_queue_size = value;
+    } else if (token_length == strlen("broadcast") && strncmp(token, "broadcast", token_length) == 0) {
+      *broadcast = true;
+    } else if (token_length > 0) {
+      TWEAK_LOG_ERROR("Unknown connection parameter: \"%.*s\"", (int)token_length, token);
+      return false;
+    }
+    token += token_length;
+    if (*token == ';') {
+      ++token;
+    }
+  }
+  return has_role;
+}
+
 static void finalize_transport(struct transport *transport);
 
+static tweak_wire_error_code initialize_transmit_slots(struct transport* transport) {
+  TWEAK_LOG_TRACE_ENTRY("transport = %p", transport);
+  if (tweak_common_mutex_init(&transport->tx_lock) != TWEAK_COMMON_THREAD_SUCCESS) {
+    TWEAK_LOG_ERROR("tweak_common_mutex_init failed");
+    return TWEAK_WIRE_ERROR;
+  }
+
+  if (tweak_common_cond_init(&transport->tx_cond) != TWEAK_COMMON_THREAD_SUCCESS) {
+    TWEAK_LOG_ERROR("tweak_common_cond_init failed");
+    tweak_common_mutex_destroy(&transport->tx_lock);
+    return TWEAK_WIRE_ERROR;
+  }
+
+  transport->tx_slots = calloc(transport->tx_queue_size, sizeof(*transport->tx_slots));
+  transport->tx_free_slots = calloc(transport->tx_queue_size, sizeof(*transport->tx_free_slots));
+  if (!transport->tx_slots || !transport->tx_free_slots) {
+    TWEAK_LOG_ERROR("calloc() returned NULL");
+    free(transport->tx_slots);
+    transport->tx_slots = NULL;
+    free(transport->tx_free_slots);
+    transport->tx_free_slots = NULL;
+    tweak_common_cond_destroy(&transport->tx_cond);
+    tweak_common_mutex_destroy(&transport->tx_lock);
+    return TWEAK_WIRE_ERROR;
+  }
+
+  for (size_t ix = 0; ix < transport->tx_queue_size; ++ix) {
+    struct transmit_slot *slot = &transport->tx_slots[ix];
+    slot->transport = transport;
+    slot->index = ix;
+    int rv = nng_aio_alloc(&slot->aio, &transmit_slot_callback, slot);
+    if (rv != 0) {
+      TWEAK_LOG_ERROR("nng_aio_alloc returned %d", rv);
+      return TWEAK_WIRE_ERROR;
+    }
+    nng_aio_set_timeout(slot->aio, TWEAK_WIRE_TIMEOUT);
+    transport->tx_free_slots[transport->tx_num_free_slots++] = ix;
+  }
+  return TWEAK_WIRE_SUCCESS;
+}
+
 static tweak_wire_error_code initialize_transport(struct transport* transport,
   const char *uri, void* aio_cookie)
 {
@@ -258,14 +508,22 @@ static tweak_wire_error_code initialize_transport(struct transport* transport,
     return TWEAK_WIRE_ERROR;
   }
 
-  rv = nng_aio_alloc(&transport->transmit_aio, &transmit_async_callback, aio_cookie);
+  /* Synchronous transmit may be called from several threads at once,
+   * so it uses blocking nng_sendmsg rather than a shared aio */
+  rv = nng_socket_set_ms(transport->socket, NNG_OPT_SENDTIMEO, TWEAK_WIRE_TIMEOUT);
   if (rv != 0) {
-    TWEAK_LOG_ERROR("nng_aio_alloc returned %d", rv);
+    TWEAK_LOG_ERROR("nng_socket_set_ms returned %d", rv);
     finalize_transport(transport);
     return TWEAK_WIRE_ERROR;
   }
 
-  nng_aio_set_timeout(transport->transmit_aio, TWEAK_WIRE_TIMEOUT);
+  if (transport->tx_queue_size > 0) {
+    if (initialize_transmit_slots(transport) != TWEAK_WIRE_SUCCESS) {
+      finalize_transport(transport);
+      return TWEAK_WIRE_ERROR;
+    }
+  }
+
   rv = nng_pipe_notify(transport->socket, NNG_PIPE_EV_ADD_POST,
     &on_new_connection, aio_cookie);
   if (rv != 0) {
@@ -323,6 +581,23 @@ static tweak_wire_error_code
   return TWEAK_WIRE_SUCCESS;
 }
 
+/*
+ * Checks whether hub protocol delivers messages to the pipe set on them.
+ * Older protocol versions ignore it and broadcast every message.
+ */
+static bool detect_addressing(nng_socket socket) {
+#if defined(NNG_OPT_HUB_ADDRESSING)
+  bool addressing = false;
+  if (nng_socket_get_bool(socket, NNG_OPT_HUB_ADDRESSING, &addressing) != 0) {
+    return false;
+  }
+  return addressing;
+#else
+  (void)socket;
+  return false;
+#endif
+}
+
 static tweak_wire_error_code
   start_listener(struct tweak_wire_connection_nng *connection_nng,
                 const char *uri)
@@ -338,6 +613,12 @@ static tweak_wire_error_code
   if (rv != TWEAK_WIRE_SUCCESS) {
     return rv;
   }
+
+  connection_nng->addressing = !connection_nng->broadcast
+    && detect_addressing(connection_nng->transport.socket);
+  TWEAK_LOG_DEBUG("nng hub %s address individual peers",
+    connection_nng->addressing ? "can" : "can't");
+
   rv = nng_listen(connection_nng->transport.socket, uri,
                   &connection_nng->connection_watchdog.listener, 0);
   if (rv != 0) {
@@ -350,6 +631,26 @@ static tweak_wire_error_code
   return TWEAK_WIRE_SUCCESS;
 }
 
+/*
+ * Without addressing all pipes are reported as a single peer, which
+ * attaches along with the first pipe and detaches along with the last one.
+ */
+static void notify_peer_state(struct tweak_wire_connection_nng *connection_nng,
+  nng_pipe pipe, bool first_or_last, tweak_wire_connection_state connection_state)
+{
+  tweak_wire_peer_state_listener listener = connection_nng->peer_state_listener;
+  if (listener == NULL) {
+    return;
+  }
+  if (connection_nng->addressing) {
+    listener(&connection_nng->base, pipe.id, connection_state,
+      connection_nng->peer_state_listener_cookie);
+  } else if (first_or_last) {
+    listener(&connection_nng->base, TWEAK_WIRE_ALL_PEERS, connection_state,
+      connection_nng->peer_state_listener_cookie);
+  }
+}
+
 static void on_new_connection(nng_pipe pipe, nng_pipe_ev ev, void* arg) {
   (void)pipe;
   (void)ev;
@@ -369,6 +670,8 @@ static void on_new_connection(nng_pipe pipe, nng_pipe_ev ev, void* arg) {
   if (listener != NULL && !peers) {
     listener(&connection_nng->base, TWEAK_WIRE_CONNECTED, cookie);
   }
+
+  notify_peer_state(connection_nng, pipe, peers == 0, TWEAK_WIRE_CONNECTED);
 }
 
 static void on_connection_lost(nng_pipe pipe, nng_pipe_ev ev, void* arg) {
@@ -398,11 +701,70 @@ static void on_connection_lost(nng_pipe pipe, nng_pipe_ev ev, void* arg) {
   } else {
     TWEAK_LOG_TRACE("User hasn't provided connection state listener");
   }
+
+  notify_peer_state(connection_nng, pipe, peers == 0, TWEAK_WIRE_DISCONNECTED);
 }
 
-static void transmit_async_callback(void* arg) {
-  (void)arg;
+/*
+ * Completion of asynchronous transmit request.
+ * Releases the message if it hasn't been consumed by nng
+ * and returns the slot to the pool.
+ */
+static void transmit_slot_callback(void* arg) {
   TWEAK_LOG_TRACE_ENTRY("arg = %p", arg);
+  struct transmit_slot *slot = arg;
+  struct transport *transport = slot->transport;
+  int32_t aio_result = nng_aio_result(slot->aio);
+  if (aio_result != 0) {
+    TWEAK_LOG_TRACE("nng_aio_result returned %d", aio_result);
+    nng_msg *message = nng_aio_get_msg(slot->aio);
+    if (message) {
+      nng_msg_free(message);
+    }
+    nng_aio_set_msg(slot->aio, NULL);
+  }
+
+  tweak_common_mutex_lock(&transport->tx_lock);
+  if (aio_result != 0 && aio_result != TWEAK_WIRE_FINALIZING) {
+    ++transport->tx_failures;
+  }
+  transport->tx_free_slots[transport->tx_num_free_slots++] = slot->index;
+  tweak_common_cond_signal(&transport->tx_cond);
+  tweak_common_mutex_unlock(&transport->tx_lock);
+}
+
+static bool has_free_transmit_slot(void* cookie) {
+  struct transport *transport = cookie;
+  return transport->tx_num_free_slots > 0 || transport->is_finalizing;
+}
+
+/*
+ * Submits message to the first idle slot without waiting for completion.
+ * If every slot is busy, waits for TWEAK_WIRE_TIMEOUT at most,
+ * so a caller producing datagrams faster than nng sends them
+ * is slowed down to the transmit rate or gets TWEAK_WIRE_ERROR_TIMEOUT.
+ */
+static tweak_wire_error_code transmit_async(struct transport *transport, nng_msg *outbound_message) {
+  tweak_common_mutex_lock(&transport->tx_lock);
+  tweak_common_cond_timed_wait_with_pred(&transport->tx_cond, &transport->tx_lock,
+    TWEAK_WIRE_TIMEOUT, &has_free_transmit_slot, transport);
+  if (transport->is_finalizing || transport->tx_num_free_slots == 0) {
+    tweak_common_mutex_unlock(&transport->tx_lock);
+    nng_msg_free(outbound_message);
+    TWEAK_LOG_TRACE("Transmit queue is full, %zu requests in flight", transport->tx_queue_size);
+    return transport->is_finalizing ? TWEAK_WIRE_ERROR : TWEAK_WIRE_ERROR_TIMEOUT;
+  }
+  struct transmit_slot *slot = &transport->tx_slots[transport->tx_free_slots[--transport->tx_num_free_slots]];
+  if (transport->tx_failures > transport->tx_failures_logged) {
+    TWEAK_LOG_WARN("%" PRIu64 " asynchronous transmit requests have failed",
+      transport->tx_failures - transport->tx_failures_logged);
+    transport->tx_failures_logged = transport->tx_failures;
+  }
+  tweak_common_mutex_unlock(&transport->tx_lock);
+
+  nng_aio_set_msg(slot->aio, outbound_message);
+  nng_send_aio(transport->socket, slot->aio);
+  return TWEAK_WIRE_SUCCESS;
 }
 
 static void recv_async_callback(void* arg) {
@@ -426,10 +788,20 @@ static void recv_async_callback(void* arg) {
     if (check_packet_header(buffer_with_header, size_with_header)) {
       uint8_t *payload = buffer_with_header + TWEAK_WIRE_DATAGRAM_HEADER_SIZE;
       size_t payload_size = size_with_header - TWEAK_WIRE_DATAGRAM_HEADER_SIZE;
-      TWEAK_LOG_TRACE("Invoking user receive listener %p, cookie = %p",
-        connection_nng->receive_listener, connection_nng->receive_listener_cookie);
-      connection_nng->receive_listener(payload, payload_size,
-        connection_nng->receive_listener_cookie);
+      if (connection_nng->peer_receive_listener) {
+        tweak_wire_peer peer = connection_nng->addressing
+          ? nng_msg_get_pipe(inbound_message).id
+          : TWEAK_WIRE_ALL_PEERS;
+        TWEAK_LOG_TRACE("Invoking user receive listener %p, peer = 0x%X, cookie = %p",
+          connection_nng->peer_receive_listener, peer, connection_nng->peer_receive_listener_cookie);
+        connection_nng->peer_receive_listener(peer, payload, payload_size,
+          connection_nng->peer_receive_listener_cookie);
+      } else {
+        TWEAK_LOG_TRACE("Invoking user receive listener %p, cookie = %p",
+          connection_nng->receive_listener, connection_nng->receive_listener_cookie);
+        connection_nng->receive_listener(payload, payload_size,
+          connection_nng->receive_listener_cookie);
+      }
     } else {
       TWEAK_LOG_WARN("Invalid datagram header");
     }
@@ -442,53 +814,123 @@ static void recv_async_callback(void* arg) {
   }
 }
 
-tweak_wire_error_code tweak_wire_nng_transmit(tweak_wire_connection connection,
-  const uint8_t *buffer, size_t size)
+tweak_wire_error_code tweak_wire_nng_acquire_tx_buffer(tweak_wire_connection connection,
+  size_t capacity, tweak_wire_tx_buffer *tx_buffer)
 {
-  TWEAK_LOG_TRACE_ENTRY("connection = %p, buffer = %p, size = %" PRId64 "",
-    connection, buffer, size);
+  TWEAK_LOG_TRACE_ENTRY("connection = %p, capacity = %" PRId64 "", connection, capacity);
+  (void)connection;
+  nng_msg *outbound_message;
+  int rv = nng_msg_alloc(&outbound_message, capacity + TWEAK_WIRE_DATAGRAM_HEADER_SIZE);
+  if (rv != 0) {
+    TWEAK_LOG_ERROR("nng_msg_alloc returned %d", rv);
+    return TWEAK_WIRE_ERROR;
+  }
+
+  uint8_t *buffer_with_header = nng_msg_body(outbound_message);
+  buffer_with_header[0] = 'T';
+  buffer_with_header[1] = 'W';
+  tx_buffer->data = buffer_with_header + TWEAK_WIRE_DATAGRAM_HEADER_SIZE;
+  tx_buffer->capacity = capacity;
+  tx_buffer->opaque = outbound_message;
+  tx_buffer->peer = TWEAK_WIRE_ALL_PEERS;
+  return TWEAK_WIRE_SUCCESS;
+}
+
+void tweak_wire_nng_release_tx_buffer(tweak_wire_connection connection,
+  tweak_wire_tx_buffer *tx_buffer)
+{
+  (void)connection;
+  if (tx_buffer->opaque) {
+    nng_msg_free((nng_msg *)tx_buffer->opaque);
+  }
+  tx_buffer->data = NULL;
+  tx_buffer->opaque = NULL;
+}
+
+uint64_t tweak_wire_nng_get_tx_failures(tweak_wire_connection connection) {
+  struct tweak_wire_connection_nng *connection_nng =
+      (struct tweak_wire_connection_nng *)connection;
+  struct transport *transport = &connection_nng->transport;
+  if (transport->tx_queue_size == 0) {
+    return 0;
+  }
+  tweak_common_mutex_lock(&transport->tx_lock);
+  uint64_t tx_failures = transport->tx_failures;
+  tweak_common_mutex_unlock(&transport->tx_lock);
+  return tx_failures;
+}
+
+tweak_wire_error_code tweak_wire_nng_commit(tweak_wire_connection connection,
+  tweak_wire_tx_buffer *tx_buffer, size_t size)
+{
+  TWEAK_LOG_TRACE_ENTRY("connection = %p, tx_buffer = %p, size = %" PRId64 "",
+    connection, tx_buffer, size);
   struct tweak_wire_connection_nng *connection_nng =
       (struct tweak_wire_connection_nng *)connection;
 
+  assert(size <= tx_buffer->capacity);
+  nng_msg *outbound_message = tx_buffer->opaque;
+  tx_buffer->data = NULL;
+  tx_buffer->opaque = NULL;
+
   if (connection_nng->transport.is_finalizing) {
     TWEAK_LOG_TRACE("connection is finalizing, aborting transmit request");
+    nng_msg_free(outbound_message);
     return TWEAK_WIRE_ERROR;
   }
 
-  size_t size_with_header = size + TWEAK_WIRE_DATAGRAM_HEADER_SIZE;
-  nng_msg *outbound_message;
-  int rv;
-  rv = nng_msg_alloc(&outbound_message, size_with_header);
-  if (rv != 0) {
-    TWEAK_LOG_ERROR("nng_msg_alloc returned %d", rv);
-    return TWEAK_WIRE_ERROR;
+  if (size < tx_buffer->capacity) {
+    nng_msg_chop(outbound_message, tx_buffer->capacity - size);
   }
 
-  uint8_t *buffer_with_header = nng_msg_body(outbound_message);
-  buffer_with_header[0] = 'T';
-  buffer_with_header[1] = 'W';
-  memcpy(buffer_with_header + TWEAK_WIRE_DATAGRAM_HEADER_SIZE, buffer, size);
-  TWEAK_LOG_TRACE_HEXDUMP("nng transmit", buffer_with_header, size_with_header);
-  int32_t aio_result;
-  nng_aio_set_msg(connection_nng->transport.transmit_aio,
-                  outbound_message);
-  nng_send_aio(connection_nng->transport.socket,
-               connection_nng->transport.transmit_aio);
-  TWEAK_LOG_TRACE("Before nng_aio_wait");
-  nng_aio_wait(connection_nng->transport.transmit_aio);
-  TWEAK_LOG_TRACE("After nng_aio_wait");
-  aio_result = nng_aio_result(connection_nng->transport.transmit_aio);
-  if (aio_result == 0) {
+  if (connection_nng->addressing && tx_buffer->peer != TWEAK_WIRE_ALL_PEERS) {
+    nng_pipe pipe = NNG_PIPE_INITIALIZER;
+    pipe.id = tx_buffer->peer;
+    nng_msg_set_pipe(outbound_message, pipe);
+  }
+
+  TWEAK_LOG_TRACE_HEXDUMP("nng transmit", nng_msg_body(outbound_message), nng_msg_len(outbound_message));
+  if (connection_nng->transport.tx_queue_size > 0) {
+    return transmit_async(&connection_nng->transport, outbound_message);
+  }
+
+  TWEAK_LOG_TRACE("Before nng_sendmsg");
+  int rv = nng_sendmsg(connection_nng->transport.socket, outbound_message, 0);
+  TWEAK_LOG_TRACE("After nng_sendmsg");
+  if (rv == 0) {
     return TWEAK_WIRE_SUCCESS;
   } else {
-    TWEAK_LOG_TRACE("nng_aio_result returned %d", aio_result);
+    TWEAK_LOG_TRACE("nng_sendmsg returned %d", rv);
     nng_msg_free(outbound_message);
-    return aio_result == NNG_ETIMEDOUT
+    return rv == NNG_ETIMEDOUT
       ? TWEAK_WIRE_ERROR_TIMEOUT
       : TWEAK_WIRE_ERROR;
   }
 }
 
+tweak_wire_error_code tweak_wire_nng_transmit(tweak_wire_connection connection,
+  const uint8_t *buffer, size_t size)
+{
+  TWEAK_LOG_TRACE_ENTRY("connection = %p, buffer = %p, size = %" PRId64 "",
+    connection, buffer, size);
+  struct tweak_wire_connection_nng *connection_nng =
+      (struct tweak_wire_connection_nng *)connection;
+
+  if (connection_nng->transport.is_finalizing) {
+    TWEAK_LOG_TRACE("connection is finalizing, aborting transmit request");
+    return TWEAK_WIRE_ERROR;
+  }
+
+  tweak_wire_tx_buffer tx_buffer;
+  tweak_wire_error_code error_code = tweak_wire_nng_acquire_tx_buffer(connection, size, &tx_buffer);
+  if (error_code != TWEAK_WIRE_SUCCESS) {
+    return error_code;
+  }
+
+  memcpy(tx_buffer.data, buffer, size);
+  return tweak_wire_nng_commit(connection, &tx_buffer, size);
+}
+
 static bool check_packet_header(uint8_t *buffer_with_header,
                                 size_t size_with_header) {
   if (size_with_header < TWEAK_WIRE_DATAGRAM_HEADER_SIZE)
@@ -520,16 +962,29 @@ static void finalize_transport(struct transport* transport) {
     nng_aio_free(transport->receive_aio);
     transport->receive_aio = NULL;
   }
-  if (transport->transmit_aio) {
-    /* If transmit operation is in progress, nng_aio_free
-     * could block until datagram is sent or configured
-     * timeout is reached.
-     * This nng_aio_abort call ensure that it doesn't happen.
+  if (transport->tx_slots) {
+    /* Wakes up callers waiting for an idle slot and
+     * cancels requests in flight. nng_aio_free waits
+     * for transmit_slot_callback to complete.
      */
-    TWEAK_LOG_TRACE("Aborting pending IO operations on transmit_aio");
-    nng_aio_abort(transport->transmit_aio, TWEAK_WIRE_FINALIZING);
-    nng_aio_free(transport->transmit_aio);
-    transport->transmit_aio = NULL;
+    TWEAK_LOG_TRACE("Aborting pending IO operations on transmit slots");
+    tweak_common_mutex_lock(&transport->tx_lock);
+    transport->is_finalizing = true;
+    tweak_common_cond_broadcast(&transport->tx_cond);
+    tweak_common_mutex_unlock(&transport->tx_lock);
+    for (size_t ix = 0; ix < transport->tx_queue_size; ++ix) {
+      if (transport->tx_slots[ix].aio) {
+        nng_aio_abort(transport->tx_slots[ix].aio, TWEAK_WIRE_FINALIZING);
+        nng_aio_free(transport->tx_slots[ix].aio);
+        transport->tx_slots[ix].aio = NULL;
+      }
+    }
+    free(transport->tx_slots);
+    transport->tx_slots = NULL;
+    free(transport->tx_free_slots);
+    transport->tx_free_slots = NULL;
+    tweak_common_cond_destroy(&transport->tx_cond);
+    tweak_common_mutex_destroy(&transport->tx_lock);
   }
   TWEAK_LOG_TRACE("Closing nng socket");
   nng_close(transport->socket);
@@ -43,6 +43,15 @@ tweak_wire_connection tweak_wire_create_nng_connection(
     void *connection_state_cookie, tweak_wire_receive_listener receive_listener,
     void *receive_listener_cookie);
 
+/**
+ * @brief Create connection using nng as a backend, reporting peers separately.
+ */
+tweak_wire_connection tweak_wire_create_nng_peer_connection(
+    const char *connection_type, const char *params, const char *uri,
+    tweak_wire_peer_state_listener peer_state_listener,
+    void *peer_state_cookie, tweak_wire_peer_receive_listener receive_listener,
+    void *receive_listener_cookie);
+
 #ifdef __cplusplus
 }
 #endif
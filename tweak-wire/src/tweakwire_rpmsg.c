@@ -273,6 +273,11 @@ tweak_wire_connection tweak_wire_create_rpmsg_connection(
 
     connection->base.transmit_proc = &tweak_wire_rpmsg_transmit;
     connection->base.destroy_proc = &tweak_wire_rpmsg_destroy_connection;
+    connection->base.acquire_tx_buffer_proc = NULL;
+    connection->base.commit_proc = NULL;
+    connection->base.release_tx_buffer_proc = NULL;
+    connection->base.get_tx_failures_proc = NULL;
+    connection->base.peer_adapter = NULL;
     connection->connection_state = TWEAK_WIRE_DISCONNECTED;
     return &connection->base;
 }
@@ -0,0 +1,989 @@
+/**
+ * @file tweakwire_shm.c
+ * @ingroup tweak-internal
+ *
+ * @brief Tweak wire transport layer implementation, shared memory backend.
+ *
+ * @copyright 2020-2022 Cogent Embedded, Inc. ALL RIGHTS RESERVED.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/*
+ * Layout of the shared memory object:
+ *
+ *   struct shm_header | server to client ring | client to server ring
+ *
+ * Each ring is a single producer single consumer byte queue carrying
+ * datagrams prefixed with their 32 bit length. Positions are free running
+ * 32 bit counters, ring size is a power of two so wrap around is implicit.
+ * Blocked side sleeps on a futex word in the shared memory, the other side
+ * issues wake syscall only if somebody is actually waiting.
+ *
+ * Liveness is tracked through a heartbeat counter each side advances
+ * every TWEAK_WIRE_SHM_POLL_INTERVAL. It's done by a thread of its own,
+ * so a receive listener running for long doesn't make the side look lost.
+ *
+ * Only one client is attached at a time. Client claims its slot with
+ * compare and swap on the session word and takes it over from another
+ * client only if heartbeat of the latter has stopped.
+ */
+
+#if !defined(_GNU_SOURCE)
+#define _GNU_SOURCE
+#endif
+
+#include <tweak2/atomic.h>
+#include <tweak2/log.h>
+#include <tweak2/thread.h>
+#include <tweak2/wire.h>
+
+#include "tweakwire_shm.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <inttypes.h>
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <linux/futex.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+
+#define TWEAK_WIRE_TIMEOUT 500
+
+/*
+ * Period of heartbeat and of peer liveness checks by receive thread.
+ */
+#define TWEAK_WIRE_SHM_POLL_INTERVAL 100
+
+/*
+ * Peer is considered lost if its heartbeat hasn't changed for this long.
+ */
+#define TWEAK_WIRE_SHM_PEER_TIMEOUT 3000
+
+#define TWEAK_WIRE_SHM_MAGIC 0x48535754u /* "TWSH" */
+
+/*
+ * Session word value of a slot being claimed by a client
+ * which hasn't published its session yet.
+ */
+#define TWEAK_WIRE_SHM_SESSION_CLAIMED UINT32_MAX
+
+#define TWEAK_WIRE_SHM_VERSION 1
+
+#define TWEAK_WIRE_SHM_DEFAULT_RING_SIZE (1u << 20)
+
+#define TWEAK_WIRE_SHM_MIN_RING_SIZE (1u << 12)
+
+#define TWEAK_WIRE_SHM_MAX_RING_SIZE (1u << 30)
+
+#define TWEAK_WIRE_SHM_CACHE_LINE_SIZE 64
+
+#define TWEAK_WIRE_SHM_LENGTH_PREFIX_SIZE ((uint32_t)sizeof(uint32_t))
+
+/*
+ * Index of a side in shm_header peers and rings arrays.
+ * Ring with given index is produced by the side with the same index.
+ */
+enum { SERVER_SIDE = 0, CLIENT_SIDE = 1 };
+
+/*
+ * Liveness data of one side of the connection.
+ */
+struct shm_peer
+{
+  /*
+   * Nonzero while the side is attached, unique per attachment.
+   */
+  volatile uint32_t session;
+  /*
+   * Advanced periodically by the receive thread of the side.
+   */
+  volatile uint32_t heartbeat;
+
+  uint8_t padding[TWEAK_WIRE_SHM_CACHE_LINE_SIZE - 2 * sizeof(uint32_t)];
+};
+
+/*
+ * Positions and futex words of a single ring.
+ */
+struct shm_ring_control
+{
+  /*
+   * Write position, advanced by producer after datagram is complete.
+   */
+  volatile uint32_t head;
+  /*
+   * Futex word bumped by producer after every datagram.
+   */
+  volatile uint32_t data_seq;
+  /*
+   * Nonzero while consumer sleeps on data_seq.
+   */
+  volatile uint32_t data_waiters;
+
+  uint8_t producer_padding[TWEAK_WIRE_SHM_CACHE_LINE_SIZE - 3 * sizeof(uint32_t)];
+  /*
+   * Read position, advanced by consumer after datagram is delivered.
+   */
+  volatile uint32_t tail;
+  /*
+   * Futex word bumped by consumer after every datagram.
+   */
+  volatile uint32_t space_seq;
+  /*
+   * Nonzero while producer sleeps on space_seq.
+   */
+  volatile uint32_t space_waiters;
+
+  uint8_t consumer_padding[TWEAK_WIRE_SHM_CACHE_LINE_SIZE - 3 * sizeof(uint32_t)];
+};
+
+struct shm_header
+{
+  /*
+   * Stored last by server when the object is ready to be used.
+   */
+  volatile uint32_t magic;
+
+  uint32_t version;
+  /*
+   * Size of each ring in bytes, power of two.
+   */
+  uint32_t ring_size;
+  /*
+   * Source of session identifiers.
+   */
+  volatile uint32_t generation;
+
+  uint8_t padding[TWEAK_WIRE_SHM_CACHE_LINE_SIZE - 4 * sizeof(uint32_t)];
+
+  struct shm_peer peers[2];
+
+  struct shm_ring_control rings[2];
+};
+
+/*
+ * Subclass of tweak_wire_connection_base class.
+ * This particular class uses shared memory rings
+ * between two processes on the same host as backend.
+ */
+struct tweak_wire_connection_shm
+{
+  /*
+   * Instance of base class.
+   */
+  struct tweak_wire_connection_base base;
+  /*
+   * Pointer to connection state listener callback.
+   */
+  tweak_wire_connection_state_listener state_listener;
+  /*
+   * Opaque pointer that is being passed to state listener.
+   */
+  void *state_listener_cookie;
+  /*
+   * Pointer to receive listener callback.
+   */
+  tweak_wire_receive_listener receive_listener;
+  /*
+   * Opaque pointer that is being passed to receive listener.
+   */
+  void *receive_listener_cookie;
+  /*
+   * Server creates shared memory object, client attaches to it.
+   */
+  bool is_server;
+  /*
+   * Name of POSIX shared memory object.
+   */
+  char shm_name[NAME_MAX];
+  /*
+   * Ring size requested by server.
+   */
+  uint32_t ring_size;
+  /*
+   * Mapped shared memory object, NULL if client isn't attached.
+   * Only receive thread maps and unmaps it after creation.
+   */
+  struct shm_header *header;
+  /*
+   * Size of the mapping.
+   */
+  size_t mapping_size;
+  /*
+   * Guards header against unmapping and serializes producers.
+   */
+  tweak_common_mutex tx_lock;
+  /*
+   * Nonzero while remote peer is considered alive.
+   */
+  volatile uint32_t connected;
+  /*
+   * Receive thread shall exit if this flag is nonzero.
+   */
+  volatile uint32_t is_finalizing;
+  /*
+   * Receiving processing thread.
+   */
+  tweak_common_thread receive_thread;
+  /*
+   * Thread advancing heartbeat of the local side.
+   */
+  tweak_common_thread heartbeat_thread;
+  /*
+   * Session of the local side published in the object.
+   */
+  uint32_t local_session;
+  /*
+   * Session of another client holding client slot, last observed by attach.
+   */
+  uint32_t busy_session;
+  /*
+   * Heartbeat of another client holding client slot, last observed by attach.
+   */
+  uint32_t busy_heartbeat;
+  /*
+   * When busy_session or busy_heartbeat has been changed last time.
+   */
+  tweak_common_timestamp busy_timestamp;
+  /*
+   * Assembly buffer for datagrams wrapped around the ring end.
+   */
+  uint8_t *rx_buffer;
+  /*
+   * Capacity of rx_buffer.
+   */
+  size_t rx_buffer_capacity;
+  /*
+   * Last observed session of remote peer.
+   */
+  uint32_t peer_session;
+  /*
+   * Last observed heartbeat of remote peer.
+   */
+  uint32_t peer_heartbeat;
+  /*
+   * When peer_heartbeat has been changed last time.
+   */
+  tweak_common_timestamp peer_heartbeat_timestamp;
+  /*
+   * Peer_session has timed out and shall not be reported as connected.
+   */
+  bool peer_lost;
+};
+
+static tweak_wire_error_code tweak_wire_shm_transmit(tweak_wire_connection connection_base,
+                                                     const uint8_t *buffer, size_t size);
+
+static void tweak_wire_shm_destroy_connection(tweak_wire_connection connection_base);
+
+static void *tweak_wire_shm_receive_thread(void *arg);
+
+static void *tweak_wire_shm_heartbeat_thread(void *arg);
+
+static bool parse_params(const char *params, bool *server_role, uint32_t *ring_size);
+
+static bool parse_uri(const char *uri, char *shm_name, size_t shm_name_size);
+
+static tweak_wire_error_code create_shm_object(struct tweak_wire_connection_shm *connection);
+
+static bool attach_shm_object(struct tweak_wire_connection_shm *connection);
+
+static void detach_shm_object(struct tweak_wire_connection_shm *connection);
+
+tweak_wire_connection tweak_wire_create_shm_connection(
+    const char *connection_type, const char *params, const char *uri,
+    tweak_wire_connection_state_listener connection_state_listener,
+    void *connection_state_cookie, tweak_wire_receive_listener receive_listener,
+    void *receive_listener_cookie)
+{
+  TWEAK_LOG_TRACE_ENTRY("connection_type=\"%s\", params=\"%s\", uri=\"%s\","
+    " connection_state_listener=%p, connection_state_cookie=%p,"
+    " receive_listener=%p, receive_listener_cookie=%p",
+    connection_type, params, uri,
+    connection_state_listener, connection_state_cookie,
+    receive_listener, receive_listener_cookie);
+
+  if (strcmp("shm", connection_type) != 0) {
+    TWEAK_LOG_ERROR("Connection type must be '%s' for this backend but '%s' was provided.", "shm", connection_type);
+    return TWEAK_WIRE_INVALID_CONNECTION;
+  }
+
+  bool server_role = false;
+  uint32_t ring_size = 0;
+
+  if (params) {
+    if (!parse_params(params, &server_role, &ring_size)) {
+      TWEAK_LOG_ERROR("Can't parse connection params: \"%s\"", params);
+      return TWEAK_WIRE_INVALID_CONNECTION;
+    }
+  } else {
+    TWEAK_LOG_ERROR("Connection params is NULL");
+    return TWEAK_WIRE_INVALID_CONNECTION;
+  }
+
+  if (!uri) {
+    TWEAK_LOG_ERROR("uri is NULL");
+    return TWEAK_WIRE_INVALID_CONNECTION;
+  }
+
+  if (!receive_listener) {
+    TWEAK_LOG_ERROR("Mandatory parameter receive_listener is NULL");
+    return TWEAK_WIRE_INVALID_CONNECTION;
+  }
+
+  struct tweak_wire_connection_shm *connection = calloc(1, sizeof(*connection));
+  if (!connection) {
+    TWEAK_LOG_ERROR("Not enough memory to allocate struct tweak_wire_connection_shm");
+    return TWEAK_WIRE_INVALID_CONNECTION;
+  }
+
+  if (!parse_uri(uri, connection->shm_name, sizeof(connection->shm_name))) {
+    TWEAK_LOG_ERROR("Cannot parse uri parameter: '%s'", uri);
+    free(connection);
+    return TWEAK_WIRE_INVALID_CONNECTION;
+  }
+
+  TWEAK_LOG_TRACE("shm set to \"%s\" mode, object = \"%s\", ring_size = %" PRIu32,
+    server_role ? "server" : "client", connection->shm_name, ring_size);
+
+  if (tweak_common_mutex_init(&connection->tx_lock) != TWEAK_COMMON_THREAD_SUCCESS) {
+    free(connection);
+    return TWEAK_WIRE_INVALID_CONNECTION;
+  }
+
+  connection->state_listener = connection_state_listener;
+  connection->state_listener_cookie = connection_state_cookie;
+  connection->receive_listener = receive_listener;
+  connection->receive_listener_cookie = receive_listener_cookie;
+  connection->is_server = server_role;
+  connection->ring_size = ring_size;
+
+  if (server_role) {
+    if (create_shm_object(connection) != TWEAK_WIRE_SUCCESS) {
+      tweak_common_mutex_destroy(&connection->tx_lock);
+      free(connection);
+      return TWEAK_WIRE_INVALID_CONNECTION;
+    }
+  }
+
+  connection->base.transmit_proc = &tweak_wire_shm_transmit;
+  connection->base.destroy_proc = &tweak_wire_shm_destroy_connection;
+  connection->base.acquire_tx_buffer_proc = NULL;
+  connection->base.commit_proc = NULL;
+  connection->base.release_tx_buffer_proc = NULL;
+  connection->base.get_tx_failures_proc = NULL;
+  connection->base.peer_adapter = NULL;
+
+  tweak_common_thread_error status = tweak_common_thread_create(&connection->heartbeat_thread,
+                                                                tweak_wire_shm_heartbeat_thread,
+                                                                connection);
+  if (status != TWEAK_COMMON_THREAD_SUCCESS) {
+    TWEAK_LOG_ERROR("tweak_common_thread_create failed: %d", status);
+    detach_shm_object(connection);
+    tweak_common_mutex_destroy(&connection->tx_lock);
+    free(connection);
+    return TWEAK_WIRE_INVALID_CONNECTION;
+  }
+
+  status = tweak_common_thread_create(&connection->receive_thread,
+                                      tweak_wire_shm_receive_thread,
+                                      connection);
+  if (status != TWEAK_COMMON_THREAD_SUCCESS) {
+    TWEAK_LOG_ERROR("tweak_common_thread_create failed: %d", status);
+    tweak_common_atomic_store_u32(&connection->is_finalizing, 1);
+    tweak_common_thread_join(connection->heartbeat_thread, NULL);
+    detach_shm_object(connection);
+    tweak_common_mutex_destroy(&connection->tx_lock);
+    free(connection);
+    return TWEAK_WIRE_INVALID_CONNECTION;
+  }
+
+  return &connection->base;
+}
+
+/*
+ * Parses semicolon separated list of parameters.
+ * "role=server" or "role=client" is mandatory,
+ * optional "ring_size=N" sets size of each ring in bytes.
+ * Only server uses it, client takes ring size from shared memory object.
+ */
+static bool parse_params(const char *params, bool *server_role, uint32_t *ring_size) {
+  bool has_role = false;
+  *ring_size = TWEAK_WIRE_SHM_DEFAULT_RING_SIZE;
+  const char *token = params;
+  while (*token) {
+    const char *delimiter = strchr(token, ';');
+    size_t token_length = delimiter ? (size_t)(delimiter - token) : strlen(token);
+    if (token_length == strlen("role=server") && strncmp(token, "role=server", token_length) == 0) {
+      *server_role = true;
+      has_role = true;
+    } else if (token_length == strlen("role=client") && strncmp(token, "role=client", token_length) == 0) {
+      *server_role = false;
+      has_role = true;
+    } else if (token_length > strlen("ring_size=") && strncmp(token, "ring_size=", strlen("ring_size=")) == 0) {
+      char *end = NULL;
+      unsigned long value = strtoul(token + strlen("ring_size="), &end, 10);
+      if (end != token + token_length
+        || value < TWEAK_WIRE_SHM_MIN_RING_SIZE || value > TWEAK_WIRE_SHM_MAX_RING_SIZE
+        || (value & (value - 1)) != 0)
+      {
+        TWEAK_LOG_ERROR("ring_size must be a power of two in range [%u, %u]",
+          TWEAK_WIRE_SHM_MIN_RING_SIZE, TWEAK_WIRE_SHM_MAX_RING_SIZE);
+        return false;
+      }
+      *ring_size = (uint32_t)value;
+    } else if (token_length > 0) {
+      TWEAK_LOG_ERROR("Unknown connection parameter: \"%.*s\"", (int)token_length, token);
+      return false;
+    }
+    token += token_length;
+    if (*token == ';') {
+      ++token;
+    }
+  }
+  return has_role;
+}
+
+/*
+ * Maps "shm://name" to POSIX shared memory object name "/name".
+ */
+static bool parse_uri(const char *uri, char *shm_name, size_t shm_name_size) {
+  const char prefix[] = "shm://";
+  if (strncmp(uri, prefix, sizeof(prefix) - 1) != 0) {
+    return false;
+  }
+  const char *name = uri + sizeof(prefix) - 1;
+  size_t name_length = strlen(name);
+  if (name_length == 0 || name_length + 2 > shm_name_size || strchr(name, '/') != NULL) {
+    return false;
+  }
+  snprintf(shm_name, shm_name_size, "/%s", name);
+  return true;
+}
+
+static size_t get_mapping_size(uint32_t ring_size) {
+  return sizeof(struct shm_header) + 2 * (size_t)ring_size;
+}
+
+static uint8_t *get_ring_data(struct shm_header *header, int side) {
+  return (uint8_t *)(header + 1) + (size_t)side * header->ring_size;
+}
+
+static int get_remote_side(struct tweak_wire_connection_shm *connection) {
+  return connection->is_server ? CLIENT_SIDE : SERVER_SIDE;
+}
+
+static int get_local_side(struct tweak_wire_connection_shm *connection) {
+  return connection->is_server ? SERVER_SIDE : CLIENT_SIDE;
+}
+
+static uint32_t new_session(struct shm_header *header) {
+  uint32_t session;
+  do {
+    session = tweak_common_atomic_fetch_add_u32(&header->generation, 1) + 1;
+  } while (session == 0 || session == TWEAK_WIRE_SHM_SESSION_CLAIMED);
+  return session;
+}
+
+static tweak_common_milliseconds elapsed_millis(tweak_common_timestamp *since) {
+  tweak_common_timestamp now;
+  tweak_common_timestamp_now(&now);
+  return tweak_common_nsec_to_msec(tweak_common_timestamp_subtract_timestamps(&now, since));
+}
+
+static tweak_wire_error_code create_shm_object(struct tweak_wire_connection_shm *connection) {
+  TWEAK_LOG_TRACE_ENTRY("connection = %p", connection);
+
+  if (shm_unlink(connection->shm_name) == 0) {
+    TWEAK_LOG_WARN("Removed stale shared memory object \"%s\"", connection->shm_name);
+  }
+
+  int fd = shm_open(connection->shm_name, O_CREAT | O_EXCL | O_RDWR, S_IRUSR | S_IWUSR);
+  if (fd < 0) {
+    TWEAK_LOG_ERROR("shm_open(\"%s\") failed: %s", connection->shm_name, strerror(errno));
+    return TWEAK_WIRE_ERROR;
+  }
+
+  size_t mapping_size = get_mapping_size(connection->ring_size);
+  void *mapping = NULL;
+  struct shm_header *header = NULL;
+  if (ftruncate(fd, (off_t)mapping_size) != 0) {
+    TWEAK_LOG_ERROR("ftruncate(\"%s\") failed: %s", connection->shm_name, strerror(errno));
+    goto error;
+  }
+
+  mapping = mmap(NULL, mapping_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  if (mapping == MAP_FAILED) {
+    TWEAK_LOG_ERROR("mmap(\"%s\") failed: %s", connection->shm_name, strerror(errno));
+    goto error;
+  }
+  close(fd);
+
+  /*.. Freshly truncated object is zero filled, so are rings and peers */
+  header = mapping;
+  header->version = TWEAK_WIRE_SHM_VERSION;
+  header->ring_size = connection->ring_size;
+  connection->local_session = new_session(header);
+  header->peers[SERVER_SIDE].session = connection->local_session;
+  tweak_common_atomic_store_u32(&header->magic, TWEAK_WIRE_SHM_MAGIC);
+
+  connection->header = header;
+  connection->mapping_size = mapping_size;
+  return TWEAK_WIRE_SUCCESS;
+
+error:
+  close(fd);
+  shm_unlink(connection->shm_name);
+  return TWEAK_WIRE_ERROR;
+}
+
+/*
+ * Claims client slot unless another client holds it. Slot is taken over
+ * only if its holder hasn't advanced heartbeat for TWEAK_WIRE_SHM_PEER_TIMEOUT,
+ * which is tracked across attach attempts.
+ */
+static bool claim_client_slot(struct tweak_wire_connection_shm *connection,
+                              struct shm_header *header)
+{
+  struct shm_peer *peer = &header->peers[CLIENT_SIDE];
+  uint32_t session = tweak_common_atomic_load_u32(&peer->session);
+  if (session != 0) {
+    uint32_t heartbeat = tweak_common_atomic_load_u32(&peer->heartbeat);
+    if (session != connection->busy_session || heartbeat != connection->busy_heartbeat) {
+      if (session != connection->busy_session) {
+        TWEAK_LOG_WARN("Shared memory object \"%s\" is used by another client", connection->shm_name);
+      }
+      connection->busy_session = session;
+      connection->busy_heartbeat = heartbeat;
+      tweak_common_timestamp_now(&connection->busy_timestamp);
+      return false;
+    }
+    if (elapsed_millis(&connection->busy_timestamp) <= TWEAK_WIRE_SHM_PEER_TIMEOUT) {
+      return false;
+    }
+    TWEAK_LOG_WARN("Client of shared memory object \"%s\" has stopped, taking over", connection->shm_name);
+  }
+  if (!tweak_common_atomic_compare_exchange_u32(&peer->session, session, TWEAK_WIRE_SHM_SESSION_CLAIMED)) {
+    TWEAK_LOG_TRACE("Client slot of \"%s\" has been claimed concurrently", connection->shm_name);
+    return false;
+  }
+  connection->busy_session = 0;
+  return true;
+}
+
+/*
+ * Called by client receive thread only.
+ */
+static bool attach_shm_object(struct tweak_wire_connection_shm *connection) {
+  int fd = shm_open(connection->shm_name, O_RDWR, 0);
+  if (fd < 0) {
+    TWEAK_LOG_TRACE("shm_open(\"%s\") failed: %s", connection->shm_name, strerror(errno));
+    return false;
+  }
+
+  struct stat st;
+  if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(struct shm_header)) {
+    close(fd);
+    return false;
+  }
+
+  size_t mapping_size = (size_t)st.st_size;
+  void *mapping = mmap(NULL, mapping_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  close(fd);
+  if (mapping == MAP_FAILED) {
+    TWEAK_LOG_ERROR("mmap(\"%s\") failed: %s", connection->shm_name, strerror(errno));
+    return false;
+  }
+
+  struct shm_header *header = mapping;
+  uint32_t ring_size = header->ring_size;
+  if (tweak_common_atomic_load_u32(&header->magic) != TWEAK_WIRE_SHM_MAGIC
+    || header->version != TWEAK_WIRE_SHM_VERSION
+    || ring_size < TWEAK_WIRE_SHM_MIN_RING_SIZE || ring_size > TWEAK_WIRE_SHM_MAX_RING_SIZE
+    || (ring_size & (ring_size - 1)) != 0
+    || mapping_size < get_mapping_size(ring_size)
+    || tweak_common_atomic_load_u32(&header->peers[SERVER_SIDE].session) == 0)
+  {
+    TWEAK_LOG_TRACE("Shared memory object \"%s\" isn't ready", connection->shm_name);
+    munmap(mapping, mapping_size);
+    return false;
+  }
+
+  if (!claim_client_slot(connection, header)) {
+    munmap(mapping, mapping_size);
+    return false;
+  }
+
+  /*.. Whatever server has sent to the previous client is stale.
+       Server doesn't transmit while the slot is merely claimed. */
+  struct shm_ring_control *inbound = &header->rings[SERVER_SIDE];
+  tweak_common_atomic_store_u32(&inbound->tail, tweak_common_atomic_load_u32(&inbound->head));
+
+  connection->local_session = new_session(header);
+  tweak_common_atomic_store_u32(&header->peers[CLIENT_SIDE].session, connection->local_session);
+
+  tweak_common_mutex_lock(&connection->tx_lock);
+  connection->header = header;
+  connection->mapping_size = mapping_size;
+  tweak_common_mutex_unlock(&connection->tx_lock);
+
+  connection->peer_session = 0;
+  connection->peer_lost = false;
+  TWEAK_LOG_TRACE("Attached to shared memory object \"%s\"", connection->shm_name);
+  return true;
+}
+
+static void detach_shm_object(struct tweak_wire_connection_shm *connection) {
+  tweak_common_mutex_lock(&connection->tx_lock);
+  struct shm_header *header = connection->header;
+  connection->header = NULL;
+  tweak_common_mutex_unlock(&connection->tx_lock);
+
+  if (!header) {
+    return;
+  }
+
+  /*.. Slot might have been taken over by another client meanwhile */
+  tweak_common_atomic_compare_exchange_u32(&header->peers[get_local_side(connection)].session,
+    connection->local_session, 0);
+  munmap(header, connection->mapping_size);
+  if (connection->is_server) {
+    shm_unlink(connection->shm_name);
+  }
+}
+
+static void futex_wait(volatile uint32_t *futex_word, uint32_t expected_value,
+                       tweak_common_milliseconds timeout_millis)
+{
+  struct timespec timeout;
+  timeout.tv_sec = timeout_millis / 1000;
+  timeout.tv_nsec = (long)(timeout_millis % 1000) * 1000000L;
+  /*.. EAGAIN, EINTR and ETIMEDOUT are all handled by callers rechecking their condition */
+  syscall(SYS_futex, futex_word, FUTEX_WAIT, expected_value, &timeout, NULL, 0);
+}
+
+static void futex_wake(volatile uint32_t *futex_word) {
+  syscall(SYS_futex, futex_word, FUTEX_WAKE, 1, NULL, NULL, 0);
+}
+
+/*
+ * Bumps futex word and issues wake syscall only if the other side is sleeping.
+ */
+static void signal_futex(volatile uint32_t *futex_word, volatile uint32_t *waiters) {
+  tweak_common_atomic_fetch_add_u32(futex_word, 1);
+  if (tweak_common_atomic_load_u32(waiters) != 0) {
+    futex_wake(futex_word);
+  }
+}
+
+static void ring_write(uint8_t *data, uint32_t ring_size, uint32_t position,
+                       const void *source, uint32_t size)
+{
+  uint32_t offset = position & (ring_size - 1);
+  uint32_t first_part = ring_size - offset < size ? ring_size - offset : size;
+  memcpy(data + offset, source, first_part);
+  memcpy(data, (const uint8_t *)source + first_part, size - first_part);
+}
+
+static void ring_read(const uint8_t *data, uint32_t ring_size, uint32_t position,
+                      void *destination, uint32_t size)
+{
+  uint32_t offset = position & (ring_size - 1);
+  uint32_t first_part = ring_size - offset < size ? ring_size - offset : size;
+  memcpy(destination, data + offset, first_part);
+  memcpy((uint8_t *)destination + first_part, data, size - first_part);
+}
+
+static tweak_wire_error_code tweak_wire_shm_transmit(tweak_wire_connection connection_base,
+                                                     const uint8_t *buffer, size_t size)
+{
+  TWEAK_LOG_TRACE_ENTRY("connection = %p, buffer = %p, size = %zu",
+                        connection_base, buffer, size);
+
+  struct tweak_wire_connection_shm *connection =
+    (struct tweak_wire_connection_shm *)connection_base;
+
+  tweak_wire_error_code result = TWEAK_WIRE_SUCCESS;
+  tweak_common_mutex_lock(&connection->tx_lock);
+
+  struct shm_header *header = connection->header;
+  if (!header || !tweak_common_atomic_load_u32(&connection->connected)) {
+    /*.. Same as nng hub with no pipes: datagram is silently dropped */
+    TWEAK_LOG_TRACE("No peer attached, datagram dropped");
+    goto exit;
+  }
+
+  uint32_t ring_size = header->ring_size;
+  if (size > ring_size - TWEAK_WIRE_SHM_LENGTH_PREFIX_SIZE) {
+    TWEAK_LOG_ERROR("Datagram of %zu bytes doesn't fit ring of %" PRIu32 " bytes", size, ring_size);
+    result = TWEAK_WIRE_ERROR;
+    goto exit;
+  }
+
+  int side = get_local_side(connection);
+  struct shm_ring_control *ring = &header->rings[side];
+  uint32_t required = TWEAK_WIRE_SHM_LENGTH_PREFIX_SIZE + (uint32_t)size;
+  uint32_t head = tweak_common_atomic_load_u32(&ring->head);
+
+  tweak_common_timestamp start;
+  tweak_common_timestamp_now(&start);
+  while (ring_size - (head - tweak_common_atomic_load_u32(&ring->tail)) < required) {
+    tweak_common_milliseconds elapsed = elapsed_millis(&start);
+    if (elapsed >= TWEAK_WIRE_TIMEOUT) {
+      TWEAK_LOG_WARN("Ring is full for %d milliseconds", TWEAK_WIRE_TIMEOUT);
+      result = TWEAK_WIRE_ERROR_TIMEOUT;
+      goto exit;
+    }
+    uint32_t seq = tweak_common_atomic_load_u32(&ring->space_seq);
+    tweak_common_atomic_fetch_add_u32(&ring->space_waiters, 1);
+    if (ring_size - (head - tweak_common_atomic_load_u32(&ring->tail)) < required) {
+      futex_wait(&ring->space_seq, seq, TWEAK_WIRE_TIMEOUT - elapsed);
+    }
+    tweak_common_atomic_fetch_add_u32(&ring->space_waiters, (uint32_t)-1);
+  }
+
+  uint8_t *data = get_ring_data(header, side);
+  uint32_t length = (uint32_t)size;
+  ring_write(data, ring_size, head, &length, TWEAK_WIRE_SHM_LENGTH_PREFIX_SIZE);
+  ring_write(data, ring_size, head + TWEAK_WIRE_SHM_LENGTH_PREFIX_SIZE, buffer, length);
+  tweak_common_atomic_store_u32(&ring->head, head + required);
+  signal_futex(&ring->data_seq, &ring->data_waiters);
+
+exit:
+  tweak_common_mutex_unlock(&connection->tx_lock);
+  return result;
+}
+
+static void set_connection_state(struct tweak_wire_connection_shm *connection,
+                                 tweak_wire_connection_state connection_state)
+{
+  uint32_t connected = connection_state == TWEAK_WIRE_CONNECTED ? 1 : 0;
+  if (tweak_common_atomic_load_u32(&connection->connected) == connected) {
+    return;
+  }
+  tweak_common_atomic_store_u32(&connection->connected, connected);
+  TWEAK_LOG_TRACE("Switching state to %s",
+    connected ? "TWEAK_WIRE_CONNECTED" : "TWEAK_WIRE_DISCONNECTED");
+  if (connection->state_listener) {
+    connection->state_listener(&connection->base, connection_state,
+                               connection->state_listener_cookie);
+  }
+}
+
+/*
+ * Compares remote session and heartbeat against the last observed values.
+ * Server trusts a new client session right away since client attaches
+ * only to a live server. Client waits for server heartbeat to advance
+ * or for its first datagram to skip objects left by a crashed server.
+ */
+static void update_peer_state(struct tweak_wire_connection_shm *connection) {
+  struct shm_peer *peer = &connection->header->peers[get_remote_side(connection)];
+  uint32_t session = tweak_common_atomic_load_u32(&peer->session);
+  uint32_t heartbeat = tweak_common_atomic_load_u32(&peer->heartbeat);
+  if (session == TWEAK_WIRE_SHM_SESSION_CLAIMED) {
+    /*.. Client is flushing its inbound ring, it isn't attached yet */
+    session = 0;
+  }
+
+  if (session != connection->peer_session) {
+    set_connection_state(connection, TWEAK_WIRE_DISCONNECTED);
+    connection->peer_session = session;
+    connection->peer_heartbeat = heartbeat;
+    connection->peer_lost = false;
+    tweak_common_timestamp_now(&connection->peer_heartbeat_timestamp);
+    if (session != 0 && connection->is_server) {
+      set_connection_state(connection, TWEAK_WIRE_CONNECTED);
+    }
+  } else if (heartbeat != connection->peer_heartbeat) {
+    connection->peer_heartbeat = heartbeat;
+    tweak_common_timestamp_now(&connection->peer_heartbeat_timestamp);
+    connection->peer_lost = false;
+    if (session != 0) {
+      set_connection_state(connection, TWEAK_WIRE_CONNECTED);
+    }
+  } else if (session != 0 && !connection->peer_lost
+    && elapsed_millis(&connection->peer_heartbeat_timestamp) > TWEAK_WIRE_SHM_PEER_TIMEOUT)
+  {
+    TWEAK_LOG_WARN("Peer heartbeat has stopped for %d milliseconds", TWEAK_WIRE_SHM_PEER_TIMEOUT);
+    connection->peer_lost = true;
+    set_connection_state(connection, TWEAK_WIRE_DISCONNECTED);
+  }
+}
+
+static bool reserve_rx_buffer(struct tweak_wire_connection_shm *connection, size_t size) {
+  if (connection->rx_buffer_capacity >= size) {
+    return true;
+  }
+  uint8_t *rx_buffer = realloc(connection->rx_buffer, size);
+  if (!rx_buffer) {
+    TWEAK_LOG_ERROR("Not enough memory to assemble %zu bytes datagram", size);
+    return false;
+  }
+  connection->rx_buffer = rx_buffer;
+  connection->rx_buffer_capacity = size;
+  return true;
+}
+
+/*
+ * Delivers every complete datagram from inbound ring.
+ * Payload that doesn't wrap around ring end is passed to the listener in place.
+ */
+static void drain_inbound_ring(struct tweak_wire_connection_shm *connection) {
+  struct shm_header *header = connection->header;
+  int side = get_remote_side(connection);
+  struct shm_ring_control *ring = &header->rings[side];
+  const uint8_t *data = get_ring_data(header, side);
+  uint32_t ring_size = header->ring_size;
+  uint32_t tail = tweak_common_atomic_load_u32(&ring->tail);
+  uint32_t head;
+
+  while ((head = tweak_common_atomic_load_u32(&ring->head)) != tail) {
+    uint32_t available = head - tail;
+    uint32_t length = 0;
+    bool corrupted = available < TWEAK_WIRE_SHM_LENGTH_PREFIX_SIZE || available > ring_size;
+    if (!corrupted) {
+      ring_read(data, ring_size, tail, &length, TWEAK_WIRE_SHM_LENGTH_PREFIX_SIZE);
+      corrupted = length > available - TWEAK_WIRE_SHM_LENGTH_PREFIX_SIZE;
+    }
+
+    if (corrupted) {
+      TWEAK_LOG_ERROR("Inbound ring is corrupted, dropping %" PRIu32 " bytes", available);
+      tail = head;
+    } else {
+      /*.. Peer publishes its session before its first datagram,
+           so state change is reported ahead of the datagram */
+      update_peer_state(connection);
+      if (connection->peer_session != 0 && !connection->peer_lost) {
+        /*.. Inbound ring is flushed on attach, so datagram proves peer is alive */
+        set_connection_state(connection, TWEAK_WIRE_CONNECTED);
+      }
+
+      if (tweak_common_atomic_load_u32(&connection->connected)) {
+        uint32_t offset = (tail + TWEAK_WIRE_SHM_LENGTH_PREFIX_SIZE) & (ring_size - 1);
+        const uint8_t *payload = NULL;
+        if (offset + length <= ring_size) {
+          payload = data + offset;
+        } else if (reserve_rx_buffer(connection, length)) {
+          ring_read(data, ring_size, tail + TWEAK_WIRE_SHM_LENGTH_PREFIX_SIZE,
+                    connection->rx_buffer, length);
+          payload = connection->rx_buffer;
+        }
+        if (payload) {
+          TWEAK_LOG_TRACE("Invoking receive listener");
+          connection->receive_listener(payload, length, connection->receive_listener_cookie);
+        }
+      } else {
+        TWEAK_LOG_TRACE("Datagram from disconnected peer dropped");
+      }
+      tail += TWEAK_WIRE_SHM_LENGTH_PREFIX_SIZE + length;
+    }
+
+    tweak_common_atomic_store_u32(&ring->tail, tail);
+    signal_futex(&ring->space_seq, &ring->space_waiters);
+  }
+}
+
+static void wait_inbound_ring(struct tweak_wire_connection_shm *connection) {
+  struct shm_ring_control *ring = &connection->header->rings[get_remote_side(connection)];
+  uint32_t seq = tweak_common_atomic_load_u32(&ring->data_seq);
+  tweak_common_atomic_fetch_add_u32(&ring->data_waiters, 1);
+  if (tweak_common_atomic_load_u32(&ring->head) == tweak_common_atomic_load_u32(&ring->tail)
+    && !tweak_common_atomic_load_u32(&connection->is_finalizing))
+  {
+    futex_wait(&ring->data_seq, seq, TWEAK_WIRE_SHM_POLL_INTERVAL);
+  }
+  tweak_common_atomic_fetch_add_u32(&ring->data_waiters, (uint32_t)-1);
+}
+
+static void *tweak_wire_shm_receive_thread(void *arg) {
+  TWEAK_LOG_TRACE_ENTRY("arg = %p", arg);
+  struct tweak_wire_connection_shm *connection = arg;
+
+  while (!tweak_common_atomic_load_u32(&connection->is_finalizing)) {
+    if (!connection->header && !attach_shm_object(connection)) {
+      tweak_common_sleep(TWEAK_WIRE_SHM_POLL_INTERVAL);
+      continue;
+    }
+
+    update_peer_state(connection);
+
+    if (!connection->is_server && (connection->peer_session == 0 || connection->peer_lost)) {
+      /*.. Server is gone, its object might be recreated under the same name */
+      TWEAK_LOG_TRACE("Detaching from shared memory object \"%s\"", connection->shm_name);
+      detach_shm_object(connection);
+      continue;
+    }
+
+    drain_inbound_ring(connection);
+    wait_inbound_ring(connection);
+  }
+
+  /*.. Report that we are disconnected */
+  set_connection_state(connection, TWEAK_WIRE_DISCONNECTED);
+  return NULL;
+}
+
+static void *tweak_wire_shm_heartbeat_thread(void *arg) {
+  TWEAK_LOG_TRACE_ENTRY("arg = %p", arg);
+  struct tweak_wire_connection_shm *connection = arg;
+
+  while (!tweak_common_atomic_load_u32(&connection->is_finalizing)) {
+    /*.. tx_lock keeps header mapped */
+    tweak_common_mutex_lock(&connection->tx_lock);
+    if (connection->header) {
+      tweak_common_atomic_fetch_add_u32(
+        &connection->header->peers[get_local_side(connection)].heartbeat, 1);
+    }
+    tweak_common_mutex_unlock(&connection->tx_lock);
+    tweak_common_sleep(TWEAK_WIRE_SHM_POLL_INTERVAL);
+  }
+  return NULL;
+}
+
+static void tweak_wire_shm_destroy_connection(tweak_wire_connection connection_base) {
+  TWEAK_LOG_TRACE_ENTRY("connection_base = %p", connection_base);
+  struct tweak_wire_connection_shm *connection =
+    (struct tweak_wire_connection_shm *)connection_base;
+
+  tweak_common_atomic_store_u32(&connection->is_finalizing, 1);
+
+  tweak_common_mutex_lock(&connection->tx_lock);
+  if (connection->header) {
+    struct shm_ring_control *ring = &connection->header->rings[get_remote_side(connection)];
+    tweak_common_atomic_fetch_add_u32(&ring->data_seq, 1);
+    futex_wake(&ring->data_seq);
+  }
+  tweak_common_mutex_unlock(&connection->tx_lock);
+
+  tweak_common_thread_join(connection->receive_thread, NULL);
+  tweak_common_thread_join(connection->heartbeat_thread, NULL);
+
+  detach_shm_object(connection);
+  tweak_common_mutex_destroy(&connection->tx_lock);
+  free(connection->rx_buffer);
+  free(connection);
+}
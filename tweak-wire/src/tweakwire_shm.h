@@ -0,0 +1,55 @@
+/**
+ * @file tweakwire_shm.h
+ * @ingroup tweak-internal
+ *
+ * @brief Tweak wire transport layer implementation, shared memory backend.
+ *
+ * @copyright 2020-2022 Cogent Embedded, Inc. ALL RIGHTS RESERVED.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef TWEAK_WIRE_SHM_H_INCLUDED
+#define TWEAK_WIRE_SHM_H_INCLUDED
+
+#include <tweak2/wire.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Create connection using POSIX shared memory as a backend.
+ *
+ * @details Server and client have to run on the same host.
+ * Uri has form "shm://name", where name selects shared memory object.
+ * Server creates the object, client attaches to it and reattaches
+ * whenever server is restarted.
+ */
+tweak_wire_connection tweak_wire_create_shm_connection(
+    const char *connection_type, const char *params, const char *uri,
+    tweak_wire_connection_state_listener connection_state_listener,
+    void *connection_state_cookie, tweak_wire_receive_listener receive_listener,
+    void *receive_listener_cookie);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* TWEAK_WIRE_SHM_H_INCLUDED */
@@ -40,6 +40,10 @@
 #include <acutest.h>
 
 #define TEST_CLIENTS 2U
+#define TEST_TX_QUEUE_SIZE 4U
+#define TEST_FLOOD_DATAGRAM_SIZE 65536U
+#define TEST_FLOOD_LIMIT 4096U
+#define TEST_SHM_SLOW_LISTENER_MILLIS 4000U
 
 static tweak_common_mutex s_lock = { 0 };
 static tweak_common_cond s_cond = { 0 };
@@ -244,6 +248,24 @@ void test_wire(void) {
     clear_wait_buffer(&client_buff[i]);
   }
 
+  puts("Transmit datagram from server to clients through tx buffer...");
+  const char *lent = "Lent!";
+  tweak_wire_tx_buffer tx_buffer;
+  TEST_CHECK(tweak_wire_acquire_tx_buffer(server_context, 64, &tx_buffer) == TWEAK_WIRE_SUCCESS);
+  TEST_CHECK(tx_buffer.capacity == 64);
+  memcpy(tx_buffer.data, lent, strlen(lent));
+  TEST_CHECK(tweak_wire_commit(server_context, &tx_buffer, strlen(lent)) == TWEAK_WIRE_SUCCESS);
+
+  for(size_t i = 0U; i < TEST_CLIENTS; i++) {
+    wait_buffer(&client_buff[i]);
+
+    TEST_CHECK(client_buff[i].size == strlen(lent));
+    TEST_CHECK(strncmp(lent, (const char *)client_buff[i].buffer, client_buff[i].size) == 0);
+    printf("Client %zu received\n", i);
+
+    clear_wait_buffer(&client_buff[i]);
+  }
+
   for(size_t i = 0U; i < TEST_CLIENTS; i++) {
     printf("Shut down client %zu...\n", i);
     tweak_wire_destroy_connection(client_context[i]);
@@ -273,7 +295,342 @@ void test_wire(void) {
   finalize();
 }
 
+struct flood_receiver {
+  tweak_common_mutex lock;
+  tweak_common_cond cond;
+  bool gate_open;
+  size_t flood_count;
+  bool end_received;
+};
+
+/*
+ * Holds nng receive loop until the gate is open,
+ * so the sender runs out of transmit slots.
+ */
+static void flood_receive_listener(const uint8_t* buffer, size_t size, void * cookie) {
+  struct flood_receiver* receiver = cookie;
+  tweak_common_mutex_lock(&receiver->lock);
+  while (!receiver->gate_open) {
+    tweak_common_cond_wait(&receiver->cond, &receiver->lock);
+  }
+  if (size > 0 && buffer[0] == 'F') {
+    ++receiver->flood_count;
+  } else if (size > 0 && buffer[0] == 'E') {
+    receiver->end_received = true;
+  }
+  tweak_common_cond_broadcast(&receiver->cond);
+  tweak_common_mutex_unlock(&receiver->lock);
+}
+
+void test_wire_tx_queue(void) {
+  initialize();
+  struct flood_receiver server_receiver = {
+    .gate_open = false
+  };
+  struct receive_buff client_buff = {
+    .has_value = false
+  };
+  tweak_common_cond_init(&server_receiver.cond);
+  tweak_common_mutex_init(&server_receiver.lock);
+  tweak_common_cond_init(&client_buff.cond);
+  tweak_common_mutex_init(&client_buff.lock);
+
+  puts("Reject malformed tx_queue params...");
+  TEST_CHECK(tweak_wire_create_connection("nng", "role=client;tx_queue=many",
+    TWEAK_DEFAULT_ENDPOINT, NULL, NULL, &test_receive_listener, &client_buff)
+      == TWEAK_WIRE_INVALID_CONNECTION);
+  TEST_CHECK(tweak_wire_create_connection("nng", "role=client;tx_queue=1025",
+    TWEAK_DEFAULT_ENDPOINT, NULL, NULL, &test_receive_listener, &client_buff)
+      == TWEAK_WIRE_INVALID_CONNECTION);
+  TEST_CHECK(tweak_wire_create_connection("nng", "tx_queue=4",
+    TWEAK_DEFAULT_ENDPOINT, NULL, NULL, &test_receive_listener, &client_buff)
+      == TWEAK_WIRE_INVALID_CONNECTION);
+  puts("SUCCESS");
+
+  puts("Create listener node...");
+  tweak_wire_connection server_context = tweak_wire_create_connection("nng",
+    "role=server", TWEAK_DEFAULT_ENDPOINT, &server_connection_state_listener,
+    NULL, &flood_receive_listener, &server_receiver);
+  TEST_CHECK(server_context != TWEAK_WIRE_INVALID_CONNECTION);
+
+  char params[64];
+  snprintf(params, sizeof(params), "role=client;tx_queue=%u", TEST_TX_QUEUE_SIZE);
+  printf("Create connector node with \"%s\"...\n", params);
+  tweak_wire_connection client_context = tweak_wire_create_connection("nng",
+    params, TWEAK_DEFAULT_ENDPOINT, &client_connection_state_listener,
+    (void*)0, &test_receive_listener, &client_buff);
+  TEST_CHECK(client_context != TWEAK_WIRE_INVALID_CONNECTION);
+
+  server_wait_connection();
+  client_wait_connection(0);
+  puts("Connection established");
+
+  puts("Flood stalled receiver until every transmit slot is busy...");
+  uint8_t *datagram = calloc(1, TEST_FLOOD_DATAGRAM_SIZE);
+  TEST_ASSERT(datagram != NULL);
+  datagram[0] = 'F';
+  size_t sent = 0;
+  tweak_wire_error_code result = TWEAK_WIRE_SUCCESS;
+  while (sent < TEST_FLOOD_LIMIT) {
+    result = tweak_wire_transmit(client_context, datagram, TEST_FLOOD_DATAGRAM_SIZE);
+    if (result != TWEAK_WIRE_SUCCESS) {
+      break;
+    }
+    ++sent;
+  }
+  free(datagram);
+  printf("%zu datagrams queued before timeout\n", sent);
+  TEST_CHECK(result == TWEAK_WIRE_ERROR_TIMEOUT);
+  TEST_CHECK(sent >= TEST_TX_QUEUE_SIZE);
+
+  puts("Transmit again while receiver is still stalled...");
+  uint8_t end[] = "End!";
+  TEST_CHECK(tweak_wire_transmit(client_context, end, sizeof(end)) == TWEAK_WIRE_ERROR_TIMEOUT);
+  TEST_CHECK(tweak_wire_get_tx_failures(client_context) == 0);
+
+  puts("Release receiver...");
+  tweak_common_mutex_lock(&server_receiver.lock);
+  server_receiver.gate_open = true;
+  tweak_common_cond_broadcast(&server_receiver.cond);
+  tweak_common_mutex_unlock(&server_receiver.lock);
+
+  puts("Transmit last datagram after queue has drained...");
+  TEST_CHECK(tweak_wire_transmit(client_context, end, sizeof(end)) == TWEAK_WIRE_SUCCESS);
+  tweak_common_mutex_lock(&server_receiver.lock);
+  while (!server_receiver.end_received) {
+    tweak_common_cond_wait(&server_receiver.cond, &server_receiver.lock);
+  }
+  size_t received = server_receiver.flood_count;
+  tweak_common_mutex_unlock(&server_receiver.lock);
+  printf("%zu datagrams received\n", received);
+  TEST_CHECK(received == sent);
+  TEST_CHECK(tweak_wire_get_tx_failures(client_context) == 0);
+  TEST_CHECK(tweak_wire_get_tx_failures(server_context) == 0);
+  puts("SUCCESS");
+
+  puts("Shut down nodes...");
+  tweak_wire_destroy_connection(client_context);
+  tweak_wire_destroy_connection(server_context);
+  puts("SUCCESS");
+
+  tweak_common_mutex_destroy(&server_receiver.lock);
+  tweak_common_cond_destroy(&server_receiver.cond);
+  tweak_common_mutex_destroy(&client_buff.lock);
+  tweak_common_cond_destroy(&client_buff.cond);
+  finalize();
+}
+
+#if defined(WITH_WIRE_SHM)
+static void client_wait_disconnection(size_t index) {
+  tweak_common_mutex_lock(&s_lock);
+  while (s_client_conn_state[index] != TWEAK_WIRE_DISCONNECTED) {
+    tweak_common_cond_wait(&s_cond, &s_lock);
+  }
+  tweak_common_mutex_unlock(&s_lock);
+}
+
+static void server_wait_disconnection(void) {
+  tweak_common_mutex_lock(&s_lock);
+  while (s_server_conn_state != TWEAK_WIRE_DISCONNECTED) {
+    tweak_common_cond_wait(&s_cond, &s_lock);
+  }
+  tweak_common_mutex_unlock(&s_lock);
+}
+
+void test_wire_shm(void) {
+  initialize();
+  const char *uri = "shm://tweak-wire-test";
+  struct receive_buff server_buff = {
+    .has_value = false
+  };
+  struct receive_buff client_buff = {
+    .has_value = false
+  };
+  tweak_common_cond_init(&server_buff.cond);
+  tweak_common_mutex_init(&server_buff.lock);
+  tweak_common_cond_init(&client_buff.cond);
+  tweak_common_mutex_init(&client_buff.lock);
+
+  puts("Create shm server node...");
+  tweak_wire_connection server_context = tweak_wire_create_connection("shm",
+    "role=server;ring_size=4096", uri, &server_connection_state_listener,
+    NULL, &test_receive_listener, &server_buff);
+  TEST_CHECK(server_context != TWEAK_WIRE_INVALID_CONNECTION);
+
+  puts("Transmit datagram from server to non-existing client...");
+  uint8_t lost[] = "Lost!";
+  TEST_CHECK(tweak_wire_transmit(server_context, lost, sizeof(lost)) == TWEAK_WIRE_SUCCESS);
+
+  puts("Reject ring size which is not a power of two...");
+  TEST_CHECK(tweak_wire_create_connection("shm", "role=server;ring_size=1000", uri,
+    NULL, NULL, &test_receive_listener, &server_buff) == TWEAK_WIRE_INVALID_CONNECTION);
+
+  for (size_t attempt = 0U; attempt < 2U; attempt++) {
+    printf("Create shm client node, attempt %zu...\n", attempt);
+    tweak_wire_connection client_context = tweak_wire_create_connection("shm",
+      "role=client", uri, &client_connection_state_listener,
+      (void*)0, &test_receive_listener, &client_buff);
+    TEST_CHECK(client_context != TWEAK_WIRE_INVALID_CONNECTION);
+
+    server_wait_connection();
+    client_wait_connection(0);
+    puts("Connection established");
+
+    const char *data = "Hello!";
+    TEST_CHECK(tweak_wire_transmit(client_context, (const uint8_t*)data, strlen(data)) == TWEAK_WIRE_SUCCESS);
+    wait_buffer(&server_buff);
+    TEST_CHECK(server_buff.size == strlen(data));
+    TEST_CHECK(strncmp(data, (const char *)server_buff.buffer, server_buff.size) == 0);
+    clear_wait_buffer(&server_buff);
+
+    puts("Transmit datagrams wrapping around ring end...");
+    uint8_t large[3000];
+    for (size_t i = 0U; i < 4U; i++) {
+      memset(large, (int)('a' + i), sizeof(large));
+      TEST_CHECK(tweak_wire_transmit(server_context, large, sizeof(large)) == TWEAK_WIRE_SUCCESS);
+      wait_buffer(&client_buff);
+      TEST_CHECK(client_buff.size == sizeof(large));
+      TEST_CHECK(memcmp(large, client_buff.buffer, sizeof(large)) == 0);
+      clear_wait_buffer(&client_buff);
+    }
+
+    uint8_t too_large[4096];
+    memset(too_large, 0, sizeof(too_large));
+    TEST_CHECK(tweak_wire_transmit(server_context, too_large, sizeof(too_large)) == TWEAK_WIRE_ERROR);
+
+    puts("Transmit datagrams through tx buffer...");
+    /* Backend doesn't lend buffers, small datagrams are kept inline and large ones on heap */
+    size_t tx_sizes[] = { 16U, TWEAK_WIRE_TX_BUFFER_INLINE_SIZE + 1U };
+    for (size_t i = 0U; i < sizeof(tx_sizes) / sizeof(tx_sizes[0]); i++) {
+      tweak_wire_tx_buffer tx_buffer;
+      TEST_CHECK(tweak_wire_acquire_tx_buffer(server_context, tx_sizes[i], &tx_buffer) == TWEAK_WIRE_SUCCESS);
+      TEST_CHECK(tx_buffer.capacity == tx_sizes[i]);
+      TEST_CHECK((tx_buffer.data == tx_buffer.inline_data) == (i == 0U));
+      memset(tx_buffer.data, (int)('k' + i), tx_sizes[i]);
+      TEST_CHECK(tweak_wire_commit(server_context, &tx_buffer, tx_sizes[i]) == TWEAK_WIRE_SUCCESS);
+      wait_buffer(&client_buff);
+      TEST_CHECK(client_buff.size == tx_sizes[i]);
+      TEST_CHECK(client_buff.buffer[0] == 'k' + i && client_buff.buffer[tx_sizes[i] - 1U] == 'k' + i);
+      clear_wait_buffer(&client_buff);
+    }
+
+    puts("Shut down client...");
+    tweak_wire_destroy_connection(client_context);
+    client_wait_disconnection(0);
+    server_wait_disconnection();
+    puts("SUCCESS");
+  }
+
+  puts("Shut down server...");
+  tweak_wire_destroy_connection(server_context);
+  puts("SUCCESS");
+
+  tweak_common_mutex_destroy(&server_buff.lock);
+  tweak_common_cond_destroy(&server_buff.cond);
+  tweak_common_mutex_destroy(&client_buff.lock);
+  tweak_common_cond_destroy(&client_buff.cond);
+  finalize();
+}
+
+/*
+ * Listener running for longer than peer timeout of shm backend.
+ */
+static void slow_receive_listener(const uint8_t* buffer, size_t size, void * cookie) {
+  tweak_common_sleep(TEST_SHM_SLOW_LISTENER_MILLIS);
+  test_receive_listener(buffer, size, cookie);
+}
+
+static unsigned int get_client_conn_cb_cnt(size_t index) {
+  tweak_common_mutex_lock(&s_lock);
+  unsigned int result = client_conn_cb_cnt[index];
+  tweak_common_mutex_unlock(&s_lock);
+  return result;
+}
+
+void test_wire_shm_single_client(void) {
+  initialize();
+  const char *uri = "shm://tweak-wire-test-single-client";
+  struct receive_buff server_buff = {
+    .has_value = false
+  };
+  struct receive_buff client_buff[TEST_CLIENTS] = {
+    { .has_value = false },
+    { .has_value = false }
+  };
+  tweak_common_cond_init(&server_buff.cond);
+  tweak_common_mutex_init(&server_buff.lock);
+  for (size_t ix = 0U; ix < TEST_CLIENTS; ix++) {
+    tweak_common_cond_init(&client_buff[ix].cond);
+    tweak_common_mutex_init(&client_buff[ix].lock);
+  }
+
+  puts("Create shm server node with slow listener...");
+  tweak_wire_connection server_context = tweak_wire_create_connection("shm",
+    "role=server;ring_size=4096", uri, &server_connection_state_listener,
+    NULL, &slow_receive_listener, &server_buff);
+  TEST_CHECK(server_context != TWEAK_WIRE_INVALID_CONNECTION);
+
+  tweak_wire_connection client_context[TEST_CLIENTS];
+  client_context[0] = tweak_wire_create_connection("shm", "role=client", uri,
+    &client_connection_state_listener, (void*)0, &test_receive_listener, &client_buff[0]);
+  TEST_CHECK(client_context[0] != TWEAK_WIRE_INVALID_CONNECTION);
+  server_wait_connection();
+  client_wait_connection(0);
+  unsigned int client_cb_cnt = get_client_conn_cb_cnt(0);
+
+  puts("Block server receive thread for longer than peer timeout...");
+  const char *data = "Hello!";
+  TEST_CHECK(tweak_wire_transmit(client_context[0], (const uint8_t*)data, strlen(data)) == TWEAK_WIRE_SUCCESS);
+  wait_buffer(&server_buff);
+  TEST_CHECK(strncmp(data, (const char *)server_buff.buffer, server_buff.size) == 0);
+  clear_wait_buffer(&server_buff);
+  TEST_CHECK(get_client_conn_cb_cnt(0) == client_cb_cnt);
+  puts("SUCCESS");
+
+  puts("Create second client node...");
+  client_context[1] = tweak_wire_create_connection("shm", "role=client", uri,
+    &client_connection_state_listener, (void*)1, &test_receive_listener, &client_buff[1]);
+  TEST_CHECK(client_context[1] != TWEAK_WIRE_INVALID_CONNECTION);
+  tweak_common_sleep(TEST_SHM_SLOW_LISTENER_MILLIS);
+  TEST_CHECK(get_client_conn_cb_cnt(1) == 0);
+  TEST_CHECK(get_client_conn_cb_cnt(0) == client_cb_cnt);
+
+  TEST_CHECK(tweak_wire_transmit(server_context, (const uint8_t*)data, strlen(data)) == TWEAK_WIRE_SUCCESS);
+  wait_buffer(&client_buff[0]);
+  TEST_CHECK(strncmp(data, (const char *)client_buff[0].buffer, client_buff[0].size) == 0);
+  clear_wait_buffer(&client_buff[0]);
+  TEST_CHECK(!client_buff[1].has_value);
+  puts("SUCCESS");
+
+  puts("Shut down first client, second one takes over...");
+  tweak_wire_destroy_connection(client_context[0]);
+  client_wait_connection(1);
+  server_wait_connection();
+  TEST_CHECK(tweak_wire_transmit(server_context, (const uint8_t*)data, strlen(data)) == TWEAK_WIRE_SUCCESS);
+  wait_buffer(&client_buff[1]);
+  TEST_CHECK(strncmp(data, (const char *)client_buff[1].buffer, client_buff[1].size) == 0);
+  clear_wait_buffer(&client_buff[1]);
+  puts("SUCCESS");
+
+  tweak_wire_destroy_connection(client_context[1]);
+  tweak_wire_destroy_connection(server_context);
+
+  tweak_common_mutex_destroy(&server_buff.lock);
+  tweak_common_cond_destroy(&server_buff.cond);
+  for (size_t ix = 0U; ix < TEST_CLIENTS; ix++) {
+    tweak_common_mutex_destroy(&client_buff[ix].lock);
+    tweak_common_cond_destroy(&client_buff[ix].cond);
+  }
+  finalize();
+}
+#endif
+
 TEST_LIST = {
    { "test-wire", test_wire },
+   { "test-wire-tx-queue", test_wire_tx_queue },
+#if defined(WITH_WIRE_SHM)
+   { "test-wire-shm", test_wire_shm },
+   { "test-wire-shm-single-client", test_wire_shm_single_client },
+#endif
    { NULL, NULL }     /* zeroed record marking the end of the list */
 };
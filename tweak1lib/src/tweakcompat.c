@@ -26,6 +26,7 @@
 
 #include <tweak.h>
 #include <tweak2/appserver.h>
+#include <tweak2/intern.h>
 #include <tweak2/log.h>
 #include <tweak2/thread.h>
 #include <tweak2/types.h>
@@ -59,9 +60,13 @@ static char* s_layout_meta = NULL;
 
 static char s_buffer[MAX_BUFFER_SIZE];
 
+/*
+ * Both maps hold references to the same interned name and uri,
+ * and the uri is shared with the item registered in the model.
+ */
 struct name_uri_pair {
-  char* name;
-  char* uri;
+  tweak_interned_string name;
+  tweak_interned_string uri;
   UT_hash_handle hh;
 };
 
@@ -73,45 +78,49 @@ struct name_uri_pair* s_uri_name_pairs = NULL;
 
 static char s_uri_concat_buffer[MAX_BUFFER_SIZE];
 
-static char* add_uri_mapping(const char* name, const char* uri) {
-  struct name_uri_pair* pair = NULL;
-  HASH_FIND_STR(s_name_uri_pairs, name, pair);
-  if (pair != NULL) {
-    TWEAK_FATAL("duplicate name");
-  }
-  pair = malloc(sizeof(*pair));
+static struct name_uri_pair* create_pair(tweak_interned_string name, tweak_interned_string uri) {
+  struct name_uri_pair* pair = malloc(sizeof(*pair));
   if (pair == NULL) {
     TWEAK_FATAL("malloc() returned NULL");
   }
-  size_t length = strlen(name);
-  char* name_dup = strdup(name);
-  char* uri_dup = strdup(uri);
-  pair->name = name_dup;
-  pair->uri = uri_dup;
-  HASH_ADD_KEYPTR(hh, s_name_uri_pairs, name_dup, length, pair);
-  return uri_dup;
+  pair->name = tweak_interned_string_acquire(name);
+  pair->uri = tweak_interned_string_acquire(uri);
+  return pair;
+}
+
+static void destroy_pair(struct name_uri_pair* pair) {
+  tweak_interned_string_release(pair->name);
+  tweak_interned_string_release(pair->uri);
+  free(pair);
 }
 
-static char* add_name_mapping(const char* uri, const char* name) {
+static const char* add_mapping(const char* name, const char* uri) {
   struct name_uri_pair* pair = NULL;
+  HASH_FIND_STR(s_name_uri_pairs, name, pair);
+  if (pair != NULL) {
+    TWEAK_FATAL("duplicate name");
+  }
   HASH_FIND_STR(s_uri_name_pairs, uri, pair);
   if (pair != NULL) {
     TWEAK_FATAL("duplicate name");
   }
-  pair = malloc(sizeof(*pair));
-  if (pair == NULL) {
-    TWEAK_FATAL("malloc() returned NULL");
+  tweak_interned_string interned_name = tweak_intern_string(name);
+  tweak_interned_string interned_uri = tweak_intern_string(uri);
+  if (interned_name == NULL || interned_uri == NULL) {
+    TWEAK_FATAL("tweak_intern_string() returned NULL");
   }
-  char* name_dup = strdup(name);
-  size_t length = strlen(uri);
-  char* uri_dup = strdup(uri);
-  pair->name = name_dup;
-  pair->uri = uri_dup;
-  HASH_ADD_KEYPTR(hh, s_uri_name_pairs, uri_dup, length, pair);
-  return name_dup;
+  pair = create_pair(interned_name, interned_uri);
+  HASH_ADD_KEYPTR(hh, s_name_uri_pairs, tweak_interned_string_c_str(pair->name),
+    tweak_interned_string_length(pair->name), pair);
+  pair = create_pair(interned_name, interned_uri);
+  HASH_ADD_KEYPTR(hh, s_uri_name_pairs, tweak_interned_string_c_str(pair->uri),
+    tweak_interned_string_length(pair->uri), pair);
+  tweak_interned_string_release(interned_name);
+  tweak_interned_string_release(interned_uri);
+  return tweak_interned_string_c_str(pair->uri);
 }
 
-static char* get_uri(const char* name);
+static const char* get_uri(const char* name);
 
 static const char* map_uri(const char* layout_name, const char* name) {
   if (!name) {
@@ -143,13 +152,12 @@ static const char* map_uri(const char* layout_name, const char* name) {
     }
     strcat(s_uri_concat_buffer, name);
   }
-  uri = add_uri_mapping(name, s_uri_concat_buffer);
-  add_name_mapping(s_uri_concat_buffer, name);
+  uri = add_mapping(name, s_uri_concat_buffer);
   tweak_common_rwlock_write_unlock(&s_name_uri_lock);
   return uri;
 }
 
-static char* get_uri(const char* name) {
+static const char* get_uri(const char* name) {
   if (!name) {
     TWEAK_FATAL("name is NULL");
   }
@@ -160,10 +168,10 @@ static char* get_uri(const char* name) {
   if (pair == NULL) {
     return NULL;
   }
-  return pair->uri;
+  return tweak_interned_string_c_str(pair->uri);
 }
 
-static char* get_name(const char* uri) {
+static const char* get_name(const char* uri) {
   if (!uri) {
     TWEAK_FATAL("uri is NULL");
   }
@@ -174,7 +182,7 @@ static char* get_name(const char* uri) {
   if (pair == NULL) {
     return NULL;
   }
-  return pair->name;
+  return tweak_interned_string_c_str(pair->name);
 }
 
 void tweak_on_update(const char* name) {
@@ -266,16 +274,12 @@ void tweak_close() {
   struct name_uri_pair *tmp = NULL;
   HASH_ITER(hh, s_name_uri_pairs, pair, tmp) {
     HASH_DEL(s_name_uri_pairs, pair);
-    free(pair->name);
-    free(pair->uri);
-    free(pair);
+    destroy_pair(pair);
   }
   s_name_uri_pairs = NULL;
   HASH_ITER(hh, s_uri_name_pairs, pair, tmp) {
     HASH_DEL(s_uri_name_pairs, pair);
-    free(pair->name);
-    free(pair->uri);
-    free(pair);
+    destroy_pair(pair);
   }
   s_uri_name_pairs = NULL;
   tweak_common_rwlock_write_unlock(&s_name_uri_lock);
@@ -73,6 +73,40 @@ extern "C" {
  */
 void tweak_initialize_library(const char *context_type, const char *params, const char *uri);
 
+/**
+ * @brief Descriptor encapsulating parameters for library initialization.
+ */
+struct tweak_initialize_library_ex_desc {
+  /**
+   * @brief context_type parameter of @see tweak_initialize_library.
+   */
+  const char* context_type;
+  /**
+   * @brief params parameter of @see tweak_initialize_library.
+   */
+  const char* params;
+  /**
+   * @brief uri parameter of @see tweak_initialize_library.
+   */
+  const char* uri;
+  /**
+   * @brief Fire item change listeners by a dedicated dispatch thread of the library
+   * rather than within context of an RPC call, see @see tweak_item_change_listener.
+   * false by default.
+   */
+  bool dispatch_thread;
+};
+
+/**
+ * @brief Initialize Tweak Library with extended parameters.
+ *
+ * @details Same as @see tweak_initialize_library, which is equivalent
+ * to this call with all optional fields of @p desc set to 0.
+ *
+ * @param desc initialization parameters.
+ */
+void tweak_initialize_library_ex(const struct tweak_initialize_library_ex_desc* desc);
+
 /**
  * @brief Listener for item change events.
  *
@@ -87,6 +121,13 @@ void tweak_initialize_library(const char *context_type, const char *params, cons
  * between client and server. Some implementations could have their IO buffers being clogged
  * with outdated packets. Either way, behaviour is undefined.
  *
+ * If library has been initialized with @p dispatch_thread flag of
+ * @see tweak_initialize_library_ex_desc, callbacks are fired by a dedicated dispatch thread
+ * of the library instead, one at a time. RPC requests are received and applied independently then,
+ * so a slow callback delays further callbacks only. If an item is changed several times while its
+ * callback is pending, the changes are coalesced and the callback is fired once. Thus, callback
+ * shall read the latest value of an item rather than assume it's called for every intermediate value.
+ *
  * User could do tweak_get*() call here.
  *
  * User could do tweak_set*() call here if it doesn't cause infinite exchange of packets
@@ -104,6 +145,71 @@ typedef void (*tweak_item_change_listener)(tweak_id tweak_id, void* cookie);
  */
 void tweak_set_item_change_listener(tweak_item_change_listener item_change_listener, void* cookie);
 
+/**
+ * @brief Read only view of item's new value passed to @see tweak_item_change_listener_ex.
+ *
+ * Pointers are valid only until the listener returns.
+ */
+struct tweak_item_value_view {
+  /**
+   * @brief Type of the value. Scalar values are stored in @p scalar field,
+   * vectors and strings are referred by @p vector field.
+   */
+  tweak_variant_type type;
+  /**
+   * @brief Scalar value, member is selected by @p type.
+   */
+  union {
+    bool b;
+    int8_t sint8;
+    int16_t sint16;
+    int32_t sint32;
+    int64_t sint64;
+    uint8_t uint8;
+    uint16_t uint16;
+    uint32_t uint32;
+    uint64_t uint64;
+    float fp32;
+    double fp64;
+  } scalar;
+  /**
+   * @brief Elements of vector value or '\0' terminated characters of string value.
+   */
+  struct {
+    /**
+     * @brief Pointer to the first element. Element type is selected by @p type.
+     */
+    const void* data;
+    /**
+     * @brief Number of vector elements or string length.
+     */
+    size_t count;
+  } vector;
+};
+
+/**
+ * @brief Listener for item change events receiving the new value.
+ *
+ * Same as @see tweak_item_change_listener, but the value is passed to the callback,
+ * so there's no need to call tweak_get*() to fetch it.
+ *
+ * @param tweak_id id of an entry recently updated.
+ * @param value new value of the entry.
+ * @param cookie user parameter passed as parameter to @see tweak_set_item_change_listener_ex.
+ */
+typedef void (*tweak_item_change_listener_ex)(tweak_id tweak_id,
+  const struct tweak_item_value_view* value, void* cookie);
+
+/**
+ * @brief Set listener receiving changes of items that don't have their own listener.
+ * It's invoked in addition to the one set by @see tweak_set_item_change_listener.
+ *
+ * @param item_change_listener procedure to invoke upon item change initiated by remote side.
+ *
+ * @param cookie user parameter to pass into @p item_change_listener.
+ */
+void tweak_set_item_change_listener_ex(tweak_item_change_listener_ex item_change_listener, void* cookie);
+
 /**
  * @brief Find id of a tweak given its @p uri.
  *
@@ -113,6 +219,9 @@ tweak_id tweak_find_id(const char* uri);
 
 /**
  * @brief Descriptor encapsulating most parameters for item creation except initial value.
+ *
+ * @details Fields may be appended by later library versions, so the descriptor
+ * should be initialized with designated initializers or zeroed.
  */
 struct tweak_add_item_ex_desc {
   /**
@@ -132,9 +241,14 @@ struct tweak_add_item_ex_desc {
    */
   tweak_item_change_listener item_change_listener;
   /**
-   * @brief user parameter to pass into item_change_listener.
+   * @brief user parameter to pass into item_change_listener or item_change_listener_ex.
    */
   void* cookie;
+  /**
+   * @brief procedure to invoke upon item change initiated by remote side,
+   * receiving the new value. Takes precedence over item_change_listener.
+   */
+  tweak_item_change_listener_ex item_change_listener_ex;
 };
 
 /**
@@ -752,6 +866,164 @@ void tweak_get_vector_float(tweak_id id, float* buffer);
 void tweak_get_vector_double(tweak_id id, double* buffer);
 /**@}*/
 
+/**@{*/
+/**
+ * @brief Updates a range of elements of a vector with int8_t items in place.
+ * Only updated range is sent to peers supporting partial updates.
+ *
+ * @param id value returned by respective tweak_create_vector_* function.
+ *
+ * @param offset index of the first element to update.
+ *
+ * @param count number of elements to update. Range shall fit into the vector.
+ *
+ * @param buffer new data for @p count elements.
+ */
+void tweak_set_vector_range_sint8(tweak_id id, size_t offset, size_t count, const int8_t* buffer);
+
+/**
+ * @brief Updates a range of elements of a vector with int16_t items in place.
+ * @copydetails tweak_set_vector_range_sint8(tweak_id, size_t, size_t, const int8_t*)
+ */
+void tweak_set_vector_range_sint16(tweak_id id, size_t offset, size_t count, const int16_t* buffer);
+
+/**
+ * @brief Updates a range of elements of a vector with int32_t items in place.
+ * @copydetails tweak_set_vector_range_sint8(tweak_id, size_t, size_t, const int8_t*)
+ */
+void tweak_set_vector_range_sint32(tweak_id id, size_t offset, size_t count, const int32_t* buffer);
+
+/**
+ * @brief Updates a range of elements of a vector with int64_t items in place.
+ * @copydetails tweak_set_vector_range_sint8(tweak_id, size_t, size_t, const int8_t*)
+ */
+void tweak_set_vector_range_sint64(tweak_id id, size_t offset, size_t count, const int64_t* buffer);
+
+/**
+ * @brief Updates a range of elements of a vector with uint8_t items in place.
+ * @copydetails tweak_set_vector_range_sint8(tweak_id, size_t, size_t, const int8_t*)
+ */
+void tweak_set_vector_range_uint8(tweak_id id, size_t offset, size_t count, const uint8_t* buffer);
+
+/**
+ * @brief Updates a range of elements of a vector with uint16_t items in place.
+ * @copydetails tweak_set_vector_range_sint8(tweak_id, size_t, size_t, const int8_t*)
+ */
+void tweak_set_vector_range_uint16(tweak_id id, size_t offset, size_t count, const uint16_t* buffer);
+
+/**
+ * @brief Updates a range of elements of a vector with uint32_t items in place.
+ * @copydetails tweak_set_vector_range_sint8(tweak_id, size_t, size_t, const int8_t*)
+ */
+void tweak_set_vector_range_uint32(tweak_id id, size_t offset, size_t count, const uint32_t* buffer);
+
+/**
+ * @brief Updates a range of elements of a vector with uint64_t items in place.
+ * @copydetails tweak_set_vector_range_sint8(tweak_id, size_t, size_t, const int8_t*)
+ */
+void tweak_set_vector_range_uint64(tweak_id id, size_t offset, size_t count, const uint64_t* buffer);
+
+/**
+ * @brief Updates a range of elements of a vector with float items in place.
+ * @copydetails tweak_set_vector_range_sint8(tweak_id, size_t, size_t, const int8_t*)
+ */
+void tweak_set_vector_range_float(tweak_id id, size_t offset, size_t count, const float* buffer);
+
+/**
+ * @brief Updates a range of elements of a vector with double items in place.
+ * @copydetails tweak_set_vector_range_sint8(tweak_id, size_t, size_t, const int8_t*)
+ */
+void tweak_set_vector_range_double(tweak_id id, size_t offset, size_t count, const double* buffer);
+/**@}*/
+
+/**@{*/
+/**
+ * @brief Extracts a range of elements from a vector of int8_t elements
+ * to an external array.
+ *
+ * @param id value returned by respective tweak_create_vector_* function.
+ *
+ * @param offset index of the first element to extract.
+ *
+ * @param count number of elements to extract. Range shall fit into the vector.
+ *
+ * @param buffer buffer to place @p count elements.
+ */
+void tweak_get_vector_range_sint8(tweak_id id, size_t offset, size_t count, int8_t* buffer);
+
+/**
+ * @brief Extracts a range of elements from a vector of int16_t elements
+ * to an external array.
+ *
+ * @copydetails tweak_get_vector_range_sint8(tweak_id, size_t, size_t, int8_t*)
+ */
+void tweak_get_vector_range_sint16(tweak_id id, size_t offset, size_t count, int16_t* buffer);
+
+/**
+ * @brief Extracts a range of elements from a vector of int32_t elements
+ * to an external array.
+ *
+ * @copydetails tweak_get_vector_range_sint8(tweak_id, size_t, size_t, int8_t*)
+ */
+void tweak_get_vector_range_sint32(tweak_id id, size_t offset, size_t count, int32_t* buffer);
+
+/**
+ * @brief Extracts a range of elements from a vector of int64_t elements
+ * to an external array.
+ *
+ * @copydetails tweak_get_vector_range_sint8(tweak_id, size_t, size_t, int8_t*)
+ */
+void tweak_get_vector_range_sint64(tweak_id id, size_t offset, size_t count, int64_t* buffer);
+
+/**
+ * @brief Extracts a range of elements from a vector of uint8_t elements
+ * to an external array.
+ *
+ * @copydetails tweak_get_vector_range_sint8(tweak_id, size_t, size_t, int8_t*)
+ */
+void tweak_get_vector_range_uint8(tweak_id id, size_t offset, size_t count, uint8_t* buffer);
+
+/**
+ * @brief Extracts a range of elements from a vector of uint16_t elements
+ * to an external array.
+ *
+ * @copydetails tweak_get_vector_range_sint8(tweak_id, size_t, size_t, int8_t*)
+ */
+void tweak_get_vector_range_uint16(tweak_id id, size_t offset, size_t count, uint16_t* buffer);
+
+/**
+ * @brief Extracts a range of elements from a vector of uint32_t elements
+ * to an external array.
+ *
+ * @copydetails tweak_get_vector_range_sint8(tweak_id, size_t, size_t, int8_t*)
+ */
+void tweak_get_vector_range_uint32(tweak_id id, size_t offset, size_t count, uint32_t* buffer);
+
+/**
+ * @brief Extracts a range of elements from a vector of uint64_t elements
+ * to an external array.
+ *
+ * @copydetails tweak_get_vector_range_sint8(tweak_id, size_t, size_t, int8_t*)
+ */
+void tweak_get_vector_range_uint64(tweak_id id, size_t offset, size_t count, uint64_t* buffer);
+
+/**
+ * @brief Extracts a range of elements from a vector of float elements
+ * to an external array.
+ *
+ * @copydetails tweak_get_vector_range_sint8(tweak_id, size_t, size_t, int8_t*)
+ */
+void tweak_get_vector_range_float(tweak_id id, size_t offset, size_t count, float* buffer);
+
+/**
+ * @brief Extracts a range of elements from a vector of double elements
+ * to an external array.
+ *
+ * @copydetails tweak_get_vector_range_sint8(tweak_id, size_t, size_t, int8_t*)
+ */
+void tweak_get_vector_range_double(tweak_id id, size_t offset, size_t count, double* buffer);
+/**@}*/
+
 /**
  * @brief Returns number of elements in a vector passed
  * to respective tweak_create_vector_ function.
@@ -796,6 +1068,360 @@ void tweak_set_string(tweak_id id, const char* string);
  */
 size_t tweak_get_string(tweak_id id, char* buffer, size_t size);
 
+/**
+ * @brief Direct reference to an item, see @ref tweak_acquire_handle.
+ */
+typedef uint64_t tweak_handle;
+
+enum {
+  /**
+   * @brief Default value for @p tweak_handle or error indicator.
+   */
+  TWEAK_INVALID_HANDLE = 0
+};
+
+/**
+ * @brief Acquire handle of an item given its @p id.
+ *
+ * @details tweak_get_* and tweak_set_* calls find an item by its tweak_id
+ * every time they're called. Handle refers to an item directly,
+ * so it is preferable to use tweak_get_*_by_handle and tweak_set_*_by_handle
+ * in hot paths accessing the same items repeatedly.
+ *
+ * Handle doesn't own any resources, so there's no need to release it.
+ * Handle of a removed item is invalidated: accessors would log an error
+ * and act as if tweak_id of a removed item was passed to them.
+ *
+ * @param id the id of an item.
+ *
+ * @return handle or @p TWEAK_INVALID_HANDLE if there's no such item.
+ */
+tweak_handle tweak_acquire_handle(tweak_id id);
+
+/**
+ * @{
+ * @brief Alters value of an existing item given its handle and a new value.
+ *
+ * @details Same as tweak_set_scalar_bool, but doesn't perform a lookup by tweak_id.
+ *
+ * @param handle handle of an item being altered.
+ *
+ * @param value new value.
+ */
+void tweak_set_scalar_bool_by_handle(tweak_handle handle, bool value);
+
+/**
+ * @brief Alters value of an existing item having int8_t type given its handle and new value.
+ *
+ * @copydetails tweak_set_scalar_bool_by_handle(tweak_handle, value)
+ */
+void tweak_set_scalar_int8_by_handle(tweak_handle handle, int8_t value);
+
+/**
+ * @brief Alters value of an existing item having int16_t type given its handle and new value.
+ *
+ * @copydetails tweak_set_scalar_bool_by_handle(tweak_handle, value)
+ */
+void tweak_set_scalar_int16_by_handle(tweak_handle handle, int16_t value);
+
+/**
+ * @brief Alters value of an existing item having int32_t type given its handle and new value.
+ *
+ * @copydetails tweak_set_scalar_bool_by_handle(tweak_handle, value)
+ */
+void tweak_set_scalar_int32_by_handle(tweak_handle handle, int32_t value);
+
+/**
+ * @brief Alters value of an existing item having int64_t type given its handle and new value.
+ *
+ * @copydetails tweak_set_scalar_bool_by_handle(tweak_handle, value)
+ */
+void tweak_set_scalar_int64_by_handle(tweak_handle handle, int64_t value);
+
+/**
+ * @brief Alters value of an existing item having uint8_t type given its handle and new value.
+ *
+ * @copydetails tweak_set_scalar_bool_by_handle(tweak_handle, value)
+ */
+void tweak_set_scalar_uint8_by_handle(tweak_handle handle, uint8_t value);
+
+/**
+ * @brief Alters value of an existing item having uint16_t type given its handle and new value.
+ *
+ * @copydetails tweak_set_scalar_bool_by_handle(tweak_handle, value)
+ */
+void tweak_set_scalar_uint16_by_handle(tweak_handle handle, uint16_t value);
+
+/**
+ * @brief Alters value of an existing item having uint32_t type given its handle and new value.
+ *
+ * @copydetails tweak_set_scalar_bool_by_handle(tweak_handle, value)
+ */
+void tweak_set_scalar_uint32_by_handle(tweak_handle handle, uint32_t value);
+
+/**
+ * @brief Alters value of an existing item having uint64_t type given its handle and new value.
+ *
+ * @copydetails tweak_set_scalar_bool_by_handle(tweak_handle, value)
+ */
+void tweak_set_scalar_uint64_by_handle(tweak_handle handle, uint64_t value);
+
+/**
+ * @brief Alters value of an existing item having float type given its handle and new value.
+ *
+ * @copydetails tweak_set_scalar_bool_by_handle(tweak_handle, value)
+ */
+void tweak_set_scalar_float_by_handle(tweak_handle handle, float value);
+
+/**
+ * @brief Alters value of an existing item having double type given its handle and new value.
+ *
+ * @copydetails tweak_set_scalar_bool_by_handle(tweak_handle, value)
+ */
+void tweak_set_scalar_double_by_handle(tweak_handle handle, double value);
+
+/**
+ * @}
+ */
+
+/**
+ * @{
+ * @brief Fetch current_value of an item given its handle.
+ *
+ * @details Same as tweak_get_scalar_bool, but doesn't perform a lookup by tweak_id.
+ * This function never blocks.
+ *
+ * @param handle handle of an item.
+ *
+ * @return item's value.
+ */
+bool tweak_get_scalar_bool_by_handle(tweak_handle handle);
+
+/**
+ * @brief Fetch current_value of item having int8_t type given its handle.
+ *
+ * @copydetails tweak_get_scalar_bool_by_handle(tweak_handle)
+ */
+int8_t tweak_get_scalar_int8_by_handle(tweak_handle handle);
+
+/**
+ * @brief Fetch current_value of item having int16_t type given its handle.
+ *
+ * @copydetails tweak_get_scalar_bool_by_handle(tweak_handle)
+ */
+int16_t tweak_get_scalar_int16_by_handle(tweak_handle handle);
+
+/**
+ * @brief Fetch current_value of item having int32_t type given its handle.
+ *
+ * @copydetails tweak_get_scalar_bool_by_handle(tweak_handle)
+ */
+int32_t tweak_get_scalar_int32_by_handle(tweak_handle handle);
+
+/**
+ * @brief Fetch current_value of item having int64_t type given its handle.
+ *
+ * @copydetails tweak_get_scalar_bool_by_handle(tweak_handle)
+ */
+int64_t tweak_get_scalar_int64_by_handle(tweak_handle handle);
+
+/**
+ * @brief Fetch current_value of item having uint8_t type given its handle.
+ *
+ * @copydetails tweak_get_scalar_bool_by_handle(tweak_handle)
+ */
+uint8_t tweak_get_scalar_uint8_by_handle(tweak_handle handle);
+
+/**
+ * @brief Fetch current_value of item having uint16_t type given its handle.
+ *
+ * @copydetails tweak_get_scalar_bool_by_handle(tweak_handle)
+ */
+uint16_t tweak_get_scalar_uint16_by_handle(tweak_handle handle);
+
+/**
+ * @brief Fetch current_value of item having uint32_t type given its handle.
+ *
+ * @copydetails tweak_get_scalar_bool_by_handle(tweak_handle)
+ */
+uint32_t tweak_get_scalar_uint32_by_handle(tweak_handle handle);
+
+/**
+ * @brief Fetch current_value of item having uint64_t type given its handle.
+ *
+ * @copydetails tweak_get_scalar_bool_by_handle(tweak_handle)
+ */
+uint64_t tweak_get_scalar_uint64_by_handle(tweak_handle handle);
+
+/**
+ * @brief Fetch current_value of item having float type given its handle.
+ *
+ * @copydetails tweak_get_scalar_bool_by_handle(tweak_handle)
+ */
+float tweak_get_scalar_float_by_handle(tweak_handle handle);
+
+/**
+ * @brief Fetch current_value of item having double type given its handle.
+ *
+ * @copydetails tweak_get_scalar_bool_by_handle(tweak_handle)
+ */
+double tweak_get_scalar_double_by_handle(tweak_handle handle);
+
+/**
+ * @}
+ */
+
+/**@{*/
+/**
+ * @brief Updates a vector with int8_t items given its handle.
+ *
+ * @param handle handle of an item created by respective tweak_create_vector_* function.
+ *
+ * @param buffer new data to store in given vector of the same size that
+ * was passed to create.
+ */
+void tweak_set_vector_sint8_by_handle(tweak_handle handle, const int8_t* buffer);
+
+/**
+ * @brief Updates a vector with int16_t items given its handle.
+ * @copydetails tweak_set_vector_sint8_by_handle(tweak_handle, const int8_t*)
+ */
+void tweak_set_vector_sint16_by_handle(tweak_handle handle, const int16_t* buffer);
+
+/**
+ * @brief Updates a vector with int32_t items given its handle.
+ * @copydetails tweak_set_vector_sint8_by_handle(tweak_handle, const int8_t*)
+ */
+void tweak_set_vector_sint32_by_handle(tweak_handle handle, const int32_t* buffer);
+
+/**
+ * @brief Updates a vector with int64_t items given its handle.
+ * @copydetails tweak_set_vector_sint8_by_handle(tweak_handle, const int8_t*)
+ */
+void tweak_set_vector_sint64_by_handle(tweak_handle handle, const int64_t* buffer);
+
+/**
+ * @brief Updates a vector with uint8_t items given its handle.
+ * @copydetails tweak_set_vector_sint8_by_handle(tweak_handle, const int8_t*)
+ */
+void tweak_set_vector_uint8_by_handle(tweak_handle handle, const uint8_t* buffer);
+
+/**
+ * @brief Updates a vector with uint16_t items given its handle.
+ * @copydetails tweak_set_vector_sint8_by_handle(tweak_handle, const int8_t*)
+ */
+void tweak_set_vector_uint16_by_handle(tweak_handle handle, const uint16_t* buffer);
+
+/**
+ * @brief Updates a vector with uint32_t items given its handle.
+ * @copydetails tweak_set_vector_sint8_by_handle(tweak_handle, const int8_t*)
+ */
+void tweak_set_vector_uint32_by_handle(tweak_handle handle, const uint32_t* buffer);
+
+/**
+ * @brief Updates a vector with uint64_t items given its handle.
+ * @copydetails tweak_set_vector_sint8_by_handle(tweak_handle, const int8_t*)
+ */
+void tweak_set_vector_uint64_by_handle(tweak_handle handle, const uint64_t* buffer);
+
+/**
+ * @brief Updates a vector with float items given its handle.
+ * @copydetails tweak_set_vector_sint8_by_handle(tweak_handle, const int8_t*)
+ */
+void tweak_set_vector_float_by_handle(tweak_handle handle, const float* buffer);
+
+/**
+ * @brief Updates a vector with double items given its handle.
+ * @copydetails tweak_set_vector_sint8_by_handle(tweak_handle, const int8_t*)
+ */
+void tweak_set_vector_double_by_handle(tweak_handle handle, const double* buffer);
+/**@}*/
+
+/**@{*/
+/**
+ * @brief Extracts data from a vector of int8_t elements
+ * given its handle to an external array.
+ *
+ * @param handle handle of an item created by respective tweak_create_vector_* function.
+ *
+ * @param buffer buffer to place data of the same size that
+ * was passed to create.
+ */
+void tweak_get_vector_sint8_by_handle(tweak_handle handle, int8_t* buffer);
+
+/**
+ * @brief Extracts data from a vector of int16_t elements
+ * given its handle to an external array.
+ *
+ * @copydetails tweak_get_vector_sint8_by_handle(tweak_handle, int8_t*)
+ */
+void tweak_get_vector_sint16_by_handle(tweak_handle handle, int16_t* buffer);
+
+/**
+ * @brief Extracts data from a vector of int32_t elements
+ * given its handle to an external array.
+ *
+ * @copydetails tweak_get_vector_sint8_by_handle(tweak_handle, int8_t*)
+ */
+void tweak_get_vector_sint32_by_handle(tweak_handle handle, int32_t* buffer);
+
+/**
+ * @brief Extracts data from a vector of int64_t elements
+ * given its handle to an external array.
+ *
+ * @copydetails tweak_get_vector_sint8_by_handle(tweak_handle, int8_t*)
+ */
+void tweak_get_vector_sint64_by_handle(tweak_handle handle, int64_t* buffer);
+
+/**
+ * @brief Extracts data from a vector of uint8_t elements
+ * given its handle to an external array.
+ *
+ * @copydetails tweak_get_vector_sint8_by_handle(tweak_handle, int8_t*)
+ */
+void tweak_get_vector_uint8_by_handle(tweak_handle handle, uint8_t* buffer);
+
+/**
+ * @brief Extracts data from a vector of uint16_t elements
+ * given its handle to an external array.
+ *
+ * @copydetails tweak_get_vector_sint8_by_handle(tweak_handle, int8_t*)
+ */
+void tweak_get_vector_uint16_by_handle(tweak_handle handle, uint16_t* buffer);
+
+/**
+ * @brief Extracts data from a vector of uint32_t elements
+ * given its handle to an external array.
+ *
+ * @copydetails tweak_get_vector_sint8_by_handle(tweak_handle, int8_t*)
+ */
+void tweak_get_vector_uint32_by_handle(tweak_handle handle, uint32_t* buffer);
+
+/**
+ * @brief Extracts data from a vector of uint64_t elements
+ * given its handle to an external array.
+ *
+ * @copydetails tweak_get_vector_sint8_by_handle(tweak_handle, int8_t*)
+ */
+void tweak_get_vector_uint64_by_handle(tweak_handle handle, uint64_t* buffer);
+
+/**
+ * @brief Extracts data from a vector of float elements
+ * given its handle to an external array.
+ *
+ * @copydetails tweak_get_vector_sint8_by_handle(tweak_handle, int8_t*)
+ */
+void tweak_get_vector_float_by_handle(tweak_handle handle, float* buffer);
+
+/**
+ * @brief Extracts data from a vector of double elements
+ * given its handle to an external array.
+ *
+ * @copydetails tweak_get_vector_sint8_by_handle(tweak_handle, int8_t*)
+ */
+void tweak_get_vector_double_by_handle(tweak_handle handle, double* buffer);
+/**@}*/
+
 /**
  * @brief remove an item from internal collection given its @p id.
  *
@@ -811,6 +1437,33 @@ size_t tweak_get_string(tweak_id id, char* buffer, size_t size);
  */
 void tweak_remove(tweak_id id);
 
+/**
+ * @brief Start collecting updates of the calling thread into a batch.
+ *
+ * @details Until tweak_commit_batch is called by the same thread, its tweak_set_scalar_*,
+ * tweak_set_vector_* and tweak_set_string calls don't alter items. Their values are
+ * staged instead, the last one wins if an item is set more than once. Calls addressed
+ * by handle and tweak_set_vector_range_* calls aren't staged and take effect immediately.
+ *
+ * The batch belongs to the calling thread: values set by other threads take effect
+ * immediately as usual, each thread can have a batch of its own.
+ * Batches can't be nested, the call is ignored if the thread has already started a batch.
+ */
+void tweak_begin_batch();
+
+/**
+ * @brief Apply all values staged by the calling thread since tweak_begin_batch at once.
+ *
+ * @details Values are applied under a single lock, so connected client never observes
+ * a partially applied set, and they are sent in one message to clients supporting it.
+ * If any of staged items doesn't exist anymore, none of the values staged by the thread
+ * is applied, see log for details.
+ *
+ * @note Values staged by a thread which exits without calling this method are lost
+ * and their storage isn't reclaimed.
+ */
+void tweak_commit_batch();
+
 /**
  * @brief free library and deallocate all resources.
  */
@@ -858,6 +1511,19 @@ tweak_default_client_item_changed_listener_t tweak_create_default_client_item_ch
   tweak_item_change_listener client_callback,
   void* client_cookie);
 
+/**
+ * @brief Same as @see tweak_create_default_client_item_changed_listener,
+ * but @p client_callback receives the new value.
+ *
+ * @param client_callback procedure to invoke upon item change initiated by remote side.
+ * @param cookie custom parameter to pass to client callback.
+ *
+ * @return new listener or NULL if internal malloc() returned NULL.
+ */
+tweak_default_client_item_changed_listener_t tweak_create_default_client_item_changed_listener_ex(
+  tweak_item_change_listener_ex client_callback,
+  void* client_cookie);
+
 #ifdef __cplusplus
 }
 #endif
@@ -27,6 +27,7 @@
 
 #include <tweak2/tweak2.h>
 #include <tweak2/appserver.h>
+#include <tweak2/idmap.h>
 #include <tweak2/log.h>
 #include <tweak2/buffer.h>
 #include <tweak2/variant.h>
@@ -39,6 +40,7 @@
 
 struct tweak_default_client_item_changed_listener {
   tweak_item_change_listener client_callback;
+  tweak_item_change_listener_ex client_callback_ex;
   void* client_cookie;
 };
 
@@ -52,10 +54,43 @@ tweak_default_client_item_changed_listener_t tweak_create_default_client_item_ch
   }
 
   result->client_callback = client_callback;
+  result->client_callback_ex = NULL;
   result->client_cookie = client_cookie;
   return result;
 }
 
+tweak_default_client_item_changed_listener_t tweak_create_default_client_item_changed_listener_ex(
+  tweak_item_change_listener_ex client_callback,
+  void* client_cookie)
+{
+  tweak_default_client_item_changed_listener_t result = malloc(sizeof(*result));
+  if (result == NULL) {
+    return NULL;
+  }
+
+  result->client_callback = NULL;
+  result->client_callback_ex = client_callback;
+  result->client_cookie = client_cookie;
+  return result;
+}
+
+static tweak_default_client_item_changed_listener_t create_client_listener(
+  const struct tweak_add_item_ex_desc* desc)
+{
+  tweak_default_client_item_changed_listener_t result = NULL;
+  if (desc->item_change_listener_ex != NULL) {
+    result = tweak_create_default_client_item_changed_listener_ex(desc->item_change_listener_ex, desc->cookie);
+  } else if (desc->item_change_listener != NULL) {
+    result = tweak_create_default_client_item_changed_listener(desc->item_change_listener, desc->cookie);
+  } else {
+    return NULL;
+  }
+  if (!result) {
+    TWEAK_FATAL("Can't allocate memory");
+  }
+  return result;
+}
+
 static tweak_app_server_context s_context = NULL;
 
 static inline bool invalid_context() {
@@ -70,21 +105,90 @@ static tweak_item_change_listener s_item_change_listener = NULL;
 
 static void* s_item_change_listener_cookie = NULL;
 
+static tweak_item_change_listener_ex s_item_change_listener_ex = NULL;
+
+static void* s_item_change_listener_ex_cookie = NULL;
+
 static char *s_context_type = NULL;
 
 static char *s_params = NULL;
 
 static char *s_uri = NULL;
 
+static bool s_dispatch_thread = false;
+
+/**
+ * @brief Values staged between tweak_begin_batch and tweak_commit_batch.
+ *
+ * @details @p index maps ids to positions in @p ids and @p values.
+ */
+struct staged_batch {
+  bool active;
+  tweak_id* ids;
+  tweak_variant* values;
+  struct tweak_id_map index;
+  size_t size;
+  size_t capacity;
+};
+
+/**
+ * @brief Batch of the calling thread, values set by other threads bypass it.
+ */
+static TWEAK_COMMON_THREAD_LOCAL struct staged_batch s_batch = { 0 };
+
+static void fill_value_view(const tweak_variant* value, struct tweak_item_value_view* view) {
+  memset(view, 0, sizeof(*view));
+  view->type = value->type;
+  switch (value->type) {
+  case TWEAK_VARIANT_TYPE_BOOL:
+    view->scalar.b = value->value.b;
+    break;
+  case TWEAK_VARIANT_TYPE_SINT8:
+    view->scalar.sint8 = value->value.sint8;
+    break;
+  case TWEAK_VARIANT_TYPE_SINT16:
+    view->scalar.sint16 = value->value.sint16;
+    break;
+  case TWEAK_VARIANT_TYPE_SINT32:
+    view->scalar.sint32 = value->value.sint32;
+    break;
+  case TWEAK_VARIANT_TYPE_SINT64:
+    view->scalar.sint64 = value->value.sint64;
+    break;
+  case TWEAK_VARIANT_TYPE_UINT8:
+    view->scalar.uint8 = value->value.uint8;
+    break;
+  case TWEAK_VARIANT_TYPE_UINT16:
+    view->scalar.uint16 = value->value.uint16;
+    break;
+  case TWEAK_VARIANT_TYPE_UINT32:
+    view->scalar.uint32 = value->value.uint32;
+    break;
+  case TWEAK_VARIANT_TYPE_UINT64:
+    view->scalar.uint64 = value->value.uint64;
+    break;
+  case TWEAK_VARIANT_TYPE_FLOAT:
+    view->scalar.fp32 = value->value.fp32;
+    break;
+  case TWEAK_VARIANT_TYPE_DOUBLE:
+    view->scalar.fp64 = value->value.fp64;
+    break;
+  case TWEAK_VARIANT_TYPE_STRING:
+    view->vector.data = tweak_variant_string_c_str(&value->value.string);
+    view->vector.count = value->value.string.length;
+    break;
+  case TWEAK_VARIANT_TYPE_NULL:
+    break;
+  default:
+    view->vector.data = tweak_buffer_get_data_const(&value->value.buffer);
+    view->vector.count = tweak_variant_get_item_count(value);
+    break;
+  }
+}
+
 static void on_current_value_changed(tweak_app_context context,
   tweak_id id, tweak_variant* value, void *cookie)
 {
-  (void)value;                  /* This parameter would be quite useful if existing design allowed to pass */
-                                /* updated value straight to the callback removing the necessity to */
-                                /* invoke tweak_get_* method to access updated value. Hovewer, this */
-                                /* decision would imply to drag tweakvariant.h stuff into public API */
-                                /* of the library, whilst it is designed to be as simple as possible. */
-
   (void)cookie;                 /* This parameter would be quite useful if underlying tweak_app API */
                                 /* allowed to alter this cookie at runtime, and by that allowing this */
                                 /* library to embed item_change_listener and its cookie in user context */
@@ -92,21 +196,35 @@ static void on_current_value_changed(tweak_app_context context,
                                 /* However, it is only specified only upon creation and tweak_set_item_change_listener */
                                 /* can't change it.*/
 
+  struct tweak_item_value_view value_view;
   void* item_cookie = tweak_app_item_get_cookie((tweak_app_server_context)context, id);
   if (item_cookie != NULL) {
     tweak_default_client_item_changed_listener_t client_listener = (tweak_default_client_item_changed_listener_t) item_cookie;
-    assert(client_listener->client_callback);
-    client_listener->client_callback(id, client_listener->client_cookie);
+    if (client_listener->client_callback_ex) {
+      fill_value_view(value, &value_view);
+      client_listener->client_callback_ex(id, &value_view, client_listener->client_cookie);
+    } else {
+      assert(client_listener->client_callback);
+      client_listener->client_callback(id, client_listener->client_cookie);
+    }
   } else {
     tweak_item_change_listener item_change_listener;
     void* item_change_listener_cookie;
+    tweak_item_change_listener_ex item_change_listener_ex;
+    void* item_change_listener_ex_cookie;
     tweak_common_mutex_lock(&s_callback_lock);
     item_change_listener = s_item_change_listener;
     item_change_listener_cookie = s_item_change_listener_cookie;
+    item_change_listener_ex = s_item_change_listener_ex;
+    item_change_listener_ex_cookie = s_item_change_listener_ex_cookie;
     tweak_common_mutex_unlock(&s_callback_lock);
     if (item_change_listener != NULL) {
       item_change_listener(id, item_change_listener_cookie);
     }
+    if (item_change_listener_ex != NULL) {
+      fill_value_view(value, &value_view);
+      item_change_listener_ex(id, &value_view, item_change_listener_ex_cookie);
+    }
   }
 }
 
@@ -126,10 +244,23 @@ static void check_finalized(void) {
 void tweak_initialize_library(const char *context_type, const char *params,
   const char *uri)
 {
+  struct tweak_initialize_library_ex_desc desc = {
+    .context_type = context_type,
+    .params = params,
+    .uri = uri
+  };
+  tweak_initialize_library_ex(&desc);
+}
+
+void tweak_initialize_library_ex(const struct tweak_initialize_library_ex_desc* desc) {
+  const char* context_type = desc->context_type;
+  const char* params = desc->params;
+  const char* uri = desc->uri;
   if (s_context != NULL) {
     if ((strings_are_equal(s_context_type, context_type) &&
          strings_are_equal(s_params, params) &&
-         strings_are_equal(s_uri, uri)))
+         strings_are_equal(s_uri, uri) &&
+         s_dispatch_thread == desc->dispatch_thread))
     {
       TWEAK_LOG_DEBUG("Context already initalized");
       return;
@@ -146,13 +277,18 @@ void tweak_initialize_library(const char *context_type, const char *params,
   atexit(&check_finalized);
 
   tweak_app_server_callbacks callbacks = {
-    .on_current_value_changed = &on_current_value_changed
+    .on_current_value_changed = &on_current_value_changed,
+    .callback_dispatch = desc->dispatch_thread
+      ? TWEAK_APP_CALLBACK_DISPATCH_EXECUTOR
+      : TWEAK_APP_CALLBACK_DISPATCH_INLINE
   };
 
   s_context_type = context_type ? strdup(context_type) : NULL;
   s_params = params ? strdup(params) : NULL;
   s_uri = uri ? strdup(uri) : NULL;
 
+  s_dispatch_thread = desc->dispatch_thread;
+
   s_context = tweak_app_create_server_context(s_context_type, s_params, s_uri, &callbacks);
   if (invalid_context()) {
     free(s_context_type);
@@ -165,6 +301,103 @@ void tweak_initialize_library(const char *context_type, const char *params,
   }
 }
 
+static void free_staged_batch(struct staged_batch* batch) {
+  for (size_t ix = 0; ix < batch->size; ++ix) {
+    tweak_variant_destroy(&batch->values[ix]);
+  }
+  free(batch->ids);
+  free(batch->values);
+  tweak_id_map_destroy(&batch->index);
+  memset(batch, 0, sizeof(*batch));
+}
+
+static void grow_staged_batch(struct staged_batch* batch) {
+  size_t new_capacity = batch->capacity ? batch->capacity * 2 : 16;
+  tweak_id* new_ids = realloc(batch->ids, new_capacity * sizeof(*new_ids));
+  if (new_ids) {
+    batch->ids = new_ids;
+  }
+  tweak_variant* new_values = realloc(batch->values, new_capacity * sizeof(*new_values));
+  if (new_values) {
+    batch->values = new_values;
+  }
+  if (!new_ids || !new_values) {
+    TWEAK_FATAL("Can't allocate memory");
+  }
+  batch->capacity = new_capacity;
+}
+
+/* Takes ownership of value if calling thread has started a batch. Value of the item
+ * staged before is handed back to the caller then. */
+static bool stage_value(tweak_id id, tweak_variant* value) {
+  struct staged_batch* batch = &s_batch;
+  if (!batch->active) {
+    return false;
+  }
+  size_t position;
+  if (!tweak_id_map_find(&batch->index, id, &position)) {
+    if (batch->size == batch->capacity) {
+      grow_staged_batch(batch);
+    }
+    position = batch->size;
+    if (!tweak_id_map_insert(&batch->index, id, position)) {
+      TWEAK_FATAL("Can't allocate memory");
+    }
+    batch->ids[position] = id;
+    batch->values[position] = (tweak_variant)TWEAK_VARIANT_INIT_EMPTY;
+    ++batch->size;
+  }
+  tweak_variant_swap(&batch->values[position], value);
+  return true;
+}
+
+static void replace_current_value(const char* func, tweak_id id, tweak_variant* value) {
+  if (stage_value(id, value)) {
+    return;
+  }
+  tweak_app_error_code result = tweak_app_item_replace_current_value((tweak_app_context)s_context, id, value);
+  if (result != TWEAK_APP_SUCCESS) {
+    TWEAK_LOG_ERROR("%s : tweak_app_item_replace_current_value returned 0x%x", func, result);
+  }
+}
+
+void tweak_begin_batch() {
+  if (invalid_context()) {
+    TWEAK_LOG_ERROR("%s : Library hasn't been initialized correctly", __func__);
+    return;
+  }
+
+  if (s_batch.active) {
+    TWEAK_LOG_ERROR("%s : Batch has already been started", __func__);
+  } else {
+    s_batch.active = true;
+  }
+}
+
+void tweak_commit_batch() {
+  if (invalid_context()) {
+    TWEAK_LOG_ERROR("%s : Library hasn't been initialized correctly", __func__);
+    return;
+  }
+
+  if (!s_batch.active) {
+    TWEAK_LOG_ERROR("%s : tweak_begin_batch hasn't been called", __func__);
+    return;
+  }
+
+  if (s_batch.size > 0) {
+    tweak_app_error_code result = tweak_app_item_replace_values((tweak_app_context)s_context,
+      s_batch.ids, s_batch.values, s_batch.size);
+    if (result != TWEAK_APP_SUCCESS) {
+      TWEAK_LOG_ERROR("%s : tweak_app_item_replace_values returned 0x%x", __func__, result);
+    }
+  }
+
+  /* Staging storage isn't kept for the next batch, thread might never start one again
+   * and thread local storage isn't reclaimed when thread exits */
+  free_staged_batch(&s_batch);
+}
+
 void tweak_set_item_change_listener(tweak_item_change_listener item_change_listener, void* cookie) {
   tweak_common_mutex_lock(&s_callback_lock);
   s_item_change_listener = item_change_listener;
@@ -172,6 +405,13 @@ void tweak_set_item_change_listener(tweak_item_change_listener item_change_liste
   tweak_common_mutex_unlock(&s_callback_lock);
 }
 
+void tweak_set_item_change_listener_ex(tweak_item_change_listener_ex item_change_listener, void* cookie) {
+  tweak_common_mutex_lock(&s_callback_lock);
+  s_item_change_listener_ex = item_change_listener;
+  s_item_change_listener_ex_cookie = cookie;
+  tweak_common_mutex_unlock(&s_callback_lock);
+}
+
 #define TWEAK2_IMPLEMENT_SCALAR_TYPE(SUFFIX, T, VARIANT_TYPE_DESC, VARIANT_FIELD, TYPE, DEFAULT_VALUE)                              \
   tweak_id tweak_add_##SUFFIX##_##T##_ex(const struct tweak_add_item_ex_desc* desc, TYPE initial_value)                             \
   {                                                                                                                                 \
@@ -187,15 +427,7 @@ void tweak_set_item_change_listener(tweak_item_change_listener item_change_liste
       }                                                                                                                             \
     };                                                                                                                              \
                                                                                                                                     \
-    tweak_default_client_item_changed_listener_t client_listener = NULL;                                                            \
-    if (desc->item_change_listener != NULL)                                                                                         \
-    {                                                                                                                               \
-      client_listener = tweak_create_default_client_item_changed_listener(desc->item_change_listener, desc->cookie);                \
-      if (!client_listener)                                                                                                         \
-      {                                                                                                                             \
-        TWEAK_FATAL("Can't allocate memory");                                                                                       \
-      }                                                                                                                             \
-    }                                                                                                                               \
+    tweak_default_client_item_changed_listener_t client_listener = create_client_listener(desc);                                    \
     return tweak_app_server_add_item(s_context, desc->uri, desc->description, desc->meta, &variant_value, client_listener);         \
   }                                                                                                                                 \
                                                                                                                                     \
@@ -228,20 +460,58 @@ void tweak_set_item_change_listener(tweak_item_change_listener item_change_liste
       }                                                                                                                             \
     };                                                                                                                              \
                                                                                                                                     \
-    tweak_app_error_code result = tweak_app_item_replace_current_value((tweak_app_context)s_context, id, &variant_value);           \
+    replace_current_value(__func__, id, &variant_value);                                                                            \
+    tweak_variant_destroy(&variant_value);                                                                                          \
+  }                                                                                                                                 \
+                                                                                                                                    \
+  TYPE tweak_get_##SUFFIX##_##T(tweak_id id) {                                                                                      \
+    if (invalid_context()) {                                                                                                        \
+      TWEAK_LOG_ERROR("%s : Library hasn't been initialized correctly", __func__);                                                  \
+      return DEFAULT_VALUE;                                                                                                         \
+    }                                                                                                                               \
+    tweak_variant variant_value = TWEAK_VARIANT_INIT_EMPTY;                                                                         \
+    tweak_app_error_code result = tweak_app_item_load_scalar((tweak_app_context)s_context, id, &variant_value);                     \
+    if (result == TWEAK_APP_SUCCESS) {                                                                                              \
+      if (variant_value.type == VARIANT_TYPE_DESC) {                                                                                \
+        return variant_value.value.VARIANT_FIELD;                                                                                   \
+      } else {                                                                                                                      \
+        TWEAK_LOG_ERROR("%s : Type mismatch: item has type 0x%x, expected 0x%x", __func__, variant_value.type, VARIANT_TYPE_DESC);  \
+        return DEFAULT_VALUE;                                                                                                       \
+      }                                                                                                                             \
+    } else {                                                                                                                        \
+      TWEAK_LOG_ERROR("%s : tweak_app_item_load_scalar returned 0x%x", __func__, result);                                           \
+      return DEFAULT_VALUE;                                                                                                         \
+    }                                                                                                                               \
+  }                                                                                                                                 \
+                                                                                                                                    \
+  void tweak_set_##SUFFIX##_##T##_by_handle(tweak_handle handle, TYPE value) {                                                      \
+    if (invalid_context()) {                                                                                                        \
+      TWEAK_LOG_ERROR("%s : Library hasn't been initialized correctly", __func__);                                                  \
+      return;                                                                                                                       \
+    }                                                                                                                               \
+                                                                                                                                    \
+    tweak_variant variant_value = {                                                                                                 \
+      .type = VARIANT_TYPE_DESC,                                                                                                    \
+      .value = {                                                                                                                    \
+        .VARIANT_FIELD = value                                                                                                      \
+      }                                                                                                                             \
+    };                                                                                                                              \
+                                                                                                                                    \
+    tweak_app_error_code result = tweak_app_handle_replace_current_value((tweak_app_context)s_context,                              \
+      handle, &variant_value);                                                                                                      \
     if (result != TWEAK_APP_SUCCESS) {                                                                                              \
-      TWEAK_LOG_ERROR("%s : tweak_app_item_replace_current_value returned 0x%x", __func__, result);                                 \
+      TWEAK_LOG_ERROR("%s : tweak_app_handle_replace_current_value returned 0x%x", __func__, result);                               \
     }                                                                                                                               \
     tweak_variant_destroy(&variant_value);                                                                                          \
   }                                                                                                                                 \
                                                                                                                                     \
-  TYPE tweak_get_##SUFFIX##_##T(tweak_id id) {                                                                                      \
+  TYPE tweak_get_##SUFFIX##_##T##_by_handle(tweak_handle handle) {                                                                  \
     if (invalid_context()) {                                                                                                        \
       TWEAK_LOG_ERROR("%s : Library hasn't been initialized correctly", __func__);                                                  \
       return DEFAULT_VALUE;                                                                                                         \
     }                                                                                                                               \
     tweak_variant variant_value = TWEAK_VARIANT_INIT_EMPTY;                                                                         \
-    tweak_app_error_code result = tweak_app_item_clone_current_value((tweak_app_context)s_context, id, &variant_value);             \
+    tweak_app_error_code result = tweak_app_handle_load_scalar((tweak_app_context)s_context, handle, &variant_value);               \
     if (result == TWEAK_APP_SUCCESS) {                                                                                              \
       if (variant_value.type == VARIANT_TYPE_DESC) {                                                                                \
         return variant_value.value.VARIANT_FIELD;                                                                                   \
@@ -250,7 +520,7 @@ void tweak_set_item_change_listener(tweak_item_change_listener item_change_liste
         return DEFAULT_VALUE;                                                                                                       \
       }                                                                                                                             \
     } else {                                                                                                                        \
-      TWEAK_LOG_ERROR("%s : tweak_app_item_clone_current_value returned 0x%x", __func__, result);                                   \
+      TWEAK_LOG_ERROR("%s : tweak_app_handle_load_scalar returned 0x%x", __func__, result);                                         \
       return DEFAULT_VALUE;                                                                                                         \
     }                                                                                                                               \
   }
@@ -279,15 +549,7 @@ TWEAK2_IMPLEMENT_SCALAR_TYPE(scalar, uint64, TWEAK_VARIANT_TYPE_UINT64, uint64,
                                                                                                                                     \
     tweak_variant variant_value = TWEAK_VARIANT_INIT_EMPTY;                                                                         \
     tweak_variant_assign_##SUFFIX##_vector(&variant_value, initial_value, count);                                                   \
-    tweak_default_client_item_changed_listener_t client_listener = NULL;                                                            \
-    if (desc->item_change_listener != NULL)                                                                                         \
-    {                                                                                                                               \
-      client_listener = tweak_create_default_client_item_changed_listener(desc->item_change_listener, desc->cookie);                \
-      if (!client_listener)                                                                                                         \
-      {                                                                                                                             \
-        TWEAK_FATAL("Can't allocate memory");                                                                                       \
-      }                                                                                                                             \
-    }                                                                                                                               \
+    tweak_default_client_item_changed_listener_t client_listener = create_client_listener(desc);                                    \
     return tweak_app_server_add_item(s_context, desc->uri, desc->description,                                                       \
       desc->meta, &variant_value, client_listener);                                                                                 \
   }                                                                                                                                 \
@@ -317,19 +579,43 @@ TWEAK2_IMPLEMENT_SCALAR_TYPE(scalar, uint64, TWEAK_VARIANT_TYPE_UINT64, uint64,
                                                                                                                                     \
     memcpy(tweak_buffer_get_data(&variant_value.value.buffer),                                                                      \
       buffer, tweak_buffer_get_size(&variant_value.value.buffer));                                                                  \
-    result = tweak_app_item_replace_current_value((tweak_app_context)s_context, id, &variant_value);                                \
+    replace_current_value(__func__, id, &variant_value);                                                                            \
+                                                                                                                                    \
+  exit:                                                                                                                             \
+    tweak_variant_destroy(&variant_value);                                                                                          \
+  }                                                                                                                                 \
+                                                                                                                                    \
+  void tweak_get_vector_##SUFFIX(tweak_id id, T* buffer) {                                                                          \
+    tweak_app_error_code result;                                                                                                    \
+    if (invalid_context())                                                                                                          \
+    {                                                                                                                               \
+      TWEAK_LOG_ERROR("%s : Library hasn't been initialized correctly", __func__);                                                  \
+      return;                                                                                                                       \
+    }                                                                                                                               \
                                                                                                                                     \
+    tweak_variant variant_value = TWEAK_VARIANT_INIT_EMPTY;                                                                         \
+    result = tweak_app_item_clone_current_value((tweak_app_context)s_context, id, &variant_value);                                  \
     if (result != TWEAK_APP_SUCCESS)                                                                                                \
     {                                                                                                                               \
-      TWEAK_LOG_ERROR("%s : tweak_app_item_replace_current_value returned 0x%x", __func__, result);                                 \
+      TWEAK_LOG_ERROR("%s : tweak_app_item_clone_current_value returned 0x%x", __func__, result);                                   \
+      goto exit;                                                                                                                    \
+    }                                                                                                                               \
+                                                                                                                                    \
+    if (variant_value.type != VARIANT_TYPE_DESC)                                                                                    \
+    {                                                                                                                               \
+      TWEAK_LOG_ERROR("%s : item has invalid type %d, expected %d", __func__, variant_value.type, VARIANT_TYPE_DESC);               \
       goto exit;                                                                                                                    \
     }                                                                                                                               \
                                                                                                                                     \
+    memcpy(buffer, tweak_buffer_get_data_const(&variant_value.value.buffer),                                                        \
+      tweak_buffer_get_size(&variant_value.value.buffer));                                                                          \
+                                                                                                                                    \
   exit:                                                                                                                             \
     tweak_variant_destroy(&variant_value);                                                                                          \
   }                                                                                                                                 \
                                                                                                                                     \
-  void tweak_get_vector_##SUFFIX(tweak_id id, T* buffer) {                                                                          \
+  void tweak_set_vector_##SUFFIX##_by_handle(tweak_handle handle, const T* buffer)                                                  \
+  {                                                                                                                                 \
     tweak_app_error_code result;                                                                                                    \
     if (invalid_context())                                                                                                          \
     {                                                                                                                               \
@@ -338,10 +624,46 @@ TWEAK2_IMPLEMENT_SCALAR_TYPE(scalar, uint64, TWEAK_VARIANT_TYPE_UINT64, uint64,
     }                                                                                                                               \
                                                                                                                                     \
     tweak_variant variant_value = TWEAK_VARIANT_INIT_EMPTY;                                                                         \
-    result = tweak_app_item_clone_current_value((tweak_app_context)s_context, id, &variant_value);                                  \
+    result = tweak_app_handle_clone_current_value((tweak_app_context)s_context, handle, &variant_value);                            \
     if (result != TWEAK_APP_SUCCESS)                                                                                                \
     {                                                                                                                               \
-      TWEAK_LOG_ERROR("%s : tweak_app_item_clone_current_value returned 0x%x", __func__, result);                                   \
+      TWEAK_LOG_ERROR("%s : tweak_app_handle_clone_current_value returned 0x%x", __func__, result);                                 \
+      return;                                                                                                                       \
+    }                                                                                                                               \
+                                                                                                                                    \
+    if (variant_value.type != VARIANT_TYPE_DESC)                                                                                    \
+    {                                                                                                                               \
+      TWEAK_LOG_ERROR("%s : item has invalid type %d, expected %d", __func__, variant_value.type, VARIANT_TYPE_DESC);               \
+      goto exit;                                                                                                                    \
+    }                                                                                                                               \
+                                                                                                                                    \
+    memcpy(tweak_buffer_get_data(&variant_value.value.buffer),                                                                      \
+      buffer, tweak_buffer_get_size(&variant_value.value.buffer));                                                                  \
+    result = tweak_app_handle_replace_current_value((tweak_app_context)s_context, handle, &variant_value);                          \
+                                                                                                                                    \
+    if (result != TWEAK_APP_SUCCESS)                                                                                                \
+    {                                                                                                                               \
+      TWEAK_LOG_ERROR("%s : tweak_app_handle_replace_current_value returned 0x%x", __func__, result);                               \
+      goto exit;                                                                                                                    \
+    }                                                                                                                               \
+                                                                                                                                    \
+  exit:                                                                                                                             \
+    tweak_variant_destroy(&variant_value);                                                                                          \
+  }                                                                                                                                 \
+                                                                                                                                    \
+  void tweak_get_vector_##SUFFIX##_by_handle(tweak_handle handle, T* buffer) {                                                      \
+    tweak_app_error_code result;                                                                                                    \
+    if (invalid_context())                                                                                                          \
+    {                                                                                                                               \
+      TWEAK_LOG_ERROR("%s : Library hasn't been initialized correctly", __func__);                                                  \
+      return;                                                                                                                       \
+    }                                                                                                                               \
+                                                                                                                                    \
+    tweak_variant variant_value = TWEAK_VARIANT_INIT_EMPTY;                                                                         \
+    result = tweak_app_handle_clone_current_value((tweak_app_context)s_context, handle, &variant_value);                            \
+    if (result != TWEAK_APP_SUCCESS)                                                                                                \
+    {                                                                                                                               \
+      TWEAK_LOG_ERROR("%s : tweak_app_handle_clone_current_value returned 0x%x", __func__, result);                                 \
       goto exit;                                                                                                                    \
     }                                                                                                                               \
                                                                                                                                     \
@@ -351,11 +673,45 @@ TWEAK2_IMPLEMENT_SCALAR_TYPE(scalar, uint64, TWEAK_VARIANT_TYPE_UINT64, uint64,
       goto exit;                                                                                                                    \
     }                                                                                                                               \
                                                                                                                                     \
-    memcpy(buffer, tweak_buffer_get_data(&variant_value.value.buffer),                                                              \
+    memcpy(buffer, tweak_buffer_get_data_const(&variant_value.value.buffer),                                                        \
       tweak_buffer_get_size(&variant_value.value.buffer));                                                                          \
                                                                                                                                     \
   exit:                                                                                                                             \
     tweak_variant_destroy(&variant_value);                                                                                          \
+  }                                                                                                                                 \
+                                                                                                                                    \
+  void tweak_set_vector_range_##SUFFIX(tweak_id id, size_t offset, size_t count, const T* buffer)                                   \
+  {                                                                                                                                 \
+    tweak_app_error_code result;                                                                                                    \
+    if (invalid_context())                                                                                                          \
+    {                                                                                                                               \
+      TWEAK_LOG_ERROR("%s : Library hasn't been initialized correctly", __func__);                                                  \
+      return;                                                                                                                       \
+    }                                                                                                                               \
+                                                                                                                                    \
+    result = tweak_app_item_store_vector_range((tweak_app_context)s_context, id, VARIANT_TYPE_DESC,                                 \
+      offset, count, buffer);                                                                                                       \
+    if (result != TWEAK_APP_SUCCESS)                                                                                                \
+    {                                                                                                                               \
+      TWEAK_LOG_ERROR("%s : tweak_app_item_store_vector_range returned 0x%x", __func__, result);                                    \
+    }                                                                                                                               \
+  }                                                                                                                                 \
+                                                                                                                                    \
+  void tweak_get_vector_range_##SUFFIX(tweak_id id, size_t offset, size_t count, T* buffer)                                         \
+  {                                                                                                                                 \
+    tweak_app_error_code result;                                                                                                    \
+    if (invalid_context())                                                                                                          \
+    {                                                                                                                               \
+      TWEAK_LOG_ERROR("%s : Library hasn't been initialized correctly", __func__);                                                  \
+      return;                                                                                                                       \
+    }                                                                                                                               \
+                                                                                                                                    \
+    result = tweak_app_item_load_vector_range((tweak_app_context)s_context, id, VARIANT_TYPE_DESC,                                  \
+      offset, count, buffer);                                                                                                       \
+    if (result != TWEAK_APP_SUCCESS)                                                                                                \
+    {                                                                                                                               \
+      TWEAK_LOG_ERROR("%s : tweak_app_item_load_vector_range returned 0x%x", __func__, result);                                     \
+    }                                                                                                                               \
   }
 
 TWEAK2_IMPLEMENT_VECTOR_TYPE(sint8, int8_t, TWEAK_VARIANT_TYPE_VECTOR_SINT8)
@@ -405,11 +761,7 @@ tweak_id tweak_create_string(const struct tweak_add_item_ex_desc *desc, const ch
   tweak_variant variant_value = TWEAK_VARIANT_INIT_EMPTY;
   tweak_variant_assign_string(&variant_value, initial_value);
 
-  tweak_default_client_item_changed_listener_t client_listener = tweak_create_default_client_item_changed_listener(desc->item_change_listener, desc->cookie);
-  if (!client_listener)
-  {
-    TWEAK_FATAL("Can't allocate memory");
-  }
+  tweak_default_client_item_changed_listener_t client_listener = create_client_listener(desc);
 
   return tweak_app_server_add_item(s_context, desc->uri, desc->description,
                                    desc->meta, &variant_value, client_listener);
@@ -426,11 +778,7 @@ void tweak_set_string(tweak_id id, const char *string)
   tweak_variant variant_value = TWEAK_VARIANT_INIT_EMPTY;
   tweak_variant_assign_string(&variant_value, string);
 
-  tweak_app_error_code result = tweak_app_item_replace_current_value((tweak_app_context)s_context, id, &variant_value);
-  if (result != TWEAK_APP_SUCCESS)
-  {
-    TWEAK_LOG_ERROR("%s : tweak_app_item_replace_current_value returned 0x%x", __func__, result);
-  }
+  replace_current_value(__func__, id, &variant_value);
   tweak_variant_destroy(&variant_value);
 }
 
@@ -482,6 +830,15 @@ tweak_id tweak_find_id(const char* uri) {
   return tweak_app_find_id(s_context, uri);
 }
 
+tweak_handle tweak_acquire_handle(tweak_id id) {
+  if (invalid_context()) {
+    TWEAK_LOG_ERROR("%s : Library hasn't been initialized correctly", __func__);
+    return TWEAK_INVALID_HANDLE;
+  }
+
+  return tweak_app_acquire_handle(s_context, id);
+}
+
 void tweak_remove(tweak_id id) {
   if (invalid_context()) {
     TWEAK_LOG_ERROR("%s : Library hasn't been initialized correctly", __func__);
@@ -511,9 +868,11 @@ void tweak_finalize_library() {
   s_params = NULL;
   free(s_uri);
   s_uri = NULL;
+  s_dispatch_thread = false;
   (void)tweak_app_traverse_items(s_context, free_attachment, NULL);
   tweak_app_destroy_context(s_context);
   tweak_common_mutex_destroy(&s_callback_lock);
+  free_staged_batch(&s_batch);
   s_context = NULL;
 }
 
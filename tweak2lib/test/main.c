@@ -0,0 +1,241 @@
+/**
+ * @file main.c
+ * @ingroup tweak-server-implementation-test
+ * @brief part of tweak2 server library test suite.
+ *
+ * @copyright 2020-2023 Cogent Embedded, Inc. ALL RIGHTS RESERVED.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/**
+ * @defgroup tweak-server-implementation-test Test suite for tweak2 server library.
+ */
+
+#include <tweak2/tweak2.h>
+#include <tweak2/appclient.h>
+#include <tweak2/defaults.h>
+#include <tweak2/thread.h>
+#include <tweak2/variant.h>
+
+#include <acutest.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+enum {
+  WAIT_MILLIS = 5000,
+  VECTOR_SIZE = 3,
+  MAX_VALUE_BYTES = 64
+};
+
+/*
+ * Copy of the last value passed to a listener,
+ * since the view is valid only until the listener returns.
+ */
+struct listener_record {
+  tweak_common_mutex lock;
+  tweak_common_cond cond;
+  size_t count;
+  tweak_id id;
+  tweak_variant_type type;
+  float fp32;
+  size_t vector_count;
+  uint8_t vector_data[MAX_VALUE_BYTES];
+};
+
+struct count_predicate {
+  struct listener_record* record;
+  size_t count;
+};
+
+static void init_record(struct listener_record* record) {
+  memset(record, 0, sizeof(*record));
+  tweak_common_mutex_init(&record->lock);
+  tweak_common_cond_init(&record->cond);
+}
+
+static void destroy_record(struct listener_record* record) {
+  tweak_common_cond_destroy(&record->cond);
+  tweak_common_mutex_destroy(&record->lock);
+}
+
+static void record_listener(tweak_id id, const struct tweak_item_value_view* value, void* cookie) {
+  struct listener_record* record = cookie;
+  size_t size = 0;
+  switch (value->type) {
+  case TWEAK_VARIANT_TYPE_VECTOR_UINT16:
+    size = value->vector.count * sizeof(uint16_t);
+    break;
+  case TWEAK_VARIANT_TYPE_STRING:
+    size = value->vector.count + 1;
+    break;
+  default:
+    break;
+  }
+  tweak_common_mutex_lock(&record->lock);
+  record->id = id;
+  record->type = value->type;
+  record->fp32 = value->type == TWEAK_VARIANT_TYPE_FLOAT ? value->scalar.fp32 : 0.f;
+  record->vector_count = value->vector.count;
+  if (size > 0 && size <= sizeof(record->vector_data)) {
+    memcpy(record->vector_data, value->vector.data, size);
+  }
+  ++record->count;
+  tweak_common_cond_broadcast(&record->cond);
+  tweak_common_mutex_unlock(&record->lock);
+}
+
+static bool has_count(void* cookie) {
+  struct count_predicate* predicate = cookie;
+  return predicate->record->count >= predicate->count;
+}
+
+static bool wait_record(struct listener_record* record, size_t count) {
+  struct count_predicate predicate = { record, count };
+  tweak_common_mutex_lock(&record->lock);
+  tweak_common_cond_timed_wait_with_pred(&record->cond, &record->lock,
+    WAIT_MILLIS, &has_count, &predicate);
+  bool result = record->count >= count;
+  tweak_common_mutex_unlock(&record->lock);
+  return result;
+}
+
+static size_t get_record_count(struct listener_record* record) {
+  tweak_common_mutex_lock(&record->lock);
+  size_t count = record->count;
+  tweak_common_mutex_unlock(&record->lock);
+  return count;
+}
+
+static void set_remote_value(tweak_app_client_context client_context,
+  const char* uri, tweak_variant* value)
+{
+  tweak_id id = TWEAK_INVALID_ID;
+  TEST_CHECK(tweak_app_client_wait_uris(client_context, &uri, 1, &id, WAIT_MILLIS)
+    == TWEAK_APP_SUCCESS);
+  TEST_CHECK(tweak_app_item_replace_current_value(client_context, id, value)
+    == TWEAK_APP_SUCCESS);
+  tweak_variant_destroy(value);
+}
+
+void test_listener_ex(void) {
+  srand((unsigned)time(NULL));
+  char uri[256];
+  int port = 32769 + rand() % 20000;
+  snprintf(uri, sizeof(uri), TWEAK_DEFAULT_ENDPOINT_TEMPLATE, port);
+
+  struct listener_record common_record;
+  struct listener_record string_record;
+  init_record(&common_record);
+  init_record(&string_record);
+
+  tweak_initialize_library("nng", "role=server", uri);
+  tweak_set_item_change_listener_ex(&record_listener, &common_record);
+
+  tweak_id scalar_id = tweak_add_scalar_float("/listener/scalar", "", "", 0.f);
+  TEST_CHECK(scalar_id != TWEAK_INVALID_ID);
+
+  uint16_t vector[VECTOR_SIZE] = { 0 };
+  struct tweak_add_item_ex_desc vector_desc = {
+    .uri = "/listener/vector",
+    .description = "",
+    .meta = ""
+  };
+  tweak_id vector_id = tweak_create_vector_uint16(&vector_desc, vector, VECTOR_SIZE);
+  TEST_CHECK(vector_id != TWEAK_INVALID_ID);
+
+  /* Item specific listener takes precedence over the common one */
+  struct tweak_add_item_ex_desc string_desc = {
+    .uri = "/listener/string",
+    .description = "",
+    .meta = "",
+    .cookie = &string_record,
+    .item_change_listener_ex = &record_listener
+  };
+  tweak_id string_id = tweak_create_string(&string_desc, "");
+  TEST_CHECK(string_id != TWEAK_INVALID_ID);
+
+  tweak_app_client_context client_context = tweak_app_create_client_context(
+    "nng", "role=client", uri, NULL);
+  TEST_CHECK(client_context != NULL);
+
+  puts("Set values locally...");
+  tweak_set_scalar_float(scalar_id, 1.5f);
+  uint16_t local_vector[VECTOR_SIZE] = { 1, 2, 3 };
+  tweak_set_vector_uint16(vector_id, local_vector);
+  tweak_set_string(string_id, "local");
+  TEST_CHECK(tweak_get_scalar_float(scalar_id) == 1.5f);
+  tweak_get_vector_uint16(vector_id, vector);
+  TEST_CHECK(memcmp(vector, local_vector, sizeof(vector)) == 0);
+  char string[MAX_VALUE_BYTES];
+  tweak_get_string(string_id, string, sizeof(string));
+  TEST_CHECK(strcmp(string, "local") == 0);
+
+  /* Listeners report changes initiated by remote side only */
+  tweak_common_sleep(WAIT_MILLIS / 10);
+  TEST_CHECK(get_record_count(&common_record) == 0);
+  TEST_CHECK(get_record_count(&string_record) == 0);
+  puts("SUCCESS");
+
+  puts("Set scalar remotely...");
+  tweak_variant value = TWEAK_VARIANT_INIT_EMPTY;
+  tweak_variant_assign_float(&value, 2.5f);
+  set_remote_value(client_context, "/listener/scalar", &value);
+  TEST_CHECK(wait_record(&common_record, 1));
+  TEST_CHECK(common_record.id == scalar_id);
+  TEST_CHECK(common_record.type == TWEAK_VARIANT_TYPE_FLOAT);
+  TEST_CHECK(common_record.fp32 == 2.5f);
+  TEST_CHECK(tweak_get_scalar_float(scalar_id) == 2.5f);
+  puts("SUCCESS");
+
+  puts("Set vector remotely...");
+  uint16_t remote_vector[VECTOR_SIZE] = { 4, 5, 6 };
+  tweak_variant_assign_uint16_vector(&value, remote_vector, VECTOR_SIZE);
+  set_remote_value(client_context, "/listener/vector", &value);
+  TEST_CHECK(wait_record(&common_record, 2));
+  TEST_CHECK(common_record.id == vector_id);
+  TEST_CHECK(common_record.type == TWEAK_VARIANT_TYPE_VECTOR_UINT16);
+  TEST_CHECK(common_record.vector_count == VECTOR_SIZE);
+  TEST_CHECK(memcmp(common_record.vector_data, remote_vector, sizeof(remote_vector)) == 0);
+  puts("SUCCESS");
+
+  puts("Set string remotely...");
+  tweak_variant_assign_string(&value, "remote");
+  set_remote_value(client_context, "/listener/string", &value);
+  TEST_CHECK(wait_record(&string_record, 1));
+  TEST_CHECK(string_record.id == string_id);
+  TEST_CHECK(string_record.type == TWEAK_VARIANT_TYPE_STRING);
+  TEST_CHECK(string_record.vector_count == strlen("remote"));
+  TEST_CHECK(strcmp((const char*)string_record.vector_data, "remote") == 0);
+  TEST_CHECK(get_record_count(&common_record) == 2);
+  puts("SUCCESS");
+
+  tweak_app_destroy_context(client_context);
+  tweak_finalize_library();
+  destroy_record(&string_record);
+  destroy_record(&common_record);
+}
+
+TEST_LIST = {
+   { "test-listener-ex", test_listener_ex },
+   { NULL, NULL }     /* zeroed record marking the end of the list */
+};